@@ -15,6 +15,11 @@ else
 	# run single instance
 	confstr="--extlearn --flpcheck=aufs --ufslearn=none --liberalsafety reachability.hex -n=1;--extlearn --flpcheck=aufs --ufslearn=none --strongsafety reachability_strongsafety.hex -n=1"
 
+	# warm starts: parse once, then load the snapshots instead of the input
+	dlvhex2 --plugindir=../../testsuite --liberalsafety --noeval --save-snapshot=$instance.ls.snapshot reachability.hex $instance >/dev/null 2>&1
+	dlvhex2 --plugindir=../../testsuite --strongsafety --noeval --save-snapshot=$instance.ss.snapshot reachability_strongsafety.hex $instance >/dev/null 2>&1
+	confstr="$confstr;--extlearn --flpcheck=aufs --ufslearn=none --liberalsafety --load-snapshot=$instance.ls.snapshot -n=1;--extlearn --flpcheck=aufs --ufslearn=none --strongsafety --load-snapshot=$instance.ss.snapshot -n=1"
+
 	$bmscripts/runconfigs.sh "dlvhex2 --plugindir=../../testsuite --verbose=8 CONF INST" "$confstr" "$instance" "$to" "$bmscripts/gstimeoutputbuilder.sh"
 fi
 
@@ -17,9 +17,13 @@ else
 	pushd clasp/build
 	ln -s fpic release
 	popd
+	CLASP_MT=""
+	if test "x$CLASP_THREADS" = xyes; then
+		CLASP_MT="--with-mt"
+	fi
 	(
 		cd clasp
-		./configure.sh --config=fpic CXX="$CXX -DNDEBUG -O3" CXXFLAGS=-fPIC ||
+		./configure.sh --config=fpic $CLASP_MT CXX="$CXX -DNDEBUG -O3" CXXFLAGS=-fPIC ||
 			{ echo "configuring clasp failed!"; exit -1; }
 	)
 fi
@@ -107,6 +107,8 @@ private ostream_printable<OrdinaryAtom>
      *
      * Also note: If we only need this for printing, we should generate it on-demand
      * and save a lot of effort if not everything is printed.
+     * This is done if Registry::setLazyAtomText is enabled: then stored atoms
+     * have an empty text and RawPrinter::printOrdinaryAtom renders it from the tuple.
      */
     std::string text;
 
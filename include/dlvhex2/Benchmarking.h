@@ -42,7 +42,9 @@
 #include <boost/typeof/typeof.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <vector>
+#include <map>
 #include <ostream>
 
 // Benchmarking is always compiled into dlvhex,
@@ -662,8 +664,10 @@ namespace benchmark
                 std::vector<Stat> instrumentations;
                 /** \brief Map from benchmark names to IDs. */
                 std::map<std::string, ID> name2id;
-                /** \brief Stack of currently running instrumentations. */
-                std::vector<Current> current;
+                /** \brief Stacks of currently running instrumentations, one for each thread. */
+                std::map<boost::thread::id, std::vector<Current> > currentStacks;
+                /** \brief Returns the stack of currently running instrumentations of the calling thread. */
+                inline std::vector<Current>& currentStack() { return currentStacks[boost::this_thread::get_id()]; }
 
                 /** \brief Interval for printing continuous benchmarks. */
                 Duration printInterval;
@@ -735,6 +739,7 @@ namespace benchmark
             boost::mutex::scoped_lock lock(mutex);
 //            if (sus) return;
             Stat& st = instrumentations[id];
+            std::vector<Current>& current = currentStack();
 
             Time now = boost::posix_time::microsec_clock::local_time();
 
@@ -759,6 +764,7 @@ namespace benchmark
             boost::mutex::scoped_lock lock(mutex);
 //            if (sus) return;
             Stat& st = instrumentations[id];
+            std::vector<Current>& current = currentStack();
 
             Time now = boost::posix_time::microsec_clock::local_time();
 
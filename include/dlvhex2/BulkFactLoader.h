@@ -0,0 +1,214 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   BulkFactLoader.h
+ *
+ * @brief  Loads ground facts and CSV files directly into the registry and the EDB.
+ */
+
+#ifndef BULK_FACT_LOADER_H__
+#define BULK_FACT_LOADER_H__
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/fwd.h"
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Atoms.h"
+
+#include <boost/cstdint.hpp>
+
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+/**
+ * \brief Loads ground facts without going through HexGrammar.
+ *
+ * A hand-written scanner tokenizes plain fact files (only facts of the form
+ * <tt>p(a,"b",1).</tt> or <tt>p.</tt>, whitespace and comments) and CSV files
+ * (see InputProvider::addCSVFileInput). Terms are interned and ground atoms
+ * are stored in Registry::ogatoms and the EDB in batches, exactly as the
+ * parser would have done it (same terms, atoms, text and maxint).
+ *
+ * Scanning of fact files stops at the first statement which is not a plain
+ * fact (rules, constraints, directives, function terms, variables, ...); all
+ * facts before this statement are loaded and the remaining input must be
+ * processed by the full parser (see ModuleHexParser::parse).
+ *
+ * With more than one thread (option ParserThreads), large fact texts are
+ * split at line boundaries into one chunk per thread. The chunks are scanned
+ * in parallel, each with a local dictionary of its terms and the texts of
+ * its atoms; then the chunks are merged into the registry in input order.
+ * Thus terms and atoms get the same IDs as with a single thread. Chunks
+ * which do not start at a statement boundary (statements spanning lines)
+ * are discarded and loaded sequentially.
+ */
+class DLVHEX_EXPORT BulkFactLoader
+{
+    public:
+        /** \brief Number of facts which are scanned before they are stored. */
+        static const unsigned DefaultBatchSize = 4096;
+
+        /** \brief Constructor.
+         * @param ctx ProgramCtx whose registry and EDB receive the facts; the EDB must exist.
+         * @param batchSize Number of facts which are scanned before they are stored. */
+        BulkFactLoader(ProgramCtx& ctx, unsigned batchSize = DefaultBatchSize);
+
+        /** \brief Loads facts from HEX text.
+         * @param begin Begin of the text.
+         * @param end End of the text.
+         * @return Position of the first statement which is not a plain fact,
+         * or \p end if the whole text consists of facts. */
+        const char* loadFacts(const char* begin, const char* end);
+
+        /** \brief Loads facts from a piece of HEX text which is continued by further pieces.
+         *
+         * Statements and comments which reach \p end are not loaded since they
+         * may continue in the next piece.
+         * @param begin Begin of the text.
+         * @param end End of the text.
+         * @param nonFact Set to true if loading stopped at a statement which is not a plain fact
+         * and to false if it stopped at an incomplete statement (or at \p end).
+         * @return Position of the first statement which was not loaded. */
+        const char* loadFactsPartial(const char* begin, const char* end, bool& nonFact);
+
+        /** \brief Loads a file in CSV format.
+         *
+         * Each line becomes a fact over \p predicate whose first argument is the
+         * line number (starting at 0), followed by the semicolon-separated fields;
+         * fields starting with a digit are integers, all others are quoted strings.
+         * Throws a GeneralError if the file cannot be read and a SyntaxError if
+         * a field cannot be converted.
+         * @param predicate Predicate used to store the CSV content.
+         * @param filename CSV file to read from. */
+        void loadCSVFile(const std::string& predicate, const std::string& filename);
+
+        /** \brief Minimum size of a chunk which is scanned by its own thread. */
+        static const std::size_t MinimumChunkSize = 1 << 16;
+
+        /** \brief Sets the number of threads for loading facts from text.
+         *
+         * Initially the value of the option ParserThreads is used.
+         * @param threads Number of threads (1 loads sequentially). */
+        void setThreads(unsigned threads)
+            { this->threads = (threads == 0) ? 1 : threads; }
+
+        /** \brief Returns the number of facts loaded so far.
+         * @return Number of facts. */
+        std::size_t getFactCount() const
+            { return factCount; }
+
+    private:
+        /** \brief Type of a scanned term. */
+        enum TokenType
+        {
+            /** \brief Constant or quoted string which is used as symbol as it is. */
+            Symbol,
+            /** \brief Content of a quoted string without the quotes (from CSV). */
+            QuotedContent,
+            /** \brief Integer term. */
+            Integer
+        };
+
+        /** \brief Term scanned from the input (refers to the input buffer). */
+        struct Token
+        {
+            TokenType type;
+            const char* begin;
+            uint32_t length;
+            uint32_t value;
+            Token(TokenType type, const char* begin, uint32_t length, uint32_t value = 0):
+                type(type), begin(begin), length(length), value(value) {}
+        };
+
+        /** \brief Result of scanning a statement. */
+        enum ScanResult
+        {
+            /** \brief Plain fact, its tokens were added to the batch. */
+            Fact,
+            /** \brief Not a plain fact. */
+            NonFact,
+            /** \brief The text ended before the statement could be classified. */
+            Incomplete
+        };
+
+        /** \brief Part of the text which is scanned by one thread. */
+        struct Chunk;
+
+        /** \brief Scans one statement and adds its tokens to \p tokens if it is a fact.
+         * @param pos Begin of the statement, set to the end of the fact.
+         * @param end End of the text.
+         * @param tokens Receives the tokens of the statement (also if it is no fact).
+         * @return See ScanResult. */
+        static ScanResult scanStatement(const char*& pos, const char* end, std::vector<Token>& tokens);
+        /** \brief Scans a chunk and builds its term dictionary and atom texts (thread-safe).
+         * @param chunk Chunk to scan. */
+        static void scanChunk(Chunk& chunk);
+        /** \brief Implements loadFacts and loadFactsPartial. */
+        const char* load(const char* begin, const char* end, bool final, bool& nonFact);
+        /** \brief Implements loadFacts and loadFactsPartial by scanning chunks in parallel. */
+        const char* loadParallel(const char* begin, const char* end, bool final, bool& nonFact);
+        /** \brief Stores the terms and facts of a scanned chunk.
+         * @param chunk Chunk to store. */
+        void mergeChunk(Chunk& chunk);
+        /** \brief Stores all scanned facts and clears the batch. */
+        void commit();
+        /** \brief Finishes a scanned fact and stores the batch if it is full. */
+        void endFact();
+        /** \brief Looks up or stores the term for a token and appends it to the atom text.
+         * @param token Scanned term.
+         * @return ID of the term. */
+        ID getTerm(const Token& token);
+        /** \brief Looks up or stores the constant term for a token.
+         * @param token Scanned term (no integer).
+         * @return ID of the term. */
+        ID internSymbol(const Token& token);
+
+        ProgramCtx& ctx;
+        RegistryPtr reg;
+        unsigned batchSize;
+        unsigned threads;
+        std::size_t factCount;
+        bool lazyText;
+        /** \brief Terms of all facts in the current batch. */
+        std::vector<Token> tokens;
+        /** \brief Index of the first token of each fact in the current batch (plus end). */
+        std::vector<uint32_t> factBegins;
+        /** \brief Reused buffers for symbols and atoms. */
+        std::string symbol;
+        OrdinaryAtom atom;
+        /** \brief Cache for the predicate of the last fact (facts usually come sorted by predicate). */
+        std::string lastPredicate;
+        ID lastPredicateID;
+};
+
+DLVHEX_NAMESPACE_END
+#endif                           // BULK_FACT_LOADER_H__
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
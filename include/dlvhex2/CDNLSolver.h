@@ -46,6 +46,7 @@
 #include "dlvhex2/DynamicVector.h"
 #include "dlvhex2/Nogood.h"
 #include "dlvhex2/SATSolver.h"
+#include "dlvhex2/SolverWarmStartCache.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/unordered_map.hpp>
 
@@ -125,6 +126,38 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         /** \brief Stores the nogoods which are currently contradictory (i.e., all literals are satisfied). */
         Set<int> contradictoryNogoods;
 
+        // dense watching data structures (alternative to the ones above, selected by option CDNLPropagation)
+        /** \brief True if unit propagation uses the dense two-watched-literal engine instead of the watching sets. */
+        bool denseWatches;
+        /** \brief Truth value of each atom (0=unassigned, 1=true, 2=false), indexed by IDAddress. */
+        std::vector<unsigned char> atomValue;
+        /** \brief Decision level of each assigned atom, indexed by IDAddress. */
+        std::vector<int> atomLevel;
+        /** \brief Literals of all nogoods as codes (see literalCode), stored consecutively; the first two literals of a nogood are its watches. */
+        std::vector<uint32_t> nogoodLiterals;
+        /** \brief Offset of the first literal of each nogood in nogoodLiterals. */
+        std::vector<uint32_t> nogoodBegin;
+        /** \brief Number of literals of each nogood. */
+        std::vector<uint32_t> nogoodLength;
+        /** \brief Stores for each literal code the nogoods which watch it; entries of nogoods which moved their watch are dropped lazily. */
+        std::vector<std::vector<int> > watchLists;
+        /** \brief Literal codes in the order of assignment; those from position propagationHead on still need to be propagated. */
+        std::vector<uint32_t> trail;
+        /** \brief Position of the current assignment of each atom in the trail, indexed by IDAddress. */
+        std::vector<uint32_t> trailPosition;
+        /** \brief Next trail position to propagate. */
+        uint32_t propagationHead;
+        /** \brief True if atoms were unassigned since the trail was compacted the last time. */
+        bool trailDirty;
+        /** \brief Nogoods which were added (or became non-contradictory by backtracking) but are not watched yet. */
+        std::vector<int> pendingNogoods;
+        /** \brief Nogoods whose falsified watch was assigned on a higher decision level than their implication would have; they are rechecked after backtracking. */
+        std::vector<int> recheckNogoods;
+        /** \brief Stores for each nogood when it was visited the last time, used to drop duplicate watch list entries. */
+        std::vector<uint32_t> nogoodVisit;
+        /** \brief Number of watch lists visited so far. */
+        uint32_t visitCounter;
+
         // variable selection heuristics
         /** \brief Counter for total number of conflicts so far (periodic reset). */
         int conflicts;
@@ -134,6 +167,49 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         boost::unordered_map<IDAddress, int, SimpleHashIDAddress> varCounterNeg;
         /** \brief Stores the indexes of the clauses which were recently contradictory in chronological order. */
         std::vector<int> recentConflicts;
+        /** \brief True if decisions are taken from an activity-ordered heap (option CDNLHeuristics) instead of the recent conflicts. */
+        bool vsids;
+        /** \brief Activity of each atom, indexed by IDAddress (only with vsids). */
+        std::vector<double> activity;
+        /** \brief Number of positive minus number of negative occurrences of each atom in conflicts, indexed by IDAddress (only with vsids). */
+        std::vector<int> polarity;
+        /** \brief Amount by which the activity of an atom is increased when it is involved in a conflict; grows after each conflict to decay older bumps. */
+        double activityIncrement;
+        /** \brief Binary max-heap of the unassigned atoms of the instance ordered by activity (only with vsids). */
+        std::vector<IDAddress> decisionHeap;
+        /** \brief Position of each atom in decisionHeap, -1 if it is not in the heap and -2 if it is not part of the instance. */
+        std::vector<int> heapPosition;
+        /** \brief True if the truth value of unassigned atoms is remembered and reused for decisions (option CDNLPhaseSaving). */
+        bool phaseSaving;
+        /** \brief Last truth value of each atom (0=none, 1=true, 2=false), indexed by IDAddress (only with phase saving). */
+        std::vector<unsigned char> savedPhase;
+
+        // restarts
+        /** \brief Restart strategy (option CDNLRestarts): 0=none, 1=Luby sequence, 2=geometric. */
+        int restartStrategy;
+        /** \brief Number of conflicts of the first restart interval (option CDNLRestartBase). */
+        int restartBase;
+        /** \brief Number of restarts so far. */
+        int restarts;
+        /** \brief Number of conflicts since the last restart. */
+        int conflictsSinceRestart;
+        /** \brief Number of conflicts after which the next restart is done. */
+        double restartLimit;
+
+        // learned nogood database
+        /** \brief Number of conflicts between two reductions of the learned nogoods (option CDNLNogoodReduction); 0 if learned nogoods are never deleted. */
+        int reductionInterval;
+        /** \brief Number of conflicts since the last reduction. */
+        int conflictsSinceReduction;
+        /** \brief Literal block distance of each learned nogood (number of distinct decision levels when it was learned), -1 for deleted nogoods,
+         * 0 for nogoods of the instance; indices beyond the end belong to the instance (only with reduction). */
+        std::vector<int> nogoodLBD;
+        /** \brief Activity of each nogood, increased whenever it is used as reason in conflict analysis (only with reduction). */
+        std::vector<double> nogoodActivity;
+        /** \brief Amount by which the activity of a nogood is increased; grows after each conflict to decay older bumps. */
+        double nogoodActivityIncrement;
+        /** \brief Indices of the learned nogoods which were not deleted so far. */
+        std::vector<int> learnedNogoods;
 
         // statistics
         /** \brief Number of assignments so far. */
@@ -146,6 +222,10 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         long cntResSteps;
         /** \brief Number of conflicts so far. */
         long cntDetectedConflicts;
+        /** \brief Number of restarts so far. */
+        long cntRestarts;
+        /** \brief Number of deleted learned nogoods so far. */
+        long cntDeletedNogoods;
 
         /** \brief Temporary objects (they are just class members in order to make them reuseable without reallocation). */
         Set<ID> tmpWatched;
@@ -185,6 +265,36 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
             return ID(lit.kind ^ ID::NAF_MASK, lit.address);
         }
 
+        /** \brief Encodes a literal as integer for indexing the dense watching data structures.
+         *
+         * For ground literals, the code coincides with NogoodSet::compactLiteral.
+         * @param lit Literal ID.
+         * @return 2 * address for positive and 2 * address + 1 for default-negated literals. */
+        static inline uint32_t literalCode(ID lit) {
+            return (lit.address << 1) | (lit.isNaf() ? 1 : 0);
+        }
+
+        /** \brief Decodes a literal code.
+         * @param code Literal code as computed by literalCode.
+         * @return Literal ID. */
+        static inline ID codeLiteral(uint32_t code) {
+            return createLiteral(code >> 1, (code & 1) == 0);
+        }
+
+        /** \brief Checks if a literal given by its code is satisfied (dense representation).
+         * @param code Literal code.
+         * @return True if the literal is satisfied and false otherwise. */
+        inline bool codeSatisfied(uint32_t code) const {
+            return atomValue[code >> 1] == 1 + (code & 1);
+        }
+
+        /** \brief Checks if a literal given by its code is falsified (dense representation).
+         * @param code Literal code.
+         * @return True if the literal is falsified and false otherwise. */
+        inline bool codeFalsified(uint32_t code) const {
+            return atomValue[code >> 1] == 2 - (code & 1);
+        }
+
         /** \brief Checks if the assignment is currently complete.
          * @return True if complete and false otherwise. */
         inline bool complete() {
@@ -195,7 +305,7 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         bool unitPropagation(Nogood& violatedNogood);
         void loadAddedNogoods();
         void analysis(Nogood& violatedNogood, Nogood& learnedNogood, int& backtrackDL);
-        Nogood resolve(Nogood& ng1, Nogood& ng2, IDAddress litadr);
+        Nogood resolve(const Nogood& ng1, const Nogood& ng2, IDAddress litadr);
         virtual void setFact(ID fact, int dl, int cause);
         virtual void clearFact(IDAddress litadr);
         void backtrack(int dl);
@@ -218,6 +328,22 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         /** \brief Updates all data structures after a literal was unassigned.
          * @param lit Literal which is now unassigned. */
         void updateWatchingStructuresAfterClearFact(ID lit);
+        /** \brief Copies the literals of a nogood into the dense literal array and schedules it for watching.
+         * @param index Index of the nogood. */
+        void storeDenseNogood(int index);
+        /** \brief Chooses the watches of a scheduled nogood and propagates it if it is unit.
+         * @param index Index of the nogood.
+         * @return False if the nogood is contradictory and true otherwise. */
+        bool watchDenseNogood(int index);
+        /** \brief Removes unassigned literals from the trail and reschedules the literals and nogoods which need to be propagated again. */
+        void compactTrail();
+        /** \brief Propagates all pending nogoods and trail literals using the dense watching data structures.
+         * @param violatedNogood Set to a contradictory nogood if propagation fails.
+         * @return False if a contradictory nogood was found and true otherwise. */
+        bool propagateTrail(Nogood& violatedNogood);
+        /** \brief Grows the dense per-atom vectors such that they can store the given atom.
+         * @param adr Atom IDAddress. */
+        void growDenseVectors(IDAddress adr);
         /** \brief Removed all watches for a nogood.
          * @param nogoodNr Index of the nogood to remove all watches for. */
         void inactivateNogood(int nogoodNr);
@@ -234,6 +360,89 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
         /** \brief Increses the usage counter for all variables in a nogood.
          * @param ng The nogood whose variables shall be touched. */
         void touchVarsInNogood(Nogood& ng);
+        /** \brief Decays the activity of all atoms after a conflict (only with vsids). */
+        void decayActivities();
+        /** \brief Fills the decision heap with all unassigned atoms of the instance. */
+        void initDecisionHeuristics();
+        /** \brief Inserts an atom into the decision heap if it is part of the instance and not in the heap yet.
+         * @param adr Atom IDAddress. */
+        void heapInsert(IDAddress adr);
+        /** \brief Moves an atom in the decision heap towards the root until the heap property holds.
+         * @param pos Current position of the atom in the heap. */
+        void heapPercolateUp(int pos);
+        /** \brief Moves an atom in the decision heap towards the leaves until the heap property holds.
+         * @param pos Current position of the atom in the heap. */
+        void heapPercolateDown(int pos);
+        /** \brief Removes the most active atom from the decision heap.
+         * @return Atom IDAddress. */
+        IDAddress heapRemoveMax();
+        /** \brief Selects the truth value of a decision literal; uses the saved phase if phase saving is enabled.
+         * @param adr Atom IDAddress.
+         * @param preferred Truth value to use if no phase is saved.
+         * @return Decision literal. */
+        ID decisionLiteral(IDAddress adr, bool preferred);
+
+        // members for restarts
+        /** \brief Computes the i-th element of the Luby sequence (1, 1, 2, 1, 1, 2, 4, ...).
+         * @param i Index starting at 0.
+         * @return Sequence element. */
+        static int luby(int i);
+        /** \brief Counts a conflict and restarts the search if the restart strategy asks for it.
+         *
+         * A restart backtracks to the exhausted decision level, such that no models are generated twice. */
+        void restartIfDue();
+
+        // members for the learned nogood database
+        /** \brief Adds a nogood which was learned during search and records it for later deletion if reduction is enabled.
+         *
+         * Must be called before backtracking such that the literal block distance can be computed.
+         * @param ng Learned nogood.
+         * @return Index of the nogood. */
+        int addLearnedNogood(const Nogood& ng);
+        /** \brief Computes the number of distinct decision levels of the literals in a nogood; each unassigned literal counts as a level on its own.
+         * @param ng Nogood.
+         * @return Literal block distance of \p ng. */
+        int literalBlockDistance(const Nogood& ng);
+        /** \brief Increases the activity of a learned nogood.
+         * @param index Index of the nogood. */
+        void bumpNogood(int index);
+        /** \brief Checks if a nogood is the reason for a current assignment.
+         * @param index Index of the nogood.
+         * @return True if some atom was implied by the nogood and is still assigned. */
+        bool isReason(int index);
+        /** \brief Checks if a nogood was deleted by a reduction.
+         * @param index Index of the nogood.
+         * @return True if the nogood was deleted and false otherwise. */
+        inline bool isDeletedNogood(int index) const {
+            return index < (int)nogoodLBD.size() && nogoodLBD[index] == -1;
+        }
+        /** \brief Counts a conflict and deletes the less useful half of the learned nogoods if the reduction interval is over.
+         *
+         * Nogoods which are currently reasons and nogoods with a literal block distance of at most 2 are kept. */
+        void reduceLearnedNogoodsIfDue();
+        /** \brief Deletes a nogood from the watching data structures and replaces it by the empty nogood, such that other indices remain valid.
+         * @param index Index of the nogood. */
+        void removeNogoodAndUpdateWatchingStructures(int index);
+        /** \brief Removes the literals of deleted nogoods from the dense literal array. */
+        void compactDenseNogoods();
+
+        // warm start
+        /** \brief Cache which receives the learned nogoods and phases when the solver is destroyed; NULL if warmStart was not called. */
+        SolverWarmStartCachePtr warmStartCache;
+        /** \brief Key of the instance in warmStartCache. */
+        SolverWarmStartCache::Key warmStartKey;
+        /** \brief Atoms which are not stored in warmStartCache; NULL if all atoms are stored. */
+        InterpretationConstPtr warmStartExcluded;
+        /** \brief Index of the first nogood which was not part of the instance when warmStart was called. */
+        int firstLearnedNogood;
+        /** \brief Checks if a nogood is implied by the current nogoods, i.e., if assigning its literals leads to a conflict by unit propagation.
+         *
+         * Must be called on decision level 0 and leaves the solver on decision level 0; consequences of the facts may remain assigned.
+         * @param ng Nogood to check.
+         * @return True if \p ng is implied and false otherwise. */
+        bool impliedByUnitPropagation(const Nogood& ng);
+        /** \brief Stores the learned nogoods and phases over the atoms which are not excluded in warmStartCache. */
+        void storeWarmStart();
 
         // external learning
         /** \brief Set of atoms which (possibly) changes since last call of external learners because they have been reassigned. */
@@ -313,6 +522,24 @@ class CDNLSolver : virtual public NogoodContainer, virtual public SATSolver
          * @param ns Instance as NogoodSet.
          */
         CDNLSolver(ProgramCtx& ctx, NogoodSet ns);
+        /**
+         * \brief Destructor.
+         *
+         * Stores the learned nogoods and phases in the warm-start cache if warmStart was called.
+         */
+        virtual ~CDNLSolver();
+
+        /**
+         * \brief Preloads learned nogoods and phases of an earlier solver for the same instance and stores the own ones on destruction.
+         *
+         * Nogoods of the cache are only added if they are implied by the instance by unit propagation, hence the cache
+         * cannot change the models even if it was written for a different instance. Must be called before the first model is computed;
+         * consequences of the instance on decision level 0 may remain assigned afterwards.
+         * @param cache Warm-start cache.
+         * @param key Key of the instance in \p cache.
+         * @param excluded Atoms which shall not be stored in the cache (e.g., input atoms whose truth value changes between runs); may be NULL.
+         */
+        void warmStart(SolverWarmStartCachePtr cache, SolverWarmStartCache::Key key, InterpretationConstPtr excluded);
 
         virtual void restartWithAssumptions(const std::vector<ID>& assumptions);
         virtual void addPropagator(PropagatorCallback* pb);
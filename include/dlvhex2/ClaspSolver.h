@@ -39,7 +39,10 @@
 
 #ifdef HAVE_LIBCLASP
 
-#define DISABLE_MULTI_THREADING  // we don't need multithreading capabilities
+// parallel solving requires a clasp library which was built with multi-threading support (configure option --enable-claspthreads)
+#ifndef HAVE_CLASP_THREADS
+#define DISABLE_MULTI_THREADING
+#endif
 
 #include "dlvhex2/ID.h"
 #include "dlvhex2/Interpretation.h"
@@ -57,6 +60,7 @@
 #include <set>
 #include <map>
 #include <queue>
+#include <deque>
 
 #include <boost/foreach.hpp>
 #include <boost/graph/graph_traits.hpp>
@@ -65,12 +69,17 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/date_time.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/interprocess/sync/interprocess_semaphore.hpp>
 
-#define WITH_THREADS 0           // this is only relevant for option parsing, so we don't care at the moment
+#ifdef HAVE_CLASP_THREADS
+#define WITH_THREADS 1
+#else
+#define WITH_THREADS 0
+#endif
 
 #include "clasp/clasp_facade.h"
 #include "clasp/model_enumerators.h"
@@ -124,12 +133,18 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
     private:
         /**
          * \brief Propagator for external behavior learning.
+         *
+         * One instance is attached to each clasp solver (thread); the assignment is extracted separately for each of them.
          */
         class ExternalPropagator : public Clasp::PostPropagator
         {
             private:
                 /** \brief Reference to solver class instance. */
                 ClaspSolver& cs;
+                /** \brief Clasp solver (thread) this propagator is attached to. */
+                Clasp::Solver& solver;
+                /** \brief Index (counted since the creation of the ClaspSolver) of the next nogood in ClaspSolver::nogoods which was not yet added to ExternalPropagator::solver. */
+                std::size_t nextNogood;
 
                 // for deferred propagation to HEX
                 /** \brief Timestamp of last propagation. */
@@ -158,8 +173,9 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
                 /**
                  * \brief Constructor.
                  * @param cs Reference to solver object.
+                 * @param solver Clasp solver (thread) to attach the propagator to.
                  */
-                ExternalPropagator(ClaspSolver& cs);
+                ExternalPropagator(ClaspSolver& cs, Clasp::Solver& solver);
                 /** \brief Destructor. */
                 virtual ~ExternalPropagator();
 
@@ -174,6 +190,11 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
                  * @return True if the assignment is now inconsistent (and needs backtracking) and false otherwise.
                  */
                 bool addNewNogoodsToClasp(Clasp::Solver& s);
+                /**
+                 * \brief Returns the index of the next nogood in ClaspSolver::nogoods which was not yet added to clasp by this propagator.
+                 * @return Index counted since the creation of the ClaspSolver.
+                 */
+                inline std::size_t getNextNogood() const { return nextNogood; }
 
                 // inherited from clasp
                 virtual bool propagateFixpoint(Clasp::Solver& s, Clasp::PostPropagator* ctx);
@@ -183,6 +204,25 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
                 virtual unsigned int priority() const;
         };
 
+        /**
+         * \brief Passes models found by a parallel clasp search to ClaspSolver::getNextModel.
+         */
+        class ParallelModelHandler : public Clasp::EventHandler
+        {
+            private:
+                /** \brief Reference to solver class instance. */
+                ClaspSolver& cs;
+            public:
+                /**
+                 * \brief Constructor.
+                 * @param cs Reference to solver object.
+                 */
+                ParallelModelHandler(ClaspSolver& cs) : cs(cs) {}
+
+                // inherited from clasp
+                virtual bool onModel(const Clasp::Solver& s, const Clasp::Model& m);
+        };
+
         // interface to clasp internals
         /** \brief Stores the result of a nogood transformation from HEX to clasp. */
         struct TransformNogoodToClaspResult
@@ -202,23 +242,6 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
             TransformNogoodToClaspResult(Clasp::LitVec clause, bool tautological, bool outOfDomain) : clause(clause), tautological(tautological), outOfDomain(outOfDomain){}
         };
 
-        // itoa/atio wrapper
-        /**
-         * \brief Encodes an IDAddress as string.
-         *
-         * This is necessary because clasp supports only strings for naming atoms.
-         * @param adr IDAddress.
-         * @return String representation of \p adr.
-         */
-        static std::string idAddressToString(IDAddress adr);
-        /**
-         * \brief Extracts an IDAddress from a string.
-         *
-         * This is necessary because clasp supports only strings for naming atoms.
-         * @param str Valid string representation of an IDAddress.
-         * @return \p str as IDAddress.
-         */
-        static IDAddress stringToIDAddress(std::string str);
 
         /** \brief Extracts the current interpretation from clasp into the given HEX assignment (parameters may be null-pointers)
          *
@@ -288,6 +311,45 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
          * \brief Destroys the clasp instance.
          */
         void shutdownClasp();
+        /**
+         * \brief Attaches an ExternalPropagator to each clasp solver (thread).
+         */
+        void createExternalPropagators();
+        /**
+         * \brief Detaches and destroys all elements of ClaspSolver::eps.
+         */
+        void deleteExternalPropagators();
+
+        // parallel search
+        /**
+         * \brief Checks if models are searched by multiple clasp threads.
+         * @return True if the clasp configuration uses more than one solver and false otherwise.
+         */
+        bool isParallel() const;
+        /**
+         * \brief Starts a parallel search wrt. ClaspSolver::assumptions in a background thread.
+         */
+        void startParallelSolve();
+        /**
+         * \brief Stops the parallel search (if running) and waits for all clasp threads to finish.
+         */
+        void stopParallelSolve();
+        /**
+         * \brief Main function of ClaspSolver::parallelSolveThread.
+         */
+        void runParallelSolve();
+        /**
+         * \brief Called by the clasp thread which found a model; waits until the model was taken by ClaspSolver::getNextModel and the next one is requested.
+         * @param s Clasp solver (thread) which found the model.
+         * @param m The model.
+         * @return True if the search shall be continued and false otherwise.
+         */
+        bool onParallelModel(const Clasp::Solver& s, const Clasp::Model& m);
+        /**
+         * \brief Implements ClaspSolver::getNextModel if ClaspSolver::isParallel is true.
+         * @return Next model or a NULL-pointer if there are no more models.
+         */
+        InterpretationPtr getNextModelParallel();
 
         // learning
         /**
@@ -316,7 +378,7 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
         /**
          * \brief Updates the symbol tables after finishing the initialization and after clasp has optimized the instance.
          *
-         * The method will update the mapping ClaspSolver::hexToClaspSolver.
+         * The method will update the mapping ClaspSolver::hexToClaspSolver using ClaspSolver::claspSymbolToHex.
          */
         void updateSymbolTable();
         /** \brief Dummy value for undefined literals. */
@@ -339,6 +401,18 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
          * @param alsoStoreNonoptimized If true, \p lit will be stored for \p addr both in ClaspSolver::hexToClaspSolver and ClaspSolver::hexToClaspProgram, if false it will be stored only in ClaspSolver::hexToClaspSolver.
          */
         void storeHexToClasp(IDAddress addr, Clasp::Literal lit, bool alsoStoreNonoptimized = false);
+        /** \brief Maps keys of the clasp symbol table (clasp atoms in ASP mode, clasp variables in SAT mode) to HEX ground atoms (identified by their IDAddress).
+         *
+         * Keys which were not introduced by dlvhex are mapped to ID::ALL_ONES.
+         * This allows for translating the symbol table after clasp has optimized the instance without encoding IDAddresses in the symbol names.
+         */
+        AddressVector claspSymbolToHex;
+        /** \brief Adds a mapping to the table ClaspSolver::claspSymbolToHex.
+         *
+         * @param symbol Key of the clasp symbol table.
+         * @param addr IDAddress of a HEX ground atom.
+         */
+        void storeClaspSymbolToHex(uint32_t symbol, IDAddress addr);
         /**
          * \brief Resets ClaspSolver::claspToHex to the given size.
          * @param size Desired size.
@@ -376,6 +450,12 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
          */
         inline const AddressVector* convertClaspSolverLitToHex(int index);
 
+        /**
+         * \brief Translates a clasp model to an interpretation over HEX ground atoms.
+         * @param m Clasp model.
+         * @return Interpretation containing all atoms which are true in \p m.
+         */
+        InterpretationPtr modelToInterpretation(const Clasp::Model& m);
         /**
          * \brief Output filtering (works on given interpretation and modifies it).
          * @param intr Interpretation to project be removing ClaspSolver::projectionMask.
@@ -394,8 +474,22 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
         // external learning
         /** \brief List of external propagators. */
         Set<PropagatorCallback*> propagators;
-        /** \brief List of nogoods scheduled for adding to clasp. */
-        std::list<Nogood> nogoods;
+        /** \brief Queue of nogoods scheduled for adding to clasp; each ExternalPropagator adds them to its own clasp solver (thread). */
+        std::deque<Nogood> nogoods;
+        /** \brief Number of nogoods which were added to all clasp solvers (threads) and have been removed from ClaspSolver::nogoods. */
+        std::size_t nogoodsOffset;
+        /**
+         * \brief Removes nogoods from the front of ClaspSolver::nogoods which were added to all clasp solvers (threads).
+         *
+         * The caller must hold ClaspSolver::hexMutex.
+         */
+        void releaseProcessedNogoods();
+        /**
+         * \brief Serializes the execution of HEX code (propagators, access to ClaspSolver::nogoods) by clasp threads.
+         *
+         * During parallel search, the thread which uses this class holds the lock except while it waits for models in ClaspSolver::getNextModel.
+         */
+        boost::recursive_mutex hexMutex;
 
         // instance information
         /** \brief Type of the problem. */
@@ -434,8 +528,34 @@ class ClaspSolver : public GenuineGroundSolver, public SATSolver
         std::auto_ptr<Clasp::Enumerator> modelEnumerator;
         /** \brief Clasp parsed values (using during option parsing). */
         std::auto_ptr<ProgramOptions::ParsedValues> parsedValues;
-        /** \brief Single clasp post propagator which distributes the call to all elements in ClaspSolver::propagators. */
-        std::auto_ptr<ExternalPropagator> ep;
+        /** \brief Clasp post propagators (one per clasp solver) which distribute the call to all elements in ClaspSolver::propagators. */
+        std::vector<ExternalPropagator*> eps;
+
+        // parallel search
+        /** \brief Parallel clasp search algorithm; only used if ClaspSolver::isParallel is true. */
+        boost::scoped_ptr<Clasp::SolveAlgorithm> parallelSolve;
+        /** \brief Receives the models of ClaspSolver::parallelSolve. */
+        ParallelModelHandler parallelModelHandler;
+        /** \brief Background thread running ClaspSolver::parallelSolve. */
+        boost::thread parallelSolveThread;
+        /** \brief Protects the handoff of models from the clasp threads to ClaspSolver::getNextModel. */
+        boost::mutex handoffMutex;
+        /** \brief Signals changes of the handoff state. */
+        boost::condition handoffCondition;
+        /** \brief Model found by a clasp thread which was not yet taken by ClaspSolver::getNextModel. */
+        InterpretationPtr handoffModel;
+        /** \brief True if ClaspSolver::handoffModel holds a model. */
+        bool handoffModelReady;
+        /** \brief True if ClaspSolver::getNextModel requests the next model from the clasp thread which delivered the last one. */
+        bool handoffContinue;
+        /** \brief True if the parallel search shall be stopped. */
+        bool handoffStop;
+        /** \brief True if the parallel search has finished. */
+        bool handoffFinished;
+        /** \brief Error message if the parallel search was aborted by an exception. */
+        std::string handoffError;
+        /** \brief True if ClaspSolver::parallelSolveThread is running. */
+        bool parallelSolveRunning;
 
         // control flow
         /** \brief Set of current assumptions using during solving. */
@@ -0,0 +1,313 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   CompactOrdinaryAtomTable.h
+ *
+ * @brief  Columnar, memory-compact table for storing ground ordinary atoms.
+ */
+
+#ifndef COMPACTORDINARYATOMTABLE_HPP_INCLUDED__
+#define COMPACTORDINARYATOMTABLE_HPP_INCLUDED__
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Atoms.h"
+#include "dlvhex2/Printhelpers.h"
+
+#include <boost/function.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+/**
+ * \brief Implements a memory-compact lookup table for ordinary atoms.
+ *
+ * In contrast to OrdinaryAtomTable, this table does not store one OrdinaryAtom
+ * object (with its own tuple vector and text string) per atom.
+ * Instead, the table is organized in columns indexed by the address:
+ * - all tuples are stored back-to-back in one arena of IDs,
+ * - per atom only the kind, the offset of its tuple in the arena (the arity
+ *   follows from the offset of the next atom) and the hash of its tuple are stored,
+ * - a single open-addressing hash table of 32 bit addresses indexes the tuples.
+ *
+ * The textual representation of an atom is not stored at all, it is built
+ * on request from the tuple using the TextBuilder set by setTextBuilder.
+ *
+ * Atoms are retrieved by value (getByAddress, getByID) as there is no OrdinaryAtom
+ * object in the table which a reference could point to.
+ */
+class DLVHEX_EXPORT CompactOrdinaryAtomTable:
+public ostream_printable<CompactOrdinaryAtomTable>
+{
+    // types
+    public:
+        /** \brief Builds the textual representation of an atom from its tuple. */
+        typedef boost::function<std::string (const Tuple&)> TextBuilder;
+
+    protected:
+        typedef boost::shared_lock<boost::shared_mutex> ReadLock;
+        typedef boost::unique_lock<boost::shared_mutex> WriteLock;
+
+        /** \brief Marks an empty slot in CompactOrdinaryAtomTable::slots. */
+        static const uint32_t EmptySlot = 0xFFFFFFFF;
+
+        // members
+    protected:
+        /** \brief Mutex for multithreading access. */
+        mutable boost::shared_mutex mutex;
+        /** \brief Kind of each atom (indexed by address). */
+        std::vector<IDKind> kinds;
+        /** \brief Offset of the tuple of each atom in CompactOrdinaryAtomTable::arena;
+         * contains one additional element such that the arity of atom a is offsets[a+1] - offsets[a]. */
+        std::vector<uint32_t> offsets;
+        /** \brief Tuple hash of each atom (indexed by address), used for probing and rehashing. */
+        std::vector<uint32_t> hashes;
+        /** \brief All tuples back-to-back. */
+        std::vector<ID> arena;
+        /** \brief Open-addressing (linear probing) hash table of addresses; the size is a power of two. */
+        std::vector<uint32_t> slots;
+        /** \brief Builds the text of atoms on request. */
+        TextBuilder textBuilder;
+
+        // methods
+    public:
+        /** \brief Constructor. */
+        CompactOrdinaryAtomTable();
+
+        /** \brief Sets the function which is used to build the textual representation of atoms.
+         * @param builder Function mapping the tuple of an atom to its text. */
+        inline void setTextBuilder(const TextBuilder& builder);
+
+        /** \brief Retrieves the number of atoms in the table.
+         * @return Number of atoms. */
+        inline unsigned getSize() const;
+
+        /** \brief Retrieve ID by address (ignore kind).
+         *
+         * Assert that address exists in table.
+         * @param addr Address of the ordinary atom to retrieve.
+         * @return ID of the ordinary atom with address \p addr.
+         */
+        inline ID getIDByAddress(IDAddress addr) const throw ();
+
+        /** \brief Look if tuple is stored, and if yes return its ID, otherwise return ID_FAIL.
+         * @param tuple Tuple (predicate and arguments) to retrieve.
+         * @return ID of the ordinary atom with tuple \p tuple or ID_FAIL.
+         */
+        inline ID getIDByTuple(const Tuple& tuple) const throw ();
+
+        /** \brief Retrieve by address (ignore kind).
+         *
+         * The text of the returned atom is only set if a TextBuilder was set.
+         * Assert that address exists in table.
+         * @param addr Address of the ordinary atom to retrieve.
+         * @return Copy of the ordinary atom with address \p addr.
+         */
+        inline OrdinaryAtom getByAddress(IDAddress addr) const;
+
+        /** \brief Retrieve by ID.
+         *
+         * Assert that id.kind is correct for OrdinaryAtom.
+         * Assert that ID exists in table.
+         * @param id ID of the ordinary atom to retrieve.
+         * @return Copy of the ordinary atom with ID \p id.
+         */
+        inline OrdinaryAtom getByID(ID id) const;
+
+        /** \brief Retrieve the tuple (predicate and arguments) of an atom without building its text.
+         * @param addr Address of the ordinary atom.
+         * @param tuple Tuple to be overwritten with the tuple of the atom. */
+        inline void getTupleByAddress(IDAddress addr, Tuple& tuple) const;
+
+        /** \brief Retrieve the predicate (first element of the tuple) of an atom.
+         * @param addr Address of the ordinary atom.
+         * @return Predicate ID. */
+        inline ID getPredicateByAddress(IDAddress addr) const throw ();
+
+        /** \brief Builds the textual representation of an atom using the TextBuilder.
+         * @param addr Address of the ordinary atom.
+         * @return Text of the atom or the empty string if no TextBuilder was set. */
+        inline std::string getTextByAddress(IDAddress addr) const;
+
+        /** \brief Store atom, assuming it does not exist.
+         *
+         * Assert that atom did not exist in table.
+         * The text of \p atom is ignored, see setTextBuilder.
+         * @param atom Ordinary atom to store.
+         * @return ID of the stored atom.
+         */
+        ID storeAndGetID(const OrdinaryAtom& atom) throw ();
+
+        /** \brief Looks up a tuple and stores it if it does not exist yet.
+         * @param kind Kind of the atom to store if the tuple does not exist.
+         * @param tuple Tuple (predicate and arguments).
+         * @return ID of the existing or the newly stored atom.
+         */
+        ID getIDByTupleOrStore(IDKind kind, const Tuple& tuple) throw ();
+
+        /** \brief Removes all atoms. */
+        void clear();
+
+        /** \brief Computes the number of heap bytes allocated by the table.
+         * @return Number of bytes. */
+        std::size_t getMemoryUsage() const;
+
+        /** \brief Prints the table in human-readable format.
+         * @param o Stream to print to.
+         * @return \p o. */
+        std::ostream& print(std::ostream& o) const;
+
+    protected:
+        /** \brief Computes the hash of a tuple.
+         * @param begin Pointer to the first element of the tuple.
+         * @param size Number of elements of the tuple.
+         * @return Hash value. */
+        static inline uint32_t hashTuple(const ID* begin, std::size_t size);
+
+        /** \brief Finds the address of a tuple; must be called with a lock held.
+         * @param tuple Tuple to find.
+         * @param hash Hash of \p tuple.
+         * @param slot Is set to the slot which contains the address, or to the empty slot where it should be inserted.
+         * @return Address of the tuple or ID_FAIL.address. */
+        IDAddress findTuple(const Tuple& tuple, uint32_t hash, std::size_t& slot) const;
+
+        /** \brief Appends an atom to the columns and to the hash table; must be called with the write lock held.
+         * @param kind Kind of the new atom.
+         * @param tuple Tuple of the new atom.
+         * @param hash Hash of \p tuple.
+         * @param slot Empty slot found by findTuple.
+         * @return ID of the new atom. */
+        ID append(IDKind kind, const Tuple& tuple, uint32_t hash, std::size_t slot);
+
+        /** \brief Doubles the size of the hash table and reinserts all addresses; must be called with the write lock held. */
+        void grow();
+};
+
+// set text builder
+void CompactOrdinaryAtomTable::setTextBuilder(const TextBuilder& builder)
+{
+    WriteLock lock(mutex);
+    textBuilder = builder;
+}
+
+
+unsigned CompactOrdinaryAtomTable::getSize() const
+{
+    ReadLock lock(mutex);
+    return kinds.size();
+}
+
+
+ID CompactOrdinaryAtomTable::getIDByAddress(IDAddress addr) const throw ()
+{
+    ReadLock lock(mutex);
+    assert(addr < kinds.size());
+    return ID(kinds[addr], addr);
+}
+
+
+uint32_t CompactOrdinaryAtomTable::hashTuple(const ID* begin, std::size_t size)
+{
+    std::size_t seed = size;
+    for(const ID* it = begin; it != begin + size; ++it) {
+        boost::hash_combine(seed, it->kind);
+        boost::hash_combine(seed, it->address);
+    }
+    // fold the upper half into the lower half (shift twice to avoid warnings for 32 bit size_t)
+    return static_cast<uint32_t>(seed ^ (seed >> 16 >> 16));
+}
+
+
+ID CompactOrdinaryAtomTable::getIDByTuple(const Tuple& tuple) const throw ()
+{
+    const uint32_t hash = hashTuple(tuple.empty() ? 0 : &tuple[0], tuple.size());
+    ReadLock lock(mutex);
+    std::size_t slot;
+    IDAddress addr = findTuple(tuple, hash, slot);
+    if( addr == ID_FAIL.address )
+        return ID_FAIL;
+    return ID(kinds[addr], addr);
+}
+
+
+OrdinaryAtom CompactOrdinaryAtomTable::getByAddress(IDAddress addr) const
+{
+    OrdinaryAtom atom(getIDByAddress(addr).kind);
+    getTupleByAddress(addr, atom.tuple);
+    ReadLock lock(mutex);
+    if( !textBuilder.empty() )
+        atom.text = textBuilder(atom.tuple);
+    return atom;
+}
+
+
+OrdinaryAtom CompactOrdinaryAtomTable::getByID(ID id) const
+{
+    assert(id.isAtom() || id.isLiteral());
+    assert(id.isOrdinaryAtom());
+    return getByAddress(id.address);
+}
+
+
+void CompactOrdinaryAtomTable::getTupleByAddress(IDAddress addr, Tuple& tuple) const
+{
+    ReadLock lock(mutex);
+    assert(addr < kinds.size());
+    tuple.assign(arena.begin() + offsets[addr], arena.begin() + offsets[addr + 1]);
+}
+
+
+ID CompactOrdinaryAtomTable::getPredicateByAddress(IDAddress addr) const throw ()
+{
+    ReadLock lock(mutex);
+    assert(addr < kinds.size());
+    assert(offsets[addr] < offsets[addr + 1]);
+    return arena[offsets[addr]];
+}
+
+
+std::string CompactOrdinaryAtomTable::getTextByAddress(IDAddress addr) const
+{
+    Tuple tuple;
+    getTupleByAddress(addr, tuple);
+    ReadLock lock(mutex);
+    if( textBuilder.empty() )
+        return std::string();
+    return textBuilder(tuple);
+}
+
+
+DLVHEX_NAMESPACE_END
+#endif                           // COMPACTORDINARYATOMTABLE_HPP_INCLUDED__
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -0,0 +1,266 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   ConcurrentTable.h
+ *
+ * @brief  Building blocks for the concurrent storage mode of Tables.
+ *
+ * In concurrent mode a table keeps, in addition to its multi_index container,
+ * - an append-only vector of pointers to the stored values, which allows for
+ *   address lookups without any lock, and
+ * - sharded hash indices for its unique keys, such that lookups by key only
+ *   lock one out of many shards (and only in shared mode).
+ * The multi_index container remains the owner of all values (its nodes never move)
+ * and is still used for iteration and for all non-unique indices.
+ */
+
+#ifndef CONCURRENTTABLE_HPP_INCLUDED__17102026
+#define CONCURRENTTABLE_HPP_INCLUDED__17102026
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/ID.h"
+
+#include <boost/atomic.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/noncopyable.hpp>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace impl
+{
+
+    /**
+     * \brief Append-only vector of pointers to table values with lock-free reads.
+     *
+     * Entries are stored in segments of doubling size which are never reallocated,
+     * hence a published entry stays at the same place for the lifetime of the vector.
+     * Appending must be serialized by the caller (tables do this using their write lock),
+     * reading is possible concurrently to appending without any lock.
+     */
+    template<typename ValueT>
+    class AppendOnlyAddressVector:
+    private boost::noncopyable
+    {
+        public:
+            /** \brief Segment s has capacity 2^(FirstSegmentBits + s). */
+            static const unsigned FirstSegmentBits = 10;
+            /** \brief Number of segments; sufficient for the full IDAddress range. */
+            static const unsigned MaxSegments = 32 - FirstSegmentBits;
+
+        private:
+            /** \brief Segment table; a segment is allocated when the first entry is appended to it. */
+            boost::atomic<const ValueT**> segments[MaxSegments];
+            /** \brief Number of published entries. */
+            boost::atomic<uint32_t> count;
+
+            /** \brief Computes segment and offset of an address.
+             * @param addr Address.
+             * @param segment Segment of \p addr (output).
+             * @param offset Offset of \p addr within \p segment (output). */
+            static inline void locate(IDAddress addr, unsigned& segment, uint32_t& offset)
+            {
+                // shift addresses such that segment boundaries are powers of two
+                const uint64_t pos = static_cast<uint64_t>(addr) + (1u << FirstSegmentBits);
+                #if defined(__GNUC__)
+                const unsigned msb = 63 - __builtin_clzll(pos);
+                #else
+                unsigned msb = FirstSegmentBits;
+                while( (pos >> (msb + 1)) != 0 ) ++msb;
+                #endif
+                segment = msb - FirstSegmentBits;
+                offset = static_cast<uint32_t>(pos - (static_cast<uint64_t>(1) << msb));
+            }
+
+        public:
+            /** \brief Constructor. */
+            AppendOnlyAddressVector():
+            count(0) {
+                for(unsigned s = 0; s < MaxSegments; ++s)
+                    segments[s].store(0, boost::memory_order_relaxed);
+            }
+
+            /** \brief Destructor. */
+            ~AppendOnlyAddressVector() {
+                clear();
+            }
+
+            /** \brief Removes all entries; must not be called concurrently to any other method. */
+            void clear() {
+                for(unsigned s = 0; s < MaxSegments; ++s) {
+                    delete[] segments[s].load(boost::memory_order_relaxed);
+                    segments[s].store(0, boost::memory_order_relaxed);
+                }
+                count.store(0, boost::memory_order_release);
+            }
+
+            /** \brief Appends a pointer; callers must serialize calls to this method.
+             * @param value Pointer to a value which remains valid for the lifetime of this vector.
+             * @return Address of the new entry. */
+            IDAddress push_back(const ValueT* value) {
+                const uint32_t addr = count.load(boost::memory_order_relaxed);
+                unsigned segment;
+                uint32_t offset;
+                locate(addr, segment, offset);
+                assert(segment < MaxSegments);
+                const ValueT** seg = segments[segment].load(boost::memory_order_relaxed);
+                if( seg == 0 ) {
+                    seg = new const ValueT*[static_cast<std::size_t>(1) << (FirstSegmentBits + segment)];
+                    segments[segment].store(seg, boost::memory_order_release);
+                }
+                seg[offset] = value;
+                // publish
+                count.store(addr + 1, boost::memory_order_release);
+                return addr;
+            }
+
+            /** \brief Retrieves a published entry without locking.
+             * @param addr Address; must have been published before.
+             * @return Pointer stored at \p addr. */
+            inline const ValueT* at(IDAddress addr) const {
+                assert(addr < count.load(boost::memory_order_acquire));
+                unsigned segment;
+                uint32_t offset;
+                locate(addr, segment, offset);
+                return segments[segment].load(boost::memory_order_acquire)[offset];
+            }
+
+            /** \brief Number of published entries.
+             * @return Size. */
+            inline uint32_t size() const {
+                return count.load(boost::memory_order_acquire);
+            }
+    };
+
+    /**
+     * \brief Hash index over a unique key of a table, split into independently locked shards.
+     *
+     * The index does not copy keys, it refers to values owned by the table,
+     * and it caches the hash value of each key.
+     * @tparam ValueT Value type stored in the table.
+     * @tparam KeyFromValue Boost.MultiIndex key extractor for the indexed key.
+     * @tparam ShardBits Logarithm of the number of shards.
+     * @tparam Hash Hash function for keys.
+     */
+    template<typename ValueT, typename KeyFromValue, unsigned ShardBits = 6,
+        typename Hash = boost::hash<typename KeyFromValue::result_type> >
+    class ShardedHashIndex:
+    private boost::noncopyable
+    {
+        public:
+            typedef typename KeyFromValue::result_type Key;
+            static const unsigned Shards = 1u << ShardBits;
+
+        private:
+            /** \brief Entry of the index. */
+            struct Entry
+            {
+                std::size_t hash;
+                const ValueT* value;
+                IDAddress address;
+                Entry(std::size_t hash, const ValueT* value, IDAddress address):
+                hash(hash), value(value), address(address) {}
+            };
+            struct EntryHash
+            {
+                inline std::size_t operator()(const Entry& e) const { return e.hash; }
+            };
+            /** \brief Hash function for lookups with a hash value computed beforehand. */
+            struct PrecomputedHash
+            {
+                std::size_t hash;
+                PrecomputedHash(std::size_t hash): hash(hash) {}
+                inline std::size_t operator()(const Key&) const { return hash; }
+            };
+            struct EntryEqual
+            {
+                inline bool operator()(const Entry& e1, const Entry& e2) const
+                    { return e1.hash == e2.hash && KeyFromValue()(*e1.value) == KeyFromValue()(*e2.value); }
+                inline bool operator()(const Key& k, const Entry& e) const
+                    { return KeyFromValue()(*e.value) == k; }
+            };
+            typedef boost::unordered_set<Entry, EntryHash, EntryEqual> EntrySet;
+
+            /** \brief One shard of the index. */
+            struct Shard
+            {
+                mutable boost::shared_mutex mutex;
+                EntrySet entries;
+            };
+            Shard shards[Shards];
+
+            static inline unsigned shardOf(std::size_t hash)
+            {
+                // use high-order bits for shard selection, low-order bits are used by the buckets within the shard
+                return static_cast<unsigned>((hash ^ (hash >> 17) ^ (hash >> 31)) >> 3) & (Shards - 1);
+            }
+
+        public:
+            /** \brief Looks up a key.
+             * @param key Key to look up.
+             * @param value Receives a pointer to the stored value if found.
+             * @return Address of the value or ID_FAIL.address if \p key is not stored. */
+            inline IDAddress find(const Key& key, const ValueT*& value) const {
+                const std::size_t h = Hash()(key);
+                const Shard& shard = shards[shardOf(h)];
+                boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+                typename EntrySet::const_iterator it = shard.entries.find(key, PrecomputedHash(h), EntryEqual());
+                if( it == shard.entries.end() )
+                    return ID_FAIL.address;
+                value = it->value;
+                return it->address;
+            }
+
+            /** \brief Adds a value which must not yet be indexed.
+             * @param value Pointer to the value owned by the table.
+             * @param address Address of \p value. */
+            inline void insert(const ValueT* value, IDAddress address) {
+                const std::size_t h = Hash()(KeyFromValue()(*value));
+                Shard& shard = shards[shardOf(h)];
+                boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+                bool success = shard.entries.insert(Entry(h, value, address)).second;
+                (void)success;
+                assert(success && "key is already indexed");
+            }
+
+            /** \brief Removes all entries; must not be called concurrently to any other method. */
+            void clear() {
+                for(unsigned s = 0; s < Shards; ++s)
+                    shards[s].entries.clear();
+            }
+    };
+
+}                                // namespace impl
+
+DLVHEX_NAMESPACE_END
+#endif                           // CONCURRENTTABLE_HPP_INCLUDED__17102026
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -78,6 +78,7 @@ WARNING("TODO what is the difference/intended usage of ExtSourceProperty vs ExtS
  * - VARIABLEOUTPUTARITY
  * - CARESABOUTASSIGNED
  * - CARESABOUTCHANGED
+ * - PERSISTENTCACHE
  */
 struct ExtSourceProperties
 {
@@ -132,6 +133,8 @@ struct ExtSourceProperties
     std::set<std::pair<int, int> > wellorderingNatural;
     /** \brief See ExtSourceProperties::providesPartialAnswer. */
     bool providesPartialAnswer;
+    /** \brief See ExtSourceProperties::isPersistentlyCacheable. */
+    bool persistentlyCacheable;  // answers may be reused in later runs
     /** \brief See ExtSourceProperties::hasAtomDependency. */
     std::set<std::tuple<int,int, int>> atomDependencies;
     /** \brief See ExtSourceProperties::getComplianceCheck. */
@@ -154,6 +157,7 @@ struct ExtSourceProperties
         caresAboutAssigned = false;
         caresAboutChanged = false;
         providesPartialAnswer = false;
+        persistentlyCacheable = false;
         complCheck = 0;
     }
 
@@ -207,6 +211,8 @@ struct ExtSourceProperties
     inline void addWellorderingNatural(int index1, int index2) { wellorderingNatural.insert(std::pair<int, int>(index1, index2)); }
     /** \brief See ExtSourceProperties::providesPartialAnswer. */
     inline void setProvidesPartialAnswer(bool value) { providesPartialAnswer = value; }
+    /** \brief See ExtSourceProperties::isPersistentlyCacheable. */
+    inline void setPersistentlyCacheable(bool value) { persistentlyCacheable = value; }
     /** \brief See ExtSourceProperties::hasAtomDependency. */
     inline void addAtomDependency(int index1, int index2, int index3) { atomDependencies.insert(std::tuple<int,int, int>(index1, index2, index3)); }
     /** \brief See ExtSourceProperties::getComplianceCheck. */
@@ -416,6 +422,17 @@ struct ExtSourceProperties
      */
     bool doesProvidePartialAnswer() const
         { return providesPartialAnswer; }
+
+    /**
+     * \brief Checks if answers of the external source may be stored across runs.
+     *
+     * This requires that the answer to a query depends only on the input tuple and the true input atoms,
+     * i.e., the source is deterministic and neither uses the environment nor other state which may change between runs.
+     * Answers of such sources are stored in the persistent answer cache (see option --extcachefile and PersistentAnswerCache).
+     * @return True if answers of the external source may be reused by later runs.
+     */
+    bool isPersistentlyCacheable() const
+        { return persistentlyCacheable; }
     
     /**
      * \brief Checks if some output position of external atom depends on a certain argument position of the input predicate.
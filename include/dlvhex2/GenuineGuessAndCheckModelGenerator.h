@@ -50,6 +50,12 @@
 
 #include <boost/unordered_map.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <deque>
 
 DLVHEX_NAMESPACE_BEGIN
 
@@ -137,6 +143,36 @@ public PropagatorCallback
         InterpretationPtr programMask;
         /** \brief Current (non-ground) guessing program. */
         OrdinaryASPProgram guessingProgram;
+        /** \brief True if the ground program and possibly the solver are taken from GenuineGuessAndCheckModelGeneratorFactory::persistentInstance. */
+        bool usePersistentInstance;
+
+        // parallel enumeration (see option EnumerationThreads)
+        /** \brief Assumptions which restrict this model generator to one cube of the search space of a parallel enumeration; empty otherwise. */
+        std::vector<ID> cube;
+        /** \brief Model generator which coordinates the parallel enumeration this model generator works for; NULL otherwise. */
+        GenuineGuessAndCheckModelGenerator* coordinator;
+        /** \brief Serializes HEX code (external sources, registry, shared nogoods) between the workers and the main thread.
+         *
+         * The main thread holds it while a parallel enumeration is running, except when it waits for a model of the workers. */
+        boost::recursive_mutex hexMutex;
+        /** \brief Cubes which are not yet assigned to a worker (only used by the model generator which coordinates the parallel enumeration). */
+        std::deque<std::vector<ID> > pendingCubes;
+        /** \brief True if models are enumerated by workers over GenuineGuessAndCheckModelGenerator::pendingCubes. */
+        bool cubeEnumeration;
+        /** \brief Threads which enumerate the models of the cubes. */
+        boost::thread_group cubeWorkers;
+        /** \brief Protects GenuineGuessAndCheckModelGenerator::pendingCubes and the model buffer. */
+        boost::mutex cubeMutex;
+        /** \brief Signals changes of the model buffer and of the number of running workers. */
+        boost::condition cubeCondition;
+        /** \brief Models found by the workers which were not yet returned. */
+        std::deque<InterpretationPtr> cubeModels;
+        /** \brief Number of workers which have not yet finished. */
+        int runningCubeWorkers;
+        /** \brief True if the workers shall stop. */
+        bool cubeStop;
+        /** \brief Error message of the first worker which failed. */
+        std::string cubeError;
 
         // members
 
@@ -165,6 +201,40 @@ public PropagatorCallback
           * @param Parameters \p program, \p grounder, \p annotatedGroundProgram and \p activeInnerEatoms are updated. */
         void inlineExternalAtoms(OrdinaryASPProgram& program, GenuineGrounderPtr& grounder, AnnotatedGroundProgram& annotatedGroundProgram, std::vector<ID>& activeInnerEatoms);
 
+        /**
+          * \brief Initializes grounder, ground program and solver from the persistent instance of the factory.
+          *
+          * The persistent instance is (re)built if \p postprocInput contains atoms which are not yet part of its input domain.
+          * The actual input (and GenuineGuessAndCheckModelGenerator::cube) is then passed to the solver as assumptions over the input domain.
+          * @param postprocInput EDB and input of this model generator (including outer external atoms and domain predicates). */
+        void initializeFromPersistentInstance(InterpretationConstPtr postprocInput);
+
+        /**
+          * \brief Partitions the search space into cubes for parallel enumeration.
+          *
+          * The cubes are all truth assignments to a few atoms which occur in many rules, where replacement atoms
+          * of external atoms are preferred. As the cubes are disjoint, so are the sets of answer sets found in them.
+          * @param threads Number of worker threads; the number of cubes is a small multiple of it. */
+        void createCubes(int threads);
+
+        /**
+          * \brief Starts the worker threads of the parallel enumeration.
+          * @param threads Number of worker threads. */
+        void startCubeEnumeration(int threads);
+
+        /**
+          * \brief Stops the worker threads of the parallel enumeration and waits for them. */
+        void stopCubeEnumeration();
+
+        /**
+          * \brief Main function of a worker thread: enumerates the models of pending cubes with model generators restricted to them. */
+        void runCubeWorker();
+
+        /**
+          * \brief Returns the next model found by a worker.
+          * @return Next model or NULL if all cubes are exhausted. */
+        InterpretationPtr generateNextModelFromCubes();
+
         /**
           * \brief If the atom represented by \p atomID uses is an external auxiliary from \p eliminatedExtAuxes,
           * then 'r' is replaced by 'R' and 'n' by 'N'.
@@ -338,8 +408,9 @@ public PropagatorCallback
          * \brief Constructor.
          * @param factory Reference to the factory which created this model generator.
          * @param input Input interpretation to this model generator.
+         * @param cube See GenuineGuessAndCheckModelGenerator::cube.
          */
-        GenuineGuessAndCheckModelGenerator(Factory& factory, InterpretationConstPtr input);
+        GenuineGuessAndCheckModelGenerator(Factory& factory, InterpretationConstPtr input, const std::vector<ID>& cube = std::vector<ID>());
 
         /**
          * \brief Destuctor.
@@ -390,6 +461,28 @@ public ostream_printable<GenuineGuessAndCheckModelGeneratorFactory>
 
         /** \brief Counts hof often this unit was evaluated and the result was detected inconsistency. */
         int inconsistentEvaluationCnt;
+
+        /** \brief Ground program and solver which are shared by the model generators of this factory (see option PersistentUnits). */
+        struct PersistentInstance
+        {
+            /** \brief Input atoms which are guessed in the ground program; the actual input is fixed by assumptions. */
+            InterpretationPtr inputDomain;
+            /** \brief Auxiliaries of the input guess and the mask of the ground program. */
+            InterpretationPtr mask;
+            /** \brief Grounder which produced PersistentInstance::annotatedGroundProgram. */
+            GenuineGrounderPtr grounder;
+            /** \brief Ground program over the input domain. */
+            AnnotatedGroundProgram annotatedGroundProgram;
+            /** \brief Solver which is handed on to the next model generator (only set for backends which support restarts without blocked models). */
+            GenuineGroundSolverPtr solver;
+            /** \brief True while a model generator works with PersistentInstance::solver. */
+            bool solverInUse;
+            /** \brief Ground nogoods learned from external atoms; they do not depend on the input and are passed to new solvers. */
+            SimpleNogoodContainerPtr eaNogoods;
+        };
+        typedef boost::shared_ptr<PersistentInstance> PersistentInstancePtr;
+        /** \brief Persistent instance or NULL if not yet created or not used. */
+        PersistentInstancePtr persistentInstance;
     public:
         /** \brief Constructor.
          *
@@ -39,6 +39,7 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 
 #include <vector>
 #include <string>
@@ -59,17 +60,27 @@ class DLVHEX_EXPORT InputProvider
          * @param i Stream to read from.
          * @param contentname Unique name for this input. */
         void addStreamInput(std::istream& i, const std::string& contentname);
+        /** \brief Add input from a stream which is read only when the input is consumed.
+         *
+         * Unlike addStreamInput, the stream is not copied into memory as a whole but read
+         * in chunks by readTextInputs; it must remain valid until then and can only be read once.
+         * @param i Stream to read from (e.g., std::cin).
+         * @param contentname Unique name for this input. */
+        void addStreamingInput(std::istream& i, const std::string& contentname);
         /** \brief Add input from a string.
          * @param content String to read from.
          * @param contentname Unique name for this input. */
         void addStringInput(const std::string& content, const std::string& contentname);
         /** \brief Add input from a file.
+         *
+         * The file is memory-mapped when the input is consumed.
          * @param filename File to read from. */
         void addFileInput(const std::string& filename);
         /** \brief Add input from a file in CSV format.
          * 
          * Each line in the CSV file is stored as tuple in the extension of a given predicate,
          * where the first element is the line number in the original file.
+         * The file is not read immediately but kept as CSV input (see getCSVInputs and getAsStream).
          * @param filename CSV file to read from (semicolon-separated).
          * @param predicate Predicate used to store the CSV content. */
         void addCSVFileInput(const std::string& predicate, const std::string& filename);
@@ -87,9 +98,49 @@ class DLVHEX_EXPORT InputProvider
         const std::vector<std::string>& contentNames() const;
 
         /** \brief Get input as a single stream.
+         *
+         * Concatenates all inputs in memory and converts CSV inputs into HEX facts;
+         * afterwards the inputs are only available through this stream.
          * @return Input stream. */
         std::istream& getAsStream();
 
+        /** \brief CSV file input which has not been converted into HEX facts. */
+        struct CSVInput
+        {
+            /** \brief Predicate used to store the CSV content. */
+            std::string predicate;
+            /** \brief CSV file to read from. */
+            std::string filename;
+            /** \brief Constructor.
+             * @param predicate See CSVInput::predicate.
+             * @param filename See CSVInput::filename. */
+            CSVInput(const std::string& predicate, const std::string& filename):
+                predicate(predicate), filename(filename) {}
+        };
+
+        /** \brief Returns the CSV inputs which are not read by readTextInputs.
+         * @return Vector of CSV inputs; empty after getAsStream was called. */
+        const std::vector<CSVInput>& getCSVInputs() const;
+
+        /** \brief Receives a piece of an input.
+         *
+         * Parameters: name of the input, begin and end of the piece (only valid during the call),
+         * and whether this is the last piece of the input. */
+        typedef boost::function<void (const std::string&, const char*, const char*, bool)> TextConsumer;
+
+        /** \brief Default size of pieces for stream inputs. */
+        static const std::size_t DefaultChunkSize = 1 << 20;
+
+        /** \brief Passes all inputs except for CSV inputs piece by piece to a consumer.
+         *
+         * Inputs are passed in the order in which they were added; nothing is concatenated.
+         * Files are memory-mapped and passed as a single piece, streaming inputs
+         * (see addStreamingInput) are read in pieces of at most \p chunkSize bytes,
+         * and all other inputs are passed as a single piece from memory.
+         * @param consumer Receives the pieces.
+         * @param chunkSize Maximum size of pieces of streaming inputs. */
+        void readTextInputs(const TextConsumer& consumer, std::size_t chunkSize = DefaultChunkSize);
+
     private:
         class Impl;
         boost::scoped_ptr<Impl> pimpl;
@@ -84,8 +84,6 @@ class InternalGroundASPSolver : public CDNLSolver, public GenuineGroundSolver
         Set<IDAddress> ordinaryFacts;
         /** \brief Set of facts in the program as Interpretation. */
         InterpretationPtr ordinaryFactsInt;
-        /** \brief Set of facts which occur in non-singular strongly connected components in the positive atom dependency graph. */
-        Set<IDAddress> nonSingularFacts;
 
         // dependency graph
         typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, IDAddress> Graph;
@@ -95,26 +93,92 @@ class InternalGroundASPSolver : public CDNLSolver, public GenuineGroundSolver
         /** \brief Positive atom dependency graph. */
         Graph depGraph;
 
-        /** \brief Stores for each component the contained atoms. */
-        std::vector<Set<IDAddress> > depSCC;
-        /** \brief Stores for each atom its component number. */
-        boost::unordered_map<IDAddress, int, SimpleHashIDAddress> componentOfAtom;
-        /** \brief Store for each rule the body atom. */
-        boost::unordered_map<IDAddress, IDAddress, SimpleHashIDAddress> bodyAtomOfRule;
+        /** \brief Stores for each atom its component number (-1 for atoms which do not occur in the program). */
+        std::vector<int> componentOfAtom;
+        /** \brief Stores for each component the number of contained atoms. */
+        std::vector<int> componentSize;
+
+        // program structure as dense arrays; rules are referred to by their index in program.getGroundProgram().idb
+        /** \brief Rules of the program by index. */
+        std::vector<ID> rules;
+        /** \brief The head atoms of rule r are headAtoms[headAtomsBegin[r]], ..., headAtoms[headAtomsBegin[r + 1] - 1]. */
+        std::vector<int> headAtomsBegin;
+        /** \brief Head atoms of all rules. */
+        std::vector<IDAddress> headAtoms;
+        /** \brief The positive body atoms of rule r, stored like headAtomsBegin. */
+        std::vector<int> posBodyAtomsBegin;
+        /** \brief Positive body atoms of all rules. */
+        std::vector<IDAddress> posBodyAtoms;
+        /** \brief The rules which contain atom a in their head are rulesWithHeadAtom[rulesWithHeadAtomBegin[a]], ..., rulesWithHeadAtom[rulesWithHeadAtomBegin[a + 1] - 1]. */
+        std::vector<int> rulesWithHeadAtomBegin;
+        /** \brief Rules by head atoms. */
+        std::vector<int> rulesWithHeadAtom;
+        /** \brief The rules which contain atom a positively in their body, stored like rulesWithHeadAtomBegin. */
+        std::vector<int> rulesWithPosBodyAtomBegin;
+        /** \brief Rules by positive body atoms. */
+        std::vector<int> rulesWithPosBodyAtom;
+        /** \brief Stores for each rule the body atom. */
+        std::vector<IDAddress> bodyAtomOfRule;
+        /** \brief Stores for each body atom its rule (-1 for other atoms). */
+        std::vector<int> ruleOfBodyAtom;
+
+        /** \brief Set of atoms with constant time insertion, deletion and membership test. */
+        class AtomSet
+        {
+            public:
+                /** \brief Elements in no particular order. */
+                std::vector<IDAddress> atoms;
+                /** \brief Stores for each atom its index in atoms (-1 if it is not an element). */
+                std::vector<int> position;
+
+                /** \brief Checks if \p a is an element. */
+                inline bool contains(IDAddress a) const { return a < position.size() && position[a] != -1; }
+                /** \brief Adds \p a to the set. */
+                inline void insert(IDAddress a) {
+                    if (a >= position.size()) position.resize(a + 1, -1);
+                    if (position[a] != -1) return;
+                    position[a] = atoms.size();
+                    atoms.push_back(a);
+                }
+                /** \brief Removes \p a from the set. */
+                inline void erase(IDAddress a) {
+                    if (!contains(a)) return;
+                    IDAddress last = atoms.back();
+                    atoms[position[a]] = last;
+                    position[last] = position[a];
+                    atoms.pop_back();
+                    position[a] = -1;
+                }
+                /** \brief Removes all elements in time linear in their number. */
+                inline void clear() {
+                    BOOST_FOREACH (IDAddress a, atoms) position[a] = -1;
+                    atoms.clear();
+                }
+                /** \brief Checks if the set is empty. */
+                inline bool empty() const { return atoms.empty(); }
+                /** \brief Returns the number of elements. */
+                inline uint32_t size() const { return atoms.size(); }
+        };
 
         // data structures for unfounded set computation
+        /** \brief Marks an atom without source rule in sourceRule. */
+        static const int noSource = -1;
+        /** \brief Marks a fact, which is founded by itself, in sourceRule. */
+        static const int factSource = -2;
+        /** \brief Stores for each atom its source rule, noSource or factSource. */
+        std::vector<int> sourceRule;
         /** \brief Currently unfounded atoms. */
-        Set<IDAddress> unfoundedAtoms;
-        /** \brief Stores for each literal the rules which contain it positively in their body. */
-        boost::unordered_map<IDAddress, Set<ID>, SimpleHashIDAddress > rulesWithPosBodyLiteral;
-        /** \brief Stores for each literal the rules which contain it negatively in their body. */
-        boost::unordered_map<IDAddress, Set<ID>, SimpleHashIDAddress > rulesWithNegBodyLiteral;
-        /** \brief Stores for each literal the rules which contain it (positively) in their head. */
-        boost::unordered_map<IDAddress, Set<ID>, SimpleHashIDAddress > rulesWithPosHeadLiteral;
-        /** \brief Stores for each body atom the set of atoms which use the corresponding rule as source. */
-        boost::unordered_map<IDAddress, Set<IDAddress>, SimpleHashIDAddress > foundedAtomsOfBodyAtom;
-        /** \brief Stores for each atom a source rule (if available); for facts, ID_FAIL will be stored. */
-        boost::unordered_map<IDAddress, ID, SimpleHashIDAddress> sourceRule;
+        AtomSet unfoundedAtoms;
+        /** \brief Unfounded set under construction in getUnfoundedSet. */
+        AtomSet ufs;
+        /** \brief Atoms which possibly became unfounded after the last assignment. */
+        std::vector<IDAddress> ufsWorklist;
+        /** \brief Externally supporting rules computed by the last call of getExternalSupport. */
+        std::vector<int> externalSupport;
+        /** \brief Stores for each rule the last call of getExternalSupport which collected it. */
+        std::vector<int> ruleVisited;
+        /** \brief Number of calls of getExternalSupport so far. */
+        int externalSupportCalls;
 
         // statistics
         /** \brief Number of unfounded sets detected so far. */
@@ -159,64 +223,69 @@ class InternalGroundASPSolver : public CDNLSolver, public GenuineGroundSolver
         virtual void setFact(ID fact, int dl, int cause);
         virtual void clearFact(IDAddress litadr);
 
+        /** \brief Checks if an atom occurs in a non-singular strongly connected component of the positive atom dependency graph.
+         * @param litadr Atom IDAddress.
+         * @return True if \p litadr is in a non-singular component and false otherwise. */
+        inline bool isNonSingular(IDAddress litadr) const {
+            return litadr < componentOfAtom.size() && componentOfAtom[litadr] != -1 && componentSize[componentOfAtom[litadr]] > 1;
+        }
         /** \brief Removes a source pointer from an atom.
          * @param litadr Atom to remove the source pointer from. */
         void removeSourceFromAtom(IDAddress litadr);
         /** \brief Adds a rule as a possible source for deriving an atom.
          * @param litadr Atom IDAddress.
-         * @param rule ID of a rule which may derive \p litadr. */
-        void addSourceToAtom(IDAddress litadr, ID rule);
-        /** \brief Retrieves a list of all atoms which might transitively depend on \p litadr.
-         * @param litadr IDAddress of an atom.
-         * @return List of all atoms which might transitively depend on \p litadr. */
-        Set<IDAddress> getDependingAtoms(IDAddress litadr);
-        /** \brief Get the set of atoms which become unfounded after a literal was assigned.
-         * @param fact Literal which is now true (either a positive or a negated atom).
-         * @param newlyUnfoundedAtoms Set of atoms which are unfounded after \p fact was assigned. */
-        void getInitialNewlyUnfoundedAtomsAfterSetFact(ID fact, Set<IDAddress>& newlyUnfoundedAtoms);
+         * @param rule Index of a rule which may derive \p litadr. */
+        void addSourceToAtom(IDAddress litadr, int rule);
+        /** \brief Adds all atoms to ufsWorklist which use a rule with \p litadr in the positive body as source.
+         * @param litadr IDAddress of an atom. */
+        void addDependingAtoms(IDAddress litadr);
+        /** \brief Adds the atoms which become unfounded after a literal was assigned to ufsWorklist.
+         * @param fact Literal which is now true (either a positive or a negated atom). */
+        void addInitialNewlyUnfoundedAtomsAfterSetFact(ID fact);
         /** \brief Bookkeeping for internal data structures after a literal became true.
          * @param fact Literal which is now true. */
         void updateUnfoundedSetStructuresAfterSetFact(ID fact);
         /** \brief Bookkeeping for internal data structures after a literal became unassigned.
          * @param fact Literal which is now unassigned. */
         void updateUnfoundedSetStructuresAfterClearFact(IDAddress litadr);
-        ID getPossibleSourceRule(const Set<ID>& ufs);
+        /** \brief Finds a rule which supports \p s externally and is not satisfied independently of \p s.
+         * @param s Set of atoms.
+         * @return Index of such a rule or -1 if there is none. */
+        int getPossibleSourceRule(const AtomSet& s);
         /** \brief Checks if a head atom uses the rule as source.
          * @param headAtom Atom a an atom in the head of \p sourceRule.
-         * @param sourceRule ID of a rule.
+         * @param sourceRule Index of a rule.
          * @return True if 1. the \p headAtom is currently unfounded and 2. no other head literal of rule \p sourceRule was set to true earlier. */
-        bool useAsNewSourceForHeadAtom(IDAddress headAtom, ID sourceRule);
+        bool useAsNewSourceForHeadAtom(IDAddress headAtom, int sourceRule);
         /** \brief Finds an unfounded set.
-         * @return A non-empty unfounded set if there is any, and an empty set otherwise. */
-        Set<ID> getUnfoundedSet();
+         * @return A non-empty unfounded set if there is any, and an empty set otherwise; the result is valid until the next call. */
+        const std::vector<IDAddress>& getUnfoundedSet();
 
         // helper members
-        /** \brief Checks for a rule if it supports a literal externally to a set \p s.
+        /** \brief Checks for a rule if it supports an atom externally to a set \p s.
          *
          * External support means that the rule may be used to derive the atom
          * but does not depend on an atom in \p s.
          *
-         * @param ruleID ID of a rule.
-         * @param lit Literal ID.
-         * @param s Set of literals.
-         * @return True if the rule supports \p lit externally wrt. \p s and false otherwise. */
-        bool doesRuleExternallySupportLiteral(ID ruleID, ID lit, const Set<ID>& s);
-        /** \brief Finds all rules which support some atom from \p s externally wrt. \p s.
-         * @param s Set of literals.
-         * @return Set of all rules which support some atom from \p s externally wrt. \p s. */
-        Set<ID> getExternalSupport(const Set<ID>& s);
-        /** \brief Compute all literals which satisfy the rule independently of set \p y.
+         * @param rule Index of a rule which contains the atom in its head.
+         * @param s Set of atoms.
+         * @return True if the rule supports the atom externally wrt. \p s and false otherwise. */
+        bool doesRuleExternallySupportLiteral(int rule, const AtomSet& s);
+        /** \brief Finds all rules which support some atom from \p s externally wrt. \p s and stores them in externalSupport.
+         * @param s Set of atoms. */
+        void getExternalSupport(const AtomSet& s);
+        /** \brief Finds a literal which satisfies the rule independently of set \p y and is currently true.
          *
-         * This is the case if either the body of rule \p ruleID is false or
+         * This is the case if either the body of rule \p rule is false or
          * some head literal, which is not in \p y, is true.
-         * @param ruleID ID of some rule.
-         * @param y Some set of literals.
-         * @return All literals which satisfy the rule independently of set \p y. */
-        Set<ID> satisfiesIndependently(ID ruleID, const Set<ID>& y);
+         * @param rule Index of some rule.
+         * @param y Some set of atoms.
+         * @return A currently true literal which satisfies the rule independently of set \p y, or ID_FAIL if there is none. */
+        ID getSatisfiedIndependentLiteral(int rule, const AtomSet& y);
         /** \brief Constructs a loop nogood for an unfouneded set.
          * @param ufs Unfounded set.
          * @param Nogood which tries to avoid the same unfounded set in the future search. */
-        Nogood getLoopNogood(const Set<ID>& ufs);
+        Nogood getLoopNogood(const AtomSet& ufs);
         /** \brief Adds a new propositional atom.
          * @param predID Predicate used for the new atom.
          * @return ID of the new atom. */
@@ -290,6 +359,7 @@ class InternalGroundASPSolver : public CDNLSolver, public GenuineGroundSolver
         /**
          * \brief Provides access to the internal nogood storage.
          *
+         * Learned nogoods which were deleted by the solver remain as empty nogoods.
          * @return Referene to the internal nogood storage.
          */
         const NogoodSet& getNogoodStorage();
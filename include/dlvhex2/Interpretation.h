@@ -40,13 +40,21 @@
 #include "dlvhex2/ID.h"
 #include "dlvhex2/Registry.h"
 #include <bm/bm.h>
+#include <bm/bmalgo.h>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
 
+class InterpretationMaskView;
+
 /**
  * \brief Stores a set of atoms efficiently as a bitset.
+ *
+ * Copies of an interpretation share the bitset until one of them is modified
+ * (copy-on-write), hence taking a snapshot of an interpretation costs O(1).
+ * A reference obtained from the non-const Interpretation::getStorage() must
+ * therefore not be used for modifications after the interpretation was copied.
  */
 class DLVHEX_EXPORT Interpretation:
 public InterpretationBase,
@@ -64,18 +72,23 @@ public ostream_printable<Interpretation>
     protected:
         /** \brief Regirstry used to interpret IDs when printing. */
         RegistryPtr registry;
-        /** \brief Internal bitset storage. */
-        Storage bits;
+        /** \brief Internal bitset storage, possibly shared with copies of this interpretation. */
+        boost::shared_ptr<Storage> bits;
 
         // \brief Specifies whether Interpretation::myHash is up-to-date.
         mutable bool hashUpdated;
 
         // \brief Hash value of this interpretation.
         mutable std::size_t myHash;
+        /** \brief Makes sure that Interpretation::bits is not shared with other interpretations before it is modified. */
+        inline void detach()
+            { if( !bits.unique() ) bits.reset(new Storage(*bits)); }
+
         // members
     public:
         /** \brief Constructor. */
-        inline Interpretation(){};
+        inline Interpretation():
+            bits(new Storage()), hashUpdated(false), myHash(0) {};
         /** \brief Constructor.
          * @param registry Registry to use for interpreting IDs.
          */
@@ -174,35 +187,66 @@ public ostream_printable<Interpretation>
          * @param id Address of a ground atom ID.
          */
         inline void setFact(IDAddress id)
-            { bits.set(id); hashUpdated = false; }
+            { detach(); bits->set(id); hashUpdated = false; }
 
         /**
          * \brief Removes an atom from the interpretation.
          * @param id Address of a ground atom ID.
          */
         inline void clearFact(IDAddress id)
-            { bits.clear_bit(id); hashUpdated = false; }
+            { detach(); bits->clear_bit(id); hashUpdated = false; }
 
         /**
          * \brief Checks if a ground atom is true in the interpretation.
          * @param id Address of a ground atom ID.
          */
         inline bool getFact(IDAddress id) const
-            { return bits.get_bit(id); }
+            { return bits->get_bit(id); }
 
         /**
          * \brief Returns the internal storage of the interpretation.
          * @return Interpretation as bitset (cf. bitmagic).
          */
-        const Storage& getStorage() const { return bits; }
-        Storage& getStorage() { return bits; }
+        const Storage& getStorage() const { return *bits; }
+        /**
+         * \brief Returns the internal storage of the interpretation for modification.
+         *
+         * Stops sharing the bitset with copies of this interpretation; the reference must not
+         * be used for modifications after this interpretation has been copied again.
+         * @return Interpretation as bitset (cf. bitmagic).
+         */
+        Storage& getStorage() { detach(); return *bits; }
+
+        /**
+         * \brief Checks if this interpretation currently shares its bitset with another one.
+         * @param other Interpretation.
+         * @return True if neither interpretation was modified since one was copied from the other.
+         */
+        inline bool sharesStorageWith(const Interpretation& other) const
+            { return bits == other.bits; }
+
+        /**
+         * \brief Returns a view of the atoms which are true in this interpretation and in \p mask.
+         *
+         * The view neither copies nor allocates; it is invalidated by modifications of this
+         * interpretation or of \p mask.
+         * @param mask Interpretation to intersect with.
+         * @return View of the intersection.
+         */
+        InterpretationMaskView getMaskedView(const Interpretation& mask) const;
+
+        /**
+         * \brief Returns the memory used by the bitset of this interpretation.
+         * @return Number of bytes (as computed by bitmagic).
+         */
+        std::size_t getMemoryUsage() const;
 
         /**
          * \brief Returns a pair of a begin and an end operator to iterate through true atoms in the interpretation.
          * @return Pair of a begin and an end operator; dereferencing iterator gives IDAddress.
          */
         std::pair<TrueBitIterator, TrueBitIterator> trueBits() const
-            { return std::make_pair(bits.first(), bits.end()); }
+            { return std::make_pair(bits->first(), bits->end()); }
 
         /**
          * \brief Helper function gives ordinary ground atom to true bit.
@@ -230,13 +274,13 @@ public ostream_printable<Interpretation>
          * @return True if there are no true atoms in the interpretation and false otherwise.
          */
         inline bool isClear() const
-            {  return bits.none();  }
+            {  return bits->none();  }
 
         /**
          * \brief Resets the interpretation to the empty one.
          */
         inline void clear()
-            {  bits.clear(); hashUpdated = false; }
+            {  detach(); bits->clear(); hashUpdated = false; }
 
         /**
          * \brief Compares this interpretation atomwise to another one.
@@ -264,6 +308,98 @@ public ostream_printable<Interpretation>
         std::size_t getHash() const;
 };
 
+/**
+ * \brief Read-only view of the atoms which are true in an interpretation and in a mask.
+ *
+ * Iterating, counting and testing the view works on the two bitsets directly,
+ * so plugins and model generators can inspect an interpretation projected to a
+ * mask without materializing the projection. Iteration enumerates the mask, so
+ * its cost is proportional to the number of atoms in the mask.
+ *
+ * The view refers to the bitsets, it must not outlive them and is invalidated
+ * by their modification.
+ */
+class DLVHEX_EXPORT InterpretationMaskView
+{
+    public:
+        typedef Interpretation::Storage Storage;
+
+        /** \brief Iterator through the addresses of the atoms in the view (in increasing order). */
+        class TrueBitIterator
+        {
+            private:
+                Storage::enumerator it;
+                const Storage* bits;
+
+                inline void skip()
+                    { while( it.valid() && !bits->get_bit(*it) ) ++it; }
+
+            public:
+                inline TrueBitIterator():
+                    it(), bits(0) {}
+                inline TrueBitIterator(const Storage::enumerator& it, const Storage* bits):
+                    it(it), bits(bits) { skip(); }
+                inline IDAddress operator*() const
+                    { return *it; }
+                inline TrueBitIterator& operator++()
+                    { ++it; skip(); return *this; }
+                inline TrueBitIterator operator++(int)
+                    { TrueBitIterator old(*this); ++(*this); return old; }
+                inline bool valid() const
+                    { return it.valid(); }
+                inline bool operator==(const TrueBitIterator& other) const
+                    { return valid() ? (other.valid() && *it == *other.it) : !other.valid(); }
+                inline bool operator!=(const TrueBitIterator& other) const
+                    { return !(*this == other); }
+        };
+
+    private:
+        const Storage& bits;
+        const Storage& mask;
+
+    public:
+        /** \brief Constructor.
+         * @param bits Bitset of the interpretation.
+         * @param mask Bitset of the mask. */
+        InterpretationMaskView(const Storage& bits, const Storage& mask):
+            bits(bits), mask(mask) {}
+
+        /** \brief Checks if a ground atom is in the view.
+         * @param id Address of a ground atom ID.
+         * @return True if the atom is true in the interpretation and in the mask. */
+        inline bool getFact(IDAddress id) const
+            { return mask.get_bit(id) && bits.get_bit(id); }
+
+        /** \brief Returns a begin and an end iterator through the atoms in the view.
+         * @return Pair of iterators; dereferencing gives IDAddress. */
+        inline std::pair<TrueBitIterator, TrueBitIterator> trueBits() const
+            { return std::make_pair(TrueBitIterator(mask.first(), &bits), TrueBitIterator(mask.end(), &bits)); }
+
+        /** \brief Counts the atoms in the view.
+         * @return Number of atoms. */
+        inline std::size_t count() const
+            { return bm::count_and(bits, mask); }
+
+        /** \brief Checks if the view is empty.
+         * @return True if no atom is true in both the interpretation and the mask. */
+        inline bool isClear() const
+            { return !bm::any_and(bits, mask); }
+
+        /** \brief Checks if all atoms in the view are in \p other.
+         * @param other Bitset to compare to.
+         * @return True if the view is a subset of \p other. */
+        bool isSubsetOf(const Storage& other) const;
+
+        /** \brief Copies the view into an interpretation.
+         * @param out Interpretation to overwrite with the atoms in the view. */
+        void materialize(Interpretation& out) const;
+};
+
+inline InterpretationMaskView Interpretation::getMaskedView(const Interpretation& mask) const
+{
+    return InterpretationMaskView(*bits, *mask.bits);
+}
+
 typedef Interpretation::Ptr InterpretationPtr;
 typedef Interpretation::ConstPtr InterpretationConstPtr;
 
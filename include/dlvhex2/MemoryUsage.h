@@ -0,0 +1,221 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   MemoryUsage.h
+ *
+ * @brief  Approximate memory accounting for registry tables, nogoods, external atom caches and model graphs.
+ *
+ * All numbers are estimates of the heap memory owned by a data structure:
+ * they are computed from object sizes, container capacities and a fixed
+ * overhead per allocation, not by instrumenting the allocator.
+ */
+
+#ifndef MEMORYUSAGE_HPP_INCLUDED__18102026
+#define MEMORYUSAGE_HPP_INCLUDED__18102026
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/fwd.h"
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Printhelpers.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+struct Term;
+struct Predicate;
+struct BuiltinAtom;
+struct ModuleAtom;
+struct Module;
+
+namespace memory
+{
+
+    /** \brief Assumed bookkeeping overhead of one heap allocation (allocator header and alignment). */
+    static const std::size_t AllocationOverhead = 2 * sizeof(void*);
+
+    /** \brief Heap memory owned by a string.
+     * @param str String.
+     * @return Number of bytes (0 if the string is stored within the object). */
+    inline std::size_t heapSize(const std::string& str)
+    {
+        const char* data = str.data();
+        const char* object = reinterpret_cast<const char*>(&str);
+        if( data >= object && data < object + sizeof(std::string) )
+            return 0;
+        return str.capacity() + 1 + AllocationOverhead;
+    }
+
+    /** \brief Heap memory owned by a vector (not including memory owned by its elements).
+     * @param vec Vector.
+     * @return Number of bytes. */
+    template<typename T>
+    inline std::size_t heapSize(const std::vector<T>& vec)
+    {
+        return (vec.capacity() == 0) ? 0 : (vec.capacity() * sizeof(T) + AllocationOverhead);
+    }
+
+    /** \brief Heap memory owned by a vector of tuples.
+     * @param tuples Vector.
+     * @return Number of bytes. */
+    inline std::size_t heapSize(const std::vector<Tuple>& tuples)
+    {
+        std::size_t bytes = (tuples.capacity() == 0) ? 0 : (tuples.capacity() * sizeof(Tuple) + AllocationOverhead);
+        for(std::vector<Tuple>::const_iterator it = tuples.begin(); it != tuples.end(); ++it)
+            bytes += heapSize(*it);
+        return bytes;
+    }
+
+    /** \brief Computes the heap memory owned by values stored in registry tables
+     * (in addition to the size of the value itself), see Table::getMemoryUsage. */
+    struct DLVHEX_EXPORT DynamicSize
+    {
+        std::size_t operator()(const Term& term) const;
+        std::size_t operator()(const Predicate& pred) const;
+        std::size_t operator()(const OrdinaryAtom& atom) const;
+        std::size_t operator()(const BuiltinAtom& atom) const;
+        std::size_t operator()(const AggregateAtom& atom) const;
+        std::size_t operator()(const ExternalAtom& atom) const;
+        std::size_t operator()(const ModuleAtom& atom) const;
+        std::size_t operator()(const Rule& rule) const;
+        std::size_t operator()(const Module& module) const;
+    };
+
+    /** \brief Named byte counts of the components of a run. */
+    class DLVHEX_EXPORT Report:
+    public ostream_printable<Report>
+    {
+        public:
+            typedef std::vector<std::pair<std::string, std::size_t> > Entries;
+
+        private:
+            Entries entries;
+
+        public:
+            /** \brief Adds bytes to a component; new components are appended.
+             * @param name Component name.
+             * @param bytes Number of bytes. */
+            void add(const std::string& name, std::size_t bytes);
+            /** \brief Raises each component to the respective value in \p sample if it is larger.
+             * @param sample Report to compare with. */
+            void updatePeak(const Report& sample);
+            /** \brief Retrieves the components.
+             * @return Components and their byte counts in the order they were added. */
+            inline const Entries& getEntries() const { return entries; }
+            /** \brief Retrieves the sum of all components.
+             * @return Number of bytes. */
+            std::size_t getTotal() const;
+            /** \brief Prints the report as semicolon-separated name/bytes pairs followed by the total
+             * (the format of the --dumpstats output).
+             * @param o Stream to print to.
+             * @return \p o. */
+            std::ostream& print(std::ostream& o) const;
+    };
+
+    /** \brief Collects the memory usage of the registry tables, of all nogood sets and of the caches of all plugin atoms.
+     *
+     * These components may be collected while another thread evaluates the program.
+     * @param ctx ProgramCtx.
+     * @param report Report to add the components to. */
+    DLVHEX_EXPORT void collect(ProgramCtx& ctx, Report& report);
+
+    /** \brief Computes the memory usage of the model graph of ProgramCtx::modelBuilder.
+     *
+     * This must only be called by the thread which evaluates the program.
+     * @param ctx ProgramCtx.
+     * @return Number of bytes (0 if there is no model builder). */
+    DLVHEX_EXPORT std::size_t modelGraphSize(ProgramCtx& ctx);
+
+    /**
+     * \brief Periodically samples the memory usage during evaluation.
+     *
+     * A background thread collects the components which can be read concurrently (see memory::collect)
+     * in fixed intervals, prints each sample and keeps the peak of each component.
+     * The model graph is owned by the evaluating thread, it reports its size via Sampler::modelGraphCheckpoint.
+     */
+    class DLVHEX_EXPORT Sampler:
+    private boost::noncopyable
+    {
+        private:
+            ProgramCtx& ctx;
+            boost::posix_time::time_duration interval;
+            std::ostream& out;
+            boost::posix_time::ptime start;
+            /** \brief Most recent model graph size reported by the evaluating thread. */
+            boost::atomic<std::size_t> modelGraphBytes;
+            /** \brief True if the sampler wants a new model graph size. */
+            boost::atomic<bool> modelGraphRequested;
+
+            mutable boost::mutex mutex;
+            boost::condition_variable stopCondition;
+            bool stopping;
+            Report peak;
+            boost::thread thread;
+
+            void run();
+            void sample();
+
+        public:
+            /** \brief Constructor, starts sampling.
+             * @param ctx ProgramCtx whose components are sampled.
+             * @param intervalMs Interval between two samples in milliseconds.
+             * @param out Stream to print the samples to. */
+            Sampler(ProgramCtx& ctx, unsigned intervalMs, std::ostream& out);
+            /** \brief Destructor, stops sampling. */
+            ~Sampler();
+
+            /** \brief Called by the evaluating thread whenever it is safe to inspect the model graph.
+             *
+             * Computes the model graph size only if a sample was taken since the last call.
+             * @param ctx ProgramCtx. */
+            void modelGraphCheckpoint(ProgramCtx& ctx);
+
+            /** \brief Retrieves the peak of each component over all samples so far.
+             * @return Report with the peaks. */
+            Report getPeak() const;
+    };
+
+}                                // namespace memory
+
+typedef boost::shared_ptr<memory::Sampler> MemorySamplerPtr;
+
+DLVHEX_NAMESPACE_END
+#endif                           // MEMORYUSAGE_HPP_INCLUDED__18102026
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
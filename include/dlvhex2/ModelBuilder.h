@@ -108,6 +108,10 @@ class ModelBuilder
              * @param o Stream to print to.
              * @return \p o. */
             std::ostream& print(std::ostream& o) const;
+            /** \brief Approximates the heap memory of the interpretation (interpretations shared by several models are counted for each model).
+             * @return Number of bytes. */
+            std::size_t getMemoryUsage() const
+                { return interpretation ? interpretation->getMemoryUsage() : 0; }
         };
 
         typedef ModelGraph<EvalGraphT, ModelProperties>
@@ -29,6 +29,7 @@
 #include "dlvhex2/EvalGraph.h"
 #include "dlvhex2/Logger.h"
 #include "dlvhex2/Printhelpers.h"
+#include "dlvhex2/MemoryUsage.h"
 
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -434,8 +435,37 @@ class ModelGraph
         {
             return boost::num_edges(mg);
         }
+
+        /** \brief Approximates the heap memory used by the model graph.
+         *
+         * Includes the memory reported by ModelPropertyBaseT::getMemoryUsage() for each model
+         * (this method is only available if the model properties provide it).
+         * @return Number of bytes. */
+        std::size_t getMemoryUsage() const;
 };                               // class ModelGraph
 
+template<typename EvalGraphT, typename ModelPropertiesT, typename ModelDepPropertiesT>
+std::size_t
+ModelGraph<EvalGraphT, ModelPropertiesT, ModelDepPropertiesT>::getMemoryUsage() const
+{
+    // vertices and edges are list nodes, each edge is also referenced from two edge lists,
+    // each model is in one list of models at its unit
+    std::size_t bytes =
+        countModels() * (sizeof(ModelPropertyBundle) + 8 * sizeof(void*) + 2 * memory::AllocationOverhead) +
+        countModelDeps() * (sizeof(ModelDepPropertyBundle) + 8 * sizeof(void*) + 3 * memory::AllocationOverhead);
+    ModelIterator it, end;
+    for(boost::tie(it, end) = getModels(); it != end; ++it) {
+        const ModelPropertyBundle& props = propsOf(*it);
+        bytes += props.getMemoryUsage();
+        for(typename ModelPropertyBundle::SuccessorModelMap::const_iterator sit = props.successors.begin();
+        sit != props.successors.end(); ++sit) {
+            bytes += (1 + sit->second.size()) * (4 * sizeof(void*) + sizeof(EvalUnit) + memory::AllocationOverhead);
+        }
+    }
+    return bytes;
+}
+
+
 // ModelGraph<...>::addModel(...) implementation
 template<typename EvalGraphT, typename ModelPropertiesT, typename ModelDepPropertiesT>
 typename ModelGraph<EvalGraphT, ModelPropertiesT, ModelDepPropertiesT>::Model
@@ -40,6 +40,9 @@
 #include <boost/foreach.hpp>
 #include <boost/foreach.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/atomic.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "dlvhex2/ID.h"
 #include "dlvhex2/Printhelpers.h"
@@ -205,20 +208,113 @@ class DLVHEX_EXPORT Nogood : public Set<ID>, public ostream_printable<Nogood>
 
 /**
  * \brief Stores a set of nogoods.
+ *
+ * The literals of all nogoods are stored consecutively in a single pool in a compact 32-bit form
+ * (see compactLiteral) rather than as separate Nogood objects. Nogood objects are only created
+ * by getNogood; solvers can iterate over the literals of a stored nogood without copying using getLiterals.
  */
 class DLVHEX_EXPORT NogoodSet : private ostream_printable<NogoodSet>
 {
+    public:
+        /** \brief Converts a compact literal back into a literal ID (used for iterating over stored nogoods). */
+        struct LiteralExpander
+        {
+            typedef ID result_type;
+            inline ID operator()(uint32_t code) const { return expandLiteral(code); }
+        };
+        /** \brief Iterator over the literals of a stored nogood; dereferencing yields literal IDs. */
+        typedef boost::transform_iterator<LiteralExpander, const uint32_t*> literal_iterator;
+        /** \brief Range of the literals of a stored nogood; invalidated by adding or removing nogoods. */
+        typedef boost::iterator_range<literal_iterator> LiteralRange;
+
     private:
-        /** \brief Internal nogood vector. */
-        std::vector<Nogood> nogoods;
+        /** \brief Location of a nogood in NogoodSet::literals. */
+        struct Slot
+        {
+            /** \brief Offset of the first literal. */
+            uint32_t begin;
+            /** \brief Number of literals. */
+            uint32_t size;
+            /** \brief Hash of the nogood as computed by Nogood::recomputeHash. */
+            std::size_t hash;
+        };
+        /** \brief Literals of all nogoods as compact literals, each nogood stored consecutively and sorted as in Nogood. */
+        std::vector<uint32_t> literals;
+        /** \brief Location of each nogood in NogoodSet::literals. */
+        std::vector<Slot> slots;
+        /** \brief Number of entries in NogoodSet::literals which belong to removed or cleared nogoods. */
+        std::size_t unusedLiterals;
         /** \brief Stores for each nogood how often it was added although it is actually stored only once since this is a set (used for deletion strategies). */
         std::vector<int> addCount;
-        /** \brief Indices between 0 and nogoods.size() which are currently unused. */
+        /** \brief Indices between 0 and slots.size() which are currently unused. */
         Set<int> freeIndices;
         /** Stores for each hash the indices of nogoods with this hash (used in the unlikely case that there is a clash of hashes). */
         boost::unordered_map<size_t, Set<int> > nogoodsWithHash;
+        /** \brief Approximate memory of NogoodSet::literals and NogoodSet::slots (including unused parts). */
+        std::size_t nogoodBytes;
+        /** \brief Sum of NogoodSet::nogoodBytes over all existing nogood sets. */
+        static boost::atomic<std::size_t> totalNogoodBytes;
+
+        /**
+         * \brief Approximate memory of NogoodSet::literals and NogoodSet::slots.
+         * @return Number of bytes.
+         */
+        std::size_t storageSize() const;
+        /**
+         * \brief Adjusts NogoodSet::nogoodBytes and NogoodSet::totalNogoodBytes.
+         * @param added Bytes added.
+         * @param removed Bytes removed.
+         */
+        void account(std::size_t added, std::size_t removed);
+        /**
+         * \brief Updates NogoodSet::nogoodBytes and NogoodSet::totalNogoodBytes after the storage has changed.
+         */
+        void updateAccount();
+        /**
+         * \brief Releases the literals of a nogood; the pool is compacted if at least half of it is unused.
+         * @param nogoodIndex Index of the nogood.
+         */
+        void releaseLiterals(int nogoodIndex);
+        /**
+         * \brief Removes the unused entries from NogoodSet::literals.
+         */
+        void compactLiterals();
 
     public:
+        /**
+         * \brief Encodes a nogood literal in 32 bits.
+         *
+         * Ground literals are encoded as 2 * address, plus 1 if they are default-negated;
+         * nonground literals additionally have the highest bit set. Addresses must be smaller than 2^30.
+         * @param lit Literal ID as created by NogoodContainer::createLiteral.
+         * @return Compact literal.
+         */
+        static inline uint32_t compactLiteral(ID lit) {
+            return (lit.isOrdinaryGroundAtom() ? 0 : 0x80000000) | (lit.address << 1) | (lit.isNaf() ? 1 : 0);
+        }
+
+        /**
+         * \brief Decodes a compact literal.
+         * @param code Compact literal as computed by compactLiteral.
+         * @return Literal ID.
+         */
+        static inline ID expandLiteral(uint32_t code) {
+            return ID(ID::MAINKIND_LITERAL | ((code & 0x80000000) ? ID::SUBKIND_ATOM_ORDINARYN : ID::SUBKIND_ATOM_ORDINARYG) | ((code & 1) ? ID::NAF_MASK : 0),
+                (code & 0x7fffffff) >> 1);
+        }
+
+        /** \brief Constructor. */
+        NogoodSet();
+
+        /**
+         * \brief Copy-constructor.
+         * @param other NogoodSet to copy.
+         */
+        NogoodSet(const NogoodSet& other);
+
+        /** \brief Destructor. */
+        ~NogoodSet();
+
         /** \brief Reorders the nogoods such that there are no free indices in the range 0-(getNogoodCount()-1). */
         void defragment();
 
@@ -249,18 +345,41 @@ class DLVHEX_EXPORT NogoodSet : private ostream_printable<NogoodSet>
         void removeNogood(Nogood ng);
 
         /**
-         * \brief Returns a nogood from the set.
-         * @param index Index of the nogood to retrieve.
-         * @return Reference to the requested nogood.
+         * \brief Replaces a nogood by the empty nogood and releases its memory, but keeps its index occupied.
+         *
+         * In contrast to removeNogood, indices of other nogoods remain valid and the slot is not reused;
+         * this is intended for solvers which keep per-index data and delete nogoods during search.
+         * @param nogoodIndex The index of the nogood to clear.
          */
-        Nogood& getNogood(int index);
+        void clearNogood(int nogoodIndex);
 
         /**
          * \brief Returns a nogood from the set.
+         *
+         * The nogood is constructed from the compact storage; use getLiterals to iterate without copying.
          * @param index Index of the nogood to retrieve.
-         * @return Constant reference to the requested nogood.
+         * @return Copy of the requested nogood.
+         */
+        Nogood getNogood(int index) const;
+
+        /**
+         * \brief Returns the literals of a nogood from the set without copying them.
+         * @param index Index of the nogood.
+         * @return Range of the literal IDs; it is invalidated when nogoods are added or removed.
          */
-        const Nogood& getNogood(int index) const;
+        inline LiteralRange getLiterals(int index) const {
+            const uint32_t* begin = literals.empty() ? 0 : &literals[0] + slots[index].begin;
+            return LiteralRange(literal_iterator(begin), literal_iterator(begin + slots[index].size));
+        }
+
+        /**
+         * \brief Returns the number of literals of a nogood from the set.
+         * @param index Index of the nogood.
+         * @return Number of literals.
+         */
+        inline int getNogoodSize(int index) const {
+            return slots[index].size;
+        }
 
         /**
          * \brief Returns the current number of nogoods in the set.
@@ -273,6 +392,20 @@ class DLVHEX_EXPORT NogoodSet : private ostream_printable<NogoodSet>
          */
         void forgetLeastFrequentlyAdded();
 
+        /**
+         * \brief Approximates the heap memory used by this set.
+         * @return Number of bytes.
+         */
+        std::size_t getMemoryUsage() const;
+
+        /**
+         * \brief Approximates the heap memory used by the nogoods of all existing nogood sets.
+         *
+         * Can be called from any thread.
+         * @return Number of bytes.
+         */
+        static std::size_t getTotalMemoryUsage();
+
         /**
          * \brief Prints the nogood set in numeric format.
          * @param o The stream to print the output.
@@ -355,13 +488,14 @@ class DLVHEX_EXPORT SimpleNogoodContainer : public NogoodContainer
     public:
         void addNogood(Nogood ng);
         void removeNogood(Nogood ng);
-        Nogood& getNogood(int index);
+        Nogood getNogood(int index);
         int getNogoodCount();
         void clear();
         void addAllResolvents(RegistryPtr reg, int maxSize = -1);
 
         void forgetLeastFrequentlyAdded();
         void defragment();
+        std::size_t getMemoryUsage();
 
         typedef boost::shared_ptr<SimpleNogoodContainer> Ptr;
         typedef boost::shared_ptr<const SimpleNogoodContainer> ConstPtr;
@@ -56,8 +56,9 @@ boost::multi_index::indexed_by<
 boost::multi_index::random_access<
 boost::multi_index::tag<impl::AddressTag>
 >,
-// (unique) textual representation (parsing index, see TODO above)
-boost::multi_index::hashed_unique<
+// textual representation (parsing index, see TODO above);
+// non-unique because atoms stored without text (see Registry::setLazyAtomText) share the empty text
+boost::multi_index::hashed_non_unique<
 boost::multi_index::tag<impl::TextTag>,
 BOOST_MULTI_INDEX_MEMBER(OrdinaryAtom,std::string,text)
 >,
@@ -86,8 +87,33 @@ ID (Atom::*)() const,&Atom::front>
         typedef AddressIndex::iterator AddressIterator;
         typedef PredicateIndex::iterator PredicateIterator;
 
+    protected:
+        typedef BOOST_MULTI_INDEX_MEMBER(OrdinaryAtom,std::string,text) TextKey;
+        typedef BOOST_MULTI_INDEX_MEMBER(OrdinaryAtom::Atom,Tuple,tuple) TupleKey;
+        /** \brief Sharded text index (only maintained in concurrent storage mode). */
+        impl::ShardedHashIndex<OrdinaryAtom, TextKey> concurrentTextIndex;
+        /** \brief Sharded tuple index (only maintained in concurrent storage mode). */
+        impl::ShardedHashIndex<OrdinaryAtom, TupleKey> concurrentTupleIndex;
+
         // methods
     public:
+        /** \brief Constructor. */
+        OrdinaryAtomTable() {}
+
+        /** \brief Copy-constructor; the copy uses the same storage mode as \p other.
+         * @param other Other table. */
+        OrdinaryAtomTable(const OrdinaryAtomTable& other):
+        Table(other) {
+            if( other.concurrent ) setConcurrentStorage(true);
+        }
+
+        /** \brief Switches the concurrent storage mode on or off.
+         *
+         * In concurrent storage mode, lookups by ID, address, text and tuple do not take the table lock,
+         * but use a lock-free address index and sharded hash indices (see ConcurrentTable.h).
+         * Switching the mode must not happen concurrently to other accesses to the table.
+         * @param enable True to enable and false to disable the concurrent storage mode. */
+        inline void setConcurrentStorage(bool enable);
         /** \brief Retrieve by ID.
          *
          * Assert that id.kind is correct for OrdinaryGroundAtom.
@@ -114,6 +140,9 @@ ID (Atom::*)() const,&Atom::front>
         inline ID getIDByAddress(IDAddress addr) const throw ();
 
         /** \brief Given string, look if already stored.
+         *
+         * Atoms which were stored without text (see Registry::setLazyAtomText) are not found;
+         * use getIDByTuple for them.
          * @param text String representation of the ordinary atom to retrieve.
          * @return ID_FAIL if not stored, otherwise return ID. */
         inline ID getIDByString(const std::string& text) const throw();
@@ -141,6 +170,7 @@ ID (Atom::*)() const,&Atom::front>
         /** \brief Store atom, assuming it does not exist.
          *
          * Assert that atom did not exist in table.
+         * The text of \p atom may be empty, then the atom is only found by tuple.
          * @param atom Atom to retrieve; must be in the table.
          * @return ID of \param atom. */
         inline ID storeAndGetID(const OrdinaryAtom& atom) throw();
@@ -163,6 +193,27 @@ ID (Atom::*)() const,&Atom::front>
             getAllByAddress() const throw();
 };
 
+void OrdinaryAtomTable::setConcurrentStorage(bool enable)
+{
+    WriteLock lock(mutex);
+    if( enable == concurrent )
+        return;
+    concurrentAddresses.clear();
+    concurrentTextIndex.clear();
+    concurrentTupleIndex.clear();
+    if( enable ) {
+        const AddressIndex& idx = container.get<impl::AddressTag>();
+        for(AddressIndex::const_iterator it = idx.begin(); it != idx.end(); ++it) {
+            const IDAddress addr = concurrentAddresses.push_back(&*it);
+            if( !it->text.empty() )
+                concurrentTextIndex.insert(&*it, addr);
+            concurrentTupleIndex.insert(&*it, addr);
+        }
+    }
+    concurrent = enable;
+}
+
+
 // retrieve by ID
 // assert that id.kind is correct for Term
 // assert that ID exists
@@ -172,6 +223,8 @@ ID id) const throw ()
 {
     assert(id.isAtom() || id.isLiteral());
     assert(id.isOrdinaryAtom());
+    if( concurrent )
+        return *concurrentAddresses.at(id.address);
     ReadLock lock(mutex);
     const AddressIndex& idx = container.get<impl::AddressTag>();
     // the following check only works for random access indices, but here it is ok
@@ -186,6 +239,8 @@ const OrdinaryAtom&
 OrdinaryAtomTable::getByAddress(
 IDAddress addr) const throw ()
 {
+    if( concurrent )
+        return *concurrentAddresses.at(addr);
     ReadLock lock(mutex);
     const AddressIndex& idx(container.get<impl::AddressTag>());
     // the following check only works for random access indices, but here it is ok
@@ -210,7 +265,14 @@ IDAddress addr) const throw ()
 ID OrdinaryAtomTable::getIDByString(
 const std::string& str) const throw()
 {
-    typedef Container::index<impl::TextTag>::type OrdinaryAtomIndex;
+    // atoms without text cannot be found by text
+    if( str.empty() )
+        return ID_FAIL;
+    if( concurrent ) {
+        const OrdinaryAtom* atom;
+        const IDAddress addr = concurrentTextIndex.find(str, atom);
+        return (addr == ID_FAIL.address) ? ID_FAIL : ID(atom->kind, addr);
+    }
     ReadLock lock(mutex);
     const TextIndex& sidx(container.get<impl::TextTag>());
     TextIndex::const_iterator it(sidx.find(str));
@@ -232,7 +294,11 @@ const std::string& str) const throw()
 ID OrdinaryAtomTable::getIDByTuple(
 const Tuple& tuple) const throw()
 {
-    typedef Container::index<impl::TupleTag>::type TupleIndex;
+    if( concurrent ) {
+        const OrdinaryAtom* atom;
+        const IDAddress addr = concurrentTupleIndex.find(tuple, atom);
+        return (addr == ID_FAIL.address) ? ID_FAIL : ID(atom->kind, addr);
+    }
     ReadLock lock(mutex);
     const TupleIndex& sidx(container.get<impl::TupleTag>());
     TupleIndex::const_iterator it(sidx.find(tuple));
@@ -290,7 +356,6 @@ const OrdinaryAtom& atm) throw()
 {
     assert(ID(atm.kind,0).isAtom());
     assert(ID(atm.kind,0).isOrdinaryAtom());
-    assert(!atm.text.empty());
     assert(!(
         (atm.tuple.front().kind & ID::PROPERTY_AUX) != 0 &&
         (atm.kind & ID::PROPERTY_AUX) == 0 ) &&
@@ -305,6 +370,15 @@ const OrdinaryAtom& atm) throw()
     (void)success;
     assert(success);
 
+    if( concurrent ) {
+        // publish address before keys, such that readers can resolve every address they find
+        const IDAddress addr = concurrentAddresses.push_back(&*it);
+        if( !atm.text.empty() )
+            concurrentTextIndex.insert(&*it, addr);
+        concurrentTupleIndex.insert(&*it, addr);
+        return ID(atm.kind, addr);
+    }
+
     return ID(
         atm.kind,                // kind
                                  // address
@@ -0,0 +1,173 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   PersistentAnswerCache.h
+ *
+ * @brief  Answers of external sources which are kept across runs.
+ */
+
+#ifndef PERSISTENTANSWERCACHE_H__
+#define PERSISTENTANSWERCACHE_H__
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/fwd.h"
+#include "dlvhex2/PluginInterface.h"
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <string>
+
+DLVHEX_NAMESPACE_BEGIN
+
+/**
+ * \brief Stores answers of external sources in a file such that later runs can skip their evaluation.
+ *
+ * Only external atoms with the property ExtSourceProperties::isPersistentlyCacheable are stored.
+ * Entries are keyed by the plugin (name and version) which provides the external atom, its predicate,
+ * the input tuple, the output pattern and a hash of the true atoms of the input interpretation.
+ * Terms and atoms are identified by their textual representation because IDs are not stable across runs.
+ *
+ * Queries over partial interpretations are not cached, and neither are nogoods learned by the external source
+ * (learning from the input-output behavior still works on answers from the cache).
+ *
+ * The number of stored entries is bounded; when the cache is saved, the least recently used entries beyond
+ * the bound are dropped. All methods are thread-safe.
+ */
+class DLVHEX_EXPORT PersistentAnswerCache
+{
+    public:
+        /** \brief Version of the file format. */
+        static const uint32_t FormatVersion = 1;
+
+    private:
+        /** \brief Answer with its time of last use. */
+        struct StoredEntry
+        {
+            /** \brief Serialized answer tuples. */
+            std::string answer;
+            /** \brief Value of clock when the entry was stored or looked up the last time. */
+            uint32_t lastUse;
+        };
+
+        /** \brief File the cache is loaded from and saved to. */
+        std::string filename;
+        /** \brief Maximum number of entries. */
+        unsigned maxEntries;
+        /** \brief Plugin name and version of each registered external predicate. */
+        std::map<std::string, std::string> sources;
+        /** \brief Stored entries by key. */
+        boost::unordered_map<std::string, StoredEntry> entries;
+        /** \brief Logical time used for LRU eviction. */
+        uint32_t clock;
+        /** \brief Number of queries answered from the cache. */
+        std::size_t hits;
+        /** \brief Number of queries which were not found in the cache. */
+        std::size_t misses;
+        /** \brief Protects all members. */
+        boost::mutex mutex;
+
+    public:
+        /**
+         * \brief Constructor.
+         *
+         * Does not access the file.
+         * @param filename File the cache is loaded from and saved to.
+         * @param maxEntries Maximum number of entries.
+         */
+        PersistentAnswerCache(const std::string& filename, unsigned maxEntries);
+
+        /**
+         * \brief Loads the entries from the file.
+         *
+         * A missing file yields an empty cache; an unreadable or incompatible file is ignored with a warning.
+         */
+        void load();
+
+        /**
+         * \brief Writes the most recently used entries to the file.
+         *
+         * Throws a GeneralError if the file cannot be written.
+         */
+        void save();
+
+        /**
+         * \brief Declares the plugin which provides an external predicate.
+         *
+         * Queries to unregistered predicates are not cached.
+         * @param predicate Predicate of the external atom.
+         * @param plugin The plugin providing the external atom.
+         */
+        void registerPluginAtom(const std::string& predicate, const PluginInterface& plugin);
+
+        /**
+         * \brief Computes the key of a query.
+         * @param reg Registry of the query.
+         * @param predicate Predicate of the external atom.
+         * @param query Query to the external atom.
+         * @param key Receives the key if the query can be cached.
+         * @return True if the answer to \p query can be cached and false otherwise.
+         */
+        bool computeKey(RegistryPtr reg, const std::string& predicate, const PluginAtom::Query& query, std::string& key);
+
+        /**
+         * \brief Retrieves an answer.
+         * @param reg Registry used to restore the terms of the answer.
+         * @param key Key of the query as computed by computeKey.
+         * @param answer Receives the answer tuples if the entry exists.
+         * @return True if the entry exists and false otherwise.
+         */
+        bool lookup(RegistryPtr reg, const std::string& key, PluginAtom::Answer& answer);
+
+        /**
+         * \brief Adds or replaces an answer.
+         * @param reg Registry of the terms of the answer.
+         * @param key Key of the query as computed by computeKey.
+         * @param answer The answer.
+         */
+        void store(RegistryPtr reg, const std::string& key, const PluginAtom::Answer& answer);
+
+        /**
+         * \brief Returns the number of queries answered from the cache.
+         * @return Number of hits.
+         */
+        std::size_t getHits();
+
+        /**
+         * \brief Returns the number of queries which were not found in the cache.
+         * @return Number of misses.
+         */
+        std::size_t getMisses();
+};
+
+DLVHEX_NAMESPACE_END
+#endif                           // PERSISTENTANSWERCACHE_H__
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -222,7 +222,10 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic.hpp>
 
+#include <list>
 #include <map>
 #include <string>
 #include <iosfwd>
@@ -1003,7 +1006,7 @@ class DLVHEX_EXPORT PluginAtom
         /**
          * \brief Destructor.
          */
-        virtual ~PluginAtom() {}
+        virtual ~PluginAtom();
 
         /**
          * \brief Get input arity.
@@ -1074,7 +1077,7 @@ class DLVHEX_EXPORT PluginAtom
          *
          * The function performs the following operations.
          * 1. It splits the query into atomic queries using PluginAtom::splitQuery.
-         * 2. It answers the atomic queries by calling either PluginAtom::retrieveCached or PluginAtom::retrieve, depending on the settings.
+         * 2. It answers the atomic queries by calling either PluginAtom::retrieveCached or PluginAtom::retrievePersistent, depending on the settings.
          * 3. It applies default learning methods to the result (e.g. learning from IO behavior, monotonicity, functionality, etc.).
          *
          * This method must not be overridden.
@@ -1093,7 +1096,11 @@ class DLVHEX_EXPORT PluginAtom
          *
          * This function implements the query cache, if enabled, and will rarely need to be
          * overridden. If the query cannot be answered from the cache, it will be forwarded
-         * to the PluginAtom::retrieve method.
+         * to the PluginAtom::retrievePersistent method.
+         *
+         * A query is also answered from the cache if there is a cached answer for the same input
+         * and a less specific output pattern. The answer might then contain tuples which do not match
+         * Query::pattern; they are ignored when the answer is integrated into the interpretation.
          *
          * @param query Input to the external source.
          * @param answer Output of the external source.
@@ -1103,6 +1110,23 @@ class DLVHEX_EXPORT PluginAtom
          */
         virtual bool retrieveCached(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
 
+        /**
+         * \brief Retrieve answer to a query from the persistent answer cache if possible and by PluginAtom::retrieve otherwise.
+         *
+         * The persistent answer cache (see ProgramCtx::persistentAnswerCache) is only used if it is enabled and the external atom
+         * has the property ExtSourceProperties::isPersistentlyCacheable; answers computed by PluginAtom::retrieve are then added to it.
+         * Answers from the persistent cache come without the nogoods learned by the external source.
+         *
+         * This method must not be overridden.
+         *
+         * @param query Input to the external source.
+         * @param answer Output of the external source.
+         * @param nogoods Here, nogoods learned from the external source can be added to prune the search space; see Nogood, NogoodContainer and ExternalLearningHelper.
+         *
+         * @return True if the query was answered from the persistent cache and false otherwise.
+         */
+        bool retrievePersistent(const Query& query, Answer& answer, NogoodContainerPtr nogoods);
+
         /**
          * \brief Retrieve answer to a query (external computation happens here).
          *
@@ -1304,11 +1328,49 @@ class DLVHEX_EXPORT PluginAtom
         PredicateMaskPtr getReplacements(){ replacements->updateMask(); return replacements; }
 
         /**
-         * \brief Erase all elements from queryAnswerNogoodCache.
+         * \brief Erase all elements from the query cache.
          */
-        void resetCache() {
-            queryAnswerNogoodCache.clear();
-        }
+        void resetCache();
+
+        /** \brief Counters of the query cache. */
+        struct CacheStatistics
+        {
+            /** \brief Queries answered from the cache (including subsumptionHits). */
+            unsigned long hits;
+            /** \brief Queries answered from the cached answer of a query with a less specific pattern. */
+            unsigned long subsumptionHits;
+            /** \brief Queries which were forwarded to PluginAtom::retrieve. */
+            unsigned long misses;
+            /** \brief Cached answers which were dropped to stay within the cache limits. */
+            unsigned long evictions;
+            /** \brief Approximate current size of the cache in bytes. */
+            std::size_t bytes;
+
+            CacheStatistics(): hits(0), subsumptionHits(0), misses(0), evictions(0), bytes(0) {}
+        };
+
+        /**
+         * \brief Returns the counters of the query cache since the atom was created.
+         * @return Copy of the counters.
+         */
+        CacheStatistics getCacheStatistics();
+
+        /**
+         * \brief Approximates the memory used by the query cache.
+         *
+         * Includes the cached nogoods (which are also accounted for by NogoodSet::getTotalMemoryUsage).
+         * @return Number of bytes.
+         */
+        std::size_t getCacheMemoryUsage();
+
+        /**
+         * \brief Approximates the memory used by the query caches of all plugin atoms.
+         *
+         * Can be called from any thread.
+         * @return Number of bytes.
+         */
+        static std::size_t getTotalCacheMemoryUsage()
+            { return totalCacheBytes.load(boost::memory_order_relaxed); }
 
     protected:
         // \brief Predicate of the atom as it appears in HEX programs (without leading &)
@@ -1335,14 +1397,92 @@ class DLVHEX_EXPORT PluginAtom
         unsigned outputSize;
 
         // Query/Answer cache
-        /** \brief Type used for associating an Answer and a NogoodContainer to a Query. */
-        typedef boost::unordered_map<const Query, std::pair<Answer, SimpleNogoodContainerPtr> > QueryAnswerNogoodCache;
+        /** \brief Answer and NogoodContainer of a query with a certain output pattern. */
+        struct CacheEntry
+        {
+            /** \brief Output pattern of the cached query. */
+            Tuple pattern;
+            /** \brief Answer to the query. */
+            Answer answer;
+            /** \brief Nogoods learned from the query; NULL if the query was answered without learning. */
+            SimpleNogoodContainerPtr nogoods;
+            /** \brief Approximate size of the entry in bytes. */
+            std::size_t bytes;
+            /** \brief Time spent in PluginAtom::retrieve per byte of the entry (microseconds); the benefit of keeping the entry. */
+            double value;
+            /** \brief Eviction priority: value plus the inflation of the stripe at the last use (entries with low priority are evicted first). */
+            double priority;
+        };
+        /** \brief Type used for associating the cached answers for different output patterns to a Query with empty pattern.
+         *
+         * The patterns of the entries of a query do not subsume each other. */
+        typedef boost::unordered_map<const Query, std::vector<CacheEntry> > QueryAnswerNogoodCache;
+        /** \brief Query which is currently answered by PluginAtom::retrieve after a cache miss. */
+        struct PendingQuery
+        {
+            /** \brief Query with empty pattern (in-depth copy). */
+            Query key;
+            /** \brief Output pattern of the query. */
+            Tuple pattern;
+            /** \brief Whether nogoods are learned. */
+            bool withNogoods;
+
+            PendingQuery(const Query& key, const Tuple& pattern, bool withNogoods):
+                key(key), pattern(pattern), withNogoods(withNogoods) {}
+        };
+        /** \brief Part of the query cache with its own lock; a query is stored in the stripe selected by the hash of its key. */
+        struct CacheStripe
+        {
+            /** \brief Mutex for accessing all other members. */
+            boost::mutex mutex;
+            /** \brief Notified whenever a pending query of the stripe was answered. */
+            boost::condition_variable retrieved;
+            /** \brief Cached answers. */
+            QueryAnswerNogoodCache entries;
+            /** \brief Queries which are currently retrieved; equivalent queries wait for them instead of calling PluginAtom::retrieve again. */
+            std::list<PendingQuery> pending;
+            /** \brief Counters of the queries to this stripe. */
+            CacheStatistics statistics;
+            /** \brief Priority of the last evicted entry; added to the value of entries when they are used (such that entries which were not used recently age). */
+            double inflation;
+
+            CacheStripe(): inflation(0) {}
+        };
+        /** \brief Number of stripes of the query cache. */
+        static const unsigned CacheStripes = 16;
         /** \brief Type used for associating a container of learned nogoods to a Query. */
         typedef boost::unordered_map<const Query, SimpleNogoodContainerPtr> QueryNogoodCache;
-        /** \brief Associates an Answer and a NogoodContainer to a Query. */
-        QueryAnswerNogoodCache queryAnswerNogoodCache;
-        /** \brief Mutex for accessing PluginAtom::queryAnswerNogoodCache. */
-        boost::mutex cacheMutex;
+        /** \brief Associates Answers and NogoodContainers to Queries.
+         *
+         * Lookups in different stripes do not block each other, and PluginAtom::retrieve is called without holding a lock.
+         * The size of the cache is bounded by the options ExtAtomCacheAtomLimit (per plugin atom, split evenly among the stripes)
+         * and ExtAtomCacheLimit (all plugin atoms); entries which are cheap to recompute relative to their size and
+         * which were not used recently are evicted first. */
+        CacheStripe queryAnswerNogoodCache[CacheStripes];
+        /** \brief Sum of the sizes of the query caches of all plugin atoms in bytes. */
+        static boost::atomic<std::size_t> totalCacheBytes;
+
+        /** \brief Approximates the memory used by a key of the query cache.
+         * @param key Key (query with empty pattern).
+         * @return Number of bytes. */
+        static std::size_t cacheKeyBytes(const Query& key);
+        /** \brief Approximates the memory used by an entry of the query cache.
+         * @param pattern Output pattern of the entry.
+         * @param answer Answer of the entry.
+         * @param nogoods Nogoods of the entry (may be NULL).
+         * @return Number of bytes. */
+        static std::size_t cacheEntryBytes(const Tuple& pattern, const Answer& answer, SimpleNogoodContainerPtr nogoods);
+
+        /**
+         * \brief Drops entries with low priority from a stripe until the size limits hold again.
+         *
+         * @param stripe Stripe to drop entries from; must be locked by the caller.
+         * @param keepKey Key of an entry which must not be dropped.
+         * @param keepPattern Pattern of the entry which must not be dropped.
+         * @param stripeLimit Maximum size of the stripe in bytes (0 for no limit).
+         * @param totalLimit Maximum size of all caches in bytes (0 for no limit); if there are not enough entries in \p stripe, it might remain exceeded.
+         */
+        void evictCacheEntries(CacheStripe& stripe, const Query& keepKey, const Tuple& keepPattern, std::size_t stripeLimit, std::size_t totalLimit);
 
         /** \brief Mask of all positive replacement atoms of this external atom. */
         PredicateMaskPtr replacements;
@@ -32,7 +32,7 @@
  */
 
 #ifndef PREDICATETABLE_HPP_INCLUDED__20122010
-#define PREDICATETABLE_HPP_INCLUDED__20102010
+#define PREDICATETABLE_HPP_INCLUDED__20122010
 
 #include "dlvhex2/PlatformDefinitions.h"
 #include "dlvhex2/Logger.h"
@@ -72,8 +72,29 @@ BOOST_MULTI_INDEX_MEMBER(Predicate,std::string,symbol)
         typedef AddressIndex::iterator AddressIterator;
         typedef Container::index<impl::PredicateNameTag>::type PredicateNameIndex;
 
+    protected:
+        typedef BOOST_MULTI_INDEX_MEMBER(Predicate,std::string,symbol) SymbolKey;
+        /** \brief Sharded predicate name index (only maintained in concurrent storage mode). */
+        impl::ShardedHashIndex<Predicate, SymbolKey> concurrentSymbolIndex;
+
         // methods
     public:
+        /** \brief Constructor. */
+        PredicateTable() {}
+
+        /** \brief Copy-constructor; the copy uses the same storage mode as \p other.
+         * @param other Other table. */
+        PredicateTable(const PredicateTable& other):
+        Table(other) {
+            if( other.concurrent ) setConcurrentStorage(true);
+        }
+
+        /** \brief Switches the concurrent storage mode on or off.
+         *
+         * See OrdinaryAtomTable::setConcurrentStorage.
+         * Note that setArity still takes the table lock in concurrent mode.
+         * @param enable True to enable and false to disable the concurrent storage mode. */
+        inline void setConcurrentStorage(bool enable);
         /** \brief Retrieve by ID.
          *
          * Assert that id.kind is correct for Term.Predicate.
@@ -113,6 +134,23 @@ BOOST_MULTI_INDEX_MEMBER(Predicate,std::string,symbol)
 
 };
 
+void PredicateTable::setConcurrentStorage(bool enable)
+{
+    WriteLock lock(mutex);
+    if( enable == concurrent )
+        return;
+    concurrentAddresses.clear();
+    concurrentSymbolIndex.clear();
+    if( enable ) {
+        const AddressIndex& idx = container.get<impl::AddressTag>();
+        for(AddressIndex::const_iterator it = idx.begin(); it != idx.end(); ++it) {
+            concurrentSymbolIndex.insert(&*it, concurrentAddresses.push_back(&*it));
+        }
+    }
+    concurrent = enable;
+}
+
+
 // retrieve by ID
 // assert that id.kind is correct for Term
 // assert that ID exists
@@ -120,6 +158,8 @@ const Predicate& PredicateTable::getByID(ID id) const throw ()
 {
     assert(id.isTerm());
     assert(id.isPredicateTerm() );
+    if( concurrent )
+        return *concurrentAddresses.at(id.address);
     ReadLock lock(mutex);
     const AddressIndex& idx = container.get<impl::AddressTag>();
     // the following check only works for random access indices, but here it is ok
@@ -153,6 +193,11 @@ void PredicateTable::setArity(ID id, int arity)
 // if no, return ID_FAIL, otherwise return ID
 ID PredicateTable::getIDByString(const std::string& str) const throw()
 {
+    if( concurrent ) {
+        const Predicate* pred;
+        const IDAddress addr = concurrentSymbolIndex.find(str, pred);
+        return (addr == ID_FAIL.address) ? ID_FAIL : ID(pred->kind, addr);
+    }
     ReadLock lock(mutex);
     const PredicateNameIndex& sidx = container.get<impl::PredicateNameTag>();
     PredicateNameIndex::const_iterator it = sidx.find(str);
@@ -170,6 +215,12 @@ ID PredicateTable::getIDByString(const std::string& str) const throw()
 
 const Predicate& PredicateTable::getByString(const std::string& str) const throw()
 {
+    if( concurrent ) {
+        const Predicate* pred;
+        if( concurrentSymbolIndex.find(str, pred) == ID_FAIL.address )
+            return PREDICATE_FAIL;
+        return *pred;
+    }
     ReadLock lock(mutex);
     const PredicateNameIndex& sidx = container.get<impl::PredicateNameTag>();
     PredicateNameIndex::const_iterator it = sidx.find(str);
@@ -199,6 +250,12 @@ ID PredicateTable::storeAndGetID(const Predicate& symb) throw()
     (void)success;
     assert(success);
 
+    if( concurrent ) {
+        const IDAddress addr = concurrentAddresses.push_back(&*it);
+        concurrentSymbolIndex.insert(&*it, addr);
+        return ID(symb.kind, addr);
+    }
+
     return ID(symb.kind,         // kind
                                  // address
         container.project<impl::AddressTag>(it) - idx.begin()
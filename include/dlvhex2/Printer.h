@@ -94,6 +94,12 @@ public Printer
         RawPrinter(std::ostream& out, RegistryPtr registry):
         Printer(out, registry) {}
         virtual void print(ID id);
+        /** \brief Prints an ordinary atom.
+         *
+         * Prints the stored text of \p atom or, if the atom has no text
+         * (see Registry::setLazyAtomText), renders it from its tuple.
+         * @param atom Ordinary atom to print. */
+        void printOrdinaryAtom(const OrdinaryAtom& atom);
         /** \brief Prints a single ID without module prefix (cf. modular HEX).
          * @param id ID to print. */
         void printWithoutPrefix(ID id);
@@ -207,6 +207,15 @@ class DLVHEX_EXPORT ProgramCtx
         // model graph is only accessible via modelbuilder->getModelGraph()!
         // (model graph is part of the model builder) TODO think about that
 
+        /** \brief Samples memory usage during evaluation (only if statistics are dumped). */
+        MemorySamplerPtr memorySampler;
+
+        /** \brief Learned nogoods and phases of the internal solver kept across runs (only with option --warmstart). */
+        SolverWarmStartCachePtr warmStartCache;
+
+        /** \brief Answers of external sources kept across runs (only with option --extcachefile). */
+        PersistentAnswerCachePtr persistentAnswerCache;
+
         /** \brief Stores which benchmarks shall be preserved at first model. */
         std::map<std::string, std::string> benchmarksToSnapshotAtFirstModel;
 
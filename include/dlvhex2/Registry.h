@@ -48,6 +48,7 @@
 #include "dlvhex2/ModuleAtomTable.h"
 #include "dlvhex2/RuleTable.h"
 #include "dlvhex2/ModuleTable.h"
+#include "dlvhex2/MemoryUsage.h"
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
@@ -182,11 +183,12 @@ public boost::enable_shared_from_this<Registry>
          * Assert symbol is constant
          * lookup symbol and return ID if exists
          * otherwise register as constant and return ID.
+         * Looking up a stored symbol does not allocate memory.
          * @param symbol String to store in a term.
          * @param aux Defines whether to mark the new term as auxiliary or not.
          * @return ID of the stored term.
          */
-        ID storeConstantTerm(const std::string& symbol, bool aux=false);
+        ID storeConstantTerm(boost::string_ref symbol, bool aux=false);
 
         /**
          * \brief Allows for storing variable terms.
@@ -244,6 +246,32 @@ public boost::enable_shared_from_this<Registry>
          */
         void setupAuxiliaryGroundAtomMask();
 
+        /**
+         * \brief Switches the concurrent storage mode of the term, predicate and ordinary atom tables.
+         *
+         * In concurrent storage mode, lookups in these tables do not serialize on the table lock
+         * (see ConcurrentTable.h), which pays off if multiple threads access the registry.
+         * Must not be called while other threads access the registry.
+         * @param enable True to enable and false to disable the concurrent storage mode.
+         */
+        void setConcurrentStorage(bool enable);
+
+        /**
+         * \brief Switches lazy text generation for ordinary atoms on or off.
+         *
+         * If enabled, storeOrdinaryAtom, storeOrdinaryGAtom and storeOrdinaryNAtom store atoms
+         * without text; the text is then only rendered from the tuple when the atom is printed
+         * (see RawPrinter::printOrdinaryAtom) and such atoms can only be found by tuple.
+         * @param enable True to enable and false to disable lazy text generation.
+         */
+        void setLazyAtomText(bool enable);
+
+        /**
+         * \brief Checks if lazy text generation for ordinary atoms is enabled.
+         * @return True if new ordinary atoms are stored without text.
+         */
+        bool hasLazyAtomText() const;
+
         /**
          * \brief Creates auxiliary constant symbols.
          *
@@ -301,6 +329,33 @@ public boost::enable_shared_from_this<Registry>
          */
         ID getIDByAuxiliaryVariableSymbol(ID auxVariableID) const;
 
+        /** \brief Auxiliary symbol created by getAuxiliaryConstantSymbol or getAuxiliaryVariableSymbol. */
+        struct AuxiliarySymbol
+        {
+            /** \brief Type of the auxiliary. */
+            char type;
+            /** \brief ID the auxiliary was created for. */
+            ID id;
+            /** \brief Symbol of the auxiliary term. */
+            std::string symbol;
+            /** \brief ID of the auxiliary term. */
+            ID auxID;
+        };
+
+        /**
+         * \brief Retrieves all auxiliary symbols (e.g., for writing them to a snapshot).
+         * @param symbols Vector the auxiliary symbols are appended to.
+         */
+        void getAuxiliarySymbols(std::vector<AuxiliarySymbol>& symbols) const;
+
+        /**
+         * \brief Registers an auxiliary symbol whose term is already stored in the registry (e.g., when loading a snapshot).
+         *
+         * Afterwards getAuxiliaryConstantSymbol and getAuxiliaryVariableSymbol return \p symbol.auxID for \p symbol.type and \p symbol.id.
+         * @param symbol Auxiliary symbol to register; its term must be stored at \p symbol.auxID.
+         */
+        void restoreAuxiliarySymbol(const AuxiliarySymbol& symbol);
+
         /**
          * \brief Checks if an external atom auxiliary is positive or negated.
          *
@@ -370,6 +425,14 @@ public boost::enable_shared_from_this<Registry>
         std::ostream& print(std::ostream& o);
         virtual std::ostream& print(std::ostream& o) const { return const_cast<Registry*>(this)->print(o); }
 
+        /**
+         * \brief Adds the approximate memory usage of each table to a report.
+         *
+         * Can be called while other threads use the registry.
+         * @param report Report to add one component per table to.
+         */
+        void getMemoryUsage(memory::Report& report) const;
+
         /**
          * \brief Lookup ground or nonground ordinary atoms.
          *
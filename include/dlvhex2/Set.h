@@ -484,6 +484,13 @@ class Set
             return rsize;
         }
 
+        /** \brief Retrieves the number of elements the internal array can hold.
+         * @return Capacity of the Set. */
+        inline int capacity() const
+        {
+            return allocSize;
+        }
+
         /** \brief Retrieves the internal data (array).
          * @return Pointer to the begin of the internal array. */
         T* getData() {
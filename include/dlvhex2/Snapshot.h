@@ -0,0 +1,96 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   Snapshot.h
+ *
+ * @brief  Binary snapshots of the registry and the parsed program for warm restarts.
+ */
+
+#ifndef SNAPSHOT_H__
+#define SNAPSHOT_H__
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/fwd.h"
+
+#include <boost/cstdint.hpp>
+#include <string>
+
+DLVHEX_NAMESPACE_BEGIN
+
+/**
+ * \brief Writes and reads binary snapshots of a ProgramCtx.
+ *
+ * A snapshot contains the tables of the Registry (terms, predicates, ordinary,
+ * builtin, aggregate and external atoms, rules), the auxiliary symbols, the EDB,
+ * the IDB and the maxint setting, i.e., the state after parsing and rewriting
+ * (cf. RewriteEDBIDBState). Loading a snapshot replaces conversion, parsing and
+ * rewriting; all later steps (safety checks, graphs, grounding, solving) run as usual.
+ *
+ * The file starts with a header containing a magic string, a byte order mark,
+ * the format version and the dlvhex version; a snapshot is only loaded by the
+ * same dlvhex version on the same platform. Snapshots are loaded by mapping the
+ * file into memory and rebuilding the tables in address order, so all IDs are
+ * identical to those of the run which saved the snapshot.
+ *
+ * Entries which are already in the registry when the snapshot is loaded (e.g.,
+ * auxiliaries registered by plugins at startup) must be identical to those in
+ * the snapshot, otherwise loading fails; thus a snapshot must be loaded with
+ * the same plugins and plugin options as were used for saving it.
+ * Module atoms (MLP) and plugin data stored in the ProgramCtx are not part of snapshots.
+ */
+class DLVHEX_EXPORT Snapshot
+{
+    public:
+        /** \brief Version of the snapshot file format. */
+        static const uint32_t FormatVersion = 2;
+
+        /**
+         * \brief Writes the registry, EDB and IDB of a ProgramCtx to a file.
+         *
+         * Throws a GeneralError if the file cannot be written or the program uses modules.
+         * @param ctx ProgramCtx to save.
+         * @param filename Name of the snapshot file.
+         */
+        static void save(const ProgramCtx& ctx, const std::string& filename);
+
+        /**
+         * \brief Restores the registry, EDB and IDB of a ProgramCtx from a file.
+         *
+         * Throws a GeneralError if the file cannot be read, is not a snapshot of this
+         * dlvhex version or does not match the current registry.
+         * @param ctx ProgramCtx to restore; must not contain a parsed program yet.
+         * @param filename Name of the snapshot file.
+         */
+        static void load(ProgramCtx& ctx, const std::string& filename);
+};
+
+DLVHEX_NAMESPACE_END
+#endif                           // SNAPSHOT_H__
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
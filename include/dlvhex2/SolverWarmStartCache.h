@@ -0,0 +1,175 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   SolverWarmStartCache.h
+ *
+ * @brief  Learned nogoods and decision phases of the internal solver which are kept across runs.
+ */
+
+#ifndef SOLVERWARMSTARTCACHE_H__
+#define SOLVERWARMSTARTCACHE_H__
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/fwd.h"
+#include "dlvhex2/ID.h"
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+/**
+ * \brief Stores learned nogoods and decision phases of solvers in a file such that later runs can start with them.
+ *
+ * Entries are keyed by a hash of the rules of a ground program (without its EDB),
+ * hence units whose ground program did not change between two runs find the
+ * entry of the earlier run, even if their input did. Atoms are identified by their
+ * textual representation because IDs are not stable across runs.
+ *
+ * Entries are only a hint: a solver which loads an entry must verify each nogood
+ * against its own instance before using it (see CDNLSolver::warmStart). Nogoods
+ * over input atoms are not stored since they typically do not carry over to
+ * the next run.
+ *
+ * The total number of stored nogoods is bounded; if an entry is stored and the
+ * bound is exceeded, the least recently used entries are dropped first (each entry
+ * counts at least as one nogood, such that the number of entries is bounded as well).
+ * All methods are thread-safe.
+ */
+class DLVHEX_EXPORT SolverWarmStartCache
+{
+    public:
+        /** \brief Version of the file format. */
+        static const uint32_t FormatVersion = 1;
+
+        /** \brief Key of an entry (hash of a ground program). */
+        typedef boost::uint64_t Key;
+
+        /** \brief Solver state for one ground program. */
+        struct Entry
+        {
+            /** \brief Textual representations of the atoms used in the entry. */
+            std::vector<std::string> atoms;
+            /** \brief Decision phase of each atom in atoms (0=none, 1=true, 2=false). */
+            std::vector<unsigned char> phases;
+            /** \brief Nogoods; literal i+1 denotes atoms[i] and -(i+1) its default negation. */
+            std::vector<std::vector<int> > nogoods;
+        };
+
+    private:
+        /** \brief Entry with its time of last use. */
+        struct StoredEntry
+        {
+            Entry entry;
+            /** \brief Value of clock when the entry was stored or looked up the last time. */
+            uint32_t lastUse;
+        };
+
+        /** \brief File the cache is loaded from and saved to. */
+        std::string filename;
+        /** \brief Maximum total number of nogoods. */
+        unsigned maxNogoods;
+        /** \brief Stored entries. */
+        std::map<Key, StoredEntry> entries;
+        /** \brief Logical time used for LRU eviction. */
+        uint32_t clock;
+        /** \brief Protects all members. */
+        boost::mutex mutex;
+
+        /** \brief Drops least recently used entries until the bound holds.
+         * @param keep Entry which is not dropped. */
+        void evict(Key keep);
+
+    public:
+        /**
+         * \brief Constructor.
+         *
+         * Does not access the file.
+         * @param filename File the cache is loaded from and saved to.
+         * @param maxNogoods Maximum total number of nogoods.
+         */
+        SolverWarmStartCache(const std::string& filename, unsigned maxNogoods);
+
+        /**
+         * \brief Loads the entries from the file.
+         *
+         * A missing file yields an empty cache; an unreadable or incompatible file is ignored with a warning.
+         */
+        void load();
+
+        /**
+         * \brief Writes all entries to the file.
+         *
+         * Throws a GeneralError if the file cannot be written.
+         */
+        void save();
+
+        /**
+         * \brief Retrieves an entry.
+         * @param key Key of the entry.
+         * @param entry Receives the entry if it exists.
+         * @return True if the entry exists and false otherwise.
+         */
+        bool lookup(Key key, Entry& entry);
+
+        /**
+         * \brief Adds or replaces an entry.
+         *
+         * Nogoods beyond the bound are dropped from the end of the entry, hence the most valuable ones should come first.
+         * @param key Key of the entry.
+         * @param entry The entry.
+         */
+        void store(Key key, const Entry& entry);
+
+        /**
+         * \brief Computes the key of a ground program.
+         *
+         * The key depends on the rules (IDB) only and not on their order.
+         * @param reg Registry.
+         * @param program Ground program.
+         * @return Key of \p program.
+         */
+        static Key computeKey(RegistryPtr reg, const OrdinaryASPProgram& program);
+
+        /**
+         * \brief Computes the textual representation of a ground atom which identifies it across runs.
+         * @param reg Registry.
+         * @param atom Address of an ordinary ground atom.
+         * @return String representation of \p atom.
+         */
+        static std::string atomText(RegistryPtr reg, IDAddress atom);
+};
+
+DLVHEX_NAMESPACE_END
+#endif                           // SOLVERWARMSTARTCACHE_H__
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
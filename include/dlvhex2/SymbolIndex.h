@@ -0,0 +1,189 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   SymbolIndex.h
+ *
+ * @brief  Hash index for interning symbols with cached hash values.
+ */
+
+#ifndef SYMBOLINDEX_HPP_INCLUDED__17102026
+#define SYMBOLINDEX_HPP_INCLUDED__17102026
+
+#include "dlvhex2/PlatformDefinitions.h"
+#include "dlvhex2/ID.h"
+
+#include <boost/utility/string_ref.hpp>
+
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace impl
+{
+
+    /**
+     * \brief Hash function for symbols.
+     *
+     * Accepts everything which converts to boost::string_ref, hence std::string keys
+     * and boost::string_ref keys of the same symbol have the same hash value.
+     */
+    struct SymbolHash
+    {
+        inline std::size_t operator()(boost::string_ref str) const
+        {
+            // FNV-1a followed by the MurmurHash3 finalizer (spreads the bits used for bucket selection)
+            uint32_t h = 2166136261u;
+            for(boost::string_ref::const_iterator it = str.begin(); it != str.end(); ++it) {
+                h ^= static_cast<unsigned char>(*it);
+                h *= 16777619u;
+            }
+            h ^= h >> 16;
+            h *= 0x85ebca6bu;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35u;
+            h ^= h >> 16;
+            return h;
+        }
+    };
+
+    /**
+     * \brief Open addressing hash index from symbols to table addresses.
+     *
+     * The index stores only the cached hash value and the address of each symbol,
+     * the symbol itself stays in the table and is retrieved by a resolver functor
+     * (address to boost::string_ref) when hash values match.
+     * Therefore lookups do not allocate and growing the index never rehashes any symbol.
+     * Synchronization is left to the table.
+     */
+    class SymbolIndex
+    {
+        private:
+            /** \brief Slot of the index; empty slots have address ID_FAIL.address. */
+            struct Slot
+            {
+                uint32_t hash;
+                IDAddress address;
+                Slot(): hash(0), address(ID_FAIL.address) {}
+                Slot(uint32_t hash, IDAddress address): hash(hash), address(address) {}
+            };
+            /** \brief Slots, the number of slots is a power of two. */
+            std::vector<Slot> slots;
+            /** \brief Number of used slots. */
+            uint32_t count;
+
+            /** \brief Doubles the number of slots and reinserts all entries using their cached hash values. */
+            void grow()
+            {
+                std::vector<Slot> old(slots.empty() ? 16 : 2 * slots.size());
+                old.swap(slots);
+                const std::size_t mask = slots.size() - 1;
+                for(std::vector<Slot>::const_iterator it = old.begin(); it != old.end(); ++it) {
+                    if( it->address == ID_FAIL.address )
+                        continue;
+                    std::size_t pos = it->hash & mask;
+                    while( slots[pos].address != ID_FAIL.address )
+                        pos = (pos + 1) & mask;
+                    slots[pos] = *it;
+                }
+            }
+
+        public:
+            /** \brief Constructor. */
+            SymbolIndex(): count(0) {}
+
+            /** \brief Computes the hash value of a symbol as it is cached by the index.
+             * @param str Symbol.
+             * @return Hash value. */
+            static inline uint32_t hash(boost::string_ref str)
+            {
+                return static_cast<uint32_t>(SymbolHash()(str));
+            }
+
+            /** \brief Looks up a symbol.
+             * @param str Symbol to look up.
+             * @param h Hash value of \p str as computed by SymbolIndex::hash.
+             * @param symbolOf Functor which maps an address stored in the index to its symbol (as boost::string_ref).
+             * @return Address of \p str or ID_FAIL.address if \p str is not indexed. */
+            template<typename Resolver>
+            inline IDAddress find(boost::string_ref str, uint32_t h, const Resolver& symbolOf) const
+            {
+                if( slots.empty() )
+                    return ID_FAIL.address;
+                const std::size_t mask = slots.size() - 1;
+                for(std::size_t pos = h & mask; slots[pos].address != ID_FAIL.address; pos = (pos + 1) & mask) {
+                    if( slots[pos].hash == h && symbolOf(slots[pos].address) == str )
+                        return slots[pos].address;
+                }
+                return ID_FAIL.address;
+            }
+
+            /** \brief Adds a symbol which must not yet be indexed.
+             * @param h Hash value of the symbol as computed by SymbolIndex::hash.
+             * @param address Address of the symbol in the table. */
+            inline void insert(uint32_t h, IDAddress address)
+            {
+                // keep the load factor below 3/4
+                if( 4 * (static_cast<std::size_t>(count) + 1) > 3 * slots.size() )
+                    grow();
+                const std::size_t mask = slots.size() - 1;
+                std::size_t pos = h & mask;
+                while( slots[pos].address != ID_FAIL.address )
+                    pos = (pos + 1) & mask;
+                slots[pos] = Slot(h, address);
+                count++;
+            }
+
+            /** \brief Removes all entries. */
+            void clear()
+            {
+                std::vector<Slot>().swap(slots);
+                count = 0;
+            }
+
+            /** \brief Number of indexed symbols.
+             * @return Size. */
+            inline uint32_t size() const
+            {
+                return count;
+            }
+
+            /** \brief Heap memory used by the index.
+             * @return Number of bytes. */
+            inline std::size_t memoryUsage() const
+            {
+                return slots.capacity() * sizeof(Slot);
+            }
+    };
+
+}                                // namespace impl
+
+DLVHEX_NAMESPACE_END
+#endif                           // SYMBOLINDEX_HPP_INCLUDED__17102026
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -37,9 +37,11 @@
 #include "dlvhex2/PlatformDefinitions.h"
 #include "dlvhex2/ID.h"
 #include "dlvhex2/Logger.h"
+#include "dlvhex2/ConcurrentTable.h"
 
 #include <boost/multi_index_container.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/mpl/size.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
 
@@ -98,10 +100,17 @@ public ostream_printable< Table<ValueT,IndexT> >
         /** \brief Internal container. */
         Container container;
 
+        /** \brief True if the table additionally maintains the concurrent indices (see ConcurrentTable.h).
+         *
+         * Only derived tables which implement setConcurrentStorage use this. */
+        bool concurrent;
+        /** \brief Lock-free address index (only maintained if Table::concurrent is true). */
+        impl::AppendOnlyAddressVector<ValueT> concurrentAddresses;
+
         // methods
     public:
         /** \brief Constructor. */
-        Table() {}
+        Table(): concurrent(false) {}
         // no virtual functions allowed, no virtual destructor
         // -> never store this in a ref to baseclass, destruction will not work!
         //
@@ -120,24 +129,46 @@ public ostream_printable< Table<ValueT,IndexT> >
         /** \brief Copy-constructor.
          * @param other Other table. */
         Table(const Table& other):
-        container(other.container) {
+        container(other.container), concurrent(false) {
+            // derived tables rebuild their concurrent indices if required
         }
 
         /** \brief Assignment operator.
          * @param other Other table.
          * @return This table. */
         Table& operator=(const Table& other) {
+            // concurrent indices refer to the old container
+            assert(!concurrent && "assignment is not supported in concurrent storage mode");
             WriteLock lock(mutex);
             container = other.container;
+            return *this;
         }
 
         /** \brief Retrieves the size of the table.
          * @return Table size. */
         inline unsigned getSize() const
         {
+            if( concurrent )
+                return concurrentAddresses.size();
             ReadLock lock(mutex);
             return container.size();
         }
+
+        /** \brief Approximates the heap memory used by the table.
+         *
+         * Counts each value, its heap memory as computed by \p dynamicSize,
+         * and a fixed overhead per value and index.
+         * @param dynamicSize Functor which returns the heap memory owned by a value (cf. memory::DynamicSize).
+         * @return Number of bytes. */
+        template<typename DynamicSize>
+        std::size_t getMemoryUsage(DynamicSize dynamicSize) const;
+
+        /** \brief Checks if the table is in concurrent storage mode.
+         * @return True if concurrent indices are maintained. */
+        inline bool isConcurrentStorage() const
+        {
+            return concurrent;
+        }
 };
 
 template<typename ValueT, typename IndexT>
@@ -160,6 +191,28 @@ std::ostream& Table<ValueT,IndexT>::print(std::ostream& o) const
 }
 
 
+template<typename ValueT, typename IndexT>
+template<typename DynamicSize>
+std::size_t Table<ValueT,IndexT>::getMemoryUsage(DynamicSize dynamicSize) const
+{
+    typedef typename Container::template index<impl::AddressTag>::type AddressIndex;
+    // each index costs about two pointers per value (links, buckets or the random access array)
+    const std::size_t perValue = sizeof(ValueT) + 2 * sizeof(void*) * boost::mpl::size<IndexT>::value +
+        2 * sizeof(void*);
+
+    ReadLock lock(mutex);
+    const AddressIndex& aidx = container.template get<impl::AddressTag>();
+    std::size_t bytes = perValue * aidx.size();
+    for(typename AddressIndex::const_iterator it = aidx.begin(); it != aidx.end(); ++it)
+        bytes += dynamicSize(*it);
+    if( concurrent ) {
+        // address vector and sharded indices
+        bytes += 4 * sizeof(void*) * aidx.size();
+    }
+    return bytes;
+}
+
+
 DLVHEX_NAMESPACE_END
 #endif                           // TABLE_HPP_INCLUDED__12102010
 
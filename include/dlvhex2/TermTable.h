@@ -39,14 +39,18 @@
 #include "dlvhex2/ID.h"
 #include "dlvhex2/Term.h"
 #include "dlvhex2/Table.h"
+#include "dlvhex2/SymbolIndex.h"
 
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/random_access_index.hpp>
+#include <boost/utility/string_ref.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
 
-/** \brief Lookup tables for terms. */
+/** \brief Lookup tables for terms.
+ *
+ * Symbols are interned using an impl::SymbolIndex which caches the hash value of each symbol,
+ * hence lookups by boost::string_ref do not allocate and growing the index never rehashes symbols.
+ */
 class TermTable:
 public Table<
 // value type is symbol struct
@@ -56,11 +60,6 @@ boost::multi_index::indexed_by<
 // address = running ID for constant access
 boost::multi_index::random_access<
 boost::multi_index::tag<impl::AddressTag>
->,
-// unique IDs for unique symbol strings
-boost::multi_index::hashed_unique<
-boost::multi_index::tag<impl::TermTag>,
-BOOST_MULTI_INDEX_MEMBER(Term,std::string,symbol)
 >
 >
 >
@@ -68,10 +67,44 @@ BOOST_MULTI_INDEX_MEMBER(Term,std::string,symbol)
     // types
     public:
         typedef Container::index<impl::AddressTag>::type AddressIndex;
-        typedef Container::index<impl::TermTag>::type TermIndex;
+
+    protected:
+        /** \brief Key extractor for the symbol of a term. */
+        struct SymbolKey
+        {
+            typedef boost::string_ref result_type;
+            inline result_type operator()(const Term& term) const { return term.symbol; }
+        };
+        /** \brief Resolves addresses of the symbol index (requires the table lock). */
+        struct SymbolOfAddress
+        {
+            const AddressIndex& idx;
+            SymbolOfAddress(const AddressIndex& idx): idx(idx) {}
+            inline boost::string_ref operator()(IDAddress addr) const { return idx[addr].symbol; }
+        };
+
+        /** \brief Unique index for symbols (unique IDs for unique symbol strings). */
+        impl::SymbolIndex symbolIndex;
+        /** \brief Sharded symbol index (only maintained in concurrent storage mode). */
+        impl::ShardedHashIndex<Term, SymbolKey, 6, impl::SymbolHash> concurrentSymbolIndex;
 
         // methods
     public:
+        /** \brief Constructor. */
+        TermTable() {}
+
+        /** \brief Copy-constructor; the copy uses the same storage mode as \p other.
+         * @param other Other table. */
+        TermTable(const TermTable& other):
+        Table(other), symbolIndex(other.symbolIndex) {
+            if( other.concurrent ) setConcurrentStorage(true);
+        }
+
+        /** \brief Switches the concurrent storage mode on or off.
+         *
+         * See OrdinaryAtomTable::setConcurrentStorage.
+         * @param enable True to enable and false to disable the concurrent storage mode. */
+        inline void setConcurrentStorage(bool enable);
         /** \brief Retrieve by ID.
          *
          * Assert that id.kind is correct for Term.
@@ -81,11 +114,21 @@ BOOST_MULTI_INDEX_MEMBER(Term,std::string,symbol)
          */
         inline const Term& getByID(ID id) const throw ();
 
+        /** \brief Retrieve the symbol of a term by ID.
+         *
+         * The symbol remains valid for the lifetime of the table.
+         * @param id Term ID (no integer).
+         * @return Symbol of the term corresponding to \p id.
+         */
+        inline boost::string_ref getStringByID(ID id) const throw ()
+            { return getByID(id).symbol; }
+
         /** \brief Given string, look if already stored.
          *
+         * Accepts std::string as well as boost::string_ref and does not allocate memory.
          * @param str Term string to lookup.
          * @return ID_FAIL if term is not stored, otherwise return term ID. */
-        inline ID getIDByString(const std::string& str) const throw();
+        inline ID getIDByString(boost::string_ref str) const throw();
 
         /** \brief Store term in the table.
          * Store symbol, assuming it does not exist.
@@ -95,9 +138,34 @@ BOOST_MULTI_INDEX_MEMBER(Term,std::string,symbol)
          * @return ID of the stored term. */
         inline ID storeAndGetID(const Term& symb) throw();
 
+        /** \brief Heap memory used by the symbol index.
+         * @return Number of bytes. */
+        inline std::size_t getIndexMemoryUsage() const
+        {
+            ReadLock lock(mutex);
+            return symbolIndex.memoryUsage();
+        }
+
         // retrieve range by kind (return lower/upper bound iterators, +provide method to get ID from iterator)
 };
 
+void TermTable::setConcurrentStorage(bool enable)
+{
+    WriteLock lock(mutex);
+    if( enable == concurrent )
+        return;
+    concurrentAddresses.clear();
+    concurrentSymbolIndex.clear();
+    if( enable ) {
+        const AddressIndex& idx = container.get<impl::AddressTag>();
+        for(AddressIndex::const_iterator it = idx.begin(); it != idx.end(); ++it) {
+            concurrentSymbolIndex.insert(&*it, concurrentAddresses.push_back(&*it));
+        }
+    }
+    concurrent = enable;
+}
+
+
 // retrieve by ID
 // assert that id.kind is correct for Term
 // assert that ID exists
@@ -108,6 +176,8 @@ ID id) const throw ()
     assert(id.isTerm());
     // integers are not allowed in this table!
     assert(id.isConstantTerm() || id.isVariableTerm() || id.isNestedTerm());
+    if( concurrent )
+        return *concurrentAddresses.at(id.address);
     ReadLock lock(mutex);
     const AddressIndex& idx = container.get<impl::AddressTag>();
     // the following check only works for random access indices, but here it is ok
@@ -119,22 +189,21 @@ ID id) const throw ()
 // given string, look if already stored
 // if no, return ID_FAIL, otherwise return ID
 ID TermTable::getIDByString(
-const std::string& str) const throw()
+boost::string_ref str) const throw()
 {
-    typedef Container::index<impl::TermTag>::type TermIndex;
+    if( concurrent ) {
+        const Term* term;
+        const IDAddress addr = concurrentSymbolIndex.find(str, term);
+        return (addr == ID_FAIL.address) ? ID_FAIL : ID(term->kind, addr);
+    }
+    const uint32_t h = impl::SymbolIndex::hash(str);
     ReadLock lock(mutex);
-    const TermIndex& sidx = container.get<impl::TermTag>();
-    TermIndex::const_iterator it = sidx.find(str);
-    if( it == sidx.end() )
+    const AddressIndex& idx = container.get<impl::AddressTag>();
+    const IDAddress addr = symbolIndex.find(str, h, SymbolOfAddress(idx));
+    if( addr == ID_FAIL.address )
         return ID_FAIL;
-    else {
-        const AddressIndex& aidx = container.get<impl::AddressTag>();
-        return ID(
-            it->kind,            // kind
-                                 // address
-            container.project<impl::AddressTag>(it) - aidx.begin()
-            );
-    }
+    else
+        return ID(idx[addr].kind, addr);
 }
 
 
@@ -173,18 +242,23 @@ const Term& symb) throw()
 
     bool success;
     AddressIndex::const_iterator it;
+    const uint32_t h = impl::SymbolIndex::hash(symb.symbol);
 
     WriteLock lock(mutex);
     AddressIndex& idx = container.get<impl::AddressTag>();
+    assert(symbolIndex.find(symb.symbol, h, SymbolOfAddress(idx)) == ID_FAIL.address);
     boost::tie(it, success) = idx.push_back(symb);
     (void)success;
     assert(success);
+    const IDAddress addr = it - idx.begin();
+    symbolIndex.insert(h, addr);
 
-    return ID(
-        symb.kind,               // kind
-                                 // address
-        container.project<impl::AddressTag>(it) - idx.begin()
-        );
+    if( concurrent ) {
+        concurrentAddresses.push_back(&*it);
+        concurrentSymbolIndex.insert(&*it, addr);
+    }
+
+    return ID(symb.kind, addr);
 }
 
 
@@ -124,6 +124,9 @@ typedef boost::shared_ptr<PluginRewriter> PluginRewriterPtr;
 class PredicateMask;
 typedef boost::shared_ptr<PredicateMask> PredicateMaskPtr;
 
+class PersistentAnswerCache;
+typedef boost::shared_ptr<PersistentAnswerCache> PersistentAnswerCachePtr;
+
 class ProgramCtx;
 
 struct Registry;
@@ -131,6 +134,9 @@ typedef boost::shared_ptr<Registry> RegistryPtr;
 
 struct Rule;
 
+class SolverWarmStartCache;
+typedef boost::shared_ptr<SolverWarmStartCache> SolverWarmStartCachePtr;
+
 class State;
 typedef boost::shared_ptr<State> StatePtr;
 
@@ -227,7 +227,7 @@ namespace ASPSolver
                     if( fid == ID_FAIL ) {
                         OrdinaryAtom a(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
                         a.tuple.swap(ptuple);
-                        {
+                        if( !pimpl->reg->hasLazyAtomText() ) {
                             WARNING("parsing efficiency problem see HexGrammarPTToASTConverter")
                                 std::stringstream ss;
                             RawPrinter printer(ss, pimpl->reg);
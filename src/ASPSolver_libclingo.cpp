@@ -189,7 +189,8 @@ namespace ASPSolver
                             const char* groundatom = it->second.name.c_str();
 
                             // try to do it via string (unstructured)
-                            ID idga = registry->ogatoms.getIDByString(groundatom);
+                            // (in lazy text mode atoms are looked up by tuple after parsing)
+                            ID idga = registry->hasLazyAtomText() ? ID_FAIL : registry->ogatoms.getIDByString(groundatom);
                             if( idga == ID_FAIL ) {
                                 // parse groundatom, register and store
                                 DBGLOG(DBG,"parsing clingo ground atom '" << groundatom << "'");
@@ -213,7 +214,11 @@ namespace ASPSolver
                                         ogatom.tuple.push_back(id);
                                     }
                                 }
-                                idga = registry->ogatoms.storeAndGetID(ogatom);
+                                idga = registry->ogatoms.getIDByTuple(ogatom.tuple);
+                                if( idga == ID_FAIL ) {
+                                    if( registry->hasLazyAtomText() ) ogatom.text.clear();
+                                    idga = registry->ogatoms.storeAndGetID(ogatom);
+                                }
                             }
                             assert(idga != ID_FAIL);
                             as->interpretation->setFact(idga.address);
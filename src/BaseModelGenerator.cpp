@@ -481,8 +481,9 @@ bool* fromCache) const
     InterpretationConstPtr eatomchanged;
     if (changed) eatomchanged = projectEAtomInputInterpretation(ctx.registry(), eatom, changed);
 
-    InterpretationPtr pim = InterpretationPtr(new Interpretation(ctx.registry()));
-    pim->add(*eatom.getPredicateInputMask());
+    // shares the bitset with the mask
+    InterpretationPtr pim = InterpretationPtr(new Interpretation(*eatom.getPredicateInputMask()));
+    pim->setRegistry(ctx.registry());
     if( eatom.auxInputPredicate == ID_FAIL ) {
         // only one input tuple, and that is the one stored in eatom.inputs
 
@@ -756,12 +757,11 @@ const ExternalAtom& eatom, InterpretationConstPtr full) const
     // we do this in general for the eatom
     //eatom.updatePredicateInputMask();
 
-    InterpretationPtr ret;
-    if( full == 0 )
-        ret.reset(new Interpretation(reg));
-    else
-        ret.reset(new Interpretation(*full));
-    ret->getStorage() &= eatom.getPredicateInputMask()->getStorage();
+    InterpretationPtr ret(new Interpretation(reg));
+    if( full != 0 ) {
+        // start from the mask, which usually has far fewer blocks than the full interpretation
+        full->getMaskedView(*eatom.getPredicateInputMask()).materialize(*ret);
+    }
     return ret;
 }
 
@@ -783,9 +783,8 @@ InterpretationPtr inputs) const
     assert(eatom.auxInputPredicate != ID_FAIL);
 
     // otherwise find all aux input predicates that are true and extract their tuples
-    Interpretation relevant(reg);
-    relevant.getStorage() |= interpretation->getStorage() & eatom.getAuxInputMask()->getStorage();
-    Interpretation::TrueBitIterator it, it_end;
+    InterpretationMaskView relevant = interpretation->getMaskedView(*eatom.getAuxInputMask());
+    InterpretationMaskView::TrueBitIterator it, it_end;
     boost::tie(it, it_end) = relevant.trueBits();
     {
         for(;it != it_end; ++it) {
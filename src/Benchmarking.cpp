@@ -220,7 +220,7 @@ namespace benchmark
 
         // init, display start of benchmarking
         NestingAwareController::NestingAwareController():
-        myID(0), maxID(0), instrumentations(), name2id(), current(),
+        myID(0), maxID(0), instrumentations(), name2id(), currentStacks(),
                                  // print continuously all 10 seconds
         printInterval(boost::posix_time::seconds(10.0)), output(&(std::cerr)) {
             myID = getInstrumentationID("BenchmarkController lifetime");
@@ -236,6 +236,7 @@ namespace benchmark
             // (do not call stop() as the mutex might hang)
             // (this code must succeed at any time!)
             Stat& st = instrumentations[myID];
+            std::vector<Current>& current = currentStack();
             Time now = boost::posix_time::microsec_clock::local_time();
             if( !current.empty() && current.back().which == myID ) {
                 // this is a very clean exit indeed!
@@ -394,6 +395,7 @@ namespace benchmark
 
         // stop and do not record, handle non-started id's gracefully
         void NestingAwareController::invalidate(ID id) {
+            std::vector<Current>& current = currentStack();
             if( !current.empty() && current.back().which == id ) {
                 // save start time of pure period (we do not want to lose this)
                 Time start = current.back().start;
@@ -412,6 +414,7 @@ namespace benchmark
             boost::mutex::scoped_lock lock(mutex);
             Stat& st = instrumentations[id];
             Stat& intost = instrumentations[intoID];
+            std::vector<Current>& current = currentStack();
 
             // copy (overwrites old snapshot!)
 
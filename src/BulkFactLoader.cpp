@@ -0,0 +1,708 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   BulkFactLoader.cpp
+ *
+ * @brief  Loads ground facts and CSV files directly into the registry and the EDB.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/BulkFactLoader.h"
+#include "dlvhex2/ProgramCtx.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Interpretation.h"
+#include "dlvhex2/Error.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Benchmarking.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace
+{
+    // character classes of HexGrammar (ascii::space, ascii::lower, ascii::alnum)
+    inline bool isSpace(char c)
+        { return c == ' ' || (c >= '\t' && c <= '\r'); }
+    inline bool isLower(char c)
+        { return c >= 'a' && c <= 'z'; }
+    inline bool isDigit(char c)
+        { return c >= '0' && c <= '9'; }
+    inline bool isIdentChar(char c)
+        { return isLower(c) || (c >= 'A' && c <= 'Z') || isDigit(c) || c == '_'; }
+
+    // skips whitespace and %-comments (cf. HexParserSkipper)
+    // (comment is set to the begin of a comment which reaches end)
+    const char* skip(const char* pos, const char* end, const char*& comment)
+    {
+        comment = 0;
+        while( pos != end ) {
+            if( isSpace(*pos) ) {
+                ++pos;
+            }
+            else if( *pos == '%' ) {
+                comment = pos;
+                while( pos != end && *pos != '\n' && *pos != '\r' )
+                    ++pos;
+                if( pos != end )
+                    comment = 0;
+            }
+            else {
+                break;
+            }
+        }
+        return pos;
+    }
+
+    inline const char* skip(const char* pos, const char* end)
+    {
+        const char* comment;
+        return skip(pos, end, comment);
+    }
+
+    // scans a quoted string starting at pos (cf. HexGrammarBase::string)
+    // returns false if this is not a valid string or if the string reaches end (incomplete is set in the latter case)
+    bool scanString(const char*& pos, const char* end, bool& incomplete)
+    {
+        assert(pos != end && *pos == '"');
+        incomplete = false;
+        ++pos;
+        while( pos != end ) {
+            if( *pos == '\\' && pos + 1 != end && (pos[1] == '"' || pos[1] == '\\') ) {
+                pos += 2;
+            }
+            else if( *pos == '"' ) {
+                ++pos;
+                return true;
+            }
+            else if( *pos == '\n' || *pos == '\r' ) {
+                return false;
+            }
+            else {
+                ++pos;
+            }
+        }
+        incomplete = true;
+        return false;
+    }
+
+    // scans digits into value, returns false on overflow
+    bool scanInteger(const char*& pos, const char* end, uint32_t& value)
+    {
+        uint64_t v = 0;
+        while( pos != end && isDigit(*pos) ) {
+            v = v * 10 + (*pos - '0');
+            if( v > std::numeric_limits<uint32_t>::max() )
+                return false;
+            ++pos;
+        }
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
+
+    // checks if the content of a CSV field becomes a valid string when it is put into quotes
+    bool isValidQuotedContent(const char* pos, const char* end)
+    {
+        while( pos != end ) {
+            if( *pos == '\\' && pos + 1 == end )
+                return false;    // would escape the closing quote
+            if( *pos == '\\' && (pos[1] == '"' || pos[1] == '\\') )
+                pos += 2;
+            else if( *pos == '"' || *pos == '\n' || *pos == '\r' )
+                return false;
+            else
+                ++pos;
+        }
+        return true;
+    }
+
+    void appendInteger(std::string& str, uint32_t value)
+    {
+        char buf[16];
+        char* p = buf + sizeof(buf);
+        do {
+            *--p = '0' + value % 10;
+            value /= 10;
+        } while( value != 0 );
+        str.append(p, buf + sizeof(buf));
+    }
+}
+
+
+BulkFactLoader::BulkFactLoader(ProgramCtx& ctx, unsigned batchSize):
+ctx(ctx),
+reg(ctx.registry()),
+batchSize(batchSize),
+threads(1),
+factCount(0),
+lazyText(ctx.registry()->hasLazyAtomText()),
+atom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG),
+lastPredicateID(ID_FAIL)
+{
+    assert(!!reg);
+    assert(!!ctx.edb);
+    assert(batchSize > 0);
+    setThreads(ctx.config.getOption("ParserThreads"));
+    factBegins.push_back(0);
+}
+
+
+ID BulkFactLoader::getTerm(const Token& token)
+{
+    if( token.type == Integer ) {
+        // by default, set maxint to the largest number in the input (cf. HexGrammarSemantics::termFromInteger)
+        if( token.value > ctx.maxint )
+            ctx.maxint = token.value;
+        if( !lazyText )
+            appendInteger(atom.text, token.value);
+        return ID::termFromInteger(token.value);
+    }
+
+    if( !lazyText ) {
+        if( token.type == Symbol ) {
+            atom.text.append(token.begin, token.length);
+        }
+        else {
+            atom.text.push_back('"');
+            atom.text.append(token.begin, token.length);
+            atom.text.push_back('"');
+        }
+    }
+    return internSymbol(token);
+}
+
+
+ID BulkFactLoader::internSymbol(const Token& token)
+{
+    assert(token.type != Integer);
+    boost::string_ref key;
+    if( token.type == Symbol ) {
+        // the token is the symbol, look it up without copying
+        key = boost::string_ref(token.begin, token.length);
+    }
+    else {
+        symbol.assign(1, '"');
+        symbol.append(token.begin, token.length);
+        symbol.push_back('"');
+        key = symbol;
+    }
+
+    ID id = reg->terms.getIDByString(key);
+    if( id == ID_FAIL ) {
+        Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, std::string(key.begin(), key.end()));
+        id = reg->terms.storeAndGetID(term);
+    }
+    return id;
+}
+
+
+void BulkFactLoader::commit()
+{
+    const std::size_t facts = factBegins.size() - 1;
+    if( facts == 0 )
+        return;
+    DBGLOG(DBG,"storing batch of " << facts << " facts");
+
+    for(std::size_t f = 0; f < facts; ++f) {
+        const uint32_t first = factBegins[f];
+        const uint32_t last = factBegins[f+1];
+        assert(first < last);
+        atom.tuple.clear();
+        atom.text.clear();
+
+        // predicate (cached, terms are stored in the same order as by the parser)
+        const Token& pred = tokens[first];
+        if( lastPredicateID != ID_FAIL && pred.type == Symbol &&
+            pred.length == lastPredicate.size() &&
+        std::memcmp(pred.begin, lastPredicate.data(), pred.length) == 0 ) {
+            atom.tuple.push_back(lastPredicateID);
+            if( !lazyText )
+                atom.text.append(lastPredicate);
+        }
+        else {
+            atom.tuple.push_back(getTerm(pred));
+            if( pred.type == Symbol ) {
+                lastPredicate.assign(pred.begin, pred.length);
+                lastPredicateID = atom.tuple.back();
+            }
+        }
+
+        // arguments
+        for(uint32_t t = first + 1; t < last; ++t) {
+            if( !lazyText )
+                atom.text.push_back(t == first + 1 ? '(' : ',');
+            atom.tuple.push_back(getTerm(tokens[t]));
+        }
+        if( !lazyText && last > first + 1 )
+            atom.text.push_back(')');
+
+        // same result as Registry::storeOrdinaryGAtom, but with the text we already have
+        ID id = reg->ogatoms.getIDByTuple(atom.tuple);
+        if( id == ID_FAIL )
+            id = reg->ogatoms.storeAndGetID(atom);
+        ctx.edb->setFact(id.address);
+    }
+
+    factCount += facts;
+    tokens.clear();
+    factBegins.resize(1);
+}
+
+
+void BulkFactLoader::endFact()
+{
+    factBegins.push_back(tokens.size());
+    if( factBegins.size() > batchSize )
+        commit();
+}
+
+
+BulkFactLoader::ScanResult BulkFactLoader::scanStatement(const char*& pos, const char* end, std::vector<Token>& tokens)
+{
+    // predicate
+    if( !isLower(*pos) )
+        return NonFact;
+    const char* ident = pos;
+    while( pos != end && isIdentChar(*pos) )
+        ++pos;
+    if( pos == end )
+        return Incomplete;
+    tokens.push_back(Token(Symbol, ident, pos - ident));
+    pos = skip(pos, end);
+    if( pos == end )
+        return Incomplete;
+
+    // optional arguments
+    if( *pos == '(' ) {
+        pos = skip(pos + 1, end);
+        if( pos == end )
+            return Incomplete;
+        if( *pos == ')' ) {
+            ++pos;
+        }
+        else {
+            while( true ) {
+                const char* term = pos;
+                if( isLower(*pos) ) {
+                    while( pos != end && isIdentChar(*pos) )
+                        ++pos;
+                    if( pos == end )
+                        return Incomplete;
+                    tokens.push_back(Token(Symbol, term, pos - term));
+                }
+                else if( *pos == '"' ) {
+                    bool incomplete;
+                    if( !scanString(pos, end, incomplete) )
+                        return incomplete ? Incomplete : NonFact;
+                    tokens.push_back(Token(Symbol, term, pos - term));
+                }
+                else if( isDigit(*pos) ) {
+                    uint32_t value;
+                    if( !scanInteger(pos, end, value) )
+                        return NonFact;
+                    if( pos == end )
+                        return Incomplete;
+                    tokens.push_back(Token(Integer, term, pos - term, value));
+                }
+                else {
+                    // variables, function terms, ...
+                    return NonFact;
+                }
+
+                pos = skip(pos, end);
+                if( pos == end )
+                    return Incomplete;
+                if( *pos == ')' ) {
+                    ++pos;
+                    break;
+                }
+                if( *pos != ',' )
+                    return NonFact;
+                pos = skip(pos + 1, end);
+                if( pos == end )
+                    return Incomplete;
+            }
+        }
+        pos = skip(pos, end);
+        if( pos == end )
+            return Incomplete;
+    }
+
+    if( *pos != '.' )
+        return NonFact;
+    ++pos;
+    return Fact;
+}
+
+
+const char* BulkFactLoader::load(const char* begin, const char* end, bool final, bool& nonFact)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"BulkFactLoader::loadFacts");
+
+    nonFact = false;
+    const char* comment;
+    const char* pos = skip(begin, end, comment);
+    while( pos != end ) {
+        const char* statement = pos;
+        const ScanResult result = scanStatement(pos, end, tokens);
+        if( result != Fact ) {
+            // leave this statement and everything after it to the next piece or to the parser
+            tokens.erase(tokens.begin() + factBegins.back(), tokens.end());
+            commit();
+            nonFact = (result == NonFact || final);
+            DBGLOG(DBG,"loaded " << factCount << " facts before " <<
+                (nonFact ? "non-fact" : "incomplete") << " statement");
+            return statement;
+        }
+        endFact();
+        pos = skip(pos, end, comment);
+    }
+
+    commit();
+    DBGLOG(DBG,"loaded " << factCount << " facts");
+    // a comment at the end of a piece might continue in the next piece
+    return (!final && comment != 0) ? comment : end;
+}
+
+
+const char* BulkFactLoader::loadFacts(const char* begin, const char* end)
+{
+    bool nonFact;
+    if( threads > 1 && static_cast<std::size_t>(end - begin) >= 2 * MinimumChunkSize )
+        return loadParallel(begin, end, true, nonFact);
+    return load(begin, end, true, nonFact);
+}
+
+
+const char* BulkFactLoader::loadFactsPartial(const char* begin, const char* end, bool& nonFact)
+{
+    if( threads > 1 && static_cast<std::size_t>(end - begin) >= 2 * MinimumChunkSize )
+        return loadParallel(begin, end, false, nonFact);
+    return load(begin, end, false, nonFact);
+}
+
+
+struct BulkFactLoader::Chunk
+{
+    /** \brief Marks integer tokens in termIndices. */
+    static const uint32_t NoTerm = 0xFFFFFFFF;
+
+    // input
+    const char* begin;
+    const char* end;
+    bool lazyText;
+
+    // position where scanning stopped (end if the chunk consists of complete facts)
+    const char* rest;
+    // facts (cf. BulkFactLoader::tokens and BulkFactLoader::factBegins)
+    std::vector<Token> tokens;
+    std::vector<uint32_t> factBegins;
+    // index into terms for each token (NoTerm for integers)
+    std::vector<uint32_t> termIndices;
+    // first token of each distinct constant in order of first occurrence
+    std::vector<uint32_t> terms;
+    // atom text of each fact (unless lazyText)
+    std::vector<std::string> texts;
+    // largest integer in the chunk
+    uint32_t maxint;
+    // error message of an exception in the scanning thread
+    std::string error;
+
+    Chunk(const char* begin, const char* end, bool lazyText):
+        begin(begin), end(end), lazyText(lazyText), rest(begin), maxint(0) {}
+};
+
+const uint32_t BulkFactLoader::Chunk::NoTerm;
+
+namespace
+{
+    // key for the term dictionary of a chunk (refers to the input buffer)
+    struct SymbolKey
+    {
+        const char* begin;
+        uint32_t length;
+        SymbolKey(const char* begin, uint32_t length): begin(begin), length(length) {}
+        bool operator==(const SymbolKey& other) const
+            { return length == other.length && std::memcmp(begin, other.begin, length) == 0; }
+    };
+
+    struct SymbolKeyHash
+    {
+        std::size_t operator()(const SymbolKey& key) const
+            { return boost::hash_range(key.begin, key.begin + key.length); }
+    };
+}
+
+
+void BulkFactLoader::scanChunk(Chunk& chunk)
+{
+    try
+    {
+        // facts
+        const char* comment;
+        const char* pos = skip(chunk.begin, chunk.end, comment);
+        chunk.factBegins.push_back(0);
+        while( pos != chunk.end ) {
+            const char* statement = pos;
+            if( scanStatement(pos, chunk.end, chunk.tokens) != Fact ) {
+                chunk.tokens.erase(chunk.tokens.begin() + chunk.factBegins.back(), chunk.tokens.end());
+                chunk.rest = statement;
+                break;
+            }
+            chunk.factBegins.push_back(chunk.tokens.size());
+            pos = skip(pos, chunk.end, comment);
+        }
+        if( pos == chunk.end )
+            chunk.rest = (comment != 0) ? comment : chunk.end;
+
+        // term dictionary
+        typedef boost::unordered_map<SymbolKey, uint32_t, SymbolKeyHash> Dictionary;
+        Dictionary dictionary;
+        chunk.termIndices.reserve(chunk.tokens.size());
+        for(uint32_t t = 0; t < chunk.tokens.size(); ++t) {
+            const Token& token = chunk.tokens[t];
+            assert(token.type != QuotedContent);
+            if( token.type == Integer ) {
+                chunk.maxint = std::max(chunk.maxint, token.value);
+                chunk.termIndices.push_back(Chunk::NoTerm);
+                continue;
+            }
+            std::pair<Dictionary::iterator, bool> inserted = dictionary.insert(
+                std::make_pair(SymbolKey(token.begin, token.length), chunk.terms.size()));
+            if( inserted.second )
+                chunk.terms.push_back(t);
+            chunk.termIndices.push_back(inserted.first->second);
+        }
+
+        // atom texts
+        if( !chunk.lazyText ) {
+            const std::size_t facts = chunk.factBegins.size() - 1;
+            chunk.texts.resize(facts);
+            for(std::size_t f = 0; f < facts; ++f) {
+                std::string& text = chunk.texts[f];
+                const uint32_t first = chunk.factBegins[f];
+                const uint32_t last = chunk.factBegins[f+1];
+                for(uint32_t t = first; t < last; ++t) {
+                    if( t > first )
+                        text.push_back(t == first + 1 ? '(' : ',');
+                    const Token& token = chunk.tokens[t];
+                    if( token.type == Integer )
+                        appendInteger(text, token.value);
+                    else
+                        text.append(token.begin, token.length);
+                }
+                if( last > first + 1 )
+                    text.push_back(')');
+            }
+        }
+    }
+    catch(const std::exception& e) {
+        chunk.error = e.what();
+    }
+}
+
+
+void BulkFactLoader::mergeChunk(Chunk& chunk)
+{
+    if( !chunk.error.empty() )
+        throw GeneralError("loading facts failed: " + chunk.error);
+
+    // terms in order of first occurrence, i.e., in the same order as a sequential scan would store them
+    std::vector<ID> ids(chunk.terms.size());
+    for(std::size_t u = 0; u < chunk.terms.size(); ++u)
+        ids[u] = internSymbol(chunk.tokens[chunk.terms[u]]);
+    if( chunk.maxint > ctx.maxint )
+        ctx.maxint = chunk.maxint;
+
+    // atoms
+    const std::size_t facts = chunk.factBegins.size() - 1;
+    for(std::size_t f = 0; f < facts; ++f) {
+        atom.tuple.clear();
+        for(uint32_t t = chunk.factBegins[f]; t < chunk.factBegins[f+1]; ++t) {
+            const uint32_t index = chunk.termIndices[t];
+            atom.tuple.push_back(index == Chunk::NoTerm ?
+                ID::termFromInteger(chunk.tokens[t].value) : ids[index]);
+        }
+        if( lazyText )
+            atom.text.clear();
+        else
+            atom.text.swap(chunk.texts[f]);
+
+        ID id = reg->ogatoms.getIDByTuple(atom.tuple);
+        if( id == ID_FAIL )
+            id = reg->ogatoms.storeAndGetID(atom);
+        ctx.edb->setFact(id.address);
+    }
+    factCount += facts;
+    DBGLOG(DBG,"merged chunk with " << facts << " facts and " << chunk.terms.size() << " distinct constants");
+}
+
+
+const char* BulkFactLoader::loadParallel(const char* begin, const char* end, bool final, bool& nonFact)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"BulkFactLoader::loadParallel");
+
+    // split at line boundaries
+    const std::size_t size = end - begin;
+    const std::size_t count = std::min<std::size_t>(threads, size / MinimumChunkSize);
+    assert(count >= 2);
+    std::vector<Chunk> chunks;
+    chunks.reserve(count);
+    const char* chunkBegin = begin;
+    for(std::size_t i = 1; i <= count; ++i) {
+        const char* chunkEnd = end;
+        if( i < count ) {
+            const char* target = std::max(chunkBegin, begin + size / count * i);
+            const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+            chunkEnd = (newline == 0) ? end : newline + 1;
+        }
+        chunks.push_back(Chunk(chunkBegin, chunkEnd, lazyText));
+        chunkBegin = chunkEnd;
+    }
+
+    // scan
+    DBGLOG(DBG,"scanning " << size << " bytes in " << count << " chunks");
+    {
+        boost::thread_group workers;
+        for(std::size_t i = 1; i < count; ++i)
+            workers.create_thread(boost::bind(&BulkFactLoader::scanChunk, boost::ref(chunks[i])));
+        scanChunk(chunks[0]);
+        workers.join_all();
+    }
+
+    // merge in input order; the next chunk is only valid if this one ends at a statement boundary
+    for(std::size_t i = 0; i < count; ++i) {
+        Chunk& chunk = chunks[i];
+        mergeChunk(chunk);
+        if( chunk.rest != chunk.end ) {
+            DBGLOG(DBG,"chunk " << i << " stopped before its end, loading the rest sequentially");
+            return load(chunk.rest, end, final, nonFact);
+        }
+        // free memory early
+        std::vector<Token>().swap(chunk.tokens);
+    }
+    nonFact = false;
+    return end;
+}
+
+
+void BulkFactLoader::loadCSVFile(const std::string& predicate, const std::string& filename)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"BulkFactLoader::loadCSVFile");
+
+    if( predicate.empty() || (!isLower(predicate[0]) && predicate[0] != '"') )
+        throw GeneralError("invalid predicate '" + predicate + "' for CSV file " + filename);
+
+    // (empty files cannot be mapped)
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if( !ifs.is_open() )
+        throw GeneralError("File " + filename + " not found");
+    const bool empty = (ifs.tellg() == std::streampos(0));
+    ifs.close();
+    if( empty )
+        return;
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filename);
+    }
+    catch(const std::exception& e) {
+        throw GeneralError("could not read CSV file " + filename + ": " + e.what());
+    }
+
+    const char* pos = file.data();
+    const char* const end = pos + file.size();
+    uint32_t lineNr = 0;
+    while( pos != end ) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        const char* next = (lineEnd == 0) ? end : lineEnd + 1;
+        if( lineEnd == 0 )
+            lineEnd = end;
+        if( lineEnd != pos && lineEnd[-1] == '\r' )
+            --lineEnd;
+
+        tokens.push_back(Token(Symbol, predicate.data(), predicate.size()));
+        tokens.push_back(Token(Integer, pos, 0, lineNr));
+
+        // split at semicolons which are not escaped by a backslash
+        // (always at least one field, possibly empty)
+        while( true ) {
+            const char* field = pos;
+            bool escaped = false;
+            while( pos != lineEnd && (escaped || *pos != ';') ) {
+                escaped = !escaped && *pos == '\\';
+                ++pos;
+            }
+
+            if( field != pos && isDigit(*field) ) {
+                const char* digits = field;
+                uint32_t value;
+                if( !scanInteger(digits, pos, value) || digits != pos )
+                    throw SyntaxError("cannot convert field '" + std::string(field, pos) +
+                        "' of CSV file to an integer", lineNr + 1, filename);
+                tokens.push_back(Token(Integer, field, pos - field, value));
+            }
+            else {
+                if( !isValidQuotedContent(field, pos) )
+                    throw SyntaxError("cannot convert field '" + std::string(field, pos) +
+                        "' of CSV file to a string", lineNr + 1, filename);
+                tokens.push_back(Token(QuotedContent, field, pos - field));
+            }
+
+            if( pos == lineEnd )
+                break;
+            ++pos;               // skip semicolon
+        }
+        endFact();
+
+        pos = next;
+        ++lineNr;
+    }
+    commit();
+
+    LOG(INFO,"loaded " << lineNr << " lines of CSV file " << filename);
+}
+
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -43,6 +43,9 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
 #include "dlvhex2/Logger.h"
 #include <boost/functional/hash.hpp>
 
@@ -56,11 +59,15 @@ DLVHEX_NAMESPACE_BEGIN
 bool CDNLSolver::unitPropagation(Nogood& violatedNogood)
 {
 
+    if (denseWatches) {
+        return propagateTrail(violatedNogood);
+    }
+
     DBGLOG(DBG, "Unit propagation starts");
     int nogoodNr;
     while (unitNogoods.size() > 0) {
         nogoodNr = *(unitNogoods.begin());
-        const Nogood& nextUnitNogood = nogoodset.getNogood(nogoodNr);
+        const NogoodSet::LiteralRange nextUnitNogood = nogoodset.getLiterals(nogoodNr);
         unitNogoods.erase(unitNogoods.begin());
 
         // find propagation DL
@@ -90,9 +97,9 @@ bool CDNLSolver::unitPropagation(Nogood& violatedNogood)
 
 void CDNLSolver::loadAddedNogoods()
 {
+    // nogoods from external learners are redundant as well and can be deleted once they are no longer reasons
     for (int i = 0; i < nogoodsToAdd.getNogoodCount(); ++i) {
-        addNogoodAndUpdateWatchingStructures(nogoodsToAdd.getNogood(i));
-
+        addLearnedNogood(nogoodsToAdd.getNogood(i));
     }
     nogoodsToAdd.clear();
 }
@@ -162,8 +169,9 @@ void CDNLSolver::analysis(Nogood& violatedNogood, Nogood& learnedNogood, int& ba
             }
             else {
                 assert(foundImpliedLit);
-                Nogood& c = nogoodset.getNogood(cause[impliedLit]);
+                Nogood c = nogoodset.getNogood(cause[impliedLit]);
                 touchVarsInNogood(c);
+                if (reductionInterval > 0) bumpNogood(cause[impliedLit]);
                 learnedNogood = resolve(learnedNogood, c, impliedLit);
             }
             #ifndef NDEBUG
@@ -183,19 +191,27 @@ void CDNLSolver::analysis(Nogood& violatedNogood, Nogood& learnedNogood, int& ba
     backtrackDL = bt;
 
     // decision heuristic metric update
-    ++conflicts;
-    if (conflicts >= 255) {
-        DBGLOG(DBG, "Maximum conflicts count: dividing all counters by 2");
-        BOOST_FOREACH (IDAddress litadr, allAtoms) {
-            varCounterPos[litadr] /= 2;
-            varCounterNeg[litadr] /= 2;
+    if (reductionInterval > 0) {
+        nogoodActivityIncrement /= 0.999;
+    }
+    if (vsids) {
+        decayActivities();
+    }
+    else {
+        ++conflicts;
+        if (conflicts >= 255) {
+            DBGLOG(DBG, "Maximum conflicts count: dividing all counters by 2");
+            BOOST_FOREACH (IDAddress litadr, allAtoms) {
+                varCounterPos[litadr] /= 2;
+                varCounterNeg[litadr] /= 2;
+            }
+            conflicts = 0;
         }
-        conflicts = 0;
     }
 }
 
 
-Nogood CDNLSolver::resolve(Nogood& ng1, Nogood& ng2, IDAddress litadr)
+Nogood CDNLSolver::resolve(const Nogood& ng1, const Nogood& ng2, IDAddress litadr)
 {
     // resolvent = union of ng1 and ng2 minus both polarities of the resolved literal
     Nogood resolvent = ng1;
@@ -216,7 +232,7 @@ void CDNLSolver::setFact(ID fact, int dl, int c = -1)
 
     if (c > -1) {
     #ifndef NDEBUG
-        BOOST_FOREACH (ID lit, nogoodset.getNogood(c)) {
+        BOOST_FOREACH (ID lit, nogoodset.getLiterals(c)) {
             if (assignedAtoms->getFact(lit.address)) {
                 DBGLOG(DBG, printToString<RawPrinter>(lit, ctx.registry()) << "=" << (interpretation->getFact(lit.address) ^ lit.isNaf()));
             }
@@ -243,7 +259,17 @@ void CDNLSolver::setFact(ID fact, int dl, int c = -1)
     assignmentOrder.insert(fact.address);
     factsOnDecisionLevel[dl].push_back(fact.address);
 
-    updateWatchingStructuresAfterSetFact(fact);
+    if (denseWatches) {
+        // propagation is deferred until the literal is taken from the trail
+        growDenseVectors(fact.address);
+        atomValue[fact.address] = fact.isNaf() ? 2 : 1;
+        atomLevel[fact.address] = dl;
+        trailPosition[fact.address] = trail.size();
+        trail.push_back(literalCode(fact));
+    }
+    else {
+        updateWatchingStructuresAfterSetFact(fact);
+    }
 
     #ifndef NDEBUG
     ++cntAssignments;
@@ -259,9 +285,24 @@ void CDNLSolver::clearFact(IDAddress litadr)
     cause[litadr] = -1;
     assignmentOrder.erase(litadr);
 
-    // getFact will return the truth value which was just cleared
-    // (truth value remains until it is overridden by a new one)
-    updateWatchingStructuresAfterClearFact(createLiteral(litadr, interpretation->getFact(litadr)));
+    if (phaseSaving) {
+        if (litadr >= savedPhase.size()) savedPhase.resize(litadr + 1, 0);
+        savedPhase[litadr] = interpretation->getFact(litadr) ? 1 : 2;
+    }
+    if (vsids) {
+        heapInsert(litadr);
+    }
+
+    if (denseWatches) {
+        // the trail is cleaned up lazily before the next propagation
+        atomValue[litadr] = 0;
+        trailDirty = true;
+    }
+    else {
+        // getFact will return the truth value which was just cleared
+        // (truth value remains until it is overridden by a new one)
+        updateWatchingStructuresAfterClearFact(createLiteral(litadr, interpretation->getFact(litadr)));
+    }
 }
 
 
@@ -311,18 +352,31 @@ ID CDNLSolver::getGuess()
 
     DBGLOG(DBG, "Have " << allAtoms.size() << " atoms; " << assignedAtoms->getStorage().count() << " are assigned");
 
+    // activity-based heuristic: choose the most active unassigned atom
+    if (vsids) {
+        while (decisionHeap.size() > 0) {
+            IDAddress litadr = heapRemoveMax();
+            if (!assigned(litadr)) {
+                // prefer the truth value which occurred less often in conflicts
+                ID guess = decisionLiteral(litadr, polarity[litadr] <= 0);
+                DBGLOG(DBG, "Guessing " << litToString(guess) << " because it is the most active atom");
+                return guess;
+            }
+        }
+    }
+
     // iterate over recent conflicts, beginning at the most recent conflict
     for (std::vector<int>::reverse_iterator rit = recentConflicts.rbegin(); rit != recentConflicts.rend(); ++rit) {
-        Nogood& ng = nogoodset.getNogood(*rit);
-
-        // skip satisfied and contraditory nogoods
-        if (watchedLiteralsOfNogood[*rit].size() == 0) {
-            continue;
-        }
+        const NogoodSet::LiteralRange ng = nogoodset.getLiterals(*rit);
 
         // find most active unassigned variable in this nogood
         ID mostActive = ID_FAIL;
         BOOST_FOREACH (ID lit, ng) {
+            // skip satisfied nogoods
+            if (falsified(lit)) {
+                mostActive = ID_FAIL;
+                break;
+            }
             if (!assigned(lit.address)) {
                 if (mostActive == ID_FAIL ||
                 (varCounterPos[lit.address] + varCounterNeg[lit.address]) > (varCounterPos[mostActive.address] + varCounterNeg[mostActive.address])) {
@@ -331,11 +385,13 @@ ID CDNLSolver::getGuess()
             }
         }
 
-        // if the nogood has no unassigned variable, it must be either satisfied or contradictory and the if above applies
-        assert(mostActive != ID_FAIL);
+        // skip satisfied and contradictory nogoods
+        if (mostActive == ID_FAIL) {
+            continue;
+        }
 
         DBGLOG(DBG, "Guessing " << litToString(mostActive) << " because it occurs in recent conflicts");
-        return mostActive;
+        return decisionLiteral(mostActive.address, !mostActive.isNaf());
     }
 
     // no recent conflicts;
@@ -351,7 +407,7 @@ ID CDNLSolver::getGuess()
     }
 
     DBGLOG(DBG, "Guessing " << litToString(mostActive) << " because it is globally active");
-    return mostActive;
+    return decisionLiteral(mostActive.address, !mostActive.isNaf());
 }
 
 
@@ -369,9 +425,28 @@ void CDNLSolver::initWatchingStructures()
     unitNogoods.clear();
     contradictoryNogoods.clear();
 
+    if (denseWatches) {
+        nogoodLiterals.clear();
+        nogoodBegin.clear();
+        nogoodLength.clear();
+        pendingNogoods.clear();
+        recheckNogoods.clear();
+        BOOST_FOREACH (std::vector<int>& watchers, watchLists) {
+            watchers.clear();
+        }
+
+        // watches are chosen when the nogoods are taken from the pending list;
+        // all literals assigned so far need to be propagated again
+        for (int nogoodNr = 0; nogoodNr < nogoodset.getNogoodCount(); ++nogoodNr) {
+            if (!isDeletedNogood(nogoodNr)) storeDenseNogood(nogoodNr);
+        }
+        propagationHead = 0;
+        return;
+    }
+
     // each nogood watches (at most) two of its literals
     for (int nogoodNr = 0; nogoodNr < nogoodset.getNogoodCount(); ++nogoodNr) {
-        updateWatchingStructuresAfterAddNogood(nogoodNr);
+        if (!isDeletedNogood(nogoodNr)) updateWatchingStructuresAfterAddNogood(nogoodNr);
     }
 }
 
@@ -380,7 +455,7 @@ void CDNLSolver::updateWatchingStructuresAfterAddNogood(int index)
 {
 
     DBGLOGD(DBG, "updateWatchingStructuresAfterAddNogood after adding nogood " << index);
-    const Nogood& ng = nogoodset.getNogood(index);
+    const NogoodSet::LiteralRange ng = nogoodset.getLiterals(index);
 
     // remember for all literals in the nogood that they are contained in this nogood
     BOOST_FOREACH (ID lit, ng) {
@@ -427,7 +502,7 @@ void CDNLSolver::updateWatchingStructuresAfterAddNogood(int index)
 
 void CDNLSolver::updateWatchingStructuresAfterRemoveNogood(int index)
 {
-    const Nogood& ng = nogoodset.getNogood(index);
+    const NogoodSet::LiteralRange ng = nogoodset.getLiterals(index);
 
     // remove the nogood from all literal lists
     BOOST_FOREACH (ID lit, ng) {
@@ -435,8 +510,8 @@ void CDNLSolver::updateWatchingStructuresAfterRemoveNogood(int index)
         nogoodsOfNegLiteral[lit.address].erase(index);
     }
 
-    // remove all watched literals
-    Set<ID>& watched = watchedLiteralsOfNogood[index];
+    // remove all watched literals (stopWatching modifies the set, thus iterate over a copy)
+    Set<ID> watched = watchedLiteralsOfNogood[index];
     BOOST_FOREACH (ID lit, watched) {
         stopWatching(index, lit);
     }
@@ -470,7 +545,7 @@ void CDNLSolver::updateWatchingStructuresAfterSetFact(ID lit)
             changed = false;
 
             BOOST_FOREACH (int nogoodNr, lit.isNaf() ? watchingNogoodsOfNegLiteral[lit.address] : watchingNogoodsOfPosLiteral[lit.address]) {
-                const Nogood& ng = nogoodset.getNogood(nogoodNr);
+                const NogoodSet::LiteralRange ng = nogoodset.getLiterals(nogoodNr);
 
                 // stop watching lit
                 stopWatching(nogoodNr, lit);
@@ -533,7 +608,7 @@ void CDNLSolver::updateWatchingStructuresAfterClearFact(ID literal)
             BOOST_FOREACH (int nogoodNr, positiveAndNegativeLiteral == 1 ? nogoodsOfPosLiteral[literal.address] : nogoodsOfNegLiteral[literal.address]) {
                 DBGLOG(DBG, "Updating nogood " << nogoodNr);
 
-                const Nogood& ng = nogoodset.getNogood(nogoodNr);
+                const NogoodSet::LiteralRange ng = nogoodset.getLiterals(nogoodNr);
 
                 bool stillInactive = false;
 
@@ -632,8 +707,244 @@ void CDNLSolver::startWatching(int nogoodNr, ID lit)
 }
 
 
+void CDNLSolver::storeDenseNogood(int index)
+{
+    const NogoodSet::LiteralRange ng = nogoodset.getLiterals(index);
+
+    if ((int)nogoodBegin.size() <= index) {
+        nogoodBegin.resize(index + 1, 0);
+        nogoodLength.resize(index + 1, 0);
+        nogoodVisit.resize(index + 1, 0);
+    }
+
+    // if the index is reused, the previous literals remain unused in the array
+    nogoodBegin[index] = nogoodLiterals.size();
+    nogoodLength[index] = ng.size();
+    BOOST_FOREACH (ID lit, ng) {
+        growDenseVectors(lit.address);
+    }
+    // the nogood set stores ground literals in the same encoding
+    nogoodLiterals.insert(nogoodLiterals.end(), ng.begin().base(), ng.end().base());
+    pendingNogoods.push_back(index);
+}
+
+
+bool CDNLSolver::watchDenseNogood(int index)
+{
+    uint32_t* lits = &nogoodLiterals[nogoodBegin[index]];
+    const uint32_t len = nogoodLength[index];
+
+    // move up to two literals which are not satisfied to the front
+    uint32_t open = 0;
+    for (uint32_t k = 0; k < len && open < 2; ++k) {
+        if (!codeSatisfied(lits[k])) {
+            std::swap(lits[open++], lits[k]);
+        }
+    }
+
+    // fill the remaining watches with the satisfied literals of the highest decision levels,
+    // such that backtracking unassigns them first
+    for (uint32_t w = open; w < 2 && w < len; ++w) {
+        uint32_t best = w;
+        for (uint32_t k = w + 1; k < len; ++k) {
+            if (atomLevel[lits[k] >> 1] > atomLevel[lits[best] >> 1]) best = k;
+        }
+        std::swap(lits[w], lits[best]);
+    }
+
+    for (uint32_t w = 0; w < 2 && w < len; ++w) {
+        watchLists[lits[w]].push_back(index);
+    }
+
+    if (open == 0) {
+        DBGLOGD(DBG, "Nogood " << index << " is contradictory");
+        contradictoryNogoods.insert(index);
+        return false;
+    }
+    if (open == 1) {
+        const int propDL = len > 1 ? atomLevel[lits[1] >> 1] : 0;
+        if (atomValue[lits[0] >> 1] == 0) {
+            DBGLOGD(DBG, "Nogood " << index << " is unit");
+            setFact(negation(codeLiteral(lits[0])), propDL, index);
+        }
+        else if (atomLevel[lits[0] >> 1] > propDL) {
+            recheckNogoods.push_back(index);
+        }
+    }
+    return true;
+}
+
+
+void CDNLSolver::compactTrail()
+{
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+    uint32_t head = none;
+    uint32_t kept = 0;
+    bool removed = false;
+    for (uint32_t i = 0; i < trail.size(); ++i) {
+        const uint32_t code = trail[i];
+        // drop unassigned literals and outdated entries of reassigned atoms
+        if (!codeSatisfied(code) || trailPosition[code >> 1] != i) {
+            removed = true;
+            continue;
+        }
+        // literals behind a removed one are propagated again
+        if (head == none && (i >= propagationHead || removed)) head = kept;
+        trailPosition[code >> 1] = kept;
+        trail[kept++] = code;
+    }
+    trail.resize(kept);
+    propagationHead = (head == none ? kept : head);
+
+    // contradictory nogoods and nogoods with a missed implication need new watches
+    BOOST_FOREACH (int nogoodNr, contradictoryNogoods) {
+        pendingNogoods.push_back(nogoodNr);
+    }
+    contradictoryNogoods.clear();
+    pendingNogoods.insert(pendingNogoods.end(), recheckNogoods.begin(), recheckNogoods.end());
+    recheckNogoods.clear();
+    trailDirty = false;
+}
+
+
+bool CDNLSolver::propagateTrail(Nogood& violatedNogood)
+{
+    DBGLOG(DBG, "Unit propagation starts (dense watches)");
+
+    if (trailDirty) compactTrail();
+
+    if (contradictoryNogoods.size() > 0) {
+        violatedNogood = nogoodset.getNogood(*(contradictoryNogoods.begin()));
+        return false;
+    }
+
+    while (pendingNogoods.size() > 0) {
+        const int nogoodNr = pendingNogoods.back();
+        pendingNogoods.pop_back();
+        if (!watchDenseNogood(nogoodNr)) {
+            violatedNogood = nogoodset.getNogood(nogoodNr);
+            DBGLOG(DBG, "Unit propagation finished with detected contradiction " << violatedNogood);
+            return false;
+        }
+    }
+
+    while (propagationHead < trail.size()) {
+        const uint32_t code = trail[propagationHead];
+        const int level = atomLevel[code >> 1];
+        std::vector<int>& watchers = watchLists[code];
+        ++visitCounter;
+
+        std::size_t i = 0, j = 0;
+        int conflictNogood = -1;
+        while (i < watchers.size()) {
+            const int nogoodNr = watchers[i++];
+            // drop duplicate entries
+            if (nogoodVisit[nogoodNr] == visitCounter) continue;
+            nogoodVisit[nogoodNr] = visitCounter;
+
+            // drop entries of deleted nogoods
+            const uint32_t len = nogoodLength[nogoodNr];
+            if (len == 0) continue;
+            uint32_t* lits = &nogoodLiterals[nogoodBegin[nogoodNr]];
+            if (len == 1) {
+                watchers[j++] = nogoodNr;
+                contradictoryNogoods.insert(nogoodNr);
+                conflictNogood = nogoodNr;
+                break;
+            }
+
+            // make the triggering literal the second watch; drop stale entries
+            if (lits[0] == code) std::swap(lits[0], lits[1]);
+            if (lits[1] != code) continue;
+
+            // the nogood is satisfied and stays so as long as code is assigned
+            const uint32_t other = lits[0];
+            if (codeFalsified(other) && atomLevel[other >> 1] <= level) {
+                watchers[j++] = nogoodNr;
+                continue;
+            }
+
+            // search for a new watch which is not satisfied
+            uint32_t k = 2;
+            while (k < len && codeSatisfied(lits[k])) ++k;
+            if (k < len) {
+                std::swap(lits[1], lits[k]);
+                watchLists[lits[1]].push_back(nogoodNr);
+                continue;
+            }
+
+            if (codeSatisfied(other)) {
+                watchers[j++] = nogoodNr;
+                contradictoryNogoods.insert(nogoodNr);
+                conflictNogood = nogoodNr;
+                break;
+            }
+
+            // all literals but the other watch are satisfied: watch the one with the highest decision level
+            uint32_t best = 1;
+            for (k = 2; k < len; ++k) {
+                if (atomLevel[lits[k] >> 1] > atomLevel[lits[best] >> 1]) best = k;
+            }
+            if (best != 1) {
+                std::swap(lits[1], lits[best]);
+                watchLists[lits[1]].push_back(nogoodNr);
+            }
+            else {
+                watchers[j++] = nogoodNr;
+            }
+
+            const int propDL = atomLevel[lits[1] >> 1];
+            if (atomValue[other >> 1] == 0) {
+                setFact(negation(codeLiteral(other)), propDL, nogoodNr);
+            }
+            else if (atomLevel[other >> 1] > propDL) {
+                recheckNogoods.push_back(nogoodNr);
+            }
+        }
+
+        if (conflictNogood != -1) {
+            // keep the remaining entries; code is propagated again after backtracking
+            while (i < watchers.size()) watchers[j++] = watchers[i++];
+            watchers.resize(j);
+            violatedNogood = nogoodset.getNogood(conflictNogood);
+            DBGLOG(DBG, "Unit propagation finished with detected contradiction " << violatedNogood);
+            return false;
+        }
+        watchers.resize(j);
+        ++propagationHead;
+    }
+
+    DBGLOG(DBG, "Unit propagation finished successfully");
+    return true;
+}
+
+
+void CDNLSolver::growDenseVectors(IDAddress adr)
+{
+    if (adr >= atomValue.size()) {
+        const std::size_t size = std::max<std::size_t>(adr + 1, 2 * atomValue.size());
+        atomValue.resize(size, 0);
+        atomLevel.resize(size, 0);
+        trailPosition.resize(size, 0);
+        watchLists.resize(2 * size);
+    }
+}
+
+
 void CDNLSolver::touchVarsInNogood(Nogood& ng)
 {
+    if (vsids) {
+        BOOST_FOREACH (ID lit, ng) {
+            if (lit.address >= activity.size()) continue;
+            activity[lit.address] += activityIncrement;
+            polarity[lit.address] += lit.isNaf() ? -1 : 1;
+            if (heapPosition[lit.address] >= 0) {
+                heapPercolateUp(heapPosition[lit.address]);
+            }
+        }
+        return;
+    }
+
     BOOST_FOREACH (ID lit, ng) {
         if (lit.isNaf()) {
             varCounterNeg[lit.address]++;
@@ -645,17 +956,461 @@ void CDNLSolver::touchVarsInNogood(Nogood& ng)
 }
 
 
+void CDNLSolver::decayActivities()
+{
+    // instead of decreasing all activities, future bumps are increased
+    activityIncrement /= 0.95;
+    if (activityIncrement > 1e100) {
+        DBGLOG(DBG, "Rescaling activities");
+        BOOST_FOREACH (double& a, activity) {
+            a *= 1e-100;
+        }
+        activityIncrement *= 1e-100;
+    }
+}
+
+
+void CDNLSolver::initDecisionHeuristics()
+{
+    if (!vsids) return;
+
+    IDAddress maxAdr = 0;
+    BOOST_FOREACH (IDAddress litadr, allAtoms) {
+        if (litadr > maxAdr) maxAdr = litadr;
+    }
+    activity.resize(maxAdr + 1, 0.0);
+    polarity.resize(maxAdr + 1, 0);
+    heapPosition.assign(maxAdr + 1, -2);
+    decisionHeap.clear();
+    BOOST_FOREACH (IDAddress litadr, allAtoms) {
+        heapPosition[litadr] = -1;
+    }
+    BOOST_FOREACH (IDAddress litadr, allAtoms) {
+        if (!assigned(litadr)) heapInsert(litadr);
+    }
+}
+
+
+void CDNLSolver::heapInsert(IDAddress adr)
+{
+    if (adr >= heapPosition.size() || heapPosition[adr] != -1) return;
+    heapPosition[adr] = decisionHeap.size();
+    decisionHeap.push_back(adr);
+    heapPercolateUp(decisionHeap.size() - 1);
+}
+
+
+void CDNLSolver::heapPercolateUp(int pos)
+{
+    const IDAddress adr = decisionHeap[pos];
+    while (pos > 0) {
+        const int parent = (pos - 1) / 2;
+        if (activity[decisionHeap[parent]] >= activity[adr]) break;
+        decisionHeap[pos] = decisionHeap[parent];
+        heapPosition[decisionHeap[pos]] = pos;
+        pos = parent;
+    }
+    decisionHeap[pos] = adr;
+    heapPosition[adr] = pos;
+}
+
+
+void CDNLSolver::heapPercolateDown(int pos)
+{
+    const IDAddress adr = decisionHeap[pos];
+    const int size = decisionHeap.size();
+    while (2 * pos + 1 < size) {
+        int child = 2 * pos + 1;
+        if (child + 1 < size && activity[decisionHeap[child + 1]] > activity[decisionHeap[child]]) ++child;
+        if (activity[decisionHeap[child]] <= activity[adr]) break;
+        decisionHeap[pos] = decisionHeap[child];
+        heapPosition[decisionHeap[pos]] = pos;
+        pos = child;
+    }
+    decisionHeap[pos] = adr;
+    heapPosition[adr] = pos;
+}
+
+
+IDAddress CDNLSolver::heapRemoveMax()
+{
+    const IDAddress top = decisionHeap[0];
+    heapPosition[top] = -1;
+    const IDAddress last = decisionHeap.back();
+    decisionHeap.pop_back();
+    if (decisionHeap.size() > 0) {
+        decisionHeap[0] = last;
+        heapPosition[last] = 0;
+        heapPercolateDown(0);
+    }
+    return top;
+}
+
+
+ID CDNLSolver::decisionLiteral(IDAddress adr, bool preferred)
+{
+    // phases are only saved with phase saving or preloaded by warmStart
+    if (adr < savedPhase.size() && savedPhase[adr] != 0) {
+        return createLiteral(adr, savedPhase[adr] == 1);
+    }
+    return createLiteral(adr, preferred);
+}
+
+
+int CDNLSolver::luby(int i)
+{
+    // find the finite subsequence which contains index i, and the size of that subsequence
+    int size = 1, seq = 0;
+    while (size < i + 1) {
+        ++seq;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        --seq;
+        i = i % size;
+    }
+    return 1 << seq;
+}
+
+
+void CDNLSolver::restartIfDue()
+{
+    if (restartStrategy == 0) return;
+
+    ++conflictsSinceRestart;
+    if (conflictsSinceRestart < restartLimit) return;
+
+    ++restarts;
+    conflictsSinceRestart = 0;
+    if (restartStrategy == 1) {
+        restartLimit = restartBase * luby(restarts);
+    }
+    else {
+        restartLimit *= 1.5;
+    }
+
+    // do not jump below the exhausted level, this could lead to regeneration of models
+    if (currentDL > exhaustedDL) {
+        DBGLOG(DBG, "Restart " << restarts << ": backtracking to DL " << exhaustedDL << "; next restart after " << restartLimit << " conflicts");
+        currentDL = exhaustedDL;
+        backtrack(currentDL);
+    }
+    #ifndef NDEBUG
+    ++cntRestarts;
+    #endif
+}
+
+
+int CDNLSolver::addLearnedNogood(const Nogood& ng)
+{
+    const int count = nogoodset.getNogoodCount();
+    const int index = addNogoodAndUpdateWatchingStructures(ng);
+
+    // nogoods which were already present (or were not added at all) keep their status
+    if (reductionInterval > 0 && nogoodset.getNogoodCount() > count) {
+        nogoodLBD.resize(index + 1, 0);
+        nogoodActivity.resize(index + 1, 0.0);
+        nogoodLBD[index] = literalBlockDistance(nogoodset.getNogood(index));
+        nogoodActivity[index] = nogoodActivityIncrement;
+        learnedNogoods.push_back(index);
+        DBGLOG(DBG, "Nogood " << index << " is learned with LBD " << nogoodLBD[index]);
+    }
+    return index;
+}
+
+
+int CDNLSolver::literalBlockDistance(const Nogood& ng)
+{
+    std::vector<int> levels;
+    int unassigned = 0;
+    BOOST_FOREACH (ID lit, ng) {
+        if (assigned(lit.address)) levels.push_back(decisionlevel[lit.address]);
+        else ++unassigned;
+    }
+    std::sort(levels.begin(), levels.end());
+    // at least 1 such that learned nogoods are distinguishable from the ones of the instance
+    return std::max(1, (int)(std::unique(levels.begin(), levels.end()) - levels.begin()) + unassigned);
+}
+
+
+void CDNLSolver::bumpNogood(int index)
+{
+    if (index >= (int)nogoodLBD.size() || nogoodLBD[index] <= 0) return;
+
+    nogoodActivity[index] += nogoodActivityIncrement;
+    if (nogoodActivity[index] > 1e20) {
+        // rescale to avoid overflows
+        BOOST_FOREACH (int learned, learnedNogoods) {
+            nogoodActivity[learned] *= 1e-20;
+        }
+        nogoodActivityIncrement *= 1e-20;
+    }
+}
+
+
+bool CDNLSolver::isReason(int index)
+{
+    BOOST_FOREACH (ID lit, nogoodset.getLiterals(index)) {
+        if (assigned(lit.address) && cause[lit.address] == index) return true;
+    }
+    return false;
+}
+
+
+namespace
+{
+    /** \brief Orders learned nogoods such that the least useful ones come first (high literal block distance, low activity). */
+    struct LessUsefulNogood
+    {
+        const std::vector<int>& lbd;
+        const std::vector<double>& activity;
+
+        LessUsefulNogood(const std::vector<int>& lbd, const std::vector<double>& activity) : lbd(lbd), activity(activity) {}
+
+        bool operator()(int a, int b) const
+        {
+            if (lbd[a] != lbd[b]) return lbd[a] > lbd[b];
+            return activity[a] < activity[b];
+        }
+    };
+}
+
+
+void CDNLSolver::reduceLearnedNogoodsIfDue()
+{
+    if (reductionInterval == 0) return;
+
+    ++conflictsSinceReduction;
+    if (conflictsSinceReduction < reductionInterval) return;
+    conflictsSinceReduction = 0;
+
+    // reasons of the current assignment and glue nogoods are always kept
+    std::vector<int> kept;
+    std::vector<int> candidates;
+    BOOST_FOREACH (int index, learnedNogoods) {
+        if (nogoodLBD[index] <= 2 || isReason(index)) kept.push_back(index);
+        else candidates.push_back(index);
+    }
+
+    // delete the less useful half of the remaining ones
+    std::sort(candidates.begin(), candidates.end(), LessUsefulNogood(nogoodLBD, nogoodActivity));
+    const std::size_t deleteCount = candidates.size() / 2;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (i < deleteCount) removeNogoodAndUpdateWatchingStructures(candidates[i]);
+        else kept.push_back(candidates[i]);
+    }
+    learnedNogoods.swap(kept);
+    DBGLOG(DBG, "Deleted " << deleteCount << " learned nogoods, " << learnedNogoods.size() << " remain");
+
+    // forget deleted nogoods in the heuristics
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < recentConflicts.size(); ++i) {
+        if (!isDeletedNogood(recentConflicts[i])) recentConflicts[j++] = recentConflicts[i];
+    }
+    recentConflicts.resize(j);
+
+    if (denseWatches && deleteCount > 0) compactDenseNogoods();
+}
+
+
+void CDNLSolver::removeNogoodAndUpdateWatchingStructures(int index)
+{
+    DBGLOG(DBG, "Deleting nogood " << index << ": " << nogoodset.getNogood(index));
+
+    if (denseWatches) {
+        // watch list entries are dropped lazily by propagateTrail
+        nogoodLength[index] = 0;
+        pendingNogoods.erase(std::remove(pendingNogoods.begin(), pendingNogoods.end(), index), pendingNogoods.end());
+        recheckNogoods.erase(std::remove(recheckNogoods.begin(), recheckNogoods.end(), index), recheckNogoods.end());
+    }
+    else {
+        updateWatchingStructuresAfterRemoveNogood(index);
+        unitNogoods.erase(index);
+    }
+    contradictoryNogoods.erase(index);
+
+    nogoodset.clearNogood(index);
+    nogoodLBD[index] = -1;
+    #ifndef NDEBUG
+    ++cntDeletedNogoods;
+    #endif
+}
+
+
+void CDNLSolver::compactDenseNogoods()
+{
+    // the order of the literals within each nogood (and thus its watches) is preserved
+    std::vector<uint32_t> literals;
+    literals.reserve(nogoodLiterals.size());
+    for (std::size_t index = 0; index < nogoodBegin.size(); ++index) {
+        const uint32_t begin = nogoodBegin[index];
+        nogoodBegin[index] = literals.size();
+        literals.insert(literals.end(), nogoodLiterals.begin() + begin, nogoodLiterals.begin() + begin + nogoodLength[index]);
+    }
+    nogoodLiterals.swap(literals);
+}
+
+
+void CDNLSolver::warmStart(SolverWarmStartCachePtr cache, SolverWarmStartCache::Key key, InterpretationConstPtr excluded)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidwarmstart, "Solver warm start");
+    assert(currentDL == 0 && "warm start must be done before search");
+
+    warmStartCache = cache;
+    warmStartKey = key;
+    warmStartExcluded = excluded;
+    firstLearnedNogood = nogoodset.getNogoodCount();
+
+    SolverWarmStartCache::Entry entry;
+    if (!cache->lookup(key, entry)) {
+        DBGLOG(DBG, "No warm-start entry for instance " << key);
+        return;
+    }
+
+    // map the atoms of the entry to the atoms of the instance
+    RegistryPtr reg = ctx.registry();
+    boost::unordered_map<std::string, IDAddress> atomOfText;
+    BOOST_FOREACH (IDAddress adr, allAtoms) {
+        if (!excluded || !excluded->getFact(adr)) atomOfText[SolverWarmStartCache::atomText(reg, adr)] = adr;
+    }
+    std::vector<IDAddress> atomOfEntryAtom(entry.atoms.size());
+    std::vector<bool> mapped(entry.atoms.size(), false);
+    for (std::size_t i = 0; i < entry.atoms.size(); ++i) {
+        boost::unordered_map<std::string, IDAddress>::const_iterator it = atomOfText.find(entry.atoms[i]);
+        if (it != atomOfText.end()) {
+            atomOfEntryAtom[i] = it->second;
+            mapped[i] = true;
+        }
+    }
+
+    // the entry might stem from an instance with different facts or from nogoods learned from external sources,
+    // thus only nogoods which are implied by this instance are used
+    // (the assignments of the verification must not change the phases)
+    std::vector<unsigned char> phases(savedPhase);
+    std::vector<Nogood> verified;
+    int rejected = 0;
+    BOOST_FOREACH (const std::vector<int>& lits, entry.nogoods) {
+        Nogood ng;
+        bool allMapped = true;
+        BOOST_FOREACH (int lit, lits) {
+            const std::size_t i = std::abs(lit) - 1;
+            if (!mapped[i]) {
+                allMapped = false;
+                break;
+            }
+            ng.insert(createLiteral(atomOfEntryAtom[i], lit > 0));
+        }
+        if (allMapped && impliedByUnitPropagation(ng)) verified.push_back(ng);
+        else ++rejected;
+    }
+
+    // the verification leaves only level-0 consequences of the instance assigned, which are sound for the search
+    savedPhase.swap(phases);
+    BOOST_FOREACH (const Nogood& ng, verified) addLearnedNogood(ng);
+
+    // phases only influence decisions and need no verification
+    for (std::size_t i = 0; i < entry.atoms.size(); ++i) {
+        if (!mapped[i] || entry.phases[i] == 0) continue;
+        const IDAddress adr = atomOfEntryAtom[i];
+        if (adr >= savedPhase.size()) savedPhase.resize(adr + 1, 0);
+        savedPhase[adr] = entry.phases[i];
+    }
+
+    DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidverified, "Warm-start nogoods verified", verified.size());
+    DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidrejected, "Warm-start nogoods rejected", rejected);
+    DBGLOG(DBG, "Warm start for instance " << key << ": " << verified.size() << " nogoods verified, " << rejected << " rejected");
+}
+
+
+bool CDNLSolver::impliedByUnitPropagation(const Nogood& ng)
+{
+    assert(currentDL == 0);
+
+    Nogood violatedNogood;
+    bool implied = false;
+    if (!unitPropagation(violatedNogood)) {
+        // everything is implied by an inconsistent instance
+        implied = true;
+    }
+    else {
+        currentDL = 1;
+        BOOST_FOREACH (ID lit, ng) {
+            if (falsified(lit)) {
+                // the other literals imply the negation of lit, unless lit is falsified by the facts (then the nogood is useless)
+                implied = decisionlevel[lit.address] > 0;
+                break;
+            }
+            if (satisfied(lit)) continue;
+            setFact(lit, currentDL);
+            if (!unitPropagation(violatedNogood)) {
+                implied = true;
+                break;
+            }
+        }
+        currentDL = 0;
+        backtrack(currentDL);
+    }
+    return implied;
+}
+
+
+void CDNLSolver::storeWarmStart()
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidwarmstart, "Solver warm start");
+    RegistryPtr reg = ctx.registry();
+
+    // phases of all atoms which are not excluded; the current assignment is used for atoms without saved phase
+    SolverWarmStartCache::Entry entry;
+    boost::unordered_map<IDAddress, int, SimpleHashIDAddress> entryAtomOfAtom;
+    BOOST_FOREACH (IDAddress adr, allAtoms) {
+        if (!!warmStartExcluded && warmStartExcluded->getFact(adr)) continue;
+        unsigned char phase = adr < savedPhase.size() ? savedPhase[adr] : 0;
+        if (phase == 0 && assigned(adr)) phase = interpretation->getFact(adr) ? 1 : 2;
+        entryAtomOfAtom[adr] = entry.atoms.size();
+        entry.atoms.push_back(SolverWarmStartCache::atomText(reg, adr));
+        entry.phases.push_back(phase);
+    }
+
+    // learned nogoods (including preloaded ones) over these atoms, shortest first
+    std::vector<std::pair<int, int> > candidates;
+    for (int i = firstLearnedNogood; i < nogoodset.getNogoodCount(); ++i) {
+        const int size = nogoodset.getNogoodSize(i);
+        // deleted nogoods are empty
+        if (size == 0) continue;
+        bool storable = true;
+        BOOST_FOREACH (ID lit, nogoodset.getLiterals(i)) {
+            if (entryAtomOfAtom.find(lit.address) == entryAtomOfAtom.end()) {
+                storable = false;
+                break;
+            }
+        }
+        if (storable) candidates.push_back(std::pair<int, int>(size, i));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    entry.nogoods.resize(candidates.size());
+    for (std::size_t c = 0; c < candidates.size(); ++c) {
+        BOOST_FOREACH (ID lit, nogoodset.getLiterals(candidates[c].second)) {
+            const int atom = entryAtomOfAtom[lit.address] + 1;
+            entry.nogoods[c].push_back(lit.isNaf() ? -atom : atom);
+        }
+    }
+    DBGLOG(DBG, "Storing " << entry.nogoods.size() << " nogoods and " << entry.atoms.size() << " phases for instance " << warmStartKey);
+    warmStartCache->store(warmStartKey, entry);
+}
+
+
 void CDNLSolver::initListOfAllAtoms()
 {
 
     // build a list of all literals which need to be assigned
     // go through all nogoods
     for (int i = 0; i < nogoodset.getNogoodCount(); ++i) {
-        const Nogood& ng = nogoodset.getNogood(i);
         // go through all literals of the nogood
-        for (Nogood::const_iterator lIt = ng.begin(); lIt != ng.end(); ++lIt) {
-            if (lIt->isOrdinaryNongroundAtom()) throw GeneralError("Got nonground atom in SAT instance");
-            allAtoms.insert(lIt->address);
+        BOOST_FOREACH (ID lit, nogoodset.getLiterals(i)) {
+            if (lit.isOrdinaryNongroundAtom()) throw GeneralError("Got nonground atom in SAT instance");
+            allAtoms.insert(lit.address);
         }
     }
 }
@@ -696,6 +1451,10 @@ int CDNLSolver::addNogoodAndUpdateWatchingStructures(Nogood ng)
 
     int index = nogoodset.addNogood(ng);
     DBGLOG(DBG, "Adding nogood " << ng << " with index " << index);
+    if (denseWatches) {
+        storeDenseNogood(index);
+        return index;
+    }
     if ((int)watchedLiteralsOfNogood.size() <= index) {
         watchedLiteralsOfNogood.push_back(Set<ID>(2, 1));
     }
@@ -714,7 +1473,9 @@ std::string CDNLSolver::getStatistics()
         << "Guesses: " << cntGuesses << std::endl
         << "Backtracks: " << cntBacktracks << std::endl
         << "Resolution steps: " << cntResSteps << std::endl
-        << "Conflicts: " << cntDetectedConflicts;
+        << "Conflicts: " << cntDetectedConflicts << std::endl
+        << "Restarts: " << cntRestarts << std::endl
+        << "Deleted nogoods: " << cntDeletedNogoods;
     return ss.str();
     #else
     std::stringstream ss;
@@ -724,7 +1485,12 @@ std::string CDNLSolver::getStatistics()
 }
 
 
-CDNLSolver::CDNLSolver(ProgramCtx& c, NogoodSet ns) :  nogoodset(ns), ctx(c), conflicts(0), cntAssignments(0), cntGuesses(0), cntBacktracks(0), cntResSteps(0), cntDetectedConflicts(0), tmpWatched(2, 1)
+CDNLSolver::CDNLSolver(ProgramCtx& c, NogoodSet ns) :  nogoodset(ns), ctx(c), denseWatches(c.config.getOption("CDNLPropagation") == 1), propagationHead(0), trailDirty(false), visitCounter(0), conflicts(0),
+    vsids(c.config.getOption("CDNLHeuristics") == 1), activityIncrement(1.0), phaseSaving(c.config.getOption("CDNLPhaseSaving") != 0),
+    restartStrategy(c.config.getOption("CDNLRestarts")), restartBase(c.config.getOption("CDNLRestartBase")), restarts(0), conflictsSinceRestart(0), restartLimit(restartBase),
+    reductionInterval(c.config.getOption("CDNLNogoodReduction")), conflictsSinceReduction(0), nogoodActivityIncrement(1.0),
+    warmStartKey(0), firstLearnedNogood(0),
+    cntAssignments(0), cntGuesses(0), cntBacktracks(0), cntResSteps(0), cntDetectedConflicts(0), cntRestarts(0), cntDeletedNogoods(0), tmpWatched(2, 1)
 {
 
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidsolvertime, "Solver time");
@@ -739,8 +1505,15 @@ CDNLSolver::CDNLSolver(ProgramCtx& c, NogoodSet ns) :  nogoodset(ns), ctx(c), co
     exhaustedDL = 0;
 
     initWatchingStructures();
+    initDecisionHeuristics();
 };
 
+
+CDNLSolver::~CDNLSolver()
+{
+    if (!!warmStartCache) storeWarmStart();
+}
+
 void CDNLSolver::restartWithAssumptions(const std::vector<ID>& assumptions)
 {
 
@@ -758,8 +1531,16 @@ void CDNLSolver::restartWithAssumptions(const std::vector<ID>& assumptions)
     conflicts = 0;
     currentDL = 0;
     exhaustedDL = 0;
+    restarts = 0;
+    conflictsSinceRestart = 0;
+    restartLimit = restartBase;
+
+    std::fill(atomValue.begin(), atomValue.end(), 0);
+    trail.clear();
+    trailDirty = false;
 
     initWatchingStructures();
+    initDecisionHeuristics();
 
     // set assumptions at DL=0
     DBGLOG(DBG, "Setting assumptions");
@@ -804,7 +1585,7 @@ bool CDNLSolver::handlePreviousModel()
             // the new nogood is for sure contraditory
             Nogood learnedNogood;
             analysis(modelNogood, learnedNogood, currentDL);
-            recentConflicts.push_back(addNogoodAndUpdateWatchingStructures(learnedNogood));
+            recentConflicts.push_back(addLearnedNogood(learnedNogood));
             DBGLOG(DBG, "Backtrack");
             backtrack(currentDL);
             return true;
@@ -853,7 +1634,7 @@ InterpretationPtr CDNLSolver::getNextModel()
                                  // if set to true, the loop will run even if the interpretation is already complete
     bool anotherIterationEvenIfComplete = false;
     // (needed to check if newly added nogood (e.g. by external learners) are satisfied)
-    while (!complete()) {
+    while (!complete() || anotherIterationEvenIfComplete) {
         anotherIterationEvenIfComplete = false;
         DBGLOG(DBG, "Unit propagation");
         if (!unitPropagation(violatedNogood)) {
@@ -867,10 +1648,12 @@ InterpretationPtr CDNLSolver::getNextModel()
                     Nogood learnedNogood;
                     int k = currentDL;
                     analysis(violatedNogood, learnedNogood, k);
-                    recentConflicts.push_back(addNogoodAndUpdateWatchingStructures(learnedNogood));
+                    recentConflicts.push_back(addLearnedNogood(learnedNogood));
                                  // do not jump below exhausted level, this could lead to regeneration of models
                     currentDL = k > exhaustedDL ? k : exhaustedDL;
                     backtrack(currentDL);
+                    restartIfDue();
+                    reduceLearnedNogoodsIfDue();
                 }
                 else {
                     flipDecisionLiteral();
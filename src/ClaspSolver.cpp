@@ -52,6 +52,7 @@
 #include "dlvhex2/Benchmarking.h"
 
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 #include <boost/graph/strong_components.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/tokenizer.hpp>
@@ -72,10 +73,10 @@ DLVHEX_NAMESPACE_BEGIN
 
 // ============================== ExternalPropagator ==============================
 
-ClaspSolver::ExternalPropagator::ExternalPropagator(ClaspSolver& cs) : cs(cs)
+ClaspSolver::ExternalPropagator::ExternalPropagator(ClaspSolver& cs, Clasp::Solver& solver) : cs(cs), solver(solver), nextNogood(cs.nogoodsOffset)
 {
 
-    cs.claspctx.master()->addPost(this);
+    solver.addPost(this);
     startAssignmentExtraction();
 
     // initialize propagation deferring
@@ -97,7 +98,7 @@ ClaspSolver::ExternalPropagator::ExternalPropagator(ClaspSolver& cs) : cs(cs)
 ClaspSolver::ExternalPropagator::~ExternalPropagator()
 {
     stopAssignmentExtraction();
-    cs.claspctx.master()->removePost(this);
+    solver.removePost(this);
 }
 
 
@@ -111,28 +112,28 @@ void ClaspSolver::ExternalPropagator::startAssignmentExtraction()
 
     // we need to extract the full assignment (only this time), to make sure that we did not miss any updates before initialization of this extractor
     DBGLOG(DBG, "Extracting full interpretation from clasp");
-    cs.extractClaspInterpretation(*cs.claspctx.master(), currentIntr, currentAssigned, currentChanged);
+    cs.extractClaspInterpretation(solver, currentIntr, currentAssigned, currentChanged);
 
     // add watches for all literals and decision levels
-    for (Clasp::SymbolTable::const_iterator it = cs.claspctx.master()->symbolTable().begin(); it != cs.claspctx.master()->symbolTable().end(); ++it) {
+    for (Clasp::SymbolTable::const_iterator it = solver.symbolTable().begin(); it != solver.symbolTable().end(); ++it) {
         // skip eliminated variables
         if (cs.claspctx.eliminated(it->second.lit.var())) continue;
 
-        uint32_t level = cs.claspctx.master()->level(it->second.lit.var());
+        uint32_t level = solver.level(it->second.lit.var());
         if (cs.claspToHex.size() > it->second.lit.index()) {
             BOOST_FOREACH (IDAddress adr, *cs.convertClaspSolverLitToHex(it->second.lit.index())) {
                 // add the variable to the undo watch for the decision level on which it was assigned
                 while (assignmentsOnDecisionLevel.size() < level + 1) {
                     assignmentsOnDecisionLevel.push_back(std::vector<IDAddress>());
                     DBGLOG(DBG, "Adding undo watch to level " << level);
-                    if (level > 0) cs.claspctx.master()->addUndoWatch(level, this);
+                    if (level > 0) solver.addUndoWatch(level, this);
                 }
             }
         }
 
         DBGLOG(DBG, "Adding watch for literal C:" << it->second.lit.index() << "/" << (it->second.lit.sign() ? "!" : "") << it->second.lit.var() << " and its negation");
-        cs.claspctx.master()->addWatch(it->second.lit, this);
-        cs.claspctx.master()->addWatch(Clasp::Literal(it->second.lit.var(), !it->second.lit.sign()), this);
+        solver.addWatch(it->second.lit, this);
+        solver.addWatch(Clasp::Literal(it->second.lit.var(), !it->second.lit.sign()), this);
     }
 }
 
@@ -141,20 +142,20 @@ void ClaspSolver::ExternalPropagator::stopAssignmentExtraction()
 {
 
     // remove watches for all literals
-    for (Clasp::SymbolTable::const_iterator it = cs.claspctx.master()->symbolTable().begin(); it != cs.claspctx.master()->symbolTable().end(); ++it) {
+    for (Clasp::SymbolTable::const_iterator it = solver.symbolTable().begin(); it != solver.symbolTable().end(); ++it) {
         // skip eliminated variables
         if (cs.claspctx.eliminated(it->second.lit.var())) continue;
 
         DBGLOG(DBG, "Removing watch for literal C:" << it->second.lit.index() << "/" << (it->second.lit.sign() ? "!" : "") << it->second.lit.var() << " and its negation");
-        cs.claspctx.master()->removeWatch(it->second.lit, this);
-        cs.claspctx.master()->removeWatch(Clasp::Literal(it->second.lit.var(), !it->second.lit.sign()), this);
+        solver.removeWatch(it->second.lit, this);
+        solver.removeWatch(Clasp::Literal(it->second.lit.var(), !it->second.lit.sign()), this);
     }
 
     // remove watches for all decision levels
     for (uint32_t i = 1; i < assignmentsOnDecisionLevel.size(); i++) {
-        //if (cs.claspctx.master()->validLevel(i)){
+        //if (solver.validLevel(i)){
         DBGLOG(DBG, "Removing watch for decision level " << i);
-        cs.claspctx.master()->removeUndoWatch(i, this);
+        solver.removeUndoWatch(i, this);
         //}
     }
 
@@ -171,6 +172,9 @@ void ClaspSolver::ExternalPropagator::callHexPropagators(Clasp::Solver& s)
 
     DBGLOG(DBG, "ExternalPropagator: Calling HEX-Propagator");
 
+    // clasp threads must not run HEX code concurrently
+    boost::recursive_mutex::scoped_lock lock(cs.hexMutex);
+
 #ifndef NDEBUG
     // extract model and compare with the incrementally extracted one
     InterpretationPtr fullyExtractedCurrentIntr = InterpretationPtr(new Interpretation(cs.reg));
@@ -202,13 +206,14 @@ bool ClaspSolver::ExternalPropagator::addNewNogoodsToClasp(Clasp::Solver& s)
 
     assert (!s.hasConflict() && "tried to add new nogoods while solver is in conflict");
 
+    boost::recursive_mutex::scoped_lock lock(cs.hexMutex);
+
     // add new clauses to clasp
-    DBGLOG(DBG, "ExternalPropagator: Adding new clauses to clasp (" << cs.nogoods.size() << " were prepared)");
+    DBGLOG(DBG, "ExternalPropagator: Adding new clauses to clasp (" << (cs.nogoodsOffset + cs.nogoods.size() - nextNogood) << " were prepared)");
     bool inconsistent = false;
-    Clasp::ClauseCreator cc(cs.claspctx.master());
-    std::list<Nogood>::iterator ngIt = cs.nogoods.begin();
-    while (ngIt != cs.nogoods.end()) {
-        const Nogood& ng = *ngIt;
+    Clasp::ClauseCreator cc(&solver);
+    while (nextNogood < cs.nogoodsOffset + cs.nogoods.size()) {
+        const Nogood& ng = cs.nogoods[nextNogood - cs.nogoodsOffset];
 
         TransformNogoodToClaspResult ngClasp = cs.nogoodToClaspClause(ng);
         if (!ngClasp.tautological && !ngClasp.outOfDomain) {
@@ -228,11 +233,11 @@ bool ClaspSolver::ExternalPropagator::addNewNogoodsToClasp(Clasp::Solver& s)
                 break;
             }
         }
-        ngIt++;
+        nextNogood++;
     }
 
-    // remove all processed nogoods
-    cs.nogoods.erase(cs.nogoods.begin(), ngIt);
+    // remove all nogoods which were processed by all solvers
+    cs.releaseProcessedNogoods();
     assert(!inconsistent || s.hasConflict());
     return inconsistent;
 }
@@ -331,7 +336,7 @@ Clasp::Constraint::PropResult ClaspSolver::ExternalPropagator::propagate(Clasp::
             while (assignmentsOnDecisionLevel.size() < level + 1) {
                 if(assignmentsOnDecisionLevel.size() > 0) {
                     DBGLOG(DBG, "Adding undo watch to level " << assignmentsOnDecisionLevel.size());
-                    cs.claspctx.master()->addUndoWatch(assignmentsOnDecisionLevel.size(), this);
+                    solver.addUndoWatch(assignmentsOnDecisionLevel.size(), this);
                 }
                 assignmentsOnDecisionLevel.push_back(std::vector<IDAddress>());
             }
@@ -349,7 +354,7 @@ Clasp::Constraint::PropResult ClaspSolver::ExternalPropagator::propagate(Clasp::
 
             // add the variable to the undo watch for the decision level on which it was assigned
             while (assignmentsOnDecisionLevel.size() < level + 1) {
-                if(assignmentsOnDecisionLevel.size() > 0) cs.claspctx.master()->addUndoWatch(assignmentsOnDecisionLevel.size(), this);
+                if(assignmentsOnDecisionLevel.size() > 0) solver.addUndoWatch(assignmentsOnDecisionLevel.size(), this);
                 assignmentsOnDecisionLevel.push_back(std::vector<IDAddress>());
             }
             assignmentsOnDecisionLevel[level].push_back(adr);
@@ -379,22 +384,11 @@ void ClaspSolver::ExternalPropagator::undoLevel(Clasp::Solver& s)
 
 // ============================== ClaspSolver ==============================
 
-std::string ClaspSolver::idAddressToString(IDAddress adr)
+namespace
 {
-    std::stringstream ss;
-    ss << adr;
-    return ss.str();
-}
-
-
-IDAddress ClaspSolver::stringToIDAddress(std::string str)
-{
-    #ifndef NDEBUG
-    if (str.find(":") != std::string::npos) {
-        str = str.substr(0, str.find(":"));
-    }
-    #endif
-    return atoi(str.c_str());
+    // clasp needs a name for every symbol, but the HEX atom behind a symbol is looked up in
+    // ClaspSolver::claspSymbolToHex by its key, thus all symbols can share the same name
+    const char* hexAtomSymbolName = "h";
 }
 
 
@@ -803,6 +797,18 @@ void ClaspSolver::interpretClaspCommandline(Clasp::Problem_t::Type type)
         || claspconfigstr == "trendy") claspconfigstr = "--configuration=" + claspconfigstr;
     // otherwise let the config string itself be parsed by clasp
 
+    // parallel search is configured via the clasp option --parallel-mode
+    int threads = ctx.config.getOption("ClaspThreads");
+    if (threads > 1 && !ctx.config.getOption("ClaspForceSingleThreaded")) {
+        #if WITH_THREADS
+        std::stringstream ss;
+        ss << " --parallel-mode=" << threads << "," << ctx.config.getStringOption("ClaspParallelMode");
+        claspconfigstr += ss.str();
+        #else
+        LOG(WARNING, "clasp was built without multi-threading support, ignoring --claspthreads=" << threads);
+        #endif
+    }
+
     DBGLOG(DBG, "Found configuration: " << claspconfigstr);
     try
     {
@@ -835,13 +841,33 @@ void ClaspSolver::interpretClaspCommandline(Clasp::Problem_t::Type type)
 
 void ClaspSolver::shutdownClasp()
 {
-    if (!!ep.get()) ep.reset();
+    stopParallelSolve();
+    deleteExternalPropagators();
     if (minc) { minc->destroy(claspctx.master(), true);  }
     if (sharedMinimizeData)   { sharedMinimizeData->release(); }
     resetAndResizeClaspToHex(0);
 }
 
 
+void ClaspSolver::createExternalPropagators()
+{
+    assert(eps.empty() && "external propagators were not deleted");
+    for (uint32_t i = 0; i < claspctx.concurrency(); ++i) {
+        DBGLOG(DBG, "Adding post propagator to clasp solver " << i);
+        eps.push_back(new ExternalPropagator(*this, *claspctx.solver(i)));
+    }
+}
+
+
+void ClaspSolver::deleteExternalPropagators()
+{
+    BOOST_FOREACH (ExternalPropagator* ep, eps) {
+        delete ep;
+    }
+    eps.clear();
+}
+
+
 ClaspSolver::TransformNogoodToClaspResult ClaspSolver::nogoodToClaspClause(const Nogood& ng, bool extendDomainIfNecessary)
 {
 
@@ -937,8 +963,8 @@ void ClaspSolver::prepareProblem(Clasp::Asp::LogicProgram& asp, const OrdinaryAS
             // create positive literal -> false
             storeHexToClasp(*en, Clasp::Literal(c, false));
 
-            std::string str = idAddressToString(*en);
-            asp.setAtomName(c, str.c_str());
+            storeClaspSymbolToHex(c, *en);
+            asp.setAtomName(c, hexAtomSymbolName);
         }
         en++;
     }
@@ -954,8 +980,8 @@ void ClaspSolver::prepareProblem(Clasp::Asp::LogicProgram& asp, const OrdinaryAS
                 // create positive literal -> false
                 storeHexToClasp(h.address, Clasp::Literal(c, false));
 
-                std::string str = idAddressToString(h.address);
-                asp.setAtomName(c, str.c_str());
+                storeClaspSymbolToHex(c, h.address);
+                asp.setAtomName(c, hexAtomSymbolName);
             }
         }
         BOOST_FOREACH (ID b, rule.body) {
@@ -966,8 +992,8 @@ void ClaspSolver::prepareProblem(Clasp::Asp::LogicProgram& asp, const OrdinaryAS
                 // create positive literal -> false
                 storeHexToClasp(b.address, Clasp::Literal(c, false));
 
-                std::string str = idAddressToString(b.address);
-                asp.setAtomName(c, str.c_str());
+                storeClaspSymbolToHex(c, b.address);
+                asp.setAtomName(c, hexAtomSymbolName);
             }
         }
     }
@@ -1034,10 +1060,10 @@ void ClaspSolver::updateSymbolTable()
 
     LOG(DBG, "Symbol table of optimized program:");
     for (Clasp::SymbolTable::const_iterator it = symTab.begin(); it != symTab.end(); ++it) {
-        std::string ss(it->second.name.c_str());
-        IDAddress hexAdr = stringToIDAddress(it->second.name.c_str());
+        assert(it->first < claspSymbolToHex.size() && claspSymbolToHex[it->first] != ID::ALL_ONES && "clasp symbol was not introduced by dlvhex");
+        IDAddress hexAdr = claspSymbolToHex[it->first];
         storeHexToClasp(hexAdr, it->second.lit);
-        DBGLOG(DBG, "H:" << hexAdr << " (" << reg->ogatoms.getByAddress(hexAdr).text <<  ") <--> "
+        DBGLOG(DBG, "H:" << hexAdr << " (" << printToString<RawPrinter>(reg->ogatoms.getIDByAddress(hexAdr), reg) <<  ") <--> "
             "C:" << it->second.lit.index() << "/" << (it->second.lit.sign() ? "!" : "") << it->second.lit.var());
         assert(it->second.lit.index() < claspToHex.size());
         AddressVector* &c2h = claspToHex[it->second.lit.index()];
@@ -1065,6 +1091,16 @@ void ClaspSolver::storeHexToClasp(IDAddress addr, Clasp::Literal lit, bool alsoS
 }
 
 
+void ClaspSolver::storeClaspSymbolToHex(uint32_t symbol, IDAddress addr)
+{
+
+    if(symbol >= claspSymbolToHex.size()) {
+        claspSymbolToHex.resize(symbol + 1, ID::ALL_ONES);
+    }
+    claspSymbolToHex[symbol] = addr;
+}
+
+
 void ClaspSolver::resetAndResizeClaspToHex(unsigned size)
 {
     DBGLOG(DBG, "resetAndResizeClaspToHex: current size is " << claspToHex.size());
@@ -1089,11 +1125,13 @@ Clasp::Literal ClaspSolver::convertHexToClaspSolverLit(IDAddress addr, bool regi
         uint32_t c = (registerVar ? claspctx.addVar(Clasp::Var_t::atom_var) : nextVar++);
         Clasp::Literal clasplit(c, inverseLits);
         storeHexToClasp(addr, clasplit, true);
-        std::string str = idAddressToString(addr);
+        storeClaspSymbolToHex(c, addr);
         #ifndef NDEBUG
-        str = str + ":" + RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(addr));
-        #endif
+        std::string str = RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(addr));
         claspctx.symbolTable().addUnique(c, str.c_str()).lit = clasplit;
+        #else
+        claspctx.symbolTable().addUnique(c, hexAtomSymbolName).lit = clasplit;
+        #endif
     }
     assert(addr < hexToClaspSolver.size());
     assert(hexToClaspSolver[addr] != noLiteral);
@@ -1107,11 +1145,13 @@ Clasp::Literal ClaspSolver::convertHexToClaspProgramLit(IDAddress addr, bool reg
         uint32_t c = (registerVar ? claspctx.addVar(Clasp::Var_t::atom_var) : nextVar++);
         Clasp::Literal clasplit(c, inverseLits);
         storeHexToClasp(addr, clasplit, true);
-        std::string str = idAddressToString(addr);
+        storeClaspSymbolToHex(c, addr);
         #ifndef NDEBUG
-        str = str + ":" + RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(addr));
-        #endif
+        std::string str = RawPrinter::toString(reg, reg->ogatoms.getIDByAddress(addr));
         claspctx.symbolTable().addUnique(c, str.c_str()).lit = clasplit;
+        #else
+        claspctx.symbolTable().addUnique(c, hexAtomSymbolName).lit = clasplit;
+        #endif
     }
     assert(addr < hexToClaspSolver.size());
     assert(hexToClaspSolver[addr] != noLiteral);
@@ -1125,6 +1165,23 @@ const ClaspSolver::AddressVector* ClaspSolver::convertClaspSolverLitToHex(int in
 }
 
 
+InterpretationPtr ClaspSolver::modelToInterpretation(const Clasp::Model& m)
+{
+    InterpretationPtr intr(new Interpretation(reg));
+    // go over all clasp variables
+    for(unsigned claspIndex = 0; claspIndex < claspToHex.size(); ++claspIndex) {
+        // check if they are true
+        if( m.isTrue(Clasp::Literal::fromIndex(claspIndex)) ) {
+            // set all corresponding bits
+            BOOST_FOREACH(IDAddress adr, *convertClaspSolverLitToHex(claspIndex)) {
+                intr->setFact(adr);
+            }
+        }
+    }
+    return intr;
+}
+
+
 void ClaspSolver::outputProject(InterpretationPtr intr)
 {
     if( !!intr && !!projectionMask ) {
@@ -1136,7 +1193,7 @@ void ClaspSolver::outputProject(InterpretationPtr intr)
 
 
 ClaspSolver::ClaspSolver(ProgramCtx& ctx, const AnnotatedGroundProgram& p, InterpretationConstPtr frozen)
-: nextVar(2), noLiteral(Clasp::Literal::fromRep(~0x0)), ctx(ctx), projectionMask(p.getGroundProgram().mask), minc(0), sharedMinimizeData(0), solve(0), ep(0), modelCount(0)
+: nextVar(2), noLiteral(Clasp::Literal::fromRep(~0x0)), ctx(ctx), projectionMask(p.getGroundProgram().mask), nogoodsOffset(0), minc(0), sharedMinimizeData(0), solve(0), parallelModelHandler(*this), handoffModelReady(false), handoffContinue(false), handoffStop(false), handoffFinished(false), parallelSolveRunning(false), modelCount(0)
 {
     reg = ctx.registry();
 
@@ -1160,7 +1217,8 @@ ClaspSolver::ClaspSolver(ProgramCtx& ctx, const AnnotatedGroundProgram& p, Inter
     modelEnumerator->init(claspctx, 0, config.solve.numModels);
 
     DBGLOG(DBG, "Finalizing initialization");
-    if (!claspctx.endInit()) {
+    // attach all solvers (threads) such that external propagators can be added to each of them
+    if (!claspctx.endInit(true)) {
         DBGLOG(DBG, "Program is inconsistent, aborting initialization");
         inconsistent = true;
         return;
@@ -1174,13 +1232,13 @@ ClaspSolver::ClaspSolver(ProgramCtx& ctx, const AnnotatedGroundProgram& p, Inter
     solve.reset(new Clasp::BasicSolve(*claspctx.master()));
     enumerationStarted = false;
 
-    DBGLOG(DBG, "Adding post propagator");
-    ep.reset(new ExternalPropagator(*this));
+    DBGLOG(DBG, "Adding post propagators");
+    createExternalPropagators();
 }
 
 
 ClaspSolver::ClaspSolver(ProgramCtx& ctx, const NogoodSet& ns, InterpretationConstPtr frozen)
-: nextVar(2), noLiteral(Clasp::Literal::fromRep(~0x0)), ctx(ctx), minc(0), sharedMinimizeData(0), solve(0), ep(0), modelCount(0)
+: nextVar(2), noLiteral(Clasp::Literal::fromRep(~0x0)), ctx(ctx), nogoodsOffset(0), minc(0), sharedMinimizeData(0), solve(0), parallelModelHandler(*this), handoffModelReady(false), handoffContinue(false), handoffStop(false), handoffFinished(false), parallelSolveRunning(false), modelCount(0)
 {
     reg = ctx.registry();
 
@@ -1204,7 +1262,8 @@ ClaspSolver::ClaspSolver(ProgramCtx& ctx, const NogoodSet& ns, InterpretationCon
     modelEnumerator->init(claspctx, 0, config.solve.numModels);
 
     DBGLOG(DBG, "Finalizing initialization");
-    if (!claspctx.endInit()) {
+    // attach all solvers (threads) such that external propagators can be added to each of them
+    if (!claspctx.endInit(true)) {
         DBGLOG(DBG, "SAT instance is unsatisfiable");
         inconsistent = true;
         return;
@@ -1243,8 +1302,8 @@ ClaspSolver::ClaspSolver(ProgramCtx& ctx, const NogoodSet& ns, InterpretationCon
     solve.reset(new Clasp::BasicSolve(*claspctx.master()));
     enumerationStarted = false;
 
-    DBGLOG(DBG, "Adding post propagator");
-    ep.reset(new ExternalPropagator(*this));
+    DBGLOG(DBG, "Adding post propagators");
+    createExternalPropagators();
 }
 
 
@@ -1262,8 +1321,9 @@ void ClaspSolver::addProgram(const AnnotatedGroundProgram& p, InterpretationCons
     DBGLOG(DBG, "Adding program component incrementally");
     nextSolveStep = Restart;
 
-    // remove post propagator to avoid that it tries the extract the assignment before the symbol table is updated
-    if (!!ep.get()) ep.reset();
+    // remove post propagators to avoid that they try the extract the assignment before the symbol table is updated
+    stopParallelSolve();
+    deleteExternalPropagators();
 
     // Update program
     asp.updateProgram();
@@ -1329,7 +1389,7 @@ void ClaspSolver::addProgram(const AnnotatedGroundProgram& p, InterpretationCons
     modelEnumerator->init(claspctx, 0, config.solve.numModels);
 
     DBGLOG(DBG, "Finalizing reinitialization");
-    if (!claspctx.endInit()) {
+    if (!claspctx.endInit(true)) {
         DBGLOG(DBG, "Program is inconsistent, aborting initialization");
         inconsistent = true;
         return;
@@ -1341,8 +1401,8 @@ void ClaspSolver::addProgram(const AnnotatedGroundProgram& p, InterpretationCons
     solve.reset(new Clasp::BasicSolve(*claspctx.master()));
     nextSolveStep = Restart;
 
-    DBGLOG(DBG, "Resetting post propagator");
-    ep.reset(new ExternalPropagator(*this));
+    DBGLOG(DBG, "Resetting post propagators");
+    createExternalPropagators();
 
     #ifndef NDEBUG
     std::stringstream ss;
@@ -1358,8 +1418,9 @@ void ClaspSolver::addNogoodSet(const NogoodSet& ns, InterpretationConstPtr froze
     assert(problemType == SAT && "programs can only be added in SAT mode");
     DBGLOG(DBG, "Adding set of nogoods incrementally");
 
-    // remove post propagator to avoid that it tries the extract the assignment before the symbol table is updated
-    if (!!ep.get()) ep.reset();
+    // remove post propagators to avoid that they try the extract the assignment before the symbol table is updated
+    stopParallelSolve();
+    deleteExternalPropagators();
 
     claspctx.unfreeze();
 
@@ -1414,7 +1475,7 @@ void ClaspSolver::addNogoodSet(const NogoodSet& ns, InterpretationConstPtr froze
     modelEnumerator->init(claspctx, 0, config.solve.numModels);
 
     DBGLOG(DBG, "Finalizing reinitialization");
-    if (!claspctx.endInit()) {
+    if (!claspctx.endInit(true)) {
         DBGLOG(DBG, "Program is inconsistent, aborting initialization");
         inconsistent = true;
         return;
@@ -1426,8 +1487,8 @@ void ClaspSolver::addNogoodSet(const NogoodSet& ns, InterpretationConstPtr froze
     solve.reset(new Clasp::BasicSolve(*claspctx.master()));
     nextSolveStep = Restart;
 
-    DBGLOG(DBG, "Resetting post propagator");
-    ep.reset(new ExternalPropagator(*this));
+    DBGLOG(DBG, "Resetting post propagators");
+    createExternalPropagators();
 }
 
 
@@ -1435,6 +1496,7 @@ void ClaspSolver::restartWithAssumptions(const std::vector<ID>& assumptions)
 {
 
     DBGLOG(DBG, "Restarting search");
+    stopParallelSolve();
 
     if (inconsistent) {
         DBGLOG(DBG, "Program is unconditionally inconsistent, ignoring assumptions");
@@ -1481,10 +1543,26 @@ void ClaspSolver::addNogood(Nogood ng)
         else { assert(lit.isNaf() && !isMappedToClaspLiteral(lit.address) && "conditions are logically incomplete"); }
     }
 
+    boost::recursive_mutex::scoped_lock lock(hexMutex);
     nogoods.push_back(ng2);
 }
 
 
+void ClaspSolver::releaseProcessedNogoods()
+{
+    if (eps.empty()) return;
+
+    std::size_t processed = eps[0]->getNextNogood();
+    for (unsigned i = 1; i < eps.size(); ++i) {
+        processed = std::min(processed, eps[i]->getNextNogood());
+    }
+    while (nogoodsOffset < processed) {
+        nogoods.pop_front();
+        nogoodsOffset++;
+    }
+}
+
+
 // this method is called before asking for the next model
 // therefore it can be called with the same optimum multiple times
 void ClaspSolver::setOptimum(std::vector<int>& optimum)
@@ -1546,6 +1624,8 @@ InterpretationPtr ClaspSolver::getNextModel()
 
     DBGLOG(DBG, "ClaspSolver::getNextModel");
 
+    if (isParallel()) return getNextModelParallel();
+
     // ReturnModel is the only step which allows for interrupting the algorithm, i.e., leaving this loop
     while (nextSolveStep != ReturnModel) {
         bool optContinue = false;
@@ -1619,17 +1699,7 @@ InterpretationPtr ClaspSolver::getNextModel()
                     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "ClaspSlv::gNM ext");
                     // Note: currentIntr does not necessarily coincide with the last model because clasp
                     // possibly has already continued the search at this point
-                    model = InterpretationPtr(new Interpretation(reg));
-                    // go over all clasp variables
-                    for(unsigned claspIndex = 0; claspIndex < claspToHex.size(); ++claspIndex) {
-                        // check if they are true
-                        if( modelEnumerator->lastModel().isTrue(Clasp::Literal::fromIndex(claspIndex)) ) {
-                            // set all corresponding bits
-                            BOOST_FOREACH(IDAddress adr, *convertClaspSolverLitToHex(claspIndex)) {
-                                model->setFact(adr);
-                            }
-                        }
-                    }
+                    model = modelToInterpretation(modelEnumerator->lastModel());
                 }
 
                 outputProject(model);
@@ -1713,6 +1783,179 @@ InterpretationPtr ClaspSolver::getNextModel()
 }
 
 
+// ============================== parallel search ==============================
+
+/*
+  With more than one clasp solver (see --claspthreads), the search is done by clasp's parallel
+  solve algorithm in a background thread. Each model is passed from the clasp thread which found it
+  to getNextModel; this thread then waits until the next model is requested.
+
+  HEX code is not thread-safe, therefore it is serialized by hexMutex: the clasp threads acquire it
+  when calling HEX propagators or accessing the nogood queue, while the thread which uses
+  ClaspSolver holds it all the time except when it waits for a model.
+*/
+
+bool ClaspSolver::ParallelModelHandler::onModel(const Clasp::Solver& s, const Clasp::Model& m)
+{
+    return cs.onParallelModel(s, m);
+}
+
+
+bool ClaspSolver::isParallel() const
+{
+    // optimization problems are solved sequentially
+    return claspctx.concurrency() > 1 && !minc;
+}
+
+
+void ClaspSolver::startParallelSolve()
+{
+    assert(!parallelSolveRunning && "parallel search is already running");
+    DBGLOG(DBG, "Starting parallel search with " << claspctx.concurrency() << " clasp threads");
+
+    parallelSolve.reset(config.solve.createSolveObject());
+    parallelSolve->setEnumerator(*modelEnumerator);
+
+    handoffModel.reset();
+    handoffModelReady = false;
+    handoffContinue = false;
+    handoffStop = false;
+    handoffFinished = false;
+    handoffError.clear();
+
+    hexMutex.lock();
+    parallelSolveRunning = true;
+    parallelSolveThread = boost::thread(boost::bind(&ClaspSolver::runParallelSolve, this));
+}
+
+
+void ClaspSolver::stopParallelSolve()
+{
+    if (!parallelSolveRunning) return;
+    DBGLOG(DBG, "Stopping parallel search");
+
+    bool finished;
+    {
+        boost::mutex::scoped_lock lock(handoffMutex);
+        handoffStop = true;
+        finished = handoffFinished;
+        handoffCondition.notify_all();
+    }
+    if (!finished) parallelSolve->interrupt();
+
+    // let clasp threads which wait for HEX code finish their work
+    hexMutex.unlock();
+    parallelSolveThread.join();
+    parallelSolveRunning = false;
+    parallelSolve.reset();
+}
+
+
+void ClaspSolver::runParallelSolve()
+{
+    std::string error;
+    try
+    {
+        parallelSolve->solve(claspctx, assumptions, &parallelModelHandler);
+    }
+    catch(const std::exception& e) {
+        error = e.what();
+    }
+    catch(...) {
+        error = "unknown exception";
+    }
+
+    boost::mutex::scoped_lock lock(handoffMutex);
+    handoffError = error;
+    handoffFinished = true;
+    handoffCondition.notify_all();
+}
+
+
+bool ClaspSolver::onParallelModel(const Clasp::Solver& s, const Clasp::Model& m)
+{
+    DBGLOG(DBG, "Clasp solver " << s.id() << " found a model");
+    InterpretationPtr intr = modelToInterpretation(m);
+
+    boost::mutex::scoped_lock lock(handoffMutex);
+    while (handoffModelReady && !handoffStop) handoffCondition.wait(lock);
+    if (handoffStop) return false;
+
+    handoffModel = intr;
+    handoffModelReady = true;
+    handoffContinue = false;
+    handoffCondition.notify_all();
+
+    // wait until the next model is requested
+    while (!handoffContinue && !handoffStop) handoffCondition.wait(lock);
+    return !handoffStop;
+}
+
+
+InterpretationPtr ClaspSolver::getNextModelParallel()
+{
+
+    if (nextSolveStep == Restart) {
+        stopParallelSolve();
+        if (inconsistent) {
+            DBGLOG(DBG, "Program is unconditionally inconsistent");
+            nextSolveStep = ReturnModel;
+            return InterpretationPtr();
+        }
+
+        DBGLOG(DBG, "Adding step literal to assumptions");
+        assumptions.push_back(claspctx.stepLiteral());
+        startParallelSolve();
+        nextSolveStep = Solve;
+    }
+    else if (nextSolveStep == ReturnModel) {
+        // we stay in this state until restart
+        return InterpretationPtr();
+    }
+
+    std::string error;
+    {
+        DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "ClaspSlv::gNM sol (parallel)");
+
+        // clasp threads may run HEX code while we wait
+        hexMutex.unlock();
+        {
+            boost::mutex::scoped_lock lock(handoffMutex);
+            handoffContinue = true;
+            handoffCondition.notify_all();
+            while (!handoffModelReady && !handoffFinished) handoffCondition.wait(lock);
+
+            if (handoffModelReady) {
+                model = handoffModel;
+                handoffModel.reset();
+                handoffModelReady = false;
+                handoffCondition.notify_all();
+            }
+            else {
+                model = InterpretationPtr();
+                error = handoffError;
+            }
+        }
+        hexMutex.lock();
+    }
+
+    if (!error.empty()) {
+        nextSolveStep = ReturnModel;
+        throw GeneralError("Parallel clasp search failed: " + error);
+    }
+
+    if (!!model) {
+        outputProject(model);
+        modelCount++;
+    }
+    else {
+        nextSolveStep = ReturnModel;
+    }
+    DBGLOG(DBG, "Returning " << (!model ? "empty " :"") << "model");
+    return model;
+}
+
+
 int ClaspSolver::getModelCount()
 {
     return modelCount;
@@ -1721,9 +1964,17 @@ int ClaspSolver::getModelCount()
 
 std::string ClaspSolver::getStatistics()
 {
+    // sum up over all solvers (threads)
+    Clasp::uint64 choices = 0;
+    Clasp::uint64 conflicts = 0;
+    for (uint32_t i = 0; i < claspctx.concurrency(); ++i) {
+        choices += claspctx.solver(i)->stats.choices;
+        conflicts += claspctx.solver(i)->stats.conflicts;
+    }
+
     std::stringstream ss;
-    ss << "Guesses: " << claspctx.master()->stats.choices << std::endl <<
-        "Conflicts: " << claspctx.master()->stats.conflicts << std::endl <<
+    ss << "Guesses: " << choices << std::endl <<
+        "Conflicts: " << conflicts << std::endl <<
         "Models: " << modelCount;
     return ss.str();
 }
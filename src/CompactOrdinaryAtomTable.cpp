@@ -0,0 +1,183 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   CompactOrdinaryAtomTable.cpp
+ *
+ * @brief  Implementation of the columnar, memory-compact ordinary atom table.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/CompactOrdinaryAtomTable.h"
+#include "dlvhex2/Logger.h"
+
+#include <algorithm>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace
+{
+    // initial number of slots of the hash table (must be a power of two)
+    const std::size_t InitialSlots = 64;
+}
+
+const uint32_t CompactOrdinaryAtomTable::EmptySlot;
+
+CompactOrdinaryAtomTable::CompactOrdinaryAtomTable():
+offsets(1, 0),
+slots(InitialSlots, EmptySlot)
+{
+}
+
+
+IDAddress CompactOrdinaryAtomTable::findTuple(const Tuple& tuple, uint32_t hash, std::size_t& slot) const
+{
+    const std::size_t mask = slots.size() - 1;
+    for(slot = hash & mask; slots[slot] != EmptySlot; slot = (slot + 1) & mask) {
+        const IDAddress addr = slots[slot];
+        if( hashes[addr] != hash )
+            continue;
+        const uint32_t begin = offsets[addr];
+        if( offsets[addr + 1] - begin != tuple.size() )
+            continue;
+        if( std::equal(tuple.begin(), tuple.end(), arena.begin() + begin) )
+            return addr;
+    }
+    return ID_FAIL.address;
+}
+
+
+ID CompactOrdinaryAtomTable::append(IDKind kind, const Tuple& tuple, uint32_t hash, std::size_t slot)
+{
+    assert(ID(kind,0).isOrdinaryAtom());
+    assert(!tuple.empty());
+    const IDAddress addr = kinds.size();
+    kinds.push_back(kind);
+    hashes.push_back(hash);
+    arena.insert(arena.end(), tuple.begin(), tuple.end());
+    offsets.push_back(arena.size());
+    slots[slot] = addr;
+
+    // keep the load factor below 0.75 such that probe sequences stay short
+    if( 4 * kinds.size() > 3 * slots.size() )
+        grow();
+    return ID(kind, addr);
+}
+
+
+void CompactOrdinaryAtomTable::grow()
+{
+    std::vector<uint32_t> newslots(2 * slots.size(), EmptySlot);
+    const std::size_t mask = newslots.size() - 1;
+    for(IDAddress addr = 0; addr < kinds.size(); ++addr) {
+        std::size_t slot = hashes[addr] & mask;
+        while( newslots[slot] != EmptySlot )
+            slot = (slot + 1) & mask;
+        newslots[slot] = addr;
+    }
+    slots.swap(newslots);
+}
+
+
+ID CompactOrdinaryAtomTable::storeAndGetID(const OrdinaryAtom& atom) throw ()
+{
+    assert(ID(atom.kind,0).isAtom());
+    assert(ID(atom.kind,0).isOrdinaryAtom());
+    assert(!atom.tuple.empty());
+
+    const uint32_t hash = hashTuple(&atom.tuple[0], atom.tuple.size());
+    WriteLock lock(mutex);
+    std::size_t slot;
+    IDAddress existing = findTuple(atom.tuple, hash, slot);
+    if( existing != ID_FAIL.address ) {
+        LOG(ERROR,"atom '" << atom << "' already stored in compact ordinary atom table");
+        assert(false);
+        return ID(kinds[existing], existing);
+    }
+    ID ret = append(atom.kind, atom.tuple, hash, slot);
+    DBGLOG(DBG,"CompactOrdinaryAtomTable stored atom " << atom << " got ID " << ret);
+    return ret;
+}
+
+
+ID CompactOrdinaryAtomTable::getIDByTupleOrStore(IDKind kind, const Tuple& tuple) throw ()
+{
+    assert(!tuple.empty());
+    const uint32_t hash = hashTuple(&tuple[0], tuple.size());
+    WriteLock lock(mutex);
+    std::size_t slot;
+    IDAddress existing = findTuple(tuple, hash, slot);
+    if( existing != ID_FAIL.address )
+        return ID(kinds[existing], existing);
+    return append(kind, tuple, hash, slot);
+}
+
+
+void CompactOrdinaryAtomTable::clear()
+{
+    WriteLock lock(mutex);
+    kinds.clear();
+    hashes.clear();
+    arena.clear();
+    offsets.assign(1, 0);
+    slots.assign(InitialSlots, EmptySlot);
+}
+
+
+std::size_t CompactOrdinaryAtomTable::getMemoryUsage() const
+{
+    ReadLock lock(mutex);
+    return kinds.capacity() * sizeof(IDKind) +
+        offsets.capacity() * sizeof(uint32_t) +
+        hashes.capacity() * sizeof(uint32_t) +
+        arena.capacity() * sizeof(ID) +
+        slots.capacity() * sizeof(uint32_t);
+}
+
+
+std::ostream& CompactOrdinaryAtomTable::print(std::ostream& o) const
+{
+    ReadLock lock(mutex);
+    o << "CompactOrdinaryAtomTable with " << kinds.size() << " atoms:" << std::endl;
+    for(IDAddress addr = 0; addr < kinds.size(); ++addr) {
+        Tuple tuple(arena.begin() + offsets[addr], arena.begin() + offsets[addr + 1]);
+        o << "  " << ID(kinds[addr], addr) << " -> " << printvector(tuple);
+        if( !textBuilder.empty() )
+            o << " '" << textBuilder(tuple) << "'";
+        o << std::endl;
+    }
+    return o;
+}
+
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -266,7 +266,7 @@ struct handle_fact
 
         // TODO lookup by string in registry, then by tuple
         ID id = state.registry->ogatoms.getIDByTuple(atom.tuple);
-        if( id == ID_FAIL ) { {
+        if( id == ID_FAIL ) { if( !state.registry->hasLazyAtomText() ) {
                 WARNING("parsing efficiency problem see HexGrammarPTToASTConverter")
                     std::stringstream ss;
                 RawPrinter printer(ss, state.registry);
@@ -67,6 +67,7 @@ ExtSourceProperties& ExtSourceProperties::operator|=(const ExtSourceProperties&
     caresAboutAssigned |= prop2.caresAboutAssigned;
     caresAboutChanged |= prop2.caresAboutChanged;
     providesPartialAnswer |= prop2.providesPartialAnswer;
+    persistentlyCacheable |= prop2.persistentlyCacheable;
     atomDependencies.insert(prop2.atomDependencies.begin(), prop2.atomDependencies.end());
     complCheck = prop2.complCheck;
     return *this;
@@ -293,6 +294,11 @@ void ExtSourceProperties::interpretProperties(RegistryPtr reg, const ExternalAto
             DBGLOG(DBG, "External Atom provides partial answer");
             providesPartialAnswer = true;
         }
+        else if (name == "persistentcache") {
+            if (param1 != ID_FAIL || param2 != ID_FAIL) throw GeneralError("Property \"persistentcache\" expects no parameters");
+            DBGLOG(DBG, "External Atom answers may be cached across runs");
+            persistentlyCacheable = true;
+        }
         else {
             throw SyntaxError("Property \"" + name + "\" unrecognized");
         }
@@ -152,14 +152,14 @@ bool ExternalAtomEvaluationHeuristicsInputComplete::doEvaluate(const ExternalAto
 
     eatom.updatePredicateInputMask();
 
-    bool aux = true;
-    if (eatom.auxInputPredicate != ID_FAIL) {
-        aux = (eatom.getAuxInputMask()->getStorage() & programMask->getStorage() & assigned->getStorage()).count() == (eatom.getAuxInputMask()->getStorage() & programMask->getStorage()).count();
-    }
+    if (!assigned)
+        return true;
 
-    return !assigned ||
-        (((eatom.getPredicateInputMask()->getStorage() & programMask->getStorage() & assigned->getStorage()).count() == (eatom.getPredicateInputMask()->getStorage() & programMask->getStorage()).count()) &&
-        aux);
+    // all input atoms which occur in the program must be assigned
+    if (eatom.auxInputPredicate != ID_FAIL &&
+        !programMask->getMaskedView(*eatom.getAuxInputMask()).isSubsetOf(assigned->getStorage()))
+        return false;
+    return programMask->getMaskedView(*eatom.getPredicateInputMask()).isSubsetOf(assigned->getStorage());
 }
 
 
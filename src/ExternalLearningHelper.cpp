@@ -384,7 +384,7 @@ void ExternalLearningHelper::learnFromInputOutputBehavior(const PluginAtom::Quer
                     // store the ID of answer atom that should still be contained in answer after minimization
                     ID ansID;
 
-                    BOOST_FOREACH(ID& iid, newNogoodsContainer.getNogood(i)) {
+                    BOOST_FOREACH(ID iid, newNogoodsContainer.getNogood(i)) {
                         if (query.ctx->registry()->ogatoms.getIDByAddress(iid.address).isExternalAuxiliary()) {
                             ansID = iid;
                         }
@@ -419,7 +419,7 @@ void ExternalLearningHelper::learnFromInputOutputBehavior(const PluginAtom::Quer
 
                             // iteratively remove each literal from nogood
 
-                            BOOST_FOREACH(ID& iid, newNogoodsContainer.getNogood(i)) {
+                            BOOST_FOREACH(ID iid, newNogoodsContainer.getNogood(i)) {
                                 // only for non-auxiliaries
                                 if (iid != ansID) {
                                     PluginAtom::Answer ans;
@@ -710,7 +710,7 @@ void ExternalLearningHelper::learnFromNegativeAtoms(const PluginAtom::Query& que
                     // store the ID of answer atom that should still not be contained in answer after minimization
                     ID ansID;
 
-                    BOOST_FOREACH(ID& iid, newNogoodsContainer.getNogood(i)) {
+                    BOOST_FOREACH(ID iid, newNogoodsContainer.getNogood(i)) {
                         if (externalAuxiliaryTable.find(iid) != externalAuxiliaryTable.end()) {
                             ansID = iid;
                         }
@@ -746,7 +746,7 @@ void ExternalLearningHelper::learnFromNegativeAtoms(const PluginAtom::Query& que
 
                             // iteratively remove each literal from nogood
 
-                            BOOST_FOREACH(ID& iid, newNogoodsContainer.getNogood(i)) {
+                            BOOST_FOREACH(ID iid, newNogoodsContainer.getNogood(i)) {
                                 // only for non-auxiliaries
                                 if (iid != ansID) {
                                     PluginAtom::Answer ans;
@@ -192,14 +192,21 @@ std::ostream& o, bool verbose) const
 
 GenuineGuessAndCheckModelGenerator::GenuineGuessAndCheckModelGenerator(
 Factory& factory,
-InterpretationConstPtr input):
+InterpretationConstPtr input,
+const std::vector<ID>& cube):
 FLPModelGeneratorBase(factory, input),
 factory(factory),
 reg(factory.reg),
 cmModelCount(0),
 unitInput(input),
 haveInconsistencyCause(false),
-guessingProgram(factory.reg)
+guessingProgram(factory.reg),
+usePersistentInstance(false),
+cube(cube),
+coordinator(0),
+cubeEnumeration(false),
+runningCubeWorkers(0),
+cubeStop(false)
 {
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidconstruct, "genuine g&c mg constructor");
     DBGLOG(DBG, "Genuine GnC-ModelGenerator is instantiated for a " << (factory.ci.disjunctiveHeads ? "" : "non-") << "disjunctive component");
@@ -354,8 +361,17 @@ guessingProgram(factory.reg)
 */
     }
 
+    // reuse the ground program (and possibly the solver) of previous model generators of this unit (parallel enumeration shares it between the workers);
+    // trans-unit learning and inlining modify the program depending on the input, thus they need a fresh instance
+    usePersistentInstance = (factory.ctx.config.getOption("PersistentUnits") || factory.ctx.config.getOption("EnumerationThreads") > 1) &&
+        !factory.ctx.config.getOption("TransUnitLearning") &&
+        !factory.ctx.config.getOption("TransUnitLearningOS") &&
+        !factory.ctx.config.getOption("ExternalSourceInlining");
+
     // evaluate edb+xidb+gidb
-    {
+    if (usePersistentInstance) {
+        initializeFromPersistentInstance(postprocInput);
+    }else{
         DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"genuine g&c init guessprog");
         DBGLOG(DBG,"evaluating guessing program");
 
@@ -445,13 +461,106 @@ guessingProgram(factory.reg)
     initializeVerificationWatchLists();
 
     updateEANogoods(InterpretationConstPtr());
+
+    // parallel enumeration (optimization needs the models in the order of the sequential search)
+    int threads = factory.ctx.config.getOption("EnumerationThreads");
+    if (cube.empty() && threads > 1 && usePersistentInstance && !factory.ctx.config.getOption("Optimization")) {
+        createCubes(threads);
+    }
 }
 
 GenuineGuessAndCheckModelGenerator::~GenuineGuessAndCheckModelGenerator()
 {
+    stopCubeEnumeration();
+
     DBGLOG(DBG, "Removing propagator to solver");
     solver->removePropagator(this);
     DBGLOG(DBG, "Final Statistics:" << std::endl << solver->getStatistics());
+
+    // hand the solver on to the next model generator
+    if (usePersistentInstance && !!factory.persistentInstance && factory.persistentInstance->solver == solver) {
+        factory.persistentInstance->solverInUse = false;
+    }
+}
+
+void GenuineGuessAndCheckModelGenerator::initializeFromPersistentInstance(InterpretationConstPtr postprocInput)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"genuine g&c init persistent instance");
+
+    // everything besides the EDB may change from one model generator to the next
+    InterpretationPtr inputAtoms(new Interpretation(reg));
+    inputAtoms->getStorage() = postprocInput->getStorage() - factory.ctx.edb->getStorage();
+
+    Factory::PersistentInstancePtr& pi = factory.persistentInstance;
+    if (!pi || (inputAtoms->getStorage() - pi->inputDomain->getStorage()).any()) {
+        DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpersistentground, "Persistent unit groundings", 1);
+        DBGLOG(DBG, "Input is not covered by the persistent instance, grounding the unit over the extended input domain");
+
+        Factory::PersistentInstancePtr npi(new Factory::PersistentInstance());
+        npi->inputDomain.reset(new Interpretation(reg));
+        if (!!pi) npi->inputDomain->add(*pi->inputDomain);
+        npi->inputDomain->add(*inputAtoms);
+        npi->mask.reset(new Interpretation(reg));
+        npi->solverInUse = false;
+        // ground nogoods learned from external atoms remain valid for the new instance
+        npi->eaNogoods = !!pi ? pi->eaNogoods : SimpleNogoodContainerPtr(new SimpleNogoodContainer());
+
+        // the EDB remains factual, while each input atom a is guessed by "a v a'"
+        OrdinaryASPProgram program(reg, factory.xidb, factory.ctx.edb, factory.ctx.maxint);
+        program.idb.insert(program.idb.end(), factory.gidb.begin(), factory.gidb.end());
+        bm::bvector<>::enumerator en = npi->inputDomain->getStorage().first();
+        bm::bvector<>::enumerator en_end = npi->inputDomain->getStorage().end();
+        while (en < en_end) {
+            Rule inputGuess(ID::MAINKIND_RULE | ID::SUBKIND_RULE_REGULAR | ID::PROPERTY_RULE_DISJ);
+            inputGuess.head.push_back(reg->ogatoms.getIDByAddress(*en));
+            inputGuess.head.push_back(getAuxiliaryAtom('x', inputGuess.head[0]));
+            npi->mask->setFact(inputGuess.head[1].address);
+            program.idb.push_back(reg->storeRule(inputGuess));
+            en++;
+        }
+
+        npi->grounder = GenuineGrounder::getInstance(factory.ctx, program);
+        DLVHEX_BENCHMARK_REGISTER_AND_START(sidhexground, "HEX grounder time");
+        OrdinaryASPProgram gp = npi->grounder->getGroundProgram();
+        DLVHEX_BENCHMARK_STOP(sidhexground);
+        // do not project within the solver as auxiliaries might be relevant for UFS checking (projection is done in G&C mg)
+        if (!!gp.mask) npi->mask->add(*gp.mask);
+        gp.mask = InterpretationConstPtr();
+        npi->annotatedGroundProgram = AnnotatedGroundProgram(factory.ctx, gp, factory.innerEatoms);
+        pi = npi;
+    }else{
+        DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidpersistentreuse, "Persistent unit reuses", 1);
+    }
+
+    grounder = pi->grounder;
+    annotatedGroundProgram = pi->annotatedGroundProgram;
+    mask->add(*pi->mask);
+    activeInnerEatoms = factory.innerEatoms;
+
+    // the internal solver keeps its blocked models over restarts, thus only clasp instances are handed on
+    if (cube.empty() && !!pi->solver && !pi->solverInUse) {
+        DBGLOG(DBG, "Reusing solver of the persistent instance");
+        solver = pi->solver;
+    }else{
+        // input atoms are fixed by assumptions and must not be eliminated by the solver;
+        // cube atoms must not be frozen as this would drop their support constraints
+        solver = GenuineGroundSolver::getInstance(factory.ctx, annotatedGroundProgram, pi->inputDomain);
+        for (int i = 0; i < pi->eaNogoods->getNogoodCount(); ++i) learnedEANogoods->addNogood(pi->eaNogoods->getNogood(i));
+        if (cube.empty() && !pi->solver && factory.ctx.config.getOption("GenuineSolver") >= 3) pi->solver = solver;
+    }
+    if (pi->solver == solver) pi->solverInUse = true;
+
+    // fix the input domain to the actual input
+    std::vector<ID> inputAssumptions;
+    bm::bvector<>::enumerator en = pi->inputDomain->getStorage().first();
+    bm::bvector<>::enumerator en_end = pi->inputDomain->getStorage().end();
+    while (en < en_end) {
+        ID atomID = reg->ogatoms.getIDByAddress(*en);
+        inputAssumptions.push_back(inputAtoms->getFact(*en) ? ID::posLiteralFromAtom(atomID) : ID::nafLiteralFromAtom(atomID));
+        en++;
+    }
+    inputAssumptions.insert(inputAssumptions.end(), cube.begin(), cube.end());
+    solver->restartWithAssumptions(inputAssumptions);
 }
 
 ID GenuineGuessAndCheckModelGenerator::getAuxiliaryAtom(char type, ID id){
@@ -868,6 +977,8 @@ InterpretationPtr GenuineGuessAndCheckModelGenerator::generateNextModel()
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidhexsolve, "HEX solver time (gNM GenGnC)");
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidhexsolve2, "HEX solver time");
 
+    if (cubeEnumeration) return generateNextModelFromCubes();
+
     InterpretationPtr modelCandidate;
     do {
         LOG(DBG,"asking for next model");
@@ -879,6 +990,10 @@ InterpretationPtr GenuineGuessAndCheckModelGenerator::generateNextModel()
         if (factory.ctx.config.getOption("OptimizationByBackend")) solver->setOptimum(factory.ctx.currentOptimum);
         modelCandidate = solver->getNextModel();
 
+        // workers of a parallel enumeration search concurrently, but the checks below run HEX code
+        boost::unique_lock<boost::recursive_mutex> hexLock;
+        if (!!coordinator) hexLock = boost::unique_lock<boost::recursive_mutex>(coordinator->hexMutex);
+
         DBGLOG(DBG, "Statistics:" << std::endl << solver->getStatistics());
         if( !modelCandidate ) {
             // compute reasons
@@ -928,6 +1043,196 @@ InterpretationPtr GenuineGuessAndCheckModelGenerator::generateNextModel()
     }while(true);
 }
 
+// ============================== parallel enumeration ==============================
+
+/*
+  With EnumerationThreads > 1, the model generator created by the factory partitions the search space
+  into cubes and becomes the coordinator: worker threads take the cubes one after the other and enumerate
+  their models with model generators whose solver assumes the cube. All of them share the persistent
+  ground program of the unit. The models are passed to the coordinator through a small buffer.
+
+  Solving is done concurrently, while HEX code (external sources, registry, nogood containers) is
+  serialized by hexMutex of the coordinator: workers acquire it for everything besides the search of
+  their solver, while the main thread holds it all the time except when it waits for a model.
+*/
+
+void GenuineGuessAndCheckModelGenerator::createCubes(int threads)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "genuine g&c create cubes");
+
+    // a few cubes per thread keep the workers busy even if the cubes differ in difficulty
+    uint32_t cubeAtomCount = 2;
+    while ((1 << cubeAtomCount) < 4 * threads) cubeAtomCount++;
+
+    // count the occurrences of atoms in the ground program
+    boost::unordered_map<IDAddress, int> occurrences;
+    BOOST_FOREACH (ID ruleID, annotatedGroundProgram.getGroundProgram().idb) {
+        const Rule& rule = reg->rules.getByID(ruleID);
+        BOOST_FOREACH (ID h, rule.head) occurrences[h.address]++;
+        BOOST_FOREACH (ID b, rule.body) {
+            if (b.isOrdinaryGroundAtom()) occurrences[b.address]++;
+        }
+    }
+
+    // prefer positive replacement atoms as they split the search space along the guesses of external atoms;
+    // other atoms must be visible in the models as otherwise different cubes could yield the same answer set
+    factory.gpMask.updateMask();
+    factory.gnMask.updateMask();
+    typedef std::pair<int, IDAddress> OccurrenceAtomPair;
+    std::vector<OccurrenceAtomPair> replacementCandidates, ordinaryCandidates;
+    typedef std::pair<IDAddress, int> AtomOccurrencePair;
+    BOOST_FOREACH (const AtomOccurrencePair& ao, occurrences) {
+        if (factory.gpMask.mask()->getFact(ao.first)) {
+            replacementCandidates.push_back(OccurrenceAtomPair(ao.second, ao.first));
+        }else if (!mask->getFact(ao.first) && !factory.gnMask.mask()->getFact(ao.first) && !reg->ogatoms.getIDByAddress(ao.first).isAuxiliary()) {
+            ordinaryCandidates.push_back(OccurrenceAtomPair(ao.second, ao.first));
+        }
+    }
+    std::sort(replacementCandidates.begin(), replacementCandidates.end(), std::greater<OccurrenceAtomPair>());
+    std::sort(ordinaryCandidates.begin(), ordinaryCandidates.end(), std::greater<OccurrenceAtomPair>());
+
+    std::vector<ID> cubeAtoms;
+    for (uint32_t i = 0; i < replacementCandidates.size() && cubeAtoms.size() < cubeAtomCount; ++i) {
+        cubeAtoms.push_back(reg->ogatoms.getIDByAddress(replacementCandidates[i].second));
+    }
+    for (uint32_t i = 0; i < ordinaryCandidates.size() && cubeAtoms.size() < cubeAtomCount; ++i) {
+        cubeAtoms.push_back(reg->ogatoms.getIDByAddress(ordinaryCandidates[i].second));
+    }
+    if (cubeAtoms.empty()) {
+        DBGLOG(DBG, "No atoms to split the search space, enumerating sequentially");
+        return;
+    }
+    DBGLOG(DBG, "Splitting the search space along " << printManyToString<RawPrinter>(cubeAtoms, ",", reg));
+
+    // one cube for each truth assignment to the cube atoms
+    for (uint32_t c = 0; c < (1u << cubeAtoms.size()); ++c) {
+        std::vector<ID> literals;
+        for (uint32_t i = 0; i < cubeAtoms.size(); ++i) {
+            literals.push_back((c & (1u << i)) ? ID::posLiteralFromAtom(cubeAtoms[i]) : ID::nafLiteralFromAtom(cubeAtoms[i]));
+        }
+        pendingCubes.push_back(literals);
+    }
+    DLVHEX_BENCHMARK_REGISTER_AND_COUNT(sidcubes, "Cubes of parallel enumerations", pendingCubes.size());
+    cubeEnumeration = true;
+}
+
+
+void GenuineGuessAndCheckModelGenerator::startCubeEnumeration(int threads)
+{
+    DBGLOG(DBG, "Starting parallel enumeration of " << pendingCubes.size() << " cubes with " << threads << " threads");
+
+    hexMutex.lock();
+    runningCubeWorkers = threads;
+    for (int i = 0; i < threads; ++i) {
+        cubeWorkers.create_thread(boost::bind(&GenuineGuessAndCheckModelGenerator::runCubeWorker, this));
+    }
+}
+
+
+void GenuineGuessAndCheckModelGenerator::stopCubeEnumeration()
+{
+    if (cubeWorkers.size() == 0) return;
+    DBGLOG(DBG, "Stopping parallel enumeration");
+
+    {
+        boost::mutex::scoped_lock lock(cubeMutex);
+        cubeStop = true;
+        cubeCondition.notify_all();
+    }
+
+    // workers finish their current search, which may need HEX code
+    hexMutex.unlock();
+    cubeWorkers.join_all();
+}
+
+
+void GenuineGuessAndCheckModelGenerator::runCubeWorker()
+{
+    std::string error;
+    try
+    {
+        while (true) {
+            std::vector<ID> nextCube;
+            {
+                boost::mutex::scoped_lock lock(cubeMutex);
+                if (cubeStop || pendingCubes.empty()) break;
+                nextCube = pendingCubes.front();
+                pendingCubes.pop_front();
+            }
+
+            // creating and destroying a model generator runs HEX code
+            boost::scoped_ptr<GenuineGuessAndCheckModelGenerator> mg;
+            {
+                boost::recursive_mutex::scoped_lock lock(hexMutex);
+                DBGLOG(DBG, "Enumerating cube " << printManyToString<RawPrinter>(nextCube, ",", reg));
+                mg.reset(new GenuineGuessAndCheckModelGenerator(factory, unitInput, nextCube));
+                mg->coordinator = this;
+            }
+            try
+            {
+                InterpretationPtr model;
+                while (!!(model = mg->generateNextModel())) {
+                    boost::mutex::scoped_lock lock(cubeMutex);
+                    while (cubeModels.size() >= cubeWorkers.size() && !cubeStop) cubeCondition.wait(lock);
+                    if (cubeStop) break;
+                    cubeModels.push_back(model);
+                    cubeCondition.notify_all();
+                }
+            }
+            catch(...) {
+                boost::recursive_mutex::scoped_lock lock(hexMutex);
+                mg.reset();
+                throw;
+            }
+            boost::recursive_mutex::scoped_lock lock(hexMutex);
+            mg.reset();
+        }
+    }
+    catch(const std::exception& e) {
+        error = e.what();
+    }
+    catch(...) {
+        error = "unknown exception";
+    }
+
+    boost::mutex::scoped_lock lock(cubeMutex);
+    if (cubeError.empty()) cubeError = error;
+    runningCubeWorkers--;
+    cubeCondition.notify_all();
+}
+
+
+InterpretationPtr GenuineGuessAndCheckModelGenerator::generateNextModelFromCubes()
+{
+    if (cubeWorkers.size() == 0) startCubeEnumeration(factory.ctx.config.getOption("EnumerationThreads"));
+
+    InterpretationPtr model;
+    std::string error;
+    {
+        DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid, "genuine g&c wait for cube models");
+
+        // workers may run HEX code while we wait
+        hexMutex.unlock();
+        {
+            boost::mutex::scoped_lock lock(cubeMutex);
+            while (cubeModels.empty() && runningCubeWorkers > 0 && cubeError.empty()) cubeCondition.wait(lock);
+            if (!cubeModels.empty()) {
+                model = cubeModels.front();
+                cubeModels.pop_front();
+                cubeCondition.notify_all();
+            }
+            error = cubeError;
+        }
+        hexMutex.lock();
+    }
+
+    if (!error.empty()) throw GeneralError("Parallel enumeration failed: " + error);
+
+    DBGLOG(DBG, "Returning " << (!model ? "empty " : "") << "model of parallel enumeration");
+    if (!!model) cmModelCount++;
+    return model;
+}
+
 void GenuineGuessAndCheckModelGenerator::identifyInconsistencyCause() {
 
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidiic1, "iIC full");
@@ -1467,6 +1772,7 @@ InterpretationConstPtr changed)
                 filev << ng.getStringRepresentation(reg) << std::endl;
             }
             solver->addNogood(ng);
+            if (usePersistentInstance) factory.persistentInstance->eaNogoods->addNogood(ng);
             if (factory.ctx.config.getOption("TransUnitLearning")) {
                 DBGLOG(DBG, "[IR] Adding learned nogood to inconsistency analyzer: " << ng.getStringRepresentation(reg));
                 analysissolverNogoods->addNogood(ng);
@@ -1939,7 +2245,7 @@ bool GenuineGuessAndCheckModelGenerator::verifyExternalAtomByEvaluation(int eaIn
         // for incomplete input we cannot yet decide this yet, evaluation is only done for learning purposes in this case
         DBGLOG(DBG, "Checking whether verification result is to be stored");
         if( !assigned ||
-            (annotatedGroundProgram.getEAMask(eaIndex)->mask()->getStorage() & annotatedGroundProgram.getProgramMask()->getStorage()).count() == (assigned->getStorage() & annotatedGroundProgram.getProgramMask()->getStorage()).count()) {
+            bm::count_and(annotatedGroundProgram.getEAMask(eaIndex)->mask()->getStorage(), annotatedGroundProgram.getProgramMask()->getStorage()) == bm::count_and(assigned->getStorage(), annotatedGroundProgram.getProgramMask()->getStorage())) {
             eaVerified[eaIndex] = vcb.verify();
             DBGLOG(DBG, "Verifying " << activeInnerEatoms[eaIndex] << " (Result: " << eaVerified[eaIndex] << ")");
 
@@ -2005,6 +2311,9 @@ void GenuineGuessAndCheckModelGenerator::propagate(InterpretationConstPtr partia
 
     assert (!!partialAssignment && !!assigned && !!changed);
 
+    boost::unique_lock<boost::recursive_mutex> hexLock;
+    if (!!coordinator) hexLock = boost::unique_lock<boost::recursive_mutex>(coordinator->hexMutex);
+
     // update external atom verification results
     // (1) unverify external atoms if atoms, which are relevant to this external atom, have (potentially) changed
     unverifyExternalAtoms(changed);
@@ -49,6 +49,7 @@
 
 #include "dlvhex2/InternalGrounder.h"
 #include "dlvhex2/InternalGroundDASPSolver.h"
+#include "dlvhex2/SolverWarmStartCache.h"
 #include "dlvhex2/GringoGrounder.h"
 #include "dlvhex2/ClaspSolver.h"
 
@@ -105,6 +106,22 @@ GenuineGrounderPtr GenuineGrounder::getInstance(ProgramCtx& ctx, const OrdinaryA
 }
 
 
+namespace
+{
+    // preloads nogoods and phases of an earlier run into an internal solver (cf. option --warmstart)
+    void warmStartInternalSolver(ProgramCtx& ctx, InternalGroundASPSolver& solver, const OrdinaryASPProgram& p, InterpretationConstPtr frozen)
+    {
+        if (!ctx.warmStartCache) return;
+
+        // facts and frozen atoms are input of the unit and might be different in the next run
+        InterpretationPtr excluded(new Interpretation(ctx.registry()));
+        if (!!p.edb) excluded->add(*p.edb);
+        if (!!frozen) excluded->add(*frozen);
+        solver.warmStart(ctx.warmStartCache, SolverWarmStartCache::computeKey(ctx.registry(), p), excluded);
+    }
+}
+
+
 GenuineGroundSolverPtr GenuineGroundSolver::getInstance(ProgramCtx& ctx, const AnnotatedGroundProgram& p, InterpretationConstPtr frozen, bool minCheck)
 {
 
@@ -112,7 +129,9 @@ GenuineGroundSolverPtr GenuineGroundSolver::getInstance(ProgramCtx& ctx, const A
         case 1: case 2:          // internal grounder or Gringo + internal solver
         {
             DBGLOG(DBG, "Instantiating genuine solver with internal solver (min-check: " << minCheck << ")");
-            GenuineGroundSolverPtr ptr(minCheck ? new InternalGroundDASPSolver(ctx, p, frozen) : new InternalGroundASPSolver(ctx, p, frozen));
+            InternalGroundASPSolver* solver = minCheck ? new InternalGroundDASPSolver(ctx, p, frozen) : new InternalGroundASPSolver(ctx, p, frozen);
+            GenuineGroundSolverPtr ptr(solver);
+            warmStartInternalSolver(ctx, *solver, p.getGroundProgram(), frozen);
             return ptr;
         }
         break;
@@ -143,7 +162,9 @@ GenuineGroundSolverPtr GenuineGroundSolver::getInstance(ProgramCtx& ctx, const O
         case 1: case 2:          // internal grounder or Gringo + internal solver
         {
             DBGLOG(DBG, "Instantiating genuine solver with internal solver (min-check: " << minCheck << ")");
-            GenuineGroundSolverPtr ptr(minCheck ? new InternalGroundDASPSolver(ctx, AnnotatedGroundProgram(ctx, p), frozen) : new InternalGroundASPSolver(ctx, AnnotatedGroundProgram(ctx, p), frozen));
+            InternalGroundASPSolver* solver = minCheck ? new InternalGroundDASPSolver(ctx, AnnotatedGroundProgram(ctx, p), frozen) : new InternalGroundASPSolver(ctx, AnnotatedGroundProgram(ctx, p), frozen);
+            GenuineGroundSolverPtr ptr(solver);
+            warmStartInternalSolver(ctx, *solver, p, frozen);
             return ptr;
         }
         break;
@@ -310,9 +310,11 @@ void GringoGrounder::GroundHexProgramBuilder::addSymbol(uint32_t symbol)
 
         // create a propositional atom with this name
         OrdinaryAtom ogatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG | ID::PROPERTY_ATOM_HIDDEN);
-        std::stringstream name;
-        name << ctx.registry()->terms.getByID(anonymousPred).symbol << "(" << symbol << ")";
-        ogatom.text = name.str();
+        if( !ctx.registry()->hasLazyAtomText() ) {
+            std::stringstream name;
+            name << ctx.registry()->terms.getByID(anonymousPred).symbol << "(" << symbol << ")";
+            ogatom.text = name.str();
+        }
         if( anonymousPred.isAuxiliary() ) ogatom.kind |= ID::PROPERTY_AUX;
         if( anonymousPred.isExternalAuxiliary() ) ogatom.kind |= ID::PROPERTY_EXTERNALAUX;
         if( anonymousPred.isExternalInputAuxiliary() ) ogatom.kind |= ID::PROPERTY_EXTERNALINPUTAUX;
@@ -492,7 +494,9 @@ void GringoGrounder::GroundHexProgramBuilder::printSymbol(unsigned atomUid, Grin
     v.print(ss);
     std::string str = ss.str();
 
-    ID dlvhexId = ctx.registry()->ogatoms.getIDByString(str);
+    // in lazy text mode atoms are looked up by tuple after parsing
+    const bool lazyText = ctx.registry()->hasLazyAtomText();
+    ID dlvhexId = lazyText ? ID_FAIL : ctx.registry()->ogatoms.getIDByString(str);
     if( dlvhexId == ID_FAIL ) {
         OrdinaryAtom ogatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, str);
 
@@ -526,7 +530,11 @@ void GringoGrounder::GroundHexProgramBuilder::printSymbol(unsigned atomUid, Grin
             if( id.isExternalInputAuxiliary() ) ogatom.kind |= ID::PROPERTY_EXTERNALINPUTAUX;
         }
         assert (ogatom.tuple.size() > 0 && "Cannot store empty atom");
-        dlvhexId = ctx.registry()->ogatoms.storeAndGetID(ogatom);
+        dlvhexId = ctx.registry()->ogatoms.getIDByTuple(ogatom.tuple);
+        if( dlvhexId == ID_FAIL ) {
+            if( lazyText ) ogatom.text.clear();
+            dlvhexId = ctx.registry()->ogatoms.storeAndGetID(ogatom);
+        }
 
         GPDBGLOG(DBG, "Registered atom " << str << " (arity " << (ogatom.tuple.size() - 1) << ") with tuple " << printvector(ogatom.tuple) << " and Gringo-ID " << atomUid << " and dlvhex-ID " << dlvhexId);
     }
@@ -990,9 +998,11 @@ void GringoGrounder::GroundHexProgramBuilder::addSymbol(uint32_t symbol)
 
         // create a propositional atom with this name
         OrdinaryAtom ogatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG | ID::PROPERTY_ATOM_HIDDEN);
-        std::stringstream name;
-        name << ctx.registry()->terms.getByID(tid).symbol << "(" << symbol << ")";
-        ogatom.text = name.str();
+        if( !ctx.registry()->hasLazyAtomText() ) {
+            std::stringstream name;
+            name << ctx.registry()->terms.getByID(tid).symbol << "(" << symbol << ")";
+            ogatom.text = name.str();
+        }
         if( tid.isAuxiliary() ) ogatom.kind |= ID::PROPERTY_AUX;
         if( tid.isExternalAuxiliary() ) ogatom.kind |= ID::PROPERTY_EXTERNALAUX;
         if( tid.isExternalInputAuxiliary() ) ogatom.kind |= ID::PROPERTY_EXTERNALINPUTAUX;
@@ -1198,7 +1208,9 @@ void GringoGrounder::GroundHexProgramBuilder::printSymbolTableEntry(const AtomRe
     assert(symbolstarts.size() == arity+1);
     OrdinaryAtom ogatom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, ss.str());
 
-    ID dlvhexId = ctx.registry()->ogatoms.getIDByString(ogatom.text);
+    // in lazy text mode atoms are looked up by tuple after parsing
+    const bool lazyText = ctx.registry()->hasLazyAtomText();
+    ID dlvhexId = lazyText ? ID_FAIL : ctx.registry()->ogatoms.getIDByString(ogatom.text);
 
     if( dlvhexId == ID_FAIL ) {
         // parse groundatom, register and store
@@ -1223,7 +1235,11 @@ void GringoGrounder::GroundHexProgramBuilder::printSymbolTableEntry(const AtomRe
                 lastsymbolstart = symbolstarts[symidx];
             }
         }
-        dlvhexId = ctx.registry()->ogatoms.storeAndGetID(ogatom);
+        dlvhexId = ctx.registry()->ogatoms.getIDByTuple(ogatom.tuple);
+        if( dlvhexId == ID_FAIL ) {
+            if( lazyText ) ogatom.text.clear();
+            dlvhexId = ctx.registry()->ogatoms.storeAndGetID(ogatom);
+        }
     }
 
     indexToGroundAtomID[atom.first] = dlvhexId;
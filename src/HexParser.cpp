@@ -39,11 +39,15 @@
 #include "dlvhex2/ProgramCtx.h"
 #include "dlvhex2/HexGrammar.h"
 #include "dlvhex2/HexParserModule.h"
+#include "dlvhex2/BulkFactLoader.h"
+#include "dlvhex2/InputProvider.h"
 #include "dlvhex2/fwd.h"
 
 #include <boost/spirit/include/qi_parse.hpp>
 
 #include <boost/scope_exit.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/ref.hpp>
 #include <fstream>
 
 //#include <unistd.h>
@@ -61,6 +65,161 @@ void ModuleHexParser::registerModule(HexParserModulePtr module)
 }
 
 
+namespace
+{
+    // feeds the pieces of each input to the BulkFactLoader and everything from
+    // the first statement which is not a plain fact on to the grammar
+    class InputPieceParser
+    {
+        public:
+            InputPieceParser(ProgramCtx& ctx, const std::vector<HexParserModulePtr>& modules):
+            loader(ctx), ctx(ctx), modules(modules), useGrammar(false) {
+            }
+
+            void operator()(const std::string& name, const char* begin, const char* end, bool last);
+
+            BulkFactLoader loader;
+
+        private:
+            void parseWithGrammar(std::string& input);
+
+            ProgramCtx& ctx;
+            const std::vector<HexParserModulePtr>& modules;
+            // created on demand
+            boost::scoped_ptr<HexGrammarSemantics> semanticsMgr;
+            boost::scoped_ptr<HexGrammar<HexParserIterator, HexParserSkipper> > grammar;
+            // incomplete statement at the end of the previous piece of the current input
+            std::string pending;
+            // part of the current input which must be parsed by the grammar
+            std::string grammarInput;
+            bool useGrammar;
+    };
+
+    void InputPieceParser::operator()(const std::string& name, const char* begin, const char* end, bool last)
+    {
+        DBGLOG(DBG,"got " << (end - begin) << " bytes of input " << name << (last ? " (last piece)" : ""));
+
+        // facts after a module header belong to the module
+        if( !useGrammar && pending.empty() && !!semanticsMgr && semanticsMgr->mlpMode != 0 )
+            useGrammar = true;
+
+        if( useGrammar ) {
+            grammarInput.append(begin, end);
+        }
+        else {
+            if( !pending.empty() ) {
+                pending.append(begin, end);
+                begin = pending.data();
+                end = begin + pending.size();
+            }
+            bool nonFact = false;
+            const char* rest;
+            if( last ) {
+                rest = loader.loadFacts(begin, end);
+                nonFact = (rest != end);
+            }
+            else {
+                rest = loader.loadFactsPartial(begin, end, nonFact);
+            }
+
+            if( nonFact ) {
+                grammarInput.assign(rest, end);
+                useGrammar = true;
+                pending.clear();
+            }
+            else {
+                std::string incomplete(rest, end);
+                pending.swap(incomplete);
+            }
+        }
+
+        if( last ) {
+            if( useGrammar ) {
+                DBGLOG(DBG,"parsing " << grammarInput.size() << " bytes of input " << name << " with grammar");
+                parseWithGrammar(grammarInput);
+            }
+            assert(pending.empty());
+            std::string().swap(grammarInput);
+            useGrammar = false;
+        }
+    }
+
+    void InputPieceParser::parseWithGrammar(std::string& input)
+    {
+        if( !grammar ) {
+            // create grammar
+            semanticsMgr.reset(new HexGrammarSemantics(ctx));
+            grammar.reset(new HexGrammar<HexParserIterator, HexParserSkipper>(*semanticsMgr));
+
+            // configure grammar with modules
+            BOOST_FOREACH(HexParserModulePtr module, modules) {
+                switch(module->getType()) {
+                    case HexParserModule::TOPLEVEL:
+                        grammar->registerToplevelModule(module->createGrammarModule());
+                        break;
+                    case HexParserModule::BODYATOM:
+                        grammar->registerBodyAtomModule(module->createGrammarModule());
+                        break;
+                    case HexParserModule::HEADATOM:
+                        grammar->registerHeadAtomModule(module->createGrammarModule());
+                        break;
+                    case HexParserModule::TERM:
+                        grammar->registerTermModule(module->createGrammarModule());
+                        break;
+                    default:
+                        LOG(ERROR,"unknown parser module type " << module->getType() << "!");
+                        assert(false);
+                        break;
+                }
+            }
+        }
+
+        // prepare iterators
+        HexParserIterator it_begin = input.begin();
+        HexParserIterator it_end = input.end();
+
+        // parse
+        HexParserSkipper skipper;
+        DBGLOG(DBG,"starting to parse");
+        bool success = false;
+        try
+        {
+            success = boost::spirit::qi::phrase_parse(
+                it_begin, it_end, *grammar, skipper);
+            DBGLOG(DBG,"parsing returned with success=" << success);
+        }
+        catch(const boost::spirit::qi::expectation_failure<HexParserIterator>& e) {
+            LOG(ERROR,"parsing returned with failure: expected '" << e.what_ << "'");
+            it_begin = e.first;
+        }
+        if( !success || it_begin != it_end ) {
+            if( it_begin != it_end )
+                LOG(ERROR,"iterators not the same!");
+
+            HexParserIterator it_displaybegin = it_begin;
+            HexParserIterator it_displayend = it_begin;
+            unsigned usedLeft = 0;
+            while( usedLeft++ < 50 &&
+                it_displaybegin != input.begin() &&
+                *it_displaybegin != '\n' )
+                it_displaybegin--;
+            if( *it_displaybegin == '\n' ) {
+                it_displaybegin++;
+                usedLeft--;
+            }
+            unsigned limitRight = 50;
+            while( limitRight-- > 0 &&
+                it_displayend != it_end &&
+                *it_displayend != '\n' )
+                it_displayend++;
+            LOG(ERROR,"unparsed '" << std::string(it_displaybegin, it_displayend) << "'");
+            LOG(ERROR,"---------" << std::string(usedLeft, '-') << "^");
+            throw SyntaxError("Could not parse complete input!");
+        }
+    }
+}
+
+
 void ModuleHexParser::parse(InputProviderPtr in, ProgramCtx& ctx)
 {
     assert(!!in);
@@ -75,82 +234,17 @@ void ModuleHexParser::parse(InputProviderPtr in, ProgramCtx& ctx)
         DBGLOG(DBG, " not reset edb ");
     }
 
-    // put whole input from stream into a string
-    // (an alternative would be the boost::spirit::multi_pass iterator
-    // but this can be done later when the parser is updated to Spirit V2)
-    WARNING("TODO incrementally read and parse this stream")
-        std::ostringstream buf;
-    buf << in->getAsStream().rdbuf();
-    std::string input = buf.str();
+    InputPieceParser pieceParser(ctx, modules);
 
-    // create grammar
-    HexGrammarSemantics semanticsMgr(ctx);
-    HexGrammar<HexParserIterator, HexParserSkipper> grammar(semanticsMgr);
-
-    // configure grammar with modules
-    BOOST_FOREACH(HexParserModulePtr module, modules) {
-        switch(module->getType()) {
-            case HexParserModule::TOPLEVEL:
-                grammar.registerToplevelModule(module->createGrammarModule());
-                break;
-            case HexParserModule::BODYATOM:
-                grammar.registerBodyAtomModule(module->createGrammarModule());
-                break;
-            case HexParserModule::HEADATOM:
-                grammar.registerHeadAtomModule(module->createGrammarModule());
-                break;
-            case HexParserModule::TERM:
-                grammar.registerTermModule(module->createGrammarModule());
-                break;
-            default:
-                LOG(ERROR,"unknown parser module type " << module->getType() << "!");
-                assert(false);
-                break;
-        }
+    // CSV inputs consist of facts only, load them directly
+    BOOST_FOREACH(const InputProvider::CSVInput& csv, in->getCSVInputs()) {
+        pieceParser.loader.loadCSVFile(csv.predicate, csv.filename);
     }
 
-    // prepare iterators
-    HexParserIterator it_begin = input.begin();
-    HexParserIterator it_end = input.end();
-
-    // parse
-    HexParserSkipper skipper;
-    DBGLOG(DBG,"starting to parse");
-    bool success = false;
-    try
-    {
-        success = boost::spirit::qi::phrase_parse(
-            it_begin, it_end, grammar, skipper);
-        DBGLOG(DBG,"parsing returned with success=" << success);
-    }
-    catch(const boost::spirit::qi::expectation_failure<HexParserIterator>& e) {
-        LOG(ERROR,"parsing returned with failure: expected '" << e.what_ << "'");
-        it_begin = e.first;
-    }
-    if( !success || it_begin != it_end ) {
-        if( it_begin != it_end )
-            LOG(ERROR,"iterators not the same!");
-
-        HexParserIterator it_displaybegin = it_begin;
-        HexParserIterator it_displayend = it_begin;
-        unsigned usedLeft = 0;
-        while( usedLeft++ < 50 &&
-            it_displaybegin != input.begin() &&
-            *it_displaybegin != '\n' )
-            it_displaybegin--;
-        if( *it_displaybegin == '\n' ) {
-            it_displaybegin++;
-            usedLeft--;
-        }
-        unsigned limitRight = 50;
-        while( limitRight-- > 0 &&
-            it_displayend != it_end &&
-            *it_displayend != '\n' )
-            it_displayend++;
-        LOG(ERROR,"unparsed '" << std::string(it_displaybegin, it_displayend) << "'");
-        LOG(ERROR,"---------" << std::string(usedLeft, '-') << "^");
-        throw SyntaxError("Could not parse complete input!");
-    }
+    // read inputs piece by piece without concatenating them
+    // (facts are loaded directly, the grammar only parses inputs from their first other statement on)
+    in->readTextInputs(boost::ref(pieceParser));
+    DBGLOG(DBG,"loaded " << pieceParser.loader.getFactCount() << " facts without grammar");
 
     // workaround: making IDs in idb unique
     WARNING("we should probably also do this for MLP, at the same time we should probably generalize MLP better")
@@ -40,71 +40,126 @@
 #include "dlvhex2/URLBuf.h"
 #include "dlvhex2/Error.h"
 
+#include <boost/foreach.hpp>
+#include <boost/ref.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
 #include <cassert>
 #include <fstream>
 #include <sstream>
 
-DLVHEX_NAMESPACE_BEGIN
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
-WARNING("TODO use boost::iostream::chain or something similar to create real streaming/incremental input provider")
+DLVHEX_NAMESPACE_BEGIN
 
 class InputProvider::Impl
 {
     public:
-        std::stringstream stream;
+        /** \brief Textual input which is read when it is consumed. */
+        struct TextInput
+        {
+            enum Type
+            {
+                /** \brief Input kept in memory (strings, streams, URLs). */
+                Memory,
+                /** \brief File which is mapped into memory. */
+                File,
+                /** \brief Stream which is read in chunks. */
+                Stream
+            };
+            Type type;
+            std::string name;
+            std::string content;
+            std::istream* stream;
+            TextInput(Type type, const std::string& name):
+                type(type), name(name), stream(0) {}
+        };
+
+        std::vector<TextInput> textInputs;
         std::vector<std::string> contentNames;
+        std::vector<CSVInput> csvInputs;
+        // all inputs concatenated, only created by getAsStream
+        std::stringstream stream;
 
     public:
         Impl() {
         }
-};
-
-InputProvider::InputProvider():
-pimpl(new Impl)
-{
-}
-
-
-InputProvider::~InputProvider()
-{
-}
-
-
-void InputProvider::addStreamInput(std::istream& i, const std::string& contentname)
-{
-    // read the input before adding it to pimpl->stream (otherwise empty input seems to make the overall stream corrupt)
-    std::stringstream inp;
-    inp << i.rdbuf();
-    pimpl->stream << inp.str();
-    pimpl->contentNames.push_back(contentname);
-}
 
+        void readTextInput(TextInput& input, const TextConsumer& consumer, std::size_t chunkSize);
+        void convertCSVFileInput(const CSVInput& csv);
+};
 
-void InputProvider::addStringInput(const std::string& content, const std::string& contentname)
+namespace
 {
-    pimpl->stream << content;
-    pimpl->contentNames.push_back(contentname);
+    // appends pieces of input to a stream
+    struct StreamAppender
+    {
+        std::ostream& out;
+        StreamAppender(std::ostream& out): out(out) {}
+        void operator()(const std::string&, const char* begin, const char* end, bool) {
+            out.write(begin, end - begin);
+        }
+    };
 }
 
-
-void InputProvider::addFileInput(const std::string& filename)
+void InputProvider::Impl::readTextInput(TextInput& input, const TextConsumer& consumer, std::size_t chunkSize)
 {
-    std::ifstream ifs;
-    ifs.open(filename.c_str());
+    static const char* const empty = "";
+    switch(input.type) {
+        case TextInput::Memory:
+            consumer(input.name, input.content.data(), input.content.data() + input.content.size(), true);
+            break;
+        case TextInput::File:
+        {
+            // (empty files cannot be mapped)
+            std::ifstream ifs(input.name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+            if( !ifs.is_open() )
+                throw GeneralError("File " + input.name + " not found");
+            const bool isEmpty = (ifs.tellg() == std::streampos(0));
+            ifs.close();
+            if( isEmpty ) {
+                consumer(input.name, empty, empty, true);
+                break;
+            }
 
-    if (!ifs.is_open()) {
-        throw GeneralError("File " + filename + " not found");
+            boost::iostreams::mapped_file_source file;
+            try
+            {
+                file.open(input.name);
+            }
+            catch(const std::exception& e) {
+                throw GeneralError("could not read file " + input.name + ": " + e.what());
+            }
+            #ifdef POSIX_MADV_SEQUENTIAL
+            // pages which were consumed can be dropped early
+            posix_madvise(const_cast<char*>(file.data()), file.size(), POSIX_MADV_SEQUENTIAL);
+            #endif
+            consumer(input.name, file.data(), file.data() + file.size(), true);
+        }
+        break;
+        case TextInput::Stream:
+        {
+            assert(input.stream != 0 && "stream input can only be read once");
+            std::vector<char> buffer(chunkSize);
+            bool last = false;
+            while( !last ) {
+                input.stream->read(&buffer[0], chunkSize);
+                const std::size_t count = input.stream->gcount();
+                last = !(*input.stream);
+                consumer(input.name, &buffer[0], &buffer[0] + count, last);
+            }
+            input.stream = 0;
+        }
+        break;
     }
-
-    pimpl->stream << ifs.rdbuf();
-    ifs.close();
-    pimpl->contentNames.push_back(filename);
 }
 
-void InputProvider::addCSVFileInput(const std::string& predicate, const std::string& filename)
+void InputProvider::Impl::convertCSVFileInput(const CSVInput& csv)
 {
     std::ifstream ifs;
-    ifs.open(filename.c_str());
+    ifs.open(csv.filename.c_str());
 
     std::string line;
     int lineNr = 0;
@@ -113,42 +168,101 @@ void InputProvider::addCSVFileInput(const std::string& predicate, const std::str
         bool firstChar = true;
         bool addQuotes = false;
         bool escaped = false;
-        pimpl->stream << predicate << "(" << lineNr << ",";
+        stream << csv.predicate << "(" << lineNr << ",";
         for (int i = 0; i <= line.length(); ++i){
             // decide type of argument
             if (firstChar && !(line[i] >= '0' && line[i] <= '9')) {
                 addQuotes = true;
-                pimpl->stream << "\"";
+                stream << "\"";
             }
             firstChar = false;
 
             // detect end of argument
             if ((line[i] == ';' || line[i] == 0) && !escaped){
-                if (addQuotes) pimpl->stream << "\"";
-                if (line[i] != 0) pimpl->stream << ",";
+                if (addQuotes) stream << "\"";
+                if (line[i] != 0) stream << ",";
                 addQuotes = false;
                 firstChar = true;
             }
 
             // escape sequence
             else if (line[i] == '\\' && !escaped) {
-                pimpl->stream << line[i];
+                stream << line[i];
                 escaped = true;
             }
 
             // output ordinary character
             else if (line[i] != 0){
-                pimpl->stream << line[i];
+                stream << line[i];
                 escaped = false;
             }
         }
         // construct fact for this line
-        pimpl->stream << ").";
+        stream << ").";
 
         ++lineNr;
     }
 
     ifs.close();
+}
+
+InputProvider::InputProvider():
+pimpl(new Impl)
+{
+}
+
+
+InputProvider::~InputProvider()
+{
+}
+
+
+void InputProvider::addStreamInput(std::istream& i, const std::string& contentname)
+{
+    Impl::TextInput input(Impl::TextInput::Memory, contentname);
+    std::stringstream inp;
+    inp << i.rdbuf();
+    input.content = inp.str();
+    pimpl->textInputs.push_back(input);
+    pimpl->contentNames.push_back(contentname);
+}
+
+
+void InputProvider::addStreamingInput(std::istream& i, const std::string& contentname)
+{
+    Impl::TextInput input(Impl::TextInput::Stream, contentname);
+    input.stream = &i;
+    pimpl->textInputs.push_back(input);
+    pimpl->contentNames.push_back(contentname);
+}
+
+
+void InputProvider::addStringInput(const std::string& content, const std::string& contentname)
+{
+    Impl::TextInput input(Impl::TextInput::Memory, contentname);
+    input.content = content;
+    pimpl->textInputs.push_back(input);
+    pimpl->contentNames.push_back(contentname);
+}
+
+
+void InputProvider::addFileInput(const std::string& filename)
+{
+    std::ifstream ifs;
+    ifs.open(filename.c_str());
+
+    if (!ifs.is_open()) {
+        throw GeneralError("File " + filename + " not found");
+    }
+    ifs.close();
+
+    pimpl->textInputs.push_back(Impl::TextInput(Impl::TextInput::File, filename));
+    pimpl->contentNames.push_back(filename);
+}
+
+void InputProvider::addCSVFileInput(const std::string& predicate, const std::string& filename)
+{
+    pimpl->csvInputs.push_back(CSVInput(predicate, filename));
     pimpl->contentNames.push_back(filename);
 }
 
@@ -161,12 +275,16 @@ void InputProvider::addURLInput(const std::string& url)
     ubuf.open(url);
     std::istream is(&ubuf);
 
-    pimpl->stream << is.rdbuf();
+    Impl::TextInput input(Impl::TextInput::Memory, url);
+    std::stringstream inp;
+    inp << is.rdbuf();
+    input.content = inp.str();
 
     if (ubuf.responsecode() == 404) {
         throw GeneralError("Requested URL " + url + " was not found");
     }
 
+    pimpl->textInputs.push_back(input);
     pimpl->contentNames.push_back(url);
 }
 #endif
@@ -186,10 +304,33 @@ const std::vector<std::string>& InputProvider::contentNames() const
 std::istream& InputProvider::getAsStream()
 {
     assert(hasContent() && "should have gotten some content before using content");
+    // the concatenated stream replaces the inputs
+    StreamAppender appender(pimpl->stream);
+    readTextInputs(boost::ref(appender));
+    pimpl->textInputs.clear();
+    BOOST_FOREACH(const CSVInput& csv, pimpl->csvInputs) {
+        pimpl->convertCSVFileInput(csv);
+    }
+    pimpl->csvInputs.clear();
     return pimpl->stream;
 }
 
 
+const std::vector<InputProvider::CSVInput>& InputProvider::getCSVInputs() const
+{
+    return pimpl->csvInputs;
+}
+
+
+void InputProvider::readTextInputs(const TextConsumer& consumer, std::size_t chunkSize)
+{
+    assert(chunkSize > 0);
+    BOOST_FOREACH(Impl::TextInput& input, pimpl->textInputs) {
+        pimpl->readTextInput(input, consumer, chunkSize);
+    }
+}
+
+
 DLVHEX_NAMESPACE_END
 
 // vim:expandtab:ts=4:sw=4:
@@ -53,6 +53,9 @@ DLVHEX_NAMESPACE_BEGIN
 //#define DBGLOGD(X,Y) DBGLOG(X,Y)
 #define DBGLOGD(X,Y) do{}while(false);
 
+const int InternalGroundASPSolver::noSource;
+const int InternalGroundASPSolver::factSource;
+
 // 1. body must not be false if all literals are true
 // 2. body must not be true if a literal is false
 // 3. head must not be false if body is true
@@ -113,8 +116,9 @@ Set<std::pair<ID, ID> > InternalGroundASPSolver::createShiftedProgram()
     DBGLOG(DBG, "Creating shifted program");
 
     Set<std::pair<ID, ID> > shiftedProg;
-    BOOST_FOREACH (ID ruleID, program.getGroundProgram().idb) {
+    for (uint32_t ruleIndex = 0; ruleIndex < rules.size(); ++ruleIndex) {
 
+        ID ruleID = rules[ruleIndex];
         const Rule& r = reg->rules.getByID(ruleID);
 
         // real shifted rule?
@@ -147,7 +151,7 @@ Set<std::pair<ID, ID> > InternalGroundASPSolver::createShiftedProgram()
             // rule was already present in original program and has already a body literal
             DBGLOG(DBG, "Creating shifted rule which was already present in original program: " << r);
 
-            shiftedProg.insert(std::pair<ID, ID>(ruleID, createLiteral(bodyAtomOfRule[ruleID.address])));
+            shiftedProg.insert(std::pair<ID, ID>(ruleID, createLiteral(bodyAtomOfRule[ruleIndex])));
         }
     }
 
@@ -222,7 +226,7 @@ void InternalGroundASPSolver::computeClarkCompletion()
         if (ruleID.isWeakConstraint()) throw GeneralError("Internal solver does not support weak constraints");
 
         ID ruleBodyAtomID = createNewBodyAtom();
-        bodyAtomOfRule[ruleID.address] = ruleBodyAtomID.address;
+        bodyAtomOfRule.push_back(ruleBodyAtomID.address);
         createNogoodsForRule(ruleBodyAtomID, ruleID);
     }
 
@@ -279,36 +283,29 @@ void InternalGroundASPSolver::computeStronglyConnectedComponents()
     std::vector<int> componentMap(depNodes.size());
     int num = boost::strong_components(depGraph, boost::make_iterator_property_map(componentMap.begin(), get(boost::vertex_index, depGraph)));
 
-    // translate into real map
-    depSCC = std::vector<Set<IDAddress> >(num);
+    // translate into dense arrays
+    componentOfAtom = std::vector<int>(reg->ogatoms.getSize(), -1);
+    componentSize = std::vector<int>(num, 0);
     Node nodeNr = 0;
     BOOST_FOREACH (int componentOfNode, componentMap) {
-        depSCC[componentOfNode].insert(depGraph[nodeNr]);
         componentOfAtom[depGraph[nodeNr]] = componentOfNode;
+        componentSize[componentOfNode]++;
         nodeNr++;
     }
 
-    // store which atoms occur in non-singular components
+    #ifndef NDEBUG
+    std::vector<std::vector<IDAddress> > depSCC(num);
+    std::vector<IDAddress> nonSingularFacts;
     BOOST_FOREACH (IDAddress litadr, ordinaryFacts) {
-        if (depSCC[componentOfAtom[litadr]].size() > 1) {
-            nonSingularFacts.insert(litadr);
-        }
+        depSCC[componentOfAtom[litadr]].push_back(litadr);
+        if (isNonSingular(litadr)) nonSingularFacts.push_back(litadr);
     }
-
-    #ifndef NDEBUG
     std::stringstream compStr;
     bool firstC = true;
-    BOOST_FOREACH (Set<IDAddress> component, depSCC) {
+    BOOST_FOREACH (const std::vector<IDAddress>& component, depSCC) {
         if (!firstC) compStr << ", ";
         firstC = false;
-        compStr << "{";
-        bool firstL = true;
-        BOOST_FOREACH (IDAddress litadr, component) {
-            if (!firstL) compStr << ", ";
-            firstL = false;
-            compStr << litadr;
-        }
-        compStr << "}";
+        compStr << toString(component);
     }
     DBGLOG(DBG, "Program components: " << compStr.str());
     DBGLOG(DBG, "All atoms: " << toString(allAtoms));
@@ -323,21 +320,30 @@ void InternalGroundASPSolver::initSourcePointers()
 
     DBGLOG(DBG, "Initialize source pointers");
 
+    // body atoms were created after the program structure was initialized
+    ruleOfBodyAtom = std::vector<int>(reg->ogatoms.getSize(), -1);
+    for (uint32_t r = 0; r < bodyAtomOfRule.size(); ++r) {
+        ruleOfBodyAtom[bodyAtomOfRule[r]] = r;
+    }
+    ruleVisited = std::vector<int>(rules.size(), 0);
+    externalSupportCalls = 0;
+
     // initially, all atoms in non-singular components, except facts, are unfounded
+    sourceRule = std::vector<int>(reg->ogatoms.getSize(), noSource);
     BOOST_FOREACH (IDAddress litadr, ordinaryFacts) {
         if (program.getGroundProgram().edb->getFact(litadr)) {
-            // store pseudo source rule ID_FAIL to mark that this is a fact and founded by itself
-            sourceRule[litadr] = ID_FAIL;
+            // store pseudo source rule to mark that this is a fact and founded by itself
+            sourceRule[litadr] = factSource;
         }
         else {
             // all non-facts in non-singular components are unfounded
-            if (nonSingularFacts.count(litadr) > 0) {
+            if (isNonSingular(litadr)) {
                 unfoundedAtoms.insert(litadr);
             }
         }
     }
 
-    DBGLOG(DBG, "Initially unfounded atoms: " << toString(unfoundedAtoms));
+    DBGLOG(DBG, "Initially unfounded atoms: " << toString(unfoundedAtoms.atoms));
 }
 
 
@@ -345,14 +351,17 @@ void InternalGroundASPSolver::initializeLists(InterpretationConstPtr frozen)
 {
 
     // determine the set of all facts and a literal index
+    headAtomsBegin.push_back(0);
+    posBodyAtomsBegin.push_back(0);
     BOOST_FOREACH (ID ruleID, program.getGroundProgram().idb) {
         const Rule& r = reg->rules.getByID(ruleID);
+        rules.push_back(ruleID);
 
-        // remember this rule for each contained literal
+        // remember the literals of this rule
         for (std::vector<ID>::const_iterator lIt = r.head.begin(); lIt != r.head.end(); ++lIt) {
             if (lIt->isOrdinaryNongroundAtom()) throw GeneralError("Got nonground program");
 
-            rulesWithPosHeadLiteral[lIt->address].insert(ruleID);
+            headAtoms.push_back(lIt->address);
             // collect all facts
             allAtoms.insert(lIt->address);
             ordinaryFacts.insert(lIt->address);
@@ -361,15 +370,33 @@ void InternalGroundASPSolver::initializeLists(InterpretationConstPtr frozen)
             if (lIt->isOrdinaryNongroundAtom()) throw GeneralError("Got nonground program");
 
             if (!lIt->isNaf()) {
-                rulesWithPosBodyLiteral[lIt->address].insert(ruleID);
-            }
-            else {
-                rulesWithNegBodyLiteral[lIt->address].insert(ruleID);
+                posBodyAtoms.push_back(lIt->address);
             }
             // collect all facts
             allAtoms.insert(lIt->address);
             ordinaryFacts.insert(lIt->address);
         }
+        headAtomsBegin.push_back(headAtoms.size());
+        posBodyAtomsBegin.push_back(posBodyAtoms.size());
+    }
+
+    // remember for each atom the rules which contain it (counting sort by atoms)
+    uint32_t atomCount = reg->ogatoms.getSize();
+    rulesWithHeadAtomBegin = std::vector<int>(atomCount + 1, 0);
+    rulesWithPosBodyAtomBegin = std::vector<int>(atomCount + 1, 0);
+    BOOST_FOREACH (IDAddress litadr, headAtoms) rulesWithHeadAtomBegin[litadr + 1]++;
+    BOOST_FOREACH (IDAddress litadr, posBodyAtoms) rulesWithPosBodyAtomBegin[litadr + 1]++;
+    for (uint32_t a = 0; a < atomCount; ++a) {
+        rulesWithHeadAtomBegin[a + 1] += rulesWithHeadAtomBegin[a];
+        rulesWithPosBodyAtomBegin[a + 1] += rulesWithPosBodyAtomBegin[a];
+    }
+    rulesWithHeadAtom.resize(headAtoms.size());
+    rulesWithPosBodyAtom.resize(posBodyAtoms.size());
+    std::vector<int> nextHeadRule(rulesWithHeadAtomBegin.begin(), rulesWithHeadAtomBegin.end() - 1);
+    std::vector<int> nextPosBodyRule(rulesWithPosBodyAtomBegin.begin(), rulesWithPosBodyAtomBegin.end() - 1);
+    for (uint32_t r = 0; r < rules.size(); ++r) {
+        for (int i = headAtomsBegin[r]; i < headAtomsBegin[r + 1]; ++i) rulesWithHeadAtom[nextHeadRule[headAtoms[i]]++] = r;
+        for (int i = posBodyAtomsBegin[r]; i < posBodyAtomsBegin[r + 1]; ++i) rulesWithPosBodyAtom[nextPosBodyRule[posBodyAtoms[i]]++] = r;
     }
 
     // include facts in the list of all atoms
@@ -418,55 +445,51 @@ void InternalGroundASPSolver::removeSourceFromAtom(IDAddress litadr)
 {
 
     // check if the literal has currently a source rule
-    if (sourceRule.find(litadr) != sourceRule.end()) {
-        if (sourceRule[litadr] != ID_FAIL) {
-            ID sourceRuleID = sourceRule[litadr];
-            DBGLOG(DBG, "Literal " << litadr << " canceled its source pointer to rule " << sourceRuleID.address);
-            foundedAtomsOfBodyAtom[bodyAtomOfRule[sourceRuleID.address]].erase(litadr);
-            sourceRule.erase(litadr);
-        }
+    if (litadr < sourceRule.size() && sourceRule[litadr] >= 0) {
+        DBGLOG(DBG, "Literal " << litadr << " canceled its source pointer to rule " << sourceRule[litadr]);
+        sourceRule[litadr] = noSource;
     }
 }
 
 
-void InternalGroundASPSolver::addSourceToAtom(IDAddress litadr, ID rule)
+void InternalGroundASPSolver::addSourceToAtom(IDAddress litadr, int rule)
 {
-    DBGLOG(DBG, "Literal " << litadr << " sets a source pointer to " << rule.address);
+    DBGLOG(DBG, "Literal " << litadr << " sets a source pointer to " << rule);
     sourceRule[litadr] = rule;
-    foundedAtomsOfBodyAtom[bodyAtomOfRule[rule.address]].insert(litadr);
 }
 
 
-Set<IDAddress> InternalGroundASPSolver::getDependingAtoms(IDAddress litadr)
+void InternalGroundASPSolver::addDependingAtoms(IDAddress litadr)
 {
 
-    // litadr became unfounded; now compute all atoms which depend on litadr and are
+    // litadr became unfounded; now collect all atoms which depend on litadr and
     // therefore become unfounded too
-    Set<IDAddress> dependingAtoms;
+    if (litadr + 1 >= rulesWithPosBodyAtomBegin.size()) return;
 
     // go through all rules which contain litadr in their body
-    BOOST_FOREACH (ID ruleID, rulesWithPosBodyLiteral[litadr]) {
+    for (int i = rulesWithPosBodyAtomBegin[litadr]; i < rulesWithPosBodyAtomBegin[litadr + 1]; ++i) {
+        int rule = rulesWithPosBodyAtom[i];
 
         // go through all atoms which use this rule as source
-        BOOST_FOREACH (IDAddress dependingAtom, foundedAtomsOfBodyAtom[bodyAtomOfRule[ruleID.address]]) {
-            // this atom is depends on litadr
-            dependingAtoms.insert(dependingAtom);
+        for (int h = headAtomsBegin[rule]; h < headAtomsBegin[rule + 1]; ++h) {
+            if (sourceRule[headAtoms[h]] == rule) ufsWorklist.push_back(headAtoms[h]);
         }
     }
-
-    return dependingAtoms;
 }
 
 
-void InternalGroundASPSolver::getInitialNewlyUnfoundedAtomsAfterSetFact(ID fact, Set<IDAddress>& newlyUnfoundedAtoms)
+void InternalGroundASPSolver::addInitialNewlyUnfoundedAtomsAfterSetFact(ID fact)
 {
 
     // if the fact is a falsified body literal, all atoms which depend on it become unfounded
     if (fact.isNaf()) {
-        if (foundedAtomsOfBodyAtom.find(fact.address) != foundedAtomsOfBodyAtom.end()) {
-            BOOST_FOREACH (IDAddress dependingAtom, foundedAtomsOfBodyAtom[fact.address]) {
-                DBGLOGD(DBG, "" << dependingAtom << " is initially unfounded because the body of its source rule became false");
-                newlyUnfoundedAtoms.insert(dependingAtom);
+        if (fact.address < ruleOfBodyAtom.size() && ruleOfBodyAtom[fact.address] != -1) {
+            int rule = ruleOfBodyAtom[fact.address];
+            for (int h = headAtomsBegin[rule]; h < headAtomsBegin[rule + 1]; ++h) {
+                if (sourceRule[headAtoms[h]] == rule) {
+                    DBGLOGD(DBG, "" << headAtoms[h] << " is initially unfounded because the body of its source rule became false");
+                    ufsWorklist.push_back(headAtoms[h]);
+                }
             }
         }
     }
@@ -475,39 +498,38 @@ void InternalGroundASPSolver::getInitialNewlyUnfoundedAtomsAfterSetFact(ID fact,
     // (i) which were set later; or
     // (ii) which are true in a different component
     // become unfounded
-    else {
+    else if (fact.address + 1 < rulesWithHeadAtomBegin.size()) {
         // for all rules which contain the fact in their head
-        if (rulesWithPosHeadLiteral.find(fact.address) != rulesWithPosHeadLiteral.end()) {
-            BOOST_FOREACH (ID ruleID, rulesWithPosHeadLiteral[fact.address]) {
-                const Rule& r = reg->rules.getByID(ruleID);
-
-                // all other head literals cannot use this rule as source, if
-                BOOST_FOREACH (ID otherHeadLit, r.head) {
-                    if (otherHeadLit.address != fact.address && sourceRule[otherHeadLit.address] == ruleID) {
-                        // (i) they were set to true later
-                        // TODO: maybe we have to compare the order of assignments instead of the decision levels
-                        //       or we can use the decision level (would be much more efficient)
-                        if (satisfied(createLiteral(otherHeadLit.address)) &&
-                            getAssignmentOrderIndex(otherHeadLit.address) > getAssignmentOrderIndex(fact.address)
-                        ) {
-                            DBGLOGD(DBG, "" << otherHeadLit.address << " is initially unfounded because " << otherHeadLit.address <<
-                                " occurs in the head of its source rule and became true on a lower decision level");
-                            newlyUnfoundedAtoms.insert(otherHeadLit.address);
-                        }
+        for (int i = rulesWithHeadAtomBegin[fact.address]; i < rulesWithHeadAtomBegin[fact.address + 1]; ++i) {
+            int rule = rulesWithHeadAtom[i];
+
+            // all other head literals cannot use this rule as source, if
+            for (int h = headAtomsBegin[rule]; h < headAtomsBegin[rule + 1]; ++h) {
+                IDAddress otherHeadAtom = headAtoms[h];
+                if (otherHeadAtom != fact.address && sourceRule[otherHeadAtom] == rule) {
+                    // (i) they were set to true later
+                    // TODO: maybe we have to compare the order of assignments instead of the decision levels
+                    //       or we can use the decision level (would be much more efficient)
+                    if (satisfied(createLiteral(otherHeadAtom)) &&
+                        getAssignmentOrderIndex(otherHeadAtom) > getAssignmentOrderIndex(fact.address)
+                    ) {
+                        DBGLOGD(DBG, "" << otherHeadAtom << " is initially unfounded because " << otherHeadAtom <<
+                            " occurs in the head of its source rule and became true on a lower decision level");
+                        ufsWorklist.push_back(otherHeadAtom);
+                    }
 
-                        // (ii) they belong to a different component
-                        if (componentOfAtom[otherHeadLit.address] != componentOfAtom[fact.address]) {
-                            DBGLOGD(DBG, "" << otherHeadLit.address << " is initially unfounded because " << fact.address <<
-                                " occurs in the head of its source rule and is true in a different component");
-                            newlyUnfoundedAtoms.insert(otherHeadLit.address);
-                        }
+                    // (ii) they belong to a different component
+                    else if (componentOfAtom[otherHeadAtom] != componentOfAtom[fact.address]) {
+                        DBGLOGD(DBG, "" << otherHeadAtom << " is initially unfounded because " << fact.address <<
+                            " occurs in the head of its source rule and is true in a different component");
+                        ufsWorklist.push_back(otherHeadAtom);
                     }
                 }
             }
         }
     }
 
-    DBGLOGD(DBG, "Scope of unfounded set check is initially extended by " << toString(newlyUnfoundedAtoms));
+    DBGLOGD(DBG, "Scope of unfounded set check is initially extended by " << toString(ufsWorklist));
 
 }
 
@@ -515,18 +537,7 @@ void InternalGroundASPSolver::getInitialNewlyUnfoundedAtomsAfterSetFact(ID fact,
 void InternalGroundASPSolver::updateUnfoundedSetStructuresAfterSetFact(ID fact)
 {
 
-    DBGLOGD(DBG, "Updating set of atoms without source pointers, currently: " << toString(unfoundedAtoms));
-
-    #ifndef NDEBUG
-    {
-        std::stringstream ss;
-        typedef std::pair<IDAddress, Set<IDAddress> > SourcePair;
-        BOOST_FOREACH (SourcePair pair, foundedAtomsOfBodyAtom) {
-            ss << "Body atom " << pair.first << " is source for " << toString(pair.second) << "; ";
-        }
-        DBGLOGD(DBG, "Source pointer: " << ss.str());
-    }
-    #endif
+    DBGLOGD(DBG, "Updating set of atoms without source pointers, currently: " << toString(unfoundedAtoms.atoms));
 
     // atom does not need a source pointer if it is assigned to false
     if (fact.isNaf()) {
@@ -537,134 +548,115 @@ void InternalGroundASPSolver::updateUnfoundedSetStructuresAfterSetFact(ID fact)
 
     // update the unfounded data structures
     DBGLOGD(DBG, "Computing initially newly unfounded atoms");
-    Set<IDAddress> newlyUnfoundedAtoms;
-    getInitialNewlyUnfoundedAtomsAfterSetFact(fact, newlyUnfoundedAtoms);
-
-    while (newlyUnfoundedAtoms.size() > 0) {
-        Set<IDAddress> nextNewlyUnfoundedAtoms;
-
-        DBGLOGD(DBG, "Collecting depending atoms of " << toString(newlyUnfoundedAtoms));
-
-        BOOST_FOREACH (IDAddress newlyUnfoundedAtom, newlyUnfoundedAtoms) {
-            // only atoms which occur in non-singular components
-            // (singular atoms are already handled by static loop nogoods)
-            if (nonSingularFacts.count(newlyUnfoundedAtom) > 0) {
-                // only atoms which are not already unfounded or false
-                if (!falsified(createLiteral(newlyUnfoundedAtom)) && (unfoundedAtoms.count(newlyUnfoundedAtom) == 0)) {
-                    // only atoms which occur in a component that depends on unfounded atoms
-                    if (intersect(depSCC[componentOfAtom[newlyUnfoundedAtom]], unfoundedAtoms).size() > 0 ||
-                    intersect(depSCC[componentOfAtom[newlyUnfoundedAtom]], newlyUnfoundedAtoms).size() > 0) {
-                        DBGLOGD(DBG, "Atom " << newlyUnfoundedAtom << " becomes unfounded");
-                        removeSourceFromAtom(newlyUnfoundedAtom);
-                        unfoundedAtoms.insert(newlyUnfoundedAtom);
-
-                        // collect depending atoms
-                        Set<IDAddress> dependingAtoms = getDependingAtoms(newlyUnfoundedAtom);
-                        DBGLOGD(DBG, "Depending on " << newlyUnfoundedAtom << ": " << toString(dependingAtoms));
-                        nextNewlyUnfoundedAtoms.insert(dependingAtoms.begin(), dependingAtoms.end());
-                    }
-                }
+    ufsWorklist.clear();
+    addInitialNewlyUnfoundedAtomsAfterSetFact(fact);
+
+    // the atoms of the worklist lose their source pointers, which propagates along the source pointers of their component
+    while (!ufsWorklist.empty()) {
+        IDAddress newlyUnfoundedAtom = ufsWorklist.back();
+        ufsWorklist.pop_back();
+
+        // only atoms which occur in non-singular components
+        // (singular atoms are already handled by static loop nogoods)
+        if (isNonSingular(newlyUnfoundedAtom)) {
+            // only atoms which are not already unfounded or false
+            if (!falsified(createLiteral(newlyUnfoundedAtom)) && !unfoundedAtoms.contains(newlyUnfoundedAtom)) {
+                DBGLOGD(DBG, "Atom " << newlyUnfoundedAtom << " becomes unfounded");
+                removeSourceFromAtom(newlyUnfoundedAtom);
+                unfoundedAtoms.insert(newlyUnfoundedAtom);
+
+                // collect depending atoms
+                addDependingAtoms(newlyUnfoundedAtom);
             }
         }
-        newlyUnfoundedAtoms = nextNewlyUnfoundedAtoms;
     }
 
-    DBGLOG(DBG, "Updated set of unfounded atoms: " << toString(unfoundedAtoms));
+    DBGLOG(DBG, "Updated set of unfounded atoms: " << toString(unfoundedAtoms.atoms));
 }
 
 
 void InternalGroundASPSolver::updateUnfoundedSetStructuresAfterClearFact(IDAddress litadr)
 {
 
-    DBGLOGD(DBG, "Updating set of atoms without source pointers, currently: " << toString(unfoundedAtoms));
+    DBGLOGD(DBG, "Updating set of atoms without source pointers, currently: " << toString(unfoundedAtoms.atoms));
 
     // fact becomes unfounded if it has no source pointer
     // and if it is non-singular
-    if (nonSingularFacts.count(litadr) > 0) {
-        if (sourceRule.find(litadr) == sourceRule.end()) {
+    if (isNonSingular(litadr)) {
+        if (sourceRule[litadr] == noSource) {
             unfoundedAtoms.insert(litadr);
         }
     }
 
-    DBGLOGD(DBG, "Updated set of unfounded atoms: " << toString(unfoundedAtoms));
+    DBGLOGD(DBG, "Updated set of unfounded atoms: " << toString(unfoundedAtoms.atoms));
 }
 
 
-ID InternalGroundASPSolver::getPossibleSourceRule(const Set<ID>& ufs)
+int InternalGroundASPSolver::getPossibleSourceRule(const AtomSet& s)
 {
 
-    DBGLOG(DBG, "Computing externally supporting rules for " << toString(ufs));
+    DBGLOG(DBG, "Computing externally supporting rules for " << toString(s.atoms));
 
-    Set<ID> extSup = getExternalSupport(ufs);
+    getExternalSupport(s);
 
     #ifndef NDEBUG
     {
         std::stringstream ss;
         ss << "Externally supporting rules of potential ufs: {";
         bool first = true;
-        BOOST_FOREACH (ID ruleID, extSup) {
+        BOOST_FOREACH (int rule, externalSupport) {
             if (!first) ss << ", ";
             first = false;
-            ss << ruleID.address;
+            ss << rule;
         }
         ss << "}";
         DBGLOG(DBG, ss.str());
     }
     #endif
 
-    // from this set, remove all rules which are satisfied independently from ufs
+    // from this set, skip all rules which are satisfied independently from ufs
     // and can therefore not be used as source rules
-    BOOST_FOREACH (ID extRuleID, extSup) {
-        Set<ID> satInd = satisfiesIndependently(extRuleID, ufs);
-        bool skipRule = false;
-        BOOST_FOREACH (ID indSatLit, satInd) {
-            if (satisfied(indSatLit)) {
-                skipRule = true;
-                break;
-            }
-        }
-        if (!skipRule) {
-            DBGLOG(DBG, "Found possible source rule: " << extRuleID.address);
-            return extRuleID;
+    BOOST_FOREACH (int extRule, externalSupport) {
+        if (getSatisfiedIndependentLiteral(extRule, s) == ID_FAIL) {
+            DBGLOG(DBG, "Found possible source rule: " << extRule);
+            return extRule;
         }
         else {
-            DBGLOG(DBG, "Rule " << extRuleID.address << " is removed (independently satisfied)");
+            DBGLOG(DBG, "Rule " << extRule << " is removed (independently satisfied)");
         }
     }
 
-    return ID_FAIL;
+    return -1;
 }
 
 
 // a head atom uses the rule as source, if
 // 1. the atom is currently unfounded
 // 2. no other head literal was set to true earlier
-bool InternalGroundASPSolver::useAsNewSourceForHeadAtom(IDAddress headAtom, ID sourceRuleID)
+bool InternalGroundASPSolver::useAsNewSourceForHeadAtom(IDAddress headAtom, int sourceRule)
 {
 
-    DBGLOG(DBG, "Checking if " << headAtom << " uses rule " << sourceRuleID.address << " as source");
-    if (unfoundedAtoms.count(headAtom) == 0) {
+    DBGLOG(DBG, "Checking if " << headAtom << " uses rule " << sourceRule << " as source");
+    if (!unfoundedAtoms.contains(headAtom)) {
         DBGLOG(DBG, "No: " << headAtom << " is currently not unfounded");
         return false;
     }
 
-    const Rule& sourceRule = reg->rules.getByID(sourceRuleID);
-
     // only the literal which was set first can use a rule as source:
     //
     // if headLit is currently assigned, other head literals must not be set to true earlier
     // if headLit is currently unassigned, other head literals must not be true at all
     if (assigned(headAtom)) {
-        int headLitDecisionLevel = decisionlevel[headAtom];
-        BOOST_FOREACH (ID otherHeadLit, sourceRule.head) {
-            if (otherHeadLit.address != headAtom) {
-                if (satisfied(otherHeadLit)) {
+        for (int h = headAtomsBegin[sourceRule]; h < headAtomsBegin[sourceRule + 1]; ++h) {
+            IDAddress otherHeadAtom = headAtoms[h];
+            if (otherHeadAtom != headAtom) {
+                if (satisfied(createLiteral(otherHeadAtom))) {
                     // TODO: maybe we have to compare the order of assignments instead of the decision levels
                     //       or we can use the decision level (would be much more efficient)
                     if (
-                        getAssignmentOrderIndex(otherHeadLit.address) < getAssignmentOrderIndex(headAtom)
+                        getAssignmentOrderIndex(otherHeadAtom) < getAssignmentOrderIndex(headAtom)
                     ) {
-                        DBGLOG(DBG, "No: Head literal " << otherHeadLit.address << " was set to true on a lower decision level");
+                        DBGLOG(DBG, "No: Head literal " << otherHeadAtom << " was set to true on a lower decision level");
                         return false;
                     }
                 }
@@ -672,10 +664,11 @@ bool InternalGroundASPSolver::useAsNewSourceForHeadAtom(IDAddress headAtom, ID s
         }
     }
     else {
-        BOOST_FOREACH (ID otherHeadLit, sourceRule.head) {
-            if (otherHeadLit.address != headAtom) {
-                if (satisfied(otherHeadLit)) {
-                    DBGLOG(DBG, "No: Head literal " << otherHeadLit.address << " was already set to true, whereas " << headAtom << " is unassigned");
+        for (int h = headAtomsBegin[sourceRule]; h < headAtomsBegin[sourceRule + 1]; ++h) {
+            IDAddress otherHeadAtom = headAtoms[h];
+            if (otherHeadAtom != headAtom) {
+                if (satisfied(createLiteral(otherHeadAtom))) {
+                    DBGLOG(DBG, "No: Head literal " << otherHeadAtom << " was already set to true, whereas " << headAtom << " is unassigned");
                     return false;
                 }
             }
@@ -685,78 +678,66 @@ bool InternalGroundASPSolver::useAsNewSourceForHeadAtom(IDAddress headAtom, ID s
 }
 
 
-Set<ID> InternalGroundASPSolver::getUnfoundedSet()
+const std::vector<IDAddress>& InternalGroundASPSolver::getUnfoundedSet()
 {
 
-    DBGLOG(DBG, "Currently unfounded atoms: " << toString(unfoundedAtoms));
+    DBGLOG(DBG, "Currently unfounded atoms: " << toString(unfoundedAtoms.atoms));
 
-    Set<ID> ufs(5, 10);
-    while (unfoundedAtoms.size() > 0) {
-        IDAddress atom = *(unfoundedAtoms.begin());
+    while (!unfoundedAtoms.empty()) {
+        IDAddress atom = unfoundedAtoms.atoms.back();
         ufs.clear();
-        ufs.insert(createLiteral(atom));
+        ufs.insert(atom);
         do {
-            DBGLOG(DBG, "Trying to build an unfounded set over " << toString(ufs));
+            DBGLOG(DBG, "Trying to build an unfounded set over " << toString(ufs.atoms));
 
             // find a rule which externally supports ufs and
             // which is not satisfied independently of ufs
-            ID supportingRuleID = getPossibleSourceRule(ufs);
+            int supportingRule = getPossibleSourceRule(ufs);
 
             // if no rule survives, ufs is indeed unfounded
-            if (supportingRuleID == ID_FAIL) return ufs;
+            if (supportingRule == -1) return ufs.atoms;
 
             // check if this rule depends on unfounded atoms from atom's component
-            const Rule& supportingRule = reg->rules.getByID(supportingRuleID);
             bool dependsOnUnfoundedAtoms = false;
-            BOOST_FOREACH (ID bodyLit, supportingRule.body) {
-                if (!bodyLit.isNaf() && (unfoundedAtoms.count(bodyLit.address) > 0) && (depSCC[componentOfAtom[atom]].count(bodyLit.address) > 0)) {
+            for (int b = posBodyAtomsBegin[supportingRule]; b < posBodyAtomsBegin[supportingRule + 1]; ++b) {
+                IDAddress bodyAtom = posBodyAtoms[b];
+                if (unfoundedAtoms.contains(bodyAtom) && componentOfAtom[bodyAtom] == componentOfAtom[atom]) {
                     // extend the unfounded set by this atom
-                    DBGLOG(DBG, "Rule depends on unfounded " << litToString(bodyLit) << " --> adding to ufs");
-                    ufs.insert(createLiteral(bodyLit));
+                    DBGLOG(DBG, "Rule depends on unfounded " << bodyAtom << " --> adding to ufs");
+                    ufs.insert(bodyAtom);
                     dependsOnUnfoundedAtoms = true;
                 }
             }
 
             // if the rule does not depend on unfounded atoms, it can be used as the new source for its head atom(s)
             if (!dependsOnUnfoundedAtoms) {
-                BOOST_FOREACH (ID headLit, supportingRule.head) {
-
-                    if (useAsNewSourceForHeadAtom(headLit.address, supportingRuleID)) {
+                for (int h = headAtomsBegin[supportingRule]; h < headAtomsBegin[supportingRule + 1]; ++h) {
+                    IDAddress headAtom = headAtoms[h];
+                    if (useAsNewSourceForHeadAtom(headAtom, supportingRule)) {
                         // use the rule as new source
-                        DBGLOG(DBG, "Using rule " << supportingRuleID.address << " as new source for " << headLit.address);
-                        addSourceToAtom(headLit.address, supportingRuleID);
+                        DBGLOG(DBG, "Using rule " << supportingRule << " as new source for " << headAtom);
+                        addSourceToAtom(headAtom, supportingRule);
 
-                        // atom hIt->address is no longer unfounded
-                        unfoundedAtoms.erase(headLit.address);
-                        ufs.erase(createLiteral(headLit.address));
+                        // atom headAtom is no longer unfounded
+                        unfoundedAtoms.erase(headAtom);
+                        ufs.erase(headAtom);
                     }
                 }
             }
-        }while(ufs.size() > 0);
+        }while(!ufs.empty());
     }
 
-    return Set<ID>();
+    ufs.clear();
+    return ufs.atoms;
 }
 
 
-bool InternalGroundASPSolver::doesRuleExternallySupportLiteral(ID ruleID, ID lit, const Set<ID>& s)
+bool InternalGroundASPSolver::doesRuleExternallySupportLiteral(int rule, const AtomSet& s)
 {
 
-    const Rule& rule = reg->rules.getByID(ruleID);
-
-    // check if the rule supports the literal
-    bool supportsLit = false;
-    BOOST_FOREACH (ID headLit, rule.head) {
-        if (headLit.address == lit.address) {
-            supportsLit = true;
-            break;
-        }
-    }
-    if (!supportsLit) return false;
-
     // check if the support is external wrt s
-    BOOST_FOREACH (ID sLit, s) {
-        if (contains(rule.body, sLit)) {
+    for (int b = posBodyAtomsBegin[rule]; b < posBodyAtomsBegin[rule + 1]; ++b) {
+        if (s.contains(posBodyAtoms[b])) {
             return false;
         }
     }
@@ -765,56 +746,55 @@ bool InternalGroundASPSolver::doesRuleExternallySupportLiteral(ID ruleID, ID lit
 }
 
 
-Set<ID> InternalGroundASPSolver::getExternalSupport(const Set<ID>& s)
+void InternalGroundASPSolver::getExternalSupport(const AtomSet& s)
 {
 
-    Set<ID> extRules;
-    DBGLOG(DBG, "Computing externally supporting rules for set " << toString(s));
+    externalSupport.clear();
+    externalSupportCalls++;
+    DBGLOG(DBG, "Computing externally supporting rules for set " << toString(s.atoms));
 
     // go through all rules which contain one of s in their head
-    BOOST_FOREACH (ID lit, s) {
-
-        const Set<ID>& containingRules = rulesWithPosHeadLiteral[lit.address];
+    BOOST_FOREACH (IDAddress atom, s.atoms) {
+        if (atom + 1 >= rulesWithHeadAtomBegin.size()) continue;
 
-        BOOST_FOREACH (ID ruleID, containingRules) {
+        for (int i = rulesWithHeadAtomBegin[atom]; i < rulesWithHeadAtomBegin[atom + 1]; ++i) {
+            int rule = rulesWithHeadAtom[i];
+            if (ruleVisited[rule] == externalSupportCalls) continue;
+            ruleVisited[rule] = externalSupportCalls;
 
             // check if none of the elements of s occurs in the body of r
-            if (doesRuleExternallySupportLiteral(ruleID, lit, s)) {
-                DBGLOG(DBG, "Found external rule " << ruleID.address << " for set " << toString(s));
-                extRules.insert(ruleID);
+            if (doesRuleExternallySupportLiteral(rule, s)) {
+                DBGLOG(DBG, "Found external rule " << rule << " for set " << toString(s.atoms));
+                externalSupport.push_back(rule);
             }
             else {
-                DBGLOGD(DBG, "Rule " << ruleID.address << " contains " << lit.address << " but does not externally support it wrt " << toString(s));
+                DBGLOGD(DBG, "Rule " << rule << " contains " << atom << " but does not externally support it wrt " << toString(s.atoms));
             }
         }
     }
-    return extRules;
 }
 
 
-Set<ID> InternalGroundASPSolver::satisfiesIndependently(ID ruleID, const Set<ID>& y)
+ID InternalGroundASPSolver::getSatisfiedIndependentLiteral(int rule, const AtomSet& y)
 {
 
-    const Rule& rule = reg->rules.getByID(ruleID);
-
-    // compute all literals which satisfy the rule independently of set y:
+    // literals which satisfy the rule independently of set y:
     // either (i) the body of rule is false; or
     //        (ii) some head literal, which is not in y, is true
-    Set<ID> indSat;
                                  // (i)
-    indSat.insert(createLiteral(bodyAtomOfRule[ruleID.address], false));
+    ID bodyFalse = createLiteral(bodyAtomOfRule[rule], false);
+    if (satisfied(bodyFalse)) return bodyFalse;
                                  // (ii)
-    BOOST_FOREACH (ID headLiteral, rule.head) {
-        if (y.count(createLiteral(headLiteral.address)) == 0) {
-            indSat.insert(createLiteral(headLiteral.address));
+    for (int h = headAtomsBegin[rule]; h < headAtomsBegin[rule + 1]; ++h) {
+        if (!y.contains(headAtoms[h]) && satisfied(createLiteral(headAtoms[h]))) {
+            return createLiteral(headAtoms[h]);
         }
     }
-    DBGLOG(DBG, "Rule " << ruleID.address << " is satisfied independently from " << toString(y) << " by " << toString(indSat));
-    return indSat;
+    return ID_FAIL;
 }
 
 
-Nogood InternalGroundASPSolver::getLoopNogood(const Set<ID>& ufs)
+Nogood InternalGroundASPSolver::getLoopNogood(const AtomSet& ufs)
 {
 
     Nogood loopNogood;
@@ -823,24 +803,17 @@ Nogood InternalGroundASPSolver::getLoopNogood(const Set<ID>& ufs)
     // choose one l from
     // lamba(ufs) = { Ta | a in ufs} x Prod_{r in extsup(ufs)} indsat(r, ufs)
     // such that l \ { Ta | a in ufs} is currently satisfied
-    loopNogood.insert(createLiteral(*(ufs.begin())));
+    loopNogood.insert(createLiteral(ufs.atoms.front()));
 
     // choose for each external rule one literal which
     // (i) satisfies it independently from ufs; and
     // (ii) is currently true
-    Set<ID> extSup = getExternalSupport(ufs);
-    BOOST_FOREACH (ID ruleID, extSup) {
-                                 // (i)
-        Set<ID> satInd = satisfiesIndependently(ruleID, ufs);
-        BOOST_FOREACH (ID indLit, satInd) {
-                                 // (ii)
-            if (satisfied(indLit)) {
-                loopNogood.insert(createLiteral(indLit));
-                break;
-            }
-        }
+    getExternalSupport(ufs);
+    BOOST_FOREACH (int rule, externalSupport) {
+        ID indLit = getSatisfiedIndependentLiteral(rule, ufs);
+        if (indLit != ID_FAIL) loopNogood.insert(indLit);
     }
-    DBGLOG(DBG, "Loop nogood for " << toString(ufs) << " is " << loopNogood);
+    DBGLOG(DBG, "Loop nogood for " << toString(ufs.atoms) << " is " << loopNogood);
 
     return loopNogood;
 }
@@ -941,6 +914,7 @@ InternalGroundASPSolver::InternalGroundASPSolver(ProgramCtx& c, const AnnotatedG
     createSingularLoopNogoods(frozen);
     resizeVectors();
     initWatchingStructures();
+    initDecisionHeuristics();
     computeDepGraph();
     computeStronglyConnectedComponents();
     initSourcePointers();
@@ -972,7 +946,7 @@ Nogood InternalGroundASPSolver::getInconsistencyCause(InterpretationConstPtr exp
         // heuristics: choose a conflicting nogood with minimal cardinality
         int conflictNogoodIndex = contradictoryNogoods[0];
         BOOST_FOREACH (int i, contradictoryNogoods) {
-            if (nogoodset.getNogood(i).size() < nogoodset.getNogood(conflictNogoodIndex).size()) conflictNogoodIndex = i;
+            if (nogoodset.getNogoodSize(i) < nogoodset.getNogoodSize(conflictNogoodIndex)) conflictNogoodIndex = i;
         }
         Nogood violatedNogood = nogoodset.getNogood(conflictNogoodIndex);
 //        Nogood violatedNogood = nogoodset.getNogood(*(contradictoryNogoods.begin()));
@@ -1154,10 +1128,12 @@ InterpretationPtr InternalGroundASPSolver::getNextModel()
                     Nogood learnedNogood;
                     int k = currentDL;
                     analysis(violatedNogood, learnedNogood, k);
-                    recentConflicts.push_back(addNogoodAndUpdateWatchingStructures(learnedNogood));
+                    recentConflicts.push_back(addLearnedNogood(learnedNogood));
                                  // do not jump below exhausted level, this could lead to regeneration of models
                     currentDL = k > exhaustedDL ? k : exhaustedDL;
                     backtrack(currentDL);
+                    restartIfDue();
+                    reduceLearnedNogoodsIfDue();
                 }
                 else {
                     flipDecisionLiteral();
@@ -1165,16 +1141,17 @@ InterpretationPtr InternalGroundASPSolver::getNextModel()
             }
         }
         else {
-            Set<ID> ufs = getUnfoundedSet();
+            const std::vector<IDAddress>& ufsAtoms = getUnfoundedSet();
 
-            if (ufs.size() > 0) {
-                DBGLOG(DBG, "Found UFS: " << toString(ufs));
+            if (ufsAtoms.size() > 0) {
+                DBGLOG(DBG, "Found UFS: " << toString(ufsAtoms));
                 #ifndef NDEBUG
                 ++cntDetectedUnfoundedSets;
                 #endif
 
+                // loop nogoods can be deleted later since unfounded sets are searched for at every fixpoint anyway
                 Nogood loopNogood = getLoopNogood(ufs);
-                addNogoodAndUpdateWatchingStructures(loopNogood);
+                addLearnedNogood(loopNogood);
                 anotherIterationEvenIfComplete = true;
             }
             else {
@@ -40,13 +40,14 @@
 #include "dlvhex2/Printer.h"
 #include "dlvhex2/Benchmarking.h"
 #include <boost/functional/hash.hpp>
+#include <boost/tuple/tuple.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
 
 std::size_t hash_value(const Interpretation& intr)
 {
     std::size_t seed = 0;
-    Interpretation::Storage bits= intr.getStorage();
+    const Interpretation::Storage& bits = intr.getStorage();
     Interpretation::Storage::enumerator it = bits.first();
     while ( it != bits.end() ) {
         boost::hash_combine(seed, *it);
@@ -58,7 +59,9 @@ std::size_t hash_value(const Interpretation& intr)
 
 Interpretation::Interpretation(RegistryPtr registry):
 registry(registry),
-bits()
+bits(new Storage()),
+hashUpdated(false),
+myHash(0)
 {
 }
 
@@ -77,8 +80,8 @@ unsigned Interpretation::filter(FilterCallback cb)
     Storage resetThose;
 
     // go through one-bits
-    for(Storage::enumerator it = bits.first();
-    it != bits.end(); ++it) {
+    for(Storage::enumerator it = bits->first();
+    it != bits->end(); ++it) {
         if( !cb(*it) ) {
             resetThose.set(*it);
         }
@@ -94,6 +97,14 @@ unsigned Interpretation::filter(FilterCallback cb)
 }
 
 
+std::size_t Interpretation::getMemoryUsage() const
+{
+    Storage::statistics st;
+    bits->calc_stat(&st);
+    return st.memory_used;
+}
+
+
 std::ostream& Interpretation::print(std::ostream& o) const
 {
     return print(o, "{", ",", "}");
@@ -116,7 +127,7 @@ std::ostream& Interpretation::printAsFacts(std::ostream& o) const
 {
     print(o, "", ".", "");
     // make sure the last fact (if any fact exists) gets a dot
-    if( bits.first() != bits.end() )
+    if( bits->first() != bits->end() )
         o << ".";
     return o;
 }
@@ -126,13 +137,13 @@ std::ostream& Interpretation::print(
 std::ostream& o,
 const char* first, const char* sep, const char* last) const
 {
-    Storage::enumerator it = bits.first();
+    Storage::enumerator it = bits->first();
     o << first;
     RawPrinter printer(o, registry);
-    if( it != bits.end() ) {
+    if( it != bits->end() ) {
         printer.print(ID(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it));
         it++;
-        for(; it != bits.end(); ++it) {
+        for(; it != bits->end(); ++it) {
             o << sep;
             printer.print(ID(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it));
         }
@@ -145,13 +156,13 @@ std::ostream& Interpretation::printWithoutPrefix(
 std::ostream& o,
 const char* first, const char* sep, const char* last) const
 {
-    Storage::enumerator it = bits.first();
+    Storage::enumerator it = bits->first();
     o << first;
     RawPrinter printer(o, registry);
-    if( it != bits.end() ) {
+    if( it != bits->end() ) {
         printer.printWithoutPrefix(ID(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it));
         it++;
-        for(; it != bits.end(); ++it) {
+        for(; it != bits->end(); ++it) {
             o << sep;
             printer.printWithoutPrefix(ID(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it));
         }
@@ -164,12 +175,12 @@ std::ostream& Interpretation::printAsNumber(
 std::ostream& o,
 const char* first, const char* sep, const char* last) const
 {
-    Storage::enumerator it = bits.first();
+    Storage::enumerator it = bits->first();
     o << first;
-    if( it != bits.end() ) {
+    if( it != bits->end() ) {
         o << *it;
         it++;
-        for(; it != bits.end(); ++it) {
+        for(; it != bits->end(); ++it) {
             o << sep;
             o << *it;
         }
@@ -180,14 +191,16 @@ const char* first, const char* sep, const char* last) const
 
 void Interpretation::add(const Interpretation& other)
 {
-    bits |= other.bits;
+    detach();
+    *bits |= *other.bits;
     hashUpdated = false;
 }
 
 
 void Interpretation::bit_and(const Interpretation& other)
 {
-    bits &= other.bits;
+    detach();
+    *bits &= *other.bits;
     hashUpdated = false;
 }
 
@@ -212,21 +225,19 @@ InterpretationPtr Interpretation::getInterpretationWithoutExternalAtomAuxiliarie
 
 bool Interpretation::operator==(const Interpretation& other) const
 {
-    return bits == other.bits;
-    return getHash() == other.getHash() && bits == other.bits;
+    return bits == other.bits || *bits == *other.bits;
 }
 
 
 bool Interpretation::operator!=(const Interpretation& other) const
 {
-    return  bits != other.bits;
-    return getHash() != other.getHash() || bits != other.bits;
+    return bits != other.bits && *bits != *other.bits;
 }
 
 
 bool Interpretation::operator<(const Interpretation& other) const
 {
-    return bits < other.bits;
+    return bits != other.bits && *bits < *other.bits;
 }
 
 std::size_t Interpretation::getHash() const {
@@ -238,6 +249,27 @@ std::size_t Interpretation::getHash() const {
     return myHash;
 }
 
+bool InterpretationMaskView::isSubsetOf(const Storage& other) const
+{
+    TrueBitIterator it, it_end;
+    for(boost::tie(it, it_end) = trueBits(); it != it_end; ++it) {
+        if( !other.get_bit(*it) )
+            return false;
+    }
+    return true;
+}
+
+
+void InterpretationMaskView::materialize(Interpretation& out) const
+{
+    // copy the mask which is usually the smaller bitset
+    out.clear();
+    Storage& storage = out.getStorage();
+    storage = mask;
+    storage &= bits;
+}
+
+
 DLVHEX_NAMESPACE_END
 
 // vim:expandtab:ts=4:sw=4:
@@ -0,0 +1,241 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   MemoryUsage.cpp
+ *
+ * @brief  Approximate memory accounting for registry tables, nogoods, external atom caches and model graphs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/MemoryUsage.h"
+#include "dlvhex2/ProgramCtx.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Nogood.h"
+#include "dlvhex2/PluginInterface.h"
+#include "dlvhex2/ModelBuilder.h"
+#include "dlvhex2/Term.h"
+#include "dlvhex2/Predicate.h"
+#include "dlvhex2/Atoms.h"
+#include "dlvhex2/Rule.h"
+#include "dlvhex2/Module.h"
+#include "dlvhex2/Logger.h"
+
+#include <boost/foreach.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <iomanip>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace memory
+{
+
+    std::size_t DynamicSize::operator()(const Term& term) const
+    {
+        return heapSize(term.symbol) + heapSize(term.arguments);
+    }
+
+    std::size_t DynamicSize::operator()(const Predicate& pred) const
+    {
+        return heapSize(pred.symbol);
+    }
+
+    std::size_t DynamicSize::operator()(const OrdinaryAtom& atom) const
+    {
+        return heapSize(atom.text) + heapSize(atom.tuple);
+    }
+
+    std::size_t DynamicSize::operator()(const BuiltinAtom& atom) const
+    {
+        return heapSize(atom.tuple);
+    }
+
+    std::size_t DynamicSize::operator()(const AggregateAtom& atom) const
+    {
+        return heapSize(atom.tuple) + heapSize(atom.variables) + heapSize(atom.literals) +
+            heapSize(atom.mvariables) + heapSize(atom.mliterals);
+    }
+
+    std::size_t DynamicSize::operator()(const ExternalAtom& atom) const
+    {
+        std::size_t bytes = heapSize(atom.tuple) + heapSize(atom.inputs) + heapSize(atom.auxInputMapping);
+        BOOST_FOREACH(const std::list<unsigned>& positions, atom.auxInputMapping) {
+            bytes += positions.size() * (sizeof(unsigned) + 2 * sizeof(void*) + AllocationOverhead);
+        }
+        return bytes;
+    }
+
+    std::size_t DynamicSize::operator()(const ModuleAtom& atom) const
+    {
+        return heapSize(atom.tuple) + heapSize(atom.inputs) + heapSize(atom.actualModuleName);
+    }
+
+    std::size_t DynamicSize::operator()(const Rule& rule) const
+    {
+        return heapSize(rule.head) + heapSize(rule.body) + heapSize(rule.headGuard) +
+            heapSize(rule.bodyWeightVector) + heapSize(rule.weakconstraintVector);
+    }
+
+    std::size_t DynamicSize::operator()(const Module& module) const
+    {
+        return heapSize(module.moduleName);
+    }
+
+    void Report::add(const std::string& name, std::size_t bytes)
+    {
+        BOOST_FOREACH(Entries::value_type& entry, entries) {
+            if( entry.first == name ) {
+                entry.second += bytes;
+                return;
+            }
+        }
+        entries.push_back(std::make_pair(name, bytes));
+    }
+
+    void Report::updatePeak(const Report& sample)
+    {
+        BOOST_FOREACH(const Entries::value_type& entry, sample.entries) {
+            Entries::iterator it = entries.begin();
+            while( it != entries.end() && it->first != entry.first )
+                ++it;
+            if( it == entries.end() )
+                entries.push_back(entry);
+            else if( it->second < entry.second )
+                it->second = entry.second;
+        }
+    }
+
+    std::size_t Report::getTotal() const
+    {
+        std::size_t total = 0;
+        BOOST_FOREACH(const Entries::value_type& entry, entries) {
+            total += entry.second;
+        }
+        return total;
+    }
+
+    std::ostream& Report::print(std::ostream& o) const
+    {
+        BOOST_FOREACH(const Entries::value_type& entry, entries) {
+            o << entry.first << ";" << entry.second << ";";
+        }
+        return o << "total;" << getTotal();
+    }
+
+    void collect(ProgramCtx& ctx, Report& report)
+    {
+        if( !!ctx.registry() )
+            ctx.registry()->getMemoryUsage(report);
+        report.add("nogoods", NogoodSet::getTotalMemoryUsage());
+
+        std::size_t cacheBytes = 0;
+        BOOST_FOREACH(const PluginAtomMap::value_type& entry, ctx.pluginAtomMap()) {
+            cacheBytes += entry.second->getCacheMemoryUsage();
+        }
+        report.add("extcache", cacheBytes);
+    }
+
+    std::size_t modelGraphSize(ProgramCtx& ctx)
+    {
+        if( !ctx.modelBuilder )
+            return 0;
+        return ctx.modelBuilder->getModelGraph().getMemoryUsage();
+    }
+
+    Sampler::Sampler(ProgramCtx& ctx, unsigned intervalMs, std::ostream& out):
+    ctx(ctx),
+        interval(boost::posix_time::milliseconds(intervalMs)),
+        out(out),
+        start(boost::posix_time::microsec_clock::universal_time()),
+        modelGraphBytes(modelGraphSize(ctx)),
+        modelGraphRequested(false),
+        stopping(false)
+    {
+        thread = boost::thread(&Sampler::run, this);
+    }
+
+    Sampler::~Sampler()
+    {
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            stopping = true;
+        }
+        stopCondition.notify_all();
+        thread.join();
+    }
+
+    void Sampler::run()
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        while( !stopping ) {
+            stopCondition.timed_wait(lock, interval);
+            if( stopping )
+                break;
+            // collecting may take locks of the components, do not block the destructor meanwhile
+            lock.unlock();
+            sample();
+            lock.lock();
+        }
+    }
+
+    void Sampler::sample()
+    {
+        Report report;
+        collect(ctx, report);
+        report.add("modelgraph", modelGraphBytes.load());
+        modelGraphRequested.store(true);
+
+        const double seconds = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1000000.0;
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            peak.updatePeak(report);
+        }
+        out << "MEMSAMPLE;" << std::fixed << std::setprecision(3) << seconds << ";" << report << std::endl;
+    }
+
+    void Sampler::modelGraphCheckpoint(ProgramCtx& ctx)
+    {
+        if( modelGraphRequested.exchange(false) )
+            modelGraphBytes.store(modelGraphSize(ctx));
+    }
+
+    Report Sampler::getPeak() const
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        return peak;
+    }
+
+}                                // namespace memory
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -38,6 +38,7 @@
 #include <algorithm>
 #include "dlvhex2/Logger.h"
 #include "dlvhex2/Printer.h"
+#include "dlvhex2/Error.h"
 #include <boost/functional/hash.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
@@ -378,39 +379,121 @@ void Nogood::dbgload(std::string str)
 
 // ---------- Class NogoodSet ----------
 
+boost::atomic<std::size_t> NogoodSet::totalNogoodBytes(0);
+
+NogoodSet::NogoodSet():
+unusedLiterals(0),
+nogoodBytes(0)
+{
+}
+
+
+NogoodSet::NogoodSet(const NogoodSet& other):
+literals(other.literals),
+slots(other.slots),
+unusedLiterals(other.unusedLiterals),
+addCount(other.addCount),
+freeIndices(other.freeIndices),
+nogoodsWithHash(other.nogoodsWithHash),
+nogoodBytes(0)
+{
+    updateAccount();
+}
+
+
+NogoodSet::~NogoodSet()
+{
+    account(0, nogoodBytes);
+}
+
+
+std::size_t NogoodSet::storageSize() const
+{
+    return memory::heapSize(literals) + memory::heapSize(slots);
+}
+
+
+void NogoodSet::account(std::size_t added, std::size_t removed)
+{
+    nogoodBytes = nogoodBytes + added - removed;
+    if( added >= removed )
+        totalNogoodBytes.fetch_add(added - removed, boost::memory_order_relaxed);
+    else
+        totalNogoodBytes.fetch_sub(removed - added, boost::memory_order_relaxed);
+}
+
+
+void NogoodSet::updateAccount()
+{
+    account(storageSize(), nogoodBytes);
+}
+
+
 const NogoodSet& NogoodSet::operator=(const NogoodSet& other)
 {
-    nogoods = other.nogoods;
+    literals = other.literals;
+    slots = other.slots;
+    unusedLiterals = other.unusedLiterals;
+    addCount = other.addCount;
     freeIndices = other.freeIndices;
     nogoodsWithHash = other.nogoodsWithHash;
+    updateAccount();
 
     return *this;
 }
 
 
+void NogoodSet::releaseLiterals(int nogoodIndex)
+{
+    unusedLiterals += slots[nogoodIndex].size;
+    slots[nogoodIndex].size = 0;
+    if (unusedLiterals > 0 && unusedLiterals >= literals.size() / 2) compactLiterals();
+}
+
+
+void NogoodSet::compactLiterals()
+{
+    // nogoods keep their order in the pool, thus they can be moved in place
+    uint32_t used = 0;
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[i];
+        if (slot.size > 0 && slot.begin != used) {
+            std::copy(literals.begin() + slot.begin, literals.begin() + slot.begin + slot.size, literals.begin() + used);
+        }
+        slot.begin = used;
+        used += slot.size;
+    }
+    // release the memory
+    std::vector<uint32_t>(literals.begin(), literals.begin() + used).swap(literals);
+    unusedLiterals = 0;
+    updateAccount();
+}
+
+
 // reorders the nogoods such that there are no free indices in the range 0-(getNogoodCount()-1)
 void NogoodSet::defragment()
 {
     if (freeIndices.size() == 0) return;
 
     int free = 0;
-    int used = nogoods.size() - 1;
+    int used = slots.size() - 1;
     while (free < used) {
         // let used point to the last element which is not free
         while (used > 0 && freeIndices.count(used) > 0) {
-            nogoods.pop_back();
+            slots.pop_back();
+            addCount.pop_back();
             used--;
         }
         // let free point to the next free index in the range 0-(ngg.nogoods.size()-1)
-        while (free < (int)nogoods.size() - 1 && freeIndices.count(free) == 0) free++;
+        while (free < (int)slots.size() - 1 && freeIndices.count(free) == 0) free++;
         // move used to free
         if (free < used) {
-            nogoods[free] = nogoods[used];
+            slots[free] = slots[used];
             addCount[free] = addCount[used];
-            nogoods.pop_back();
+            slots.pop_back();
             addCount.pop_back();
-            nogoodsWithHash[nogoods[free].getHash()].erase(used);
-            nogoodsWithHash[nogoods[free].getHash()].insert(free);
+            nogoodsWithHash[slots[free].hash].erase(used);
+            nogoodsWithHash[slots[free].hash].insert(free);
             freeIndices.erase(free);
             free++;
             used--;
@@ -422,12 +505,13 @@ void NogoodSet::defragment()
         typedef std::pair<size_t, Set<int> > Pair;
         BOOST_FOREACH (Pair p, nogoodsWithHash) {
             BOOST_FOREACH (int i, p.second) {
-                assert (i < (int)nogoods.size());
+                assert (i < (int)slots.size());
             }
         }
     }
     #endif
     freeIndices.clear();
+    compactLiterals();
 }
 
 
@@ -439,7 +523,7 @@ int NogoodSet::addNogood(Nogood ng)
 
     // check if ng is already present
     BOOST_FOREACH (int i, nogoodsWithHash[ng.getHash()]) {
-        if (nogoods[i] == ng) {
+        if ((int)slots[i].size == ng.size() && std::equal(getLiterals(i).begin(), getLiterals(i).end(), ng.begin())) {
             addCount[i]++;
             DBGLOG(DBG, "Already contained with index " << i);
             return i;
@@ -449,40 +533,50 @@ int NogoodSet::addNogood(Nogood ng)
     // nogood is not present
     int index;
     if (freeIndices.size() == 0) {
-        nogoods.push_back(ng);
+        slots.push_back(Slot());
         addCount.push_back(1);
-        index = nogoods.size() - 1;
+        index = slots.size() - 1;
     }
     else {
         index = *freeIndices.begin();
-        nogoods[index] = ng;
         addCount[index] = 1;
         freeIndices.erase(index);
     }
     DBGLOG(DBG, "Adding with index " << index);
 
+    // append the literals to the pool
+    Slot& slot = slots[index];
+    slot.begin = literals.size();
+    slot.size = ng.size();
+    slot.hash = ng.getHash();
+    BOOST_FOREACH (ID lit, ng) {
+        if (lit.address >= (1u << 30)) throw GeneralError("Atom address exceeds the range of compact nogood literals");
+        literals.push_back(compactLiteral(lit));
+    }
+    updateAccount();
+
     nogoodsWithHash[ng.getHash()].insert(index);
     return index;
 }
 
 
-Nogood& NogoodSet::getNogood(int index)
-{
-    return nogoods[index];
-}
-
-
-const Nogood& NogoodSet::getNogood(int index) const
+Nogood NogoodSet::getNogood(int index) const
 {
-    return nogoods[index];
+    Nogood ng;
+    BOOST_FOREACH (ID lit, getLiterals(index)) {
+        ng.insert(lit);
+    }
+    ng.recomputeHash();
+    return ng;
 }
 
 
 void NogoodSet::removeNogood(int nogoodIndex)
 {
     addCount[nogoodIndex] = 0;
-    nogoodsWithHash[nogoods[nogoodIndex].getHash()].erase(nogoodIndex);
+    nogoodsWithHash[slots[nogoodIndex].hash].erase(nogoodIndex);
     freeIndices.insert(nogoodIndex);
+    releaseLiterals(nogoodIndex);
     //	defragment();	// make sure that the nogood vector does not contain free slots
 }
 
@@ -493,7 +587,7 @@ void NogoodSet::removeNogood(Nogood ng)
 
     // check if ng is present
     BOOST_FOREACH (int i, nogoodsWithHash[ng.getHash()]) {
-        if (nogoods[i] == ng) {
+        if ((int)slots[i].size == ng.size() && std::equal(getLiterals(i).begin(), getLiterals(i).end(), ng.begin())) {
             DBGLOG(DBG, "Deleting nogood " << ng << " (index: " << i << ")");
             // yes: delete it
             removeNogood(i);
@@ -504,9 +598,17 @@ void NogoodSet::removeNogood(Nogood ng)
 }
 
 
+void NogoodSet::clearNogood(int nogoodIndex)
+{
+    addCount[nogoodIndex] = 0;
+    nogoodsWithHash[slots[nogoodIndex].hash].erase(nogoodIndex);
+    releaseLiterals(nogoodIndex);
+}
+
+
 int NogoodSet::getNogoodCount() const
 {
-    return nogoods.size() - freeIndices.size();
+    return slots.size() - freeIndices.size();
 }
 
 
@@ -514,30 +616,44 @@ void NogoodSet::forgetLeastFrequentlyAdded()
 {
 
     int mac = 0;
-    for (uint32_t i = 0; i < nogoods.size(); i++) {
+    for (uint32_t i = 0; i < slots.size(); i++) {
         mac = mac > addCount[i] ? mac : addCount[i];
     }
     // delete those with an add count of less than 5% of the maximum add count
-    for (uint32_t i = 0; i < nogoods.size(); i++) {
+    for (uint32_t i = 0; i < slots.size(); i++) {
         if (addCount[i] < mac * 0.05) {
-            DBGLOG(DBG, "Forgetting nogood " << nogoods[i]);
+            DBGLOG(DBG, "Forgetting nogood " << getNogood(i));
             removeNogood(i);
         }
     }
 }
 
 
+std::size_t NogoodSet::getMemoryUsage() const
+{
+    return nogoodBytes +
+        memory::heapSize(addCount) +
+        freeIndices.capacity() * sizeof(int) +
+        nogoodsWithHash.bucket_count() * sizeof(void*) +
+        nogoodsWithHash.size() * (sizeof(std::pair<const std::size_t, Set<int> >) + sizeof(void*) + memory::AllocationOverhead);
+}
+
+
+std::size_t NogoodSet::getTotalMemoryUsage()
+{
+    return totalNogoodBytes.load(boost::memory_order_relaxed);
+}
+
+
 std::string NogoodSet::getStringRepresentation(RegistryPtr reg) const
 {
 
     std::stringstream ss;
-    bool first = true;
-    BOOST_FOREACH (Nogood ng, nogoods) {
-        if (!first) {
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        if (i > 0) {
             ss << ", ";
         }
-        first = false;
-        ss << ng.getStringRepresentation(reg);
+        ss << getNogood(i).getStringRepresentation(reg);
     }
     return ss.str();
 }
@@ -546,9 +662,9 @@ std::string NogoodSet::getStringRepresentation(RegistryPtr reg) const
 std::ostream& NogoodSet::print(std::ostream& o) const
 {
     o << "{ ";
-    for (std::vector<Nogood>::const_iterator it = nogoods.begin(); it != nogoods.end(); ++it) {
-        if (it != nogoods.begin()) o << ", ";
-        o << (*it);
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        if (i > 0) o << ", ";
+        o << getNogood(i);
     }
     o << " }";
     return o;
@@ -569,7 +685,7 @@ void SimpleNogoodContainer::removeNogood(Nogood ng)
 }
 
 
-Nogood& SimpleNogoodContainer::getNogood(int index)
+Nogood SimpleNogoodContainer::getNogood(int index)
 {
     boost::mutex::scoped_lock lock(mutex);
     return ngg.getNogood(index);
@@ -702,6 +818,13 @@ void SimpleNogoodContainer::defragment()
 }
 
 
+std::size_t SimpleNogoodContainer::getMemoryUsage()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    return ngg.getMemoryUsage();
+}
+
+
 DLVHEX_NAMESPACE_END
 
 // vim:expandtab:ts=4:sw=4:
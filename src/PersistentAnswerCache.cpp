@@ -0,0 +1,437 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   PersistentAnswerCache.cpp
+ *
+ * @brief  Answers of external sources which are kept across runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/PersistentAnswerCache.h"
+#include "dlvhex2/SolverWarmStartCache.h"
+#include "dlvhex2/ProgramCtx.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Interpretation.h"
+#include "dlvhex2/Error.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Benchmarking.h"
+
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace
+{
+    // 15 characters and terminating zero
+    const char Magic[16] = "dlvhex2extcache";
+    // detects files written on a platform with different byte order
+    const uint32_t ByteOrderMark = 0x01020304;
+
+    // keys and answers are serialized into strings in native byte order
+    void appendU32(std::string& out, uint32_t value)
+        { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void appendU64(std::string& out, boost::uint64_t value)
+        { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void appendString(std::string& out, const std::string& str) {
+        appendU32(out, str.size());
+        out.append(str);
+    }
+
+    // reads serialized data from memory, checking bounds
+    class AnswerCacheReader
+    {
+        private:
+            const char* pos;
+            const char* end;
+
+            void need(std::size_t bytes) {
+                if( static_cast<std::size_t>(end - pos) < bytes )
+                    throw GeneralError("data is truncated");
+            }
+
+        public:
+            AnswerCacheReader(const char* begin, const char* end): pos(begin), end(end) {}
+
+            bool atEnd() const
+                { return pos == end; }
+
+            void readBytes(char* target, std::size_t bytes) {
+                need(bytes);
+                std::memcpy(target, pos, bytes);
+                pos += bytes;
+            }
+            uint32_t readU32() {
+                uint32_t value;
+                readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+                return value;
+            }
+            void readString(std::string& str) {
+                const uint32_t size = readU32();
+                need(size);
+                str.assign(pos, size);
+                pos += size;
+            }
+            char readChar() {
+                char c;
+                readBytes(&c, 1);
+                return c;
+            }
+            // reads the size of a sequence and checks that the data can contain it (prevents huge allocations for corrupt data)
+            uint32_t readCount(std::size_t minBytesPerElement) {
+                const uint32_t count = readU32();
+                need(static_cast<std::size_t>(count) * minBytesPerElement);
+                return count;
+            }
+    };
+
+    // appends the textual representation of a term;
+    // variables are numbered by their first occurrence such that patterns which are equal up to renaming get the same representation
+    // (returns false for terms which cannot be restored in another run)
+    bool appendTerm(std::string& out, RegistryPtr reg, ID term, std::map<ID, uint32_t>& variables)
+    {
+        if( term.isIntegerTerm() ) {
+            out += 'i';
+            appendU32(out, term.address);
+        }
+        else if( term.isVariableTerm() ) {
+            if( term.isAnonymousVariable() ) {
+                out += '_';
+            }
+            else {
+                out += 'v';
+                appendU32(out, variables.insert(std::make_pair(term, variables.size())).first->second);
+            }
+        }
+        else if( term.isPredicateTerm() ) {
+            const Predicate& pred = reg->preds.getByID(term);
+            out += 'p';
+            appendU32(out, pred.arity);
+            appendString(out, pred.symbol);
+        }
+        else if( term.isConstantTerm() || term.isNestedTerm() ) {
+            const Term& t = reg->terms.getByID(term);
+            out += t.isNestedTerm() ? 'n' : 'c';
+            appendU32(out, t.kind);
+            if( t.isNestedTerm() ) {
+                appendU32(out, t.arguments.size());
+                BOOST_FOREACH (ID arg, t.arguments) {
+                    if( !appendTerm(out, reg, arg, variables) ) return false;
+                }
+            }
+            else {
+                appendString(out, t.symbol);
+            }
+        }
+        else {
+            // builtins do not occur in inputs and answers
+            return false;
+        }
+        return true;
+    }
+
+    // restores a term written by appendTerm (only ground constant, integer and nested terms can occur in answers)
+    ID readTerm(AnswerCacheReader& reader, RegistryPtr reg)
+    {
+        const char type = reader.readChar();
+        if( type == 'i' ) return ID::termFromInteger(reader.readU32());
+        if( type != 'c' && type != 'n' ) throw GeneralError("invalid term");
+
+        const ID kind(reader.readU32(), 0);
+        if( !kind.isTerm() || (type == 'c' ? !kind.isConstantTerm() : !kind.isNestedTerm()) )
+            throw GeneralError("invalid term kind");
+        Term term(kind.kind, "");
+        if( type == 'c' ) {
+            reader.readString(term.symbol);
+            if( term.symbol.empty() ) throw GeneralError("invalid term");
+        }
+        else {
+            std::vector<ID> args(reader.readCount(1 + sizeof(uint32_t)));
+            if( args.empty() ) throw GeneralError("invalid term");
+            BOOST_FOREACH (ID& arg, args) arg = readTerm(reader, reg);
+            term = Term(term.kind, args, reg);
+        }
+        ID id = reg->terms.getIDByString(term.symbol);
+        if( id == ID_FAIL ) id = reg->terms.storeAndGetID(term);
+        return id;
+    }
+}
+
+
+PersistentAnswerCache::PersistentAnswerCache(const std::string& filename, unsigned maxEntries):
+filename(filename), maxEntries(maxEntries), clock(0), hits(0), misses(0)
+{
+}
+
+
+void PersistentAnswerCache::load()
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Loading persistent answer cache");
+    boost::mutex::scoped_lock lock(mutex);
+
+    entries.clear();
+    clock = 0;
+
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if( !in.is_open() ) {
+        LOG(INFO,"external answer cache file '" << filename << "' does not exist yet, starting with an empty cache");
+        return;
+    }
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    try
+    {
+        AnswerCacheReader reader(data.data(), data.data() + data.size());
+
+        // header
+        char magic[sizeof(Magic)];
+        reader.readBytes(magic, sizeof(magic));
+        if( std::memcmp(magic, Magic, sizeof(Magic)) != 0 )
+            throw GeneralError("not a dlvhex external answer cache file");
+        if( reader.readU32() != ByteOrderMark )
+            throw GeneralError("written on a platform with different byte order");
+        if( reader.readU32() != FormatVersion )
+            throw GeneralError("unsupported format version");
+        std::string version;
+        reader.readString(version);
+        if( version != VERSION )
+            throw GeneralError("written by dlvhex " + version);
+
+        // entries in order of last use
+        const uint32_t entryCount = reader.readCount(2 * sizeof(uint32_t));
+        for(uint32_t e = 0; e < entryCount; ++e) {
+            std::string key;
+            reader.readString(key);
+            StoredEntry& stored = entries[key];
+            reader.readString(stored.answer);
+            stored.lastUse = ++clock;
+        }
+        if( !reader.atEnd() )
+            throw GeneralError("trailing data");
+    }
+    catch(const GeneralError& e) {
+        LOG(WARNING,"ignoring external answer cache file '" << filename << "': " << e.getErrorMsg());
+        entries.clear();
+        clock = 0;
+        return;
+    }
+    LOG(INFO,"loaded " << entries.size() << " answers from external answer cache file '" << filename << "'");
+}
+
+
+void PersistentAnswerCache::save()
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Saving persistent answer cache");
+    boost::mutex::scoped_lock lock(mutex);
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !out.is_open() )
+        throw GeneralError("could not open external answer cache file '" + filename + "' for writing");
+
+    // write the most recently used entries in order of last use such that loading restores the LRU order
+    typedef boost::unordered_map<std::string, StoredEntry>::value_type Entry;
+    std::vector<std::pair<uint32_t, const Entry*> > order;
+    order.reserve(entries.size());
+    BOOST_FOREACH (const Entry& entry, entries)
+        order.push_back(std::make_pair(entry.second.lastUse, &entry));
+    std::sort(order.begin(), order.end());
+    const std::size_t dropped = order.size() > maxEntries ? order.size() - maxEntries : 0;
+
+    std::string header(Magic, sizeof(Magic));
+    appendU32(header, ByteOrderMark);
+    appendU32(header, FormatVersion);
+    appendString(header, VERSION);
+    appendU32(header, order.size() - dropped);
+    out.write(header.data(), header.size());
+
+    std::string buffer;
+    for(std::size_t i = dropped; i < order.size(); ++i) {
+        buffer.clear();
+        appendString(buffer, order[i].second->first);
+        appendString(buffer, order[i].second->second.answer);
+        out.write(buffer.data(), buffer.size());
+    }
+
+    out.close();
+    if( out.fail() )
+        throw GeneralError("could not write external answer cache file '" + filename + "'");
+    LOG(INFO,"saved " << order.size() - dropped << " answers to external answer cache file '" << filename << "'" <<
+        (dropped > 0 ? " (dropped least recently used answers)" : ""));
+}
+
+
+void PersistentAnswerCache::registerPluginAtom(const std::string& predicate, const PluginInterface& plugin)
+{
+    boost::mutex::scoped_lock lock(mutex);
+
+    // answers of other versions of the plugin must not be reused
+    std::stringstream ss;
+    ss << plugin.getPluginName() << " " << plugin.getVersionMajor() << "." << plugin.getVersionMinor() << "." << plugin.getVersionMicro();
+    sources[predicate] = ss.str();
+}
+
+
+bool PersistentAnswerCache::computeKey(RegistryPtr reg, const std::string& predicate, const PluginAtom::Query& query, std::string& key)
+{
+    // answers wrt. partial interpretations depend on the assignment
+    if( !!query.assigned ) return false;
+
+    key.clear();
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        std::map<std::string, std::string>::const_iterator it = sources.find(predicate);
+        if( it == sources.end() ) return false;
+        appendString(key, it->second);
+    }
+    appendString(key, predicate);
+
+    std::map<ID, uint32_t> variables;
+    appendU32(key, query.input.size());
+    BOOST_FOREACH (ID term, query.input) {
+        if( !appendTerm(key, reg, term, variables) ) return false;
+    }
+    appendU32(key, query.pattern.size());
+    BOOST_FOREACH (ID term, query.pattern) {
+        if( !appendTerm(key, reg, term, variables) ) return false;
+    }
+
+    // hash atoms individually and combine them in sorted order such that the key does not depend on the addresses of the atoms
+    boost::hash<std::string> hashString;
+    std::vector<std::size_t> atomHashes;
+    if( !!query.interpretation ) {
+        Interpretation::TrueBitIterator bit, bit_end;
+        for(boost::tie(bit, bit_end) = query.interpretation->trueBits(); bit != bit_end; ++bit) {
+            if( !!query.predicateInputMask && !query.predicateInputMask->getFact(*bit) ) continue;
+            atomHashes.push_back(hashString(SolverWarmStartCache::atomText(reg, *bit)));
+        }
+    }
+    std::sort(atomHashes.begin(), atomHashes.end());
+    std::size_t seed = atomHashes.size();
+    BOOST_FOREACH (std::size_t h, atomHashes) boost::hash_combine(seed, h);
+    appendU32(key, atomHashes.size());
+    appendU64(key, seed);
+    return true;
+}
+
+
+bool PersistentAnswerCache::lookup(RegistryPtr reg, const std::string& key, PluginAtom::Answer& answer)
+{
+    std::string data;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        boost::unordered_map<std::string, StoredEntry>::iterator it = entries.find(key);
+        if( it == entries.end() ) {
+            misses++;
+            return false;
+        }
+        it->second.lastUse = ++clock;
+        data = it->second.answer;
+    }
+
+    // restore the terms without holding the lock
+    std::vector<Tuple> tuples;
+    try
+    {
+        AnswerCacheReader reader(data.data(), data.data() + data.size());
+        tuples.resize(reader.readCount(sizeof(uint32_t)));
+        BOOST_FOREACH (Tuple& tuple, tuples) {
+            tuple.resize(reader.readCount(1 + sizeof(uint32_t)));
+            BOOST_FOREACH (ID& term, tuple) term = readTerm(reader, reg);
+        }
+        if( !reader.atEnd() )
+            throw GeneralError("trailing data");
+    }
+    catch(const GeneralError& e) {
+        LOG(WARNING,"ignoring corrupt entry of external answer cache file '" << filename << "': " << e.getErrorMsg());
+        boost::mutex::scoped_lock lock(mutex);
+        entries.erase(key);
+        misses++;
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(mutex);
+    hits++;
+    answer.get().insert(answer.get().end(), tuples.begin(), tuples.end());
+    answer.use();
+    return true;
+}
+
+
+void PersistentAnswerCache::store(RegistryPtr reg, const std::string& key, const PluginAtom::Answer& answer)
+{
+    // partial answers depend on the assignment
+    if( !answer.getUnknown().empty() ) return;
+
+    std::string data;
+    std::map<ID, uint32_t> variables;
+    appendU32(data, answer.get().size());
+    BOOST_FOREACH (const Tuple& tuple, answer.get()) {
+        appendU32(data, tuple.size());
+        BOOST_FOREACH (ID term, tuple) {
+            // variables in answers are invalid anyway, do not store them
+            if( term.isVariableTerm() || term.isPredicateTerm() || !appendTerm(data, reg, term, variables) ) {
+                DBGLOG(DBG,"answer contains terms which cannot be stored");
+                return;
+            }
+        }
+    }
+
+    boost::mutex::scoped_lock lock(mutex);
+    StoredEntry& stored = entries[key];
+    stored.answer.swap(data);
+    stored.lastUse = ++clock;
+}
+
+
+std::size_t PersistentAnswerCache::getHits()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    return hits;
+}
+
+
+std::size_t PersistentAnswerCache::getMisses()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    return misses;
+}
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
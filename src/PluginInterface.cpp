@@ -51,6 +51,10 @@
 #include "dlvhex2/Benchmarking.h"
 #include "dlvhex2/HexParser.h"
 #include "dlvhex2/ExternalLearningHelper.h"
+#include "dlvhex2/MemoryUsage.h"
+#include "dlvhex2/PersistentAnswerCache.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
 
@@ -69,16 +73,74 @@ bool PluginAtom::Query::operator<(const Query& other) const
 }
 #endif
 
+namespace
+{
+    // copies share the bitset with the original until either is modified
+    InterpretationPtr snapshot(const InterpretationConstPtr& intr, RegistryPtr reg)
+    {
+        InterpretationPtr copy(new Interpretation(*intr));
+        copy->setRegistry(reg);
+        return copy;
+    }
+
+    // true iff each tuple matching pattern specific also matches pattern general,
+    // i.e., there is a substitution of the variables of general which yields specific
+    bool patternSubsumes(const Tuple& general, const Tuple& specific)
+    {
+        if( general.size() != specific.size() ) return false;
+        std::vector<std::pair<ID, ID> > substitution;
+        for(std::size_t i = 0; i < general.size(); ++i) {
+            if( !general[i].isVariableTerm() ) {
+                // constants and nested terms must be the same
+                if( general[i] != specific[i] ) return false;
+            }
+            else if( !general[i].isAnonymousVariable() ) {
+                bool bound = false;
+                for(std::size_t s = 0; s < substitution.size() && !bound; ++s) {
+                    if( substitution[s].first != general[i] ) continue;
+                    bound = true;
+                    // different anonymous variables in specific might have the same ID, thus they never match
+                    if( substitution[s].second != specific[i] || (specific[i].isVariableTerm() && specific[i].isAnonymousVariable()) ) return false;
+                }
+                if( !bound ) substitution.push_back(std::make_pair(general[i], specific[i]));
+            }
+        }
+        return true;
+    }
+}
+
+std::size_t PluginAtom::cacheKeyBytes(const Query& key)
+{
+    std::size_t bytes = sizeof(QueryAnswerNogoodCache::value_type) + sizeof(void*) + memory::AllocationOverhead;
+    bytes += memory::heapSize(key.input);
+    // the projected input is owned by the cache, the other interpretations are shared with the caller
+    if( !!key.inputi )
+        bytes += key.inputi->getMemoryUsage();
+    return bytes;
+}
+
+
+std::size_t PluginAtom::cacheEntryBytes(const Tuple& pattern, const Answer& answer, SimpleNogoodContainerPtr nogoods)
+{
+    std::size_t bytes = sizeof(CacheEntry) + memory::heapSize(pattern);
+    bytes += sizeof(std::vector<Tuple>) + memory::heapSize(answer.get());
+    bytes += sizeof(std::vector<Tuple>) + memory::heapSize(answer.getUnknown());
+    if( !!nogoods )
+        bytes += nogoods->getMemoryUsage();
+    return bytes;
+}
+
+
 void PluginAtom::Query::assign(const PluginAtom::Query& q2){
     ctx = q2.ctx;
     interpretation.reset(); assigned.reset(); changed.reset(); predicateInputMask.reset();
-    if (!!q2.interpretation) { InterpretationPtr interpretation(new Interpretation(q2.ctx->registry())); interpretation->add(*q2.interpretation); this->interpretation = interpretation; }
-    if (!!q2.assigned) { InterpretationPtr assigned(new Interpretation(q2.ctx->registry())); assigned->add(*q2.assigned); this->assigned = assigned; }
-    if (!!q2.changed) { InterpretationPtr changed(new Interpretation(q2.ctx->registry())); changed->add(*q2.changed); this->changed = changed; }
+    if (!!q2.interpretation) { this->interpretation = snapshot(q2.interpretation, q2.ctx->registry()); }
+    if (!!q2.assigned) { this->assigned = snapshot(q2.assigned, q2.ctx->registry()); }
+    if (!!q2.changed) { this->changed = snapshot(q2.changed, q2.ctx->registry()); }
     input = q2.input;
     pattern = q2.pattern;
     eatomID = q2.eatomID;
-    if (!!q2.predicateInputMask) { InterpretationPtr predicateInputMask(new Interpretation(q2.ctx->registry())); predicateInputMask->add(*q2.predicateInputMask); this->predicateInputMask = predicateInputMask; }
+    if (!!q2.predicateInputMask) { this->predicateInputMask = snapshot(q2.predicateInputMask, q2.ctx->registry()); }
 }
 
 bool PluginAtom::Query::operator==(const Query& other) const
@@ -127,6 +189,13 @@ std::size_t hash_value(const PluginAtom::Query& q)
     return seed;
 }
 
+boost::atomic<std::size_t> PluginAtom::totalCacheBytes(0);
+
+PluginAtom::~PluginAtom()
+{
+    resetCache();
+}
+
 PluginAtom::Answer::Answer():
 output(new std::vector<Tuple>),
 unknown(new std::vector<Tuple>),
@@ -273,10 +342,7 @@ bool PluginAtom::retrieveFacade(const Query& query, Answer& answer, NogoodContai
         }
         else {
             replacements->updateMask();
-            subqueryFromCache = false;
-
-            DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidr,"PluginAtom retrieve");
-            retrieve(atomicQuery, atomicAnswer, query.ctx->config.getOption("ExternalLearningUser") ? nogoods : NogoodContainerPtr());
+            subqueryFromCache = retrievePersistent(atomicQuery, atomicAnswer, query.ctx->config.getOption("ExternalLearningUser") ? nogoods : NogoodContainerPtr());
         }
 
         // if (!subqueryFromCache)
@@ -311,14 +377,15 @@ bool PluginAtom::retrieveCached(const Query& query, Answer& answer, NogoodContai
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidrc,"PluginAtom retrieveCached");
     // Cache answer for queries which were already done once:
     //
-    // The most efficient way would be:
+    // The most efficient way is:
     // * use cache for same inputSet + same *inputi + more specific pattern
     // * store new cache for new inputSet/*inputi combination or unrelated (does not unify) pattern
     // * replace cache for existing inputSet/*inputi combination and less specific (unifies in one direction) pattern
     //
-    // The currently implemented "poor (wo)man's version" is:
-    // * store answers in cache with queries as keys, disregard relations between patterns
-    ///@todo: efficiency could be increased for certain programs by considering pattern relationships as indicated above
+    // This is implemented as follows:
+    // * the cache maps queries without pattern (i.e., input interpretation and input tuple) to entries for different patterns
+    // * a query is answered from an entry whose pattern subsumes the query pattern
+    // * a new entry replaces the entries whose patterns are subsumed by its own pattern
 
 
     // Remark: Note that cache entries for nogoods must not be reused if the set of ground atoms in the registry (which might occur as input to the external atom) was expanded,
@@ -355,75 +422,275 @@ bool PluginAtom::retrieveCached(const Query& query, Answer& answer, NogoodContai
     // (which might occur as input), comparing predicateInputMask in Query::operator==() should guarantee that the cache entry is not reused anymore
     // (actually, comparing the sizes of predicateInputMask suffices as predicateInputMask can only increase but not decrease when the registry is expanded).
 
-    boost::mutex::scoped_lock lock(cacheMutex);
-    InterpretationPtr emp(new Interpretation(query.ctx->registry()));
-    typedef std::pair<Answer, SimpleNogoodContainerPtr> CacheEntryType;
+    // entries are stored under the query without output pattern
+    Query key = query;
+    key.pattern.clear();
+    CacheStripe& stripe = queryAnswerNogoodCache[hash_value(key) % CacheStripes];
+    boost::mutex::scoped_lock lock(stripe.mutex);
+
+    while( true ) {
+        DLVHEX_BENCHMARK_REGISTER_AND_START(sidcl,"PluginAtom cache lookup");
+        QueryAnswerNogoodCache::iterator it = stripe.entries.find(key);
+        CacheEntry* cached = 0;
+        if( it != stripe.entries.end() ) {
+            BOOST_FOREACH (CacheEntry& entry, it->second) {
+                // if nogoods are requested, entries answered without learning must be reevaluated
+                if( (!nogoods || !!entry.nogoods) && patternSubsumes(entry.pattern, query.pattern) ) {
+                    cached = &entry;
+                    break;
+                }
+            }
+        }
+        DLVHEX_BENCHMARK_STOP(sidcl);
+
+        if( cached ) {
+            DBGLOG(DBG, "Answering from cache" << (cached->pattern != query.pattern ? " (less specific pattern)" : ""));
+            stripe.statistics.hits++;
+            if( cached->pattern != query.pattern ) stripe.statistics.subsumptionHits++;
+            cached->priority = stripe.inflation + cached->value;
+            // tuples which do not match the more specific pattern are skipped by the caller (cf. BaseModelGenerator::verifyEAtomAnswerTuple);
+            // they must not be removed because learning from negative atoms considers all tuples which are not in the answer as false
+            answer = cached->answer;
+
+            // return cached nogoods
+            if( nogoods ) {
+                DBGLOG(DBG, "Found " << cached->nogoods->getNogoodCount() << " cached nogoods");
+                for (int i = 0; i < cached->nogoods->getNogoodCount(); ++i) nogoods->addNogood(cached->nogoods->getNogood(i));
+            }
+            return true;         // answered from cache
+        }
+
+        // if another thread is retrieving an answer which will answer this query, wait for it and look again
+        bool pending = false;
+        BOOST_FOREACH (const PendingQuery& pq, stripe.pending) {
+            if( (!nogoods || pq.withNogoods) && pq.key == key && patternSubsumes(pq.pattern, query.pattern) ) {
+                pending = true;
+                break;
+            }
+        }
+        if( !pending ) break;
+        DBGLOG(DBG, "Waiting for pending query");
+        DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidcw,"PluginAtom cache wait");
+        stripe.retrieved.wait(lock);
+    }
+
+    DBGLOG(DBG, "Answering by evaluation");
+    stripe.statistics.misses++;
 
-    DLVHEX_BENCHMARK_REGISTER_AND_START(sidcl,"PluginAtom cache lookup");
-    CacheEntryType& ans = queryAnswerNogoodCache[query];
-    DLVHEX_BENCHMARK_STOP(sidcl);
-    if( ans.first.hasBeenUsed()) {
-        DBGLOG(DBG, "Answering from cache");
+    // make sure that the cache uses an in-depth copy of the query (otherwise the cache might change with the assignment)
+    Query keyc = key;
+    keyc.assign(key);
+    std::list<PendingQuery>::iterator pq = stripe.pending.insert(stripe.pending.end(), PendingQuery(keyc, query.pattern, !!nogoods));
 
-        // check if there are cached nogoods
+    // retrieve without holding the lock such that other queries are not blocked
+    CacheEntry entry;
+    entry.pattern = query.pattern;
+    lock.unlock();
+    const boost::posix_time::ptime retrieveStart = boost::posix_time::microsec_clock::universal_time();
+    try
+    {
         if (nogoods) {
-            if (ans.second) {
-                DBGLOG(DBG, "Found " << ans.second->getNogoodCount() << " cached nogoods");
-		// answer was not default -> use
-		answer = ans.first;
-                // return cached nogoods
-                for (int i = 0; i < ans.second->getNogoodCount(); ++i) nogoods->addNogood(ans.second->getNogood(i));
-                return true;             // answered from cache
-            }
-            else {
-                DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidr,"PluginAtom retrieve from retrieveCached");
-                // answer is cached but no nogoods: reevaluate and return nogoods
-                DBGLOG(DBG, "No cached nogoods --> reevaluate");
-                queryAnswerNogoodCache[query].first = Answer();
-                ans.second.reset(new SimpleNogoodContainer());
-                retrieve(query, ans.first, ans.second);
-                for (int i = 0; i < ans.second->getNogoodCount(); ++i) nogoods->addNogood(ans.second->getNogood(i));
-		// answer was not default -> use
-		answer = ans.first;
-                return false;             // not (fully) answered from cache
-            }
-        }else{
-		// answer was not default -> use
-		answer = ans.first;
-		return true;
-	}
+            entry.nogoods.reset(new SimpleNogoodContainer());
+            retrievePersistent(query, entry.answer, query.ctx->config.getOption("ExternalLearningUser") ? entry.nogoods : NogoodContainerPtr());
+        }
+        else {
+            retrievePersistent(query, entry.answer, NogoodContainerPtr());
+        }
+        // if there was no answer, perhaps it has never been used, so we use it manually
+        entry.answer.use();
     }
-    else {
-        {
-            DBGLOG(DBG, "Answering by evaluation");
-            // answer was default constructed
-            // -> retrieve and replace in cache
-            DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidr,"PluginAtom retrieve");
-
-            // make sure that the cache uses an in-depth copy of the query (otherwise the cache might change with the assignment)
-            queryAnswerNogoodCache.erase(queryAnswerNogoodCache.find(query));
-            Query queryc = query;
-            queryc.assign(query);
-            CacheEntryType& ans = queryAnswerNogoodCache[queryc]; // shadows above ans!
-
-            if (nogoods) {
-                assert(!ans.second);
-
-                ans.second.reset(new SimpleNogoodContainer());
-                retrieve(queryc, ans.first, query.ctx->config.getOption("ExternalLearningUser") ? ans.second : NogoodContainerPtr());
-                for (int i = 0; i < ans.second->getNogoodCount(); ++i) nogoods->addNogood(ans.second->getNogood(i));
-                answer = ans.first;
+    catch(...) {
+        lock.lock();
+        stripe.pending.erase(pq);
+        stripe.retrieved.notify_all();
+        throw;
+    }
+    const double retrieveTime = (boost::posix_time::microsec_clock::universal_time() - retrieveStart).total_microseconds();
+    entry.bytes = cacheEntryBytes(entry.pattern, entry.answer, entry.nogoods);
+    entry.value = (retrieveTime + 1) / entry.bytes;
+    lock.lock();
+    entry.priority = stripe.inflation + entry.value;
+
+    QueryAnswerNogoodCache::iterator it = stripe.entries.find(keyc);
+    std::size_t added = entry.bytes;
+    std::size_t removed = 0;
+    if( it == stripe.entries.end() ) {
+        it = stripe.entries.insert(QueryAnswerNogoodCache::value_type(keyc, std::vector<CacheEntry>())).first;
+        added += cacheKeyBytes(keyc);
+    }
+
+    // the new entry replaces the entries with more specific patterns unless they provide nogoods which the new one does not
+    std::vector<CacheEntry>& entries = it->second;
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if( !patternSubsumes(entry.pattern, entries[i].pattern) || (!entry.nogoods && !!entries[i].nogoods) ) {
+            if( kept != i ) entries[kept] = entries[i];
+            ++kept;
+        }
+        else {
+            removed += entries[i].bytes;
+        }
+    }
+    entries.resize(kept);
+    entries.push_back(entry);
+    stripe.statistics.bytes += added - removed;
+    totalCacheBytes.fetch_add(added - removed, boost::memory_order_relaxed);
+
+    // limits are given in megabytes
+    const std::size_t megabyte = 1024 * 1024;
+    const std::size_t totalLimit = query.ctx->config.getOption("ExtAtomCacheLimit") * megabyte;
+    evictCacheEntries(stripe, keyc, entry.pattern, query.ctx->config.getOption("ExtAtomCacheAtomLimit") * megabyte / CacheStripes, totalLimit);
+    if( totalLimit > 0 && getTotalCacheMemoryUsage() > totalLimit ) {
+        // this stripe is too small to meet the total limit, take other stripes of this atom which are not in use
+        // (blocking on them could deadlock with threads which do the same)
+        for (unsigned s = 0; s < CacheStripes && getTotalCacheMemoryUsage() > totalLimit; ++s) {
+            if( &queryAnswerNogoodCache[s] == &stripe ) continue;
+            boost::mutex::scoped_try_lock otherLock(queryAnswerNogoodCache[s].mutex);
+            if( otherLock.owns_lock() ) evictCacheEntries(queryAnswerNogoodCache[s], keyc, entry.pattern, 0, totalLimit);
+        }
+    }
+
+    stripe.pending.erase(pq);
+    stripe.retrieved.notify_all();
+    lock.unlock();
+
+    answer = entry.answer;
+    if (nogoods) {
+        for (int i = 0; i < entry.nogoods->getNogoodCount(); ++i) nogoods->addNogood(entry.nogoods->getNogood(i));
+    }
+    return false;                // not answered from cache
+}
+
+
+void PluginAtom::evictCacheEntries(CacheStripe& stripe, const Query& keepKey, const Tuple& keepPattern, std::size_t stripeLimit, std::size_t totalLimit)
+{
+    if( !((stripeLimit > 0 && stripe.statistics.bytes > stripeLimit) || (totalLimit > 0 && getTotalCacheMemoryUsage() > totalLimit)) )
+        return;
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidev,"PluginAtom cache eviction");
+
+    // evict down to 3/4 of the limits such that this does not happen on every insertion
+    const std::size_t stripeTarget = stripeLimit / 4 * 3;
+    const std::size_t totalTarget = totalLimit / 4 * 3;
+
+    std::vector<std::pair<double, CacheEntry*> > candidates;
+    for (QueryAnswerNogoodCache::iterator it = stripe.entries.begin(); it != stripe.entries.end(); ++it) {
+        BOOST_FOREACH (CacheEntry& entry, it->second) {
+            if( entry.pattern == keepPattern && it->first == keepKey ) continue;
+            candidates.push_back(std::make_pair(entry.priority, &entry));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // mark the entries with lowest priority by a negative priority
+    std::size_t stripeBytes = stripe.statistics.bytes;
+    std::size_t totalBytes = getTotalCacheMemoryUsage();
+    for (std::size_t c = 0; c < candidates.size() &&
+        ((stripeLimit > 0 && stripeBytes > stripeTarget) || (totalLimit > 0 && totalBytes > totalTarget)); ++c) {
+        CacheEntry& entry = *candidates[c].second;
+        stripeBytes -= std::min(stripeBytes, entry.bytes);
+        totalBytes -= std::min(totalBytes, entry.bytes);
+        // entries which stay in the cache are ranked relative to the evicted ones from now on
+        stripe.inflation = entry.priority;
+        entry.priority = -1;
+    }
+
+    std::size_t freed = 0;
+    unsigned long evicted = 0;
+    for (QueryAnswerNogoodCache::iterator it = stripe.entries.begin(); it != stripe.entries.end(); ) {
+        std::vector<CacheEntry>& entries = it->second;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if( entries[i].priority < 0 ) {
+                freed += entries[i].bytes;
+                ++evicted;
             }
             else {
-                retrieve(queryc, ans.first, NogoodContainerPtr());
-                answer = ans.first;
+                if( kept != i ) entries[kept] = entries[i];
+                ++kept;
             }
+        }
+        entries.resize(kept);
+        if( entries.empty() ) {
+            freed += cacheKeyBytes(it->first);
+            it = stripe.entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    DBGLOG(DBG, "Evicted " << evicted << " cache entries with " << freed << " bytes");
+    stripe.statistics.evictions += evicted;
+    stripe.statistics.bytes -= freed;
+    totalCacheBytes.fetch_sub(freed, boost::memory_order_relaxed);
+}
 
-            // if there was no answer, perhaps it has never been used, so we use it manually
-            ans.first.use();
+
+bool PluginAtom::retrievePersistent(const Query& query, Answer& answer, NogoodContainerPtr nogoods)
+{
+    // answers can only be reused by later runs if they depend on the input only
+    PersistentAnswerCachePtr persistentCache = !!query.ctx ? query.ctx->persistentAnswerCache : PersistentAnswerCachePtr();
+    std::string key;
+    if( !!persistentCache && query.eatomID != ID_FAIL &&
+        registry->eatoms.getByID(query.eatomID).getExtSourceProperties().isPersistentlyCacheable() ) {
+        DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidpl,"PluginAtom persistent cache lookup");
+        if( !persistentCache->computeKey(registry, predicate, query, key) ) {
+            persistentCache.reset();
+        }
+        else if( persistentCache->lookup(registry, key, answer) ) {
+            DBGLOG(DBG, "Answering from persistent cache");
+            return true;
         }
-        return false;            // not answered from cache
     }
+    else {
+        persistentCache.reset();
+    }
+
+    {
+        DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sidr,"PluginAtom retrieve");
+        retrieve(query, answer, nogoods);
+    }
+    if( !!persistentCache ) persistentCache->store(registry, key, answer);
+    return false;
+}
+
+
+void PluginAtom::resetCache()
+{
+    for (unsigned s = 0; s < CacheStripes; ++s) {
+        CacheStripe& stripe = queryAnswerNogoodCache[s];
+        boost::mutex::scoped_lock lock(stripe.mutex);
+        stripe.entries.clear();
+        totalCacheBytes.fetch_sub(stripe.statistics.bytes, boost::memory_order_relaxed);
+        stripe.statistics.bytes = 0;
+        stripe.inflation = 0;
+    }
+}
+
+
+PluginAtom::CacheStatistics PluginAtom::getCacheStatistics()
+{
+    CacheStatistics statistics;
+    for (unsigned s = 0; s < CacheStripes; ++s) {
+        boost::mutex::scoped_lock lock(queryAnswerNogoodCache[s].mutex);
+        const CacheStatistics& stripeStatistics = queryAnswerNogoodCache[s].statistics;
+        statistics.hits += stripeStatistics.hits;
+        statistics.subsumptionHits += stripeStatistics.subsumptionHits;
+        statistics.misses += stripeStatistics.misses;
+        statistics.evictions += stripeStatistics.evictions;
+        statistics.bytes += stripeStatistics.bytes;
+    }
+    return statistics;
+}
+
+
+std::size_t PluginAtom::getCacheMemoryUsage()
+{
+    std::size_t bytes = 0;
+    for (unsigned s = 0; s < CacheStripes; ++s) {
+        boost::mutex::scoped_lock lock(queryAnswerNogoodCache[s].mutex);
+        bytes += queryAnswerNogoodCache[s].entries.bucket_count() * sizeof(void*) + queryAnswerNogoodCache[s].statistics.bytes;
+    }
+    return bytes;
 }
 
 
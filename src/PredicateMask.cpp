@@ -115,7 +115,6 @@ void PredicateMask::updateMask()
 
     assert(!!maski);
     RegistryPtr reg = maski->getRegistry();
-    Interpretation::Storage& bits = maski->getStorage();
 
     unsigned maxaddr = 0;
 
@@ -166,6 +165,9 @@ void PredicateMask::updateMask()
     }
     #endif
     assert(knownAddresses == (it - it_begin));
+    // only access the storage for modification if there is something to update
+    // (this stops sharing the mask with copies)
+    Interpretation::Storage& bits = maski->getStorage();
     for(;missingBits != 0; it++, missingBits--) {
         if (!reg->ogatoms.getIDByAddress(knownAddresses).isHiddenAtom()) {
             assert(it != reg->ogatoms.getAllByAddress().second);
@@ -298,11 +300,11 @@ void ExternalAtomMask::addOutputAtoms(InterpretationConstPtr intr)
             const OrdinaryAtom& oatom = ctx->registry()->ogatoms.getByAddress(atom);
             if (oatom.tuple[0] == posreplacement || oatom.tuple[0] == negreplacement) {
                 if (matchOutputAtom(oatom.tuple)) {
-                    DBGLOG(DBG, "Output atom " << oatom.text << " matches the external atom");
+                    DBGLOG(DBG, "Output atom " << printToString<RawPrinter>(id, reg) << " matches the external atom");
                     maski->setFact(atom);
                 }
                 else {
-                    DBGLOG(DBG, "Output atom " << oatom.text << " does not match the external atom");
+                    DBGLOG(DBG, "Output atom " << printToString<RawPrinter>(id, reg) << " does not match the external atom");
                 }
             }
         }
@@ -521,11 +523,11 @@ void ExternalAtomMask::updateMask()
             const IDAddress outputAtom = *en;
             const OrdinaryAtom& oatom = eatom->pluginAtom->getRegistry()->ogatoms.getByAddress(outputAtom);
             if (matchOutputAtom(oatom.tuple)) {
-                DBGLOG(DBG, "Output atom " << oatom.text << " matches the external atom");
+                DBGLOG(DBG, "Output atom " << printToString<RawPrinter>(eatom->pluginAtom->getRegistry()->ogatoms.getIDByAddress(outputAtom), eatom->pluginAtom->getRegistry()) << " matches the external atom");
                 maski->setFact(outputAtom);
             }
             else {
-                DBGLOG(DBG, "Output atom " << oatom.text << " does not match the external atom");
+                DBGLOG(DBG, "Output atom " << printToString<RawPrinter>(eatom->pluginAtom->getRegistry()->ogatoms.getIDByAddress(outputAtom), eatom->pluginAtom->getRegistry()) << " does not match the external atom");
             }
             en++;
         }
@@ -76,10 +76,10 @@ void RawPrinter::print(ID id)
         case ID::MAINKIND_ATOM:
             switch(id.kind & ID::SUBKIND_MASK) {
                 case ID::SUBKIND_ATOM_ORDINARYG:
-                    out << registry->ogatoms.getByID(id).text;
+                    printOrdinaryAtom(registry->ogatoms.getByID(id));
                     break;
                 case ID::SUBKIND_ATOM_ORDINARYN:
-                    out << registry->onatoms.getByID(id).text;
+                    printOrdinaryAtom(registry->onatoms.getByID(id));
                     break;
                 case ID::SUBKIND_ATOM_BUILTIN:
                 {
@@ -289,6 +289,27 @@ void RawPrinter::print(ID id)
 }
 
 
+void RawPrinter::printOrdinaryAtom(const OrdinaryAtom& atom)
+{
+    if( !atom.text.empty() ) {
+        out << atom.text;
+        return;
+    }
+    // lazy text: predicate(arg1,...,argn)
+    assert(!atom.tuple.empty());
+    print(atom.tuple.front());
+    if( atom.tuple.size() > 1 ) {
+        out << "(";
+        for(Tuple::const_iterator it = atom.tuple.begin() + 1; it != atom.tuple.end(); ++it) {
+            if( it != atom.tuple.begin() + 1 )
+                out << ",";
+            print(*it);
+        }
+        out << ")";
+    }
+}
+
+
 std::string RawPrinter::toString(RegistryPtr reg, ID id)
 {
     std::stringstream ss;
@@ -319,7 +340,17 @@ void RawPrinter::printWithoutPrefix(ID id)
         case ID::MAINKIND_ATOM:
             switch(id.kind & ID::SUBKIND_MASK) {
                 case ID::SUBKIND_ATOM_ORDINARYG:
-                    out << removeModulePrefix(registry->ogatoms.getByID(id).text);
+                {
+                    const OrdinaryAtom& atom = registry->ogatoms.getByID(id);
+                    if( !atom.text.empty() ) {
+                        out << removeModulePrefix(atom.text);
+                    }
+                    else {
+                        std::ostringstream s;
+                        RawPrinter(s, registry).printOrdinaryAtom(atom);
+                        out << removeModulePrefix(s.str());
+                    }
+                }
                     break;
                 default:
                     assert(false);
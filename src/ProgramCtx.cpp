@@ -45,6 +45,7 @@
 #include "dlvhex2/PluginContainer.h"
 #include "dlvhex2/State.h"
 #include "dlvhex2/Printer.h"
+#include "dlvhex2/PersistentAnswerCache.h"
 //#include "dlvhex2/DLVProcess.h"
 //#include "dlvhex2/EvalHeuristicEasy.h"
 
@@ -71,6 +72,14 @@ maxint(0), currentOptimumRelevantLevels(0), terminationRequest(false)
     config.setOption("UseAtomDependency", 0);
     config.setOption("UseAtomCompliance", 0);
     config.setOption("GenuineSolver", 0);
+    config.setOption("CDNLPropagation", 0);
+    config.setOption("CDNLHeuristics", 0);
+    config.setOption("CDNLRestarts", 0);
+    config.setOption("CDNLRestartBase", 100);
+    config.setOption("CDNLPhaseSaving", 0);
+    config.setOption("CDNLNogoodReduction", 0);
+    config.setStringOption("WarmStartFile", "");
+    config.setOption("WarmStartLimit", 10000);
     config.setOption("ExternalLearning", 1);
     config.setOption("UFSLearning", 1);
     config.setOption("UFSLearnStrategy", 2);
@@ -88,6 +97,15 @@ maxint(0), currentOptimumRelevantLevels(0), terminationRequest(false)
     config.setOption("Silent", 0);
     config.setOption("Verbose", 0);
     config.setOption("UseExtAtomCache",1);
+    config.setOption("ExtAtomCacheLimit",0);
+    config.setOption("ExtAtomCacheAtomLimit",0);
+    config.setStringOption("ExtAtomCacheFile", "");
+    config.setOption("ExtAtomCacheFileLimit", 100000);
+    config.setOption("ConcurrentRegistry",0);
+    config.setOption("LazyAtomText",0);
+    config.setOption("ParserThreads",1);
+    config.setStringOption("SaveSnapshot","");
+    config.setStringOption("LoadSnapshot","");
     config.setOption("KeepNamespacePrefix",0);
     config.setOption("DumpDepGraph",0);
     config.setOption("DumpCyclicPredicateInputAnalysisGraph",0);
@@ -110,6 +128,7 @@ maxint(0), currentOptimumRelevantLevels(0), terminationRequest(false)
     config.setOption("IncludeAuxInputInAuxiliaries",0);
     config.setOption("DumpEvaluationPlan",0);
     config.setOption("DumpStats",0);
+    config.setOption("MemorySampleInterval",1000);
                                  // perhaps only temporary
     config.setOption("BenchmarkEAstderr",0);
                                  // perhaps only temporary
@@ -131,10 +150,17 @@ maxint(0), currentOptimumRelevantLevels(0), terminationRequest(false)
                                  // see --help
     config.setOption("UseConstantSpace", 0);
     config.setOption("ClaspForceSingleThreaded", 0);
+                                 // number of clasp threads and their cooperation (compete or split), see --claspthreads
+    config.setOption("ClaspThreads", 1);
+    config.setStringOption("ClaspParallelMode", "compete");
     config.setOption("LazyUFSCheckerInitialization", 0);
     config.setOption("SupportSets", 0);
     config.setOption("ExternalSourceInlining", 0);
     config.setOption("ForceGC", 0);
+                                 // if 1, guess and check model generators of a unit share their ground program, see --persistentunits
+    config.setOption("PersistentUnits", 0);
+                                 // number of threads which enumerate cubes of the search space of guess and check units, see --enumthreads
+    config.setOption("EnumerationThreads", 1);
     config.setStringOption("PluginDirs", "");
     config.setOption("IncrementalGrounding", 0);
     config.setOption("MinimizationSize", 10000);
@@ -522,6 +548,8 @@ void ProgramCtx::addPluginAtomsFromPluginContainer()
             else {
                 pap->setRegistry(registry());
                 pluginAtoms[pred] = pap;
+                if( !!persistentAnswerCache )
+                    persistentAnswerCache->registerPluginAtom(pred, *plugin);
             }
         }
     }
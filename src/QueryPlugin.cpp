@@ -723,14 +723,14 @@ namespace
         it != bits.end(); ++it) {
             // build substitution tuple
             const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(*it);
-            DBGLOG(DBG,"got auxiliary " << ogatom.text);
+            DBGLOG(DBG,"got auxiliary " << printToString<RawPrinter>(reg->ogatoms.getIDByAddress(*it), reg));
             assert(ogatom.tuple.size() > 1);
             Tuple subst(ogatom.tuple.begin()+1, ogatom.tuple.end());
             assert(!subst.empty());
 
             // discard duplicates
             if( printedSubstitutions.find(subst) != printedSubstitutions.end() ) {
-                LOG(DBG,"discarded duplicate substitution from auxiliary atom " << ogatom.text);
+                LOG(DBG,"discarded duplicate substitution from auxiliary atom " << printToString<RawPrinter>(reg->ogatoms.getIDByAddress(*it), reg));
                 continue;
             }
 
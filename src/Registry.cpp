@@ -49,7 +49,6 @@
 #include <boost/unordered_map.hpp>
 #include <boost/range/join.hpp>
 #include <boost/foreach.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/bimap/bimap.hpp>
 
 DLVHEX_NAMESPACE_BEGIN
@@ -139,9 +138,11 @@ struct Registry::Impl
     PredicateMaskPtr auxGroundAtomMask;
     std::list<AuxPrinterPtr> auxPrinters;
     AuxPrinterPtr defaultAuxPrinter;
+    bool lazyAtomText;
 
     Impl():
-    auxGroundAtomMask(new PredicateMask) {}
+    auxGroundAtomMask(new PredicateMask),
+    lazyAtomText(false) {}
 };
 
 Registry::Registry():
@@ -210,6 +211,22 @@ std::ostream& ExternalAtomTable::print(std::ostream& o, RegistryPtr reg) const t
 }
 
 
+void Registry::getMemoryUsage(memory::Report& report) const
+{
+    const memory::DynamicSize dynamicSize;
+    report.add("terms", terms.getMemoryUsage(dynamicSize) + terms.getIndexMemoryUsage());
+    report.add("preds", preds.getMemoryUsage(dynamicSize));
+    report.add("ogatoms", ogatoms.getMemoryUsage(dynamicSize));
+    report.add("onatoms", onatoms.getMemoryUsage(dynamicSize));
+    report.add("batoms", batoms.getMemoryUsage(dynamicSize));
+    report.add("aatoms", aatoms.getMemoryUsage(dynamicSize));
+    report.add("eatoms", eatoms.getMemoryUsage(dynamicSize));
+    report.add("matoms", matoms.getMemoryUsage(dynamicSize));
+    report.add("rules", rules.getMemoryUsage(dynamicSize));
+    report.add("modules", moduleTable.getMemoryUsage(dynamicSize) + memory::heapSize(inputList));
+}
+
+
                                  //const
 std::ostream& Registry::print(std::ostream& o)
 {
@@ -461,13 +478,19 @@ namespace
 {
     // assume, that oatom.id and oatom.tuple is initialized!
     // assume, that oatom.text is not initialized!
-    // oatom.text will be modified
+    // oatom.text will be modified (cleared in lazy text mode)
     ID storeOrdinaryAtomHelper(
         Registry* reg,
         OrdinaryAtom& oatom,
     OrdinaryAtomTable& oat) {
         ID ret = oat.getIDByTuple(oatom.tuple);
-        if( ret == ID_FAIL ) {
+        if( ret == ID_FAIL && reg->hasLazyAtomText() ) {
+            // text is rendered on demand when printing
+            oatom.text.clear();
+            ret = oat.storeAndGetID(oatom);
+            DBGLOG(DBG,"stored oatom " << oatom << " without text which got " << ret);
+        }
+        else if( ret == ID_FAIL ) {
             // text
             std::stringstream s;
             RawPrinter printer(s, reg);
@@ -528,15 +551,16 @@ ID Registry::storeConstOrVarTerm(Term& term)
 }
 
 
-ID Registry::storeConstantTerm(const std::string& symbol, bool aux)
+ID Registry::storeConstantTerm(boost::string_ref symbol, bool aux)
 {
     assert(!symbol.empty() && (::islower(symbol[0]) || symbol[0] == '"'));
 
     ID ret = terms.getIDByString(symbol);
     if( ret == ID_FAIL ) {
-        ret = preds.getIDByString(symbol);
+        const std::string str(symbol.begin(), symbol.end());
+        ret = preds.getIDByString(str);
         if( ret == ID_FAIL ) {
-            Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, symbol);
+            Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, str);
             if( aux )
                 term.kind |= ID::PROPERTY_AUX;
             ret = terms.storeAndGetID(term);
@@ -567,13 +591,14 @@ ID Registry::storeTerm(Term& term)
 {
     assert(!term.symbol.empty());
     if( isdigit(term.symbol[0]) ) {
-        try
-        {
-            return ID::termFromInteger(boost::lexical_cast<uint32_t>(term.symbol));
-        }
-        catch( const boost::bad_lexical_cast&) {
-            throw FatalError("bad term to convert to integer: '" + term.symbol + "'");
+        // integers are not stored in the term table
+        uint32_t value = 0;
+        for(std::string::const_iterator it = term.symbol.begin(); it != term.symbol.end(); ++it) {
+            if( !isdigit(*it) || value > (ID_FAIL.address - (*it - '0')) / 10 )
+                throw FatalError("bad term to convert to integer: '" + term.symbol + "'");
+            value = 10 * value + (*it - '0');
         }
+        return ID::termFromInteger(value);
     }
 
     // add subkind flags
@@ -630,6 +655,27 @@ void Registry::setupAuxiliaryGroundAtomMask()
 }
 
 
+void Registry::setConcurrentStorage(bool enable)
+{
+    terms.setConcurrentStorage(enable);
+    preds.setConcurrentStorage(enable);
+    ogatoms.setConcurrentStorage(enable);
+    onatoms.setConcurrentStorage(enable);
+}
+
+
+void Registry::setLazyAtomText(bool enable)
+{
+    pimpl->lazyAtomText = enable;
+}
+
+
+bool Registry::hasLazyAtomText() const
+{
+    return pimpl->lazyAtomText;
+}
+
+
 ID Registry::getAuxiliaryConstantSymbol(char type, ID id)
 {
     DBGLOG_SCOPE(DBG,"gACS",false);
@@ -760,6 +806,39 @@ ID Registry::getIDByAuxiliaryConstantSymbol(ID auxConstantID) const
 }
 
 
+void Registry::getAuxiliarySymbols(std::vector<AuxiliarySymbol>& symbols) const
+{
+    for(AuxiliaryStorage::left_const_iterator it = pimpl->auxSymbols.left.begin();
+    it != pimpl->auxSymbols.left.end(); ++it) {
+        AuxiliarySymbol symbol;
+        symbol.type = it->first.type;
+        symbol.id = it->first.id;
+        symbol.symbol = it->second.symbol;
+        symbol.auxID = it->second.id;
+        symbols.push_back(symbol);
+    }
+}
+
+
+void Registry::restoreAuxiliarySymbol(const AuxiliarySymbol& symbol)
+{
+    assert(symbol.auxID.isTerm());
+    assert(terms.getByID(symbol.auxID).symbol == symbol.symbol);
+    AuxiliaryKey key(symbol.type, symbol.id);
+    AuxiliaryStorage::left_const_iterator it = pimpl->auxSymbols.left.find(key);
+    if( it != pimpl->auxSymbols.left.end() ) {
+        if( it->second.id != symbol.auxID )
+            throw FatalError("auxiliary symbol '" + symbol.symbol + "' is already registered with a different ID");
+        return;
+    }
+    pimpl->auxSymbols.insert(AuxiliaryStorageTranslation(key, AuxiliaryValue(symbol.symbol, symbol.auxID)));
+
+    // auxiliary constants are auxiliary predicates (see getAuxiliaryConstantSymbol)
+    if( symbol.auxID.isConstantTerm() )
+        pimpl->auxGroundAtomMask->addPredicate(symbol.auxID);
+}
+
+
 // maps an auxiliary constant symbol back to the ID behind
 ID Registry::getIDByAuxiliaryVariableSymbol(ID auxVariableID) const
 {
@@ -871,7 +950,14 @@ bool Registry::printAtomForUser(std::ostream& o, IDAddress address, const std::s
     if( !getAuxiliaryGroundAtomMask()->getFact(address) ) {
         // fast direct output
         if (ogatoms.getIDByAddress(address).isHiddenAtom()) return false;
-        o << prefix << ogatoms.getByAddress(address).text;
+        const OrdinaryAtom& atom = ogatoms.getByAddress(address);
+        if( !atom.text.empty() ) {
+            o << prefix << atom.text;
+        }
+        else {
+            o << prefix;
+            RawPrinter(o, this).printOrdinaryAtom(atom);
+        }
         return true;
     }
     else {
@@ -0,0 +1,592 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   Snapshot.cpp
+ *
+ * @brief  Binary snapshots of the registry and the parsed program for warm restarts.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/Snapshot.h"
+#include "dlvhex2/ProgramCtx.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Interpretation.h"
+#include "dlvhex2/Error.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Benchmarking.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace
+{
+    // 15 characters and terminating zero
+    const char Magic[16] = "dlvhex2snapshot";
+    // detects snapshots written on a platform with different byte order
+    const uint32_t ByteOrderMark = 0x01020304;
+    // terminates the file (detects truncated files)
+    const uint32_t EndMark = 0xFFFFFFFF;
+
+    // kinds used to access table entries by address
+    const IDKind TermKind = ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT;
+    const IDKind PredicateKind = ID::MAINKIND_TERM | ID::SUBKIND_TERM_PREDICATE;
+    const IDKind OrdinaryAtomKind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG;
+    const IDKind BuiltinAtomKind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_BUILTIN;
+    const IDKind AggregateAtomKind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_AGGREGATE;
+    const IDKind ExternalAtomKind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_EXTERNAL;
+    const IDKind RuleKind = ID::MAINKIND_RULE | ID::SUBKIND_RULE_REGULAR;
+
+    // writes snapshot data in native byte order
+    class SnapshotWriter
+    {
+        private:
+            std::ostream& out;
+
+        public:
+            SnapshotWriter(std::ostream& out): out(out) {}
+
+            void writeU32(uint32_t value)
+                { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+            void writeInt(int value)
+                { writeU32(static_cast<uint32_t>(value)); }
+            void writeID(ID id)
+                { writeU32(id.kind); writeU32(id.address); }
+            void writeString(const std::string& str) {
+                writeU32(str.size());
+                out.write(str.data(), str.size());
+            }
+            void writeTuple(const Tuple& tuple) {
+                writeU32(tuple.size());
+                for(Tuple::const_iterator it = tuple.begin(); it != tuple.end(); ++it)
+                    writeID(*it);
+            }
+            void writeTuples(const std::vector<Tuple>& tuples) {
+                writeU32(tuples.size());
+                for(std::vector<Tuple>::const_iterator it = tuples.begin(); it != tuples.end(); ++it)
+                    writeTuple(*it);
+            }
+            void writeIntSet(const std::set<int>& values) {
+                writeU32(values.size());
+                for(std::set<int>::const_iterator it = values.begin(); it != values.end(); ++it)
+                    writeInt(*it);
+            }
+            void writeIntPairSet(const std::set<std::pair<int, int> >& values) {
+                writeU32(values.size());
+                for(std::set<std::pair<int, int> >::const_iterator it = values.begin(); it != values.end(); ++it) {
+                    writeInt(it->first);
+                    writeInt(it->second);
+                }
+            }
+
+            void write(const Term& term) {
+                writeU32(term.kind);
+                writeString(term.symbol);
+                writeTuple(term.arguments);
+            }
+            void write(const Predicate& pred) {
+                writeU32(pred.kind);
+                writeString(pred.symbol);
+                writeInt(pred.arity);
+            }
+            void write(const OrdinaryAtom& atom) {
+                writeU32(atom.kind);
+                writeString(atom.text);
+                writeTuple(atom.tuple);
+            }
+            void write(const BuiltinAtom& atom) {
+                writeU32(atom.kind);
+                writeTuple(atom.tuple);
+            }
+            void write(const AggregateAtom& atom) {
+                writeU32(atom.kind);
+                writeTuple(atom.tuple);
+                writeTuple(atom.variables);
+                writeTuple(atom.literals);
+                writeTuples(atom.mvariables);
+                writeTuples(atom.mliterals);
+            }
+            void write(const ExternalAtom& atom) {
+                writeU32(atom.kind);
+                writeID(atom.predicate);
+                writeTuple(atom.inputs);
+                writeTuple(atom.tuple);
+                writeID(atom.auxInputPredicate);
+                writeU32(atom.auxInputMapping.size());
+                for(ExternalAtom::AuxInputMapping::const_iterator it = atom.auxInputMapping.begin();
+                it != atom.auxInputMapping.end(); ++it) {
+                    writeU32(it->size());
+                    for(std::list<unsigned>::const_iterator itp = it->begin(); itp != it->end(); ++itp)
+                        writeU32(*itp);
+                }
+                write(atom.prop);
+            }
+            void write(const ExtSourceProperties& prop) {
+                writeIntSet(prop.monotonicInputPredicates);
+                writeIntSet(prop.antimonotonicInputPredicates);
+                writeIntSet(prop.predicateParameterNameIndependence);
+                writeIntSet(prop.finiteOutputDomain);
+                writeIntPairSet(prop.relativeFiniteOutputDomain);
+                writeU32(prop.functional);
+                writeInt(prop.functionalStart);
+                writeU32(prop.supportSets);
+                writeU32(prop.onlySafeSupportSets);
+                writeU32(prop.completePositiveSupportSets);
+                writeU32(prop.completeNegativeSupportSets);
+                writeU32(prop.variableOutputArity);
+                writeU32(prop.caresAboutAssigned);
+                writeU32(prop.caresAboutChanged);
+                writeU32(prop.atomlevellinear);
+                writeU32(prop.tuplelevellinear);
+                writeU32(prop.usesEnvironment);
+                writeU32(prop.finiteFiber);
+                writeIntPairSet(prop.wellorderingStrlen);
+                writeIntPairSet(prop.wellorderingNatural);
+                writeU32(prop.providesPartialAnswer);
+                writeU32(prop.persistentlyCacheable);
+                writeU32(prop.atomDependencies.size());
+                for(std::set<std::tuple<int, int, int> >::const_iterator it = prop.atomDependencies.begin();
+                it != prop.atomDependencies.end(); ++it) {
+                    writeInt(std::get<0>(*it));
+                    writeInt(std::get<1>(*it));
+                    writeInt(std::get<2>(*it));
+                }
+                writeInt(prop.complCheck);
+            }
+            void write(const Rule& rule) {
+                writeU32(rule.kind);
+                writeTuple(rule.head);
+                writeTuple(rule.body);
+                writeTuple(rule.headGuard);
+                writeTuple(rule.bodyWeightVector);
+                writeID(rule.bound);
+                writeID(rule.weight);
+                writeID(rule.level);
+                writeTuple(rule.weakconstraintVector);
+            }
+
+            // writes all entries of a table in address order
+            template<typename TableT>
+            void writeTable(const TableT& table, IDKind kind) {
+                const uint32_t size = table.getSize();
+                writeU32(size);
+                for(IDAddress addr = 0; addr < size; ++addr)
+                    write(table.getByID(ID(kind, addr)));
+            }
+    };
+
+    // reads snapshot data from memory, checking bounds
+    class SnapshotReader
+    {
+        private:
+            const char* pos;
+            const char* end;
+            const std::string& filename;
+
+            void need(std::size_t bytes) {
+                if( static_cast<std::size_t>(end - pos) < bytes )
+                    throw GeneralError("snapshot file '" + filename + "' is truncated");
+            }
+
+        public:
+            SnapshotReader(const char* begin, const char* end, const std::string& filename):
+            pos(begin), end(end), filename(filename) {}
+
+            bool atEnd() const
+                { return pos == end; }
+
+            void readBytes(char* target, std::size_t bytes) {
+                need(bytes);
+                std::memcpy(target, pos, bytes);
+                pos += bytes;
+            }
+            uint32_t readU32() {
+                uint32_t value;
+                readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+                return value;
+            }
+            int readInt()
+                { return static_cast<int>(readU32()); }
+            bool readBool()
+                { return readU32() != 0; }
+            ID readID() {
+                const IDKind kind = readU32();
+                return ID(kind, readU32());
+            }
+            void readString(std::string& str) {
+                const uint32_t size = readU32();
+                need(size);
+                str.assign(pos, size);
+                pos += size;
+            }
+            void readTuple(Tuple& tuple) {
+                const uint32_t size = readU32();
+                need(static_cast<std::size_t>(size) * 2 * sizeof(uint32_t));
+                tuple.resize(size);
+                for(uint32_t i = 0; i < size; ++i)
+                    tuple[i] = readID();
+            }
+            void readTuples(std::vector<Tuple>& tuples) {
+                tuples.resize(readU32());
+                for(std::vector<Tuple>::iterator it = tuples.begin(); it != tuples.end(); ++it)
+                    readTuple(*it);
+            }
+            void readIntSet(std::set<int>& values) {
+                const uint32_t size = readU32();
+                for(uint32_t i = 0; i < size; ++i)
+                    values.insert(readInt());
+            }
+            void readIntPairSet(std::set<std::pair<int, int> >& values) {
+                const uint32_t size = readU32();
+                for(uint32_t i = 0; i < size; ++i) {
+                    const int first = readInt();
+                    values.insert(std::make_pair(first, readInt()));
+                }
+            }
+            void read(ExtSourceProperties& prop) {
+                readIntSet(prop.monotonicInputPredicates);
+                readIntSet(prop.antimonotonicInputPredicates);
+                readIntSet(prop.predicateParameterNameIndependence);
+                readIntSet(prop.finiteOutputDomain);
+                readIntPairSet(prop.relativeFiniteOutputDomain);
+                prop.functional = readBool();
+                prop.functionalStart = readInt();
+                prop.supportSets = readBool();
+                prop.onlySafeSupportSets = readBool();
+                prop.completePositiveSupportSets = readBool();
+                prop.completeNegativeSupportSets = readBool();
+                prop.variableOutputArity = readBool();
+                prop.caresAboutAssigned = readBool();
+                prop.caresAboutChanged = readBool();
+                prop.atomlevellinear = readBool();
+                prop.tuplelevellinear = readBool();
+                prop.usesEnvironment = readBool();
+                prop.finiteFiber = readBool();
+                readIntPairSet(prop.wellorderingStrlen);
+                readIntPairSet(prop.wellorderingNatural);
+                prop.providesPartialAnswer = readBool();
+                prop.persistentlyCacheable = readBool();
+                const uint32_t dependencies = readU32();
+                for(uint32_t i = 0; i < dependencies; ++i) {
+                    const int a = readInt();
+                    const int b = readInt();
+                    prop.atomDependencies.insert(std::make_tuple(a, b, readInt()));
+                }
+                prop.complCheck = readInt();
+            }
+
+            template<typename ValueT>
+            ValueT read();
+    };
+
+    template<>
+    Term SnapshotReader::read<Term>()
+    {
+        const IDKind kind = readU32();
+        std::string symbol;
+        readString(symbol);
+        Term term(kind, symbol);
+        readTuple(term.arguments);
+        return term;
+    }
+
+    template<>
+    Predicate SnapshotReader::read<Predicate>()
+    {
+        const IDKind kind = readU32();
+        std::string symbol;
+        readString(symbol);
+        return Predicate(kind, symbol, readInt());
+    }
+
+    template<>
+    OrdinaryAtom SnapshotReader::read<OrdinaryAtom>()
+    {
+        OrdinaryAtom atom(readU32());
+        readString(atom.text);
+        readTuple(atom.tuple);
+        return atom;
+    }
+
+    template<>
+    BuiltinAtom SnapshotReader::read<BuiltinAtom>()
+    {
+        BuiltinAtom atom(readU32());
+        readTuple(atom.tuple);
+        return atom;
+    }
+
+    template<>
+    AggregateAtom SnapshotReader::read<AggregateAtom>()
+    {
+        AggregateAtom atom(readU32());
+        readTuple(atom.tuple);
+        readTuple(atom.variables);
+        readTuple(atom.literals);
+        readTuples(atom.mvariables);
+        readTuples(atom.mliterals);
+        return atom;
+    }
+
+    template<>
+    ExternalAtom SnapshotReader::read<ExternalAtom>()
+    {
+        ExternalAtom atom(readU32());
+        atom.predicate = readID();
+        readTuple(atom.inputs);
+        readTuple(atom.tuple);
+        atom.auxInputPredicate = readID();
+        atom.auxInputMapping.resize(readU32());
+        for(ExternalAtom::AuxInputMapping::iterator it = atom.auxInputMapping.begin();
+        it != atom.auxInputMapping.end(); ++it) {
+            const uint32_t size = readU32();
+            for(uint32_t i = 0; i < size; ++i)
+                it->push_back(readU32());
+        }
+        read(atom.prop);
+        return atom;
+    }
+
+    template<>
+    Rule SnapshotReader::read<Rule>()
+    {
+        Rule rule(readU32());
+        readTuple(rule.head);
+        readTuple(rule.body);
+        readTuple(rule.headGuard);
+        readTuple(rule.bodyWeightVector);
+        rule.bound = readID();
+        rule.weight = readID();
+        rule.level = readID();
+        readTuple(rule.weakconstraintVector);
+        return rule;
+    }
+
+    // entries which are already stored when loading must agree with the snapshot in their keys
+    bool sameEntry(const Term& a, const Term& b)
+        { return a.kind == b.kind && a.symbol == b.symbol; }
+    bool sameEntry(const Predicate& a, const Predicate& b)
+        { return a.kind == b.kind && a.symbol == b.symbol && a.arity == b.arity; }
+    bool sameEntry(const OrdinaryAtom& a, const OrdinaryAtom& b)
+        { return a.kind == b.kind && a.tuple == b.tuple; }
+    bool sameEntry(const BuiltinAtom& a, const BuiltinAtom& b)
+        { return a.kind == b.kind && a.tuple == b.tuple; }
+    bool sameEntry(const AggregateAtom& a, const AggregateAtom& b)
+        { return a.kind == b.kind && a.tuple == b.tuple && a.variables == b.variables && a.literals == b.literals; }
+    bool sameEntry(const ExternalAtom& a, const ExternalAtom& b)
+        { return a.kind == b.kind && a.predicate == b.predicate && a.inputs == b.inputs && a.tuple == b.tuple; }
+    bool sameEntry(const Rule& a, const Rule& b)
+        { return a.kind == b.kind && a.head == b.head && a.body == b.body; }
+
+    // adapts loaded entries to the current registry configuration
+    template<typename ValueT>
+    void adaptEntry(ValueT&, const Registry&) {}
+    void adaptEntry(OrdinaryAtom& atom, const Registry& reg)
+    {
+        if( reg.hasLazyAtomText() )
+            atom.text.clear();
+    }
+
+    // stores the entries of a table section in address order
+    // (entries which are already stored are only checked)
+    template<typename ValueT, typename TableT>
+    void loadTable(SnapshotReader& reader, TableT& table, IDKind kind, const Registry& reg, const std::string& name)
+    {
+        const uint32_t size = reader.readU32();
+        const uint32_t existing = table.getSize();
+        if( size < existing )
+            throw GeneralError("snapshot does not match the registry: table " + name +
+                " has more entries than the snapshot (were other plugins or plugin options used?)");
+        for(IDAddress addr = 0; addr < size; ++addr) {
+            ValueT value(reader.read<ValueT>());
+            if( addr < existing ) {
+                if( !sameEntry(table.getByID(ID(kind, addr)), value) ) {
+                    std::ostringstream s;
+                    s << "snapshot does not match the registry: entry " << addr << " of table " << name <<
+                        " differs (were other plugins or plugin options used?)";
+                    throw GeneralError(s.str());
+                }
+            }
+            else {
+                adaptEntry(value, reg);
+                const ID id = table.storeAndGetID(value);
+                if( id.address != addr )
+                    throw GeneralError("snapshot contains duplicate entries in table " + name);
+            }
+        }
+        DBGLOG(DBG,"loaded " << size << " entries of table " << name << " from snapshot");
+    }
+}
+
+
+void Snapshot::save(const ProgramCtx& ctx, const std::string& filename)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Saving snapshot");
+    LOG(INFO,"saving snapshot to '" << filename << "'");
+
+    const RegistryPtr& reg = ctx.registry();
+    assert(!!reg);
+    if( reg->matoms.getSize() != 0 || reg->moduleTable.getSize() != 0 )
+        throw GeneralError("snapshots of modular HEX programs are not supported");
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !out.is_open() )
+        throw GeneralError("could not open snapshot file '" + filename + "' for writing");
+    SnapshotWriter writer(out);
+
+    // header
+    out.write(Magic, sizeof(Magic));
+    writer.writeU32(ByteOrderMark);
+    writer.writeU32(FormatVersion);
+    writer.writeString(VERSION);
+
+    // registry
+    writer.writeTable(reg->terms, TermKind);
+    writer.writeTable(reg->preds, PredicateKind);
+    writer.writeTable(reg->ogatoms, OrdinaryAtomKind);
+    writer.writeTable(reg->onatoms, OrdinaryAtomKind);
+    writer.writeTable(reg->batoms, BuiltinAtomKind);
+    writer.writeTable(reg->aatoms, AggregateAtomKind);
+    writer.writeTable(reg->eatoms, ExternalAtomKind);
+    writer.writeTable(reg->rules, RuleKind);
+    std::vector<Registry::AuxiliarySymbol> auxSymbols;
+    reg->getAuxiliarySymbols(auxSymbols);
+    writer.writeU32(auxSymbols.size());
+    BOOST_FOREACH(const Registry::AuxiliarySymbol& aux, auxSymbols) {
+        writer.writeU32(static_cast<unsigned char>(aux.type));
+        writer.writeID(aux.id);
+        writer.writeString(aux.symbol);
+        writer.writeID(aux.auxID);
+    }
+
+    // program
+    writer.writeU32(ctx.maxint);
+    if( !!ctx.edb ) {
+        const Interpretation::Storage& bits = ctx.edb->getStorage();
+        writer.writeU32(bits.count());
+        for(Interpretation::Storage::enumerator it = bits.first(); it != bits.end(); ++it)
+            writer.writeU32(*it);
+    }
+    else {
+        writer.writeU32(0);
+    }
+    writer.writeTuple(ctx.idb);
+    writer.writeU32(EndMark);
+
+    out.close();
+    if( out.fail() )
+        throw GeneralError("could not write snapshot file '" + filename + "'");
+}
+
+
+void Snapshot::load(ProgramCtx& ctx, const std::string& filename)
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Loading snapshot");
+    LOG(INFO,"loading snapshot from '" << filename << "'");
+
+    RegistryPtr reg = ctx.registry();
+    assert(!!reg);
+    if( !ctx.idb.empty() )
+        throw GeneralError("cannot load a snapshot into a program context which already contains a program");
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filename);
+    }
+    catch(const std::exception& e) {
+        throw GeneralError("could not map snapshot file '" + filename + "': " + e.what());
+    }
+    SnapshotReader reader(file.data(), file.data() + file.size(), filename);
+
+    // header
+    char magic[sizeof(Magic)];
+    reader.readBytes(magic, sizeof(magic));
+    if( std::memcmp(magic, Magic, sizeof(Magic)) != 0 )
+        throw GeneralError("file '" + filename + "' is not a dlvhex snapshot");
+    if( reader.readU32() != ByteOrderMark )
+        throw GeneralError("snapshot file '" + filename + "' was written on a platform with different byte order");
+    if( reader.readU32() != FormatVersion )
+        throw GeneralError("snapshot file '" + filename + "' has an unsupported format version");
+    std::string version;
+    reader.readString(version);
+    if( version != VERSION )
+        throw GeneralError("snapshot file '" + filename + "' was written by dlvhex " + version + " (this is " + VERSION + ")");
+
+    // registry
+    loadTable<Term>(reader, reg->terms, TermKind, *reg, "terms");
+    loadTable<Predicate>(reader, reg->preds, PredicateKind, *reg, "preds");
+    loadTable<OrdinaryAtom>(reader, reg->ogatoms, OrdinaryAtomKind, *reg, "ogatoms");
+    loadTable<OrdinaryAtom>(reader, reg->onatoms, OrdinaryAtomKind, *reg, "onatoms");
+    loadTable<BuiltinAtom>(reader, reg->batoms, BuiltinAtomKind, *reg, "batoms");
+    loadTable<AggregateAtom>(reader, reg->aatoms, AggregateAtomKind, *reg, "aatoms");
+    loadTable<ExternalAtom>(reader, reg->eatoms, ExternalAtomKind, *reg, "eatoms");
+    loadTable<Rule>(reader, reg->rules, RuleKind, *reg, "rules");
+    const uint32_t auxSymbols = reader.readU32();
+    for(uint32_t i = 0; i < auxSymbols; ++i) {
+        Registry::AuxiliarySymbol aux;
+        aux.type = static_cast<char>(reader.readU32());
+        aux.id = reader.readID();
+        reader.readString(aux.symbol);
+        aux.auxID = reader.readID();
+        try
+        {
+            reg->restoreAuxiliarySymbol(aux);
+        }
+        catch(const GeneralError& e) {
+            throw GeneralError("snapshot does not match the registry: " + e.getErrorMsg());
+        }
+    }
+
+    // program
+    ctx.maxint = reader.readU32();
+    if( !ctx.edb )
+        ctx.edb.reset(new Interpretation(reg));
+    const uint32_t facts = reader.readU32();
+    for(uint32_t i = 0; i < facts; ++i)
+        ctx.edb->setFact(reader.readU32());
+    reader.readTuple(ctx.idb);
+    if( reader.readU32() != EndMark || !reader.atEnd() )
+        throw GeneralError("snapshot file '" + filename + "' is corrupt");
+
+    LOG(INFO,"loaded snapshot with " << reg->ogatoms.getSize() << " ground atoms, " <<
+        facts << " facts and " << ctx.idb.size() << " rules");
+}
+
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
@@ -0,0 +1,340 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   SolverWarmStartCache.cpp
+ *
+ * @brief  Learned nogoods and decision phases of the internal solver which are kept across runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif                           // HAVE_CONFIG_H
+
+#include "dlvhex2/SolverWarmStartCache.h"
+#include "dlvhex2/OrdinaryASPProgram.h"
+#include "dlvhex2/Registry.h"
+#include "dlvhex2/Printer.h"
+#include "dlvhex2/Error.h"
+#include "dlvhex2/Logger.h"
+#include "dlvhex2/Benchmarking.h"
+
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+DLVHEX_NAMESPACE_BEGIN
+
+namespace
+{
+    // 15 characters and terminating zero
+    const char Magic[16] = "dlvhex2warmstrt";
+    // detects files written on a platform with different byte order
+    const uint32_t ByteOrderMark = 0x01020304;
+
+    // writes cache data in native byte order
+    class WarmStartWriter
+    {
+        private:
+            std::ostream& out;
+
+        public:
+            WarmStartWriter(std::ostream& out): out(out) {}
+
+            void writeU32(uint32_t value)
+                { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+            void writeU64(boost::uint64_t value)
+                { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+            void writeString(const std::string& str) {
+                writeU32(str.size());
+                out.write(str.data(), str.size());
+            }
+    };
+
+    // reads cache data from memory, checking bounds
+    class WarmStartReader
+    {
+        private:
+            const char* pos;
+            const char* end;
+
+            void need(std::size_t bytes) {
+                if( static_cast<std::size_t>(end - pos) < bytes )
+                    throw GeneralError("file is truncated");
+            }
+
+        public:
+            WarmStartReader(const char* begin, const char* end): pos(begin), end(end) {}
+
+            bool atEnd() const
+                { return pos == end; }
+
+            void readBytes(char* target, std::size_t bytes) {
+                need(bytes);
+                std::memcpy(target, pos, bytes);
+                pos += bytes;
+            }
+            uint32_t readU32() {
+                uint32_t value;
+                readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+                return value;
+            }
+            boost::uint64_t readU64() {
+                boost::uint64_t value;
+                readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+                return value;
+            }
+            void readString(std::string& str) {
+                const uint32_t size = readU32();
+                need(size);
+                str.assign(pos, size);
+                pos += size;
+            }
+            // reads the size of a sequence and checks that the data can contain it (prevents huge allocations for corrupt files)
+            uint32_t readCount(std::size_t minBytesPerElement) {
+                const uint32_t count = readU32();
+                need(static_cast<std::size_t>(count) * minBytesPerElement);
+                return count;
+            }
+    };
+
+    // an entry counts at least as one nogood
+    inline std::size_t cost(const SolverWarmStartCache::Entry& entry)
+    {
+        return std::max<std::size_t>(1, entry.nogoods.size());
+    }
+}
+
+
+SolverWarmStartCache::SolverWarmStartCache(const std::string& filename, unsigned maxNogoods):
+filename(filename), maxNogoods(maxNogoods), clock(0)
+{
+}
+
+
+void SolverWarmStartCache::load()
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Loading warm-start cache");
+    boost::mutex::scoped_lock lock(mutex);
+
+    entries.clear();
+    clock = 0;
+
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if( !in.is_open() ) {
+        LOG(INFO,"warm-start file '" << filename << "' does not exist yet, starting cold");
+        return;
+    }
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    try
+    {
+        WarmStartReader reader(data.data(), data.data() + data.size());
+
+        // header
+        char magic[sizeof(Magic)];
+        reader.readBytes(magic, sizeof(magic));
+        if( std::memcmp(magic, Magic, sizeof(Magic)) != 0 )
+            throw GeneralError("not a dlvhex warm-start file");
+        if( reader.readU32() != ByteOrderMark )
+            throw GeneralError("written on a platform with different byte order");
+        if( reader.readU32() != FormatVersion )
+            throw GeneralError("unsupported format version");
+        std::string version;
+        reader.readString(version);
+        if( version != VERSION )
+            throw GeneralError("written by dlvhex " + version);
+
+        // entries in order of last use
+        const uint32_t entryCount = reader.readCount(sizeof(Key));
+        for(uint32_t e = 0; e < entryCount; ++e) {
+            const Key key = reader.readU64();
+            StoredEntry& stored = entries[key];
+            stored.lastUse = ++clock;
+            Entry& entry = stored.entry;
+
+            const uint32_t atomCount = reader.readCount(2 * sizeof(uint32_t));
+            entry.atoms.resize(atomCount);
+            entry.phases.resize(atomCount);
+            for(uint32_t a = 0; a < atomCount; ++a) {
+                reader.readString(entry.atoms[a]);
+                entry.phases[a] = reader.readU32();
+            }
+
+            entry.nogoods.resize(reader.readCount(sizeof(uint32_t)));
+            BOOST_FOREACH (std::vector<int>& ng, entry.nogoods) {
+                ng.resize(reader.readCount(sizeof(uint32_t)));
+                BOOST_FOREACH (int& lit, ng) {
+                    lit = static_cast<int>(reader.readU32());
+                    if( lit == 0 || (uint32_t)std::abs(lit) > atomCount )
+                        throw GeneralError("invalid literal");
+                }
+            }
+        }
+        if( !reader.atEnd() )
+            throw GeneralError("trailing data");
+
+        // the bound might have been lowered since the file was written
+        if( !entries.empty() )
+            evict(entries.begin()->first);
+    }
+    catch(const GeneralError& e) {
+        LOG(WARNING,"ignoring warm-start file '" << filename << "': " << e.getErrorMsg());
+        entries.clear();
+        clock = 0;
+        return;
+    }
+    LOG(INFO,"loaded " << entries.size() << " entries from warm-start file '" << filename << "'");
+}
+
+
+void SolverWarmStartCache::save()
+{
+    DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"Saving warm-start cache");
+    boost::mutex::scoped_lock lock(mutex);
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !out.is_open() )
+        throw GeneralError("could not open warm-start file '" + filename + "' for writing");
+    WarmStartWriter writer(out);
+
+    // header
+    out.write(Magic, sizeof(Magic));
+    writer.writeU32(ByteOrderMark);
+    writer.writeU32(FormatVersion);
+    writer.writeString(VERSION);
+
+    // write entries in order of last use such that loading restores the LRU order
+    std::vector<std::pair<uint32_t, Key> > order;
+    for(std::map<Key, StoredEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        order.push_back(std::make_pair(it->second.lastUse, it->first));
+    std::sort(order.begin(), order.end());
+
+    writer.writeU32(order.size());
+    for(std::size_t i = 0; i < order.size(); ++i) {
+        const Entry& entry = entries[order[i].second].entry;
+        writer.writeU64(order[i].second);
+
+        writer.writeU32(entry.atoms.size());
+        for(std::size_t a = 0; a < entry.atoms.size(); ++a) {
+            writer.writeString(entry.atoms[a]);
+            writer.writeU32(entry.phases[a]);
+        }
+
+        writer.writeU32(entry.nogoods.size());
+        BOOST_FOREACH (const std::vector<int>& ng, entry.nogoods) {
+            writer.writeU32(ng.size());
+            BOOST_FOREACH (int lit, ng) writer.writeU32(static_cast<uint32_t>(lit));
+        }
+    }
+
+    out.close();
+    if( out.fail() )
+        throw GeneralError("could not write warm-start file '" + filename + "'");
+    LOG(INFO,"saved " << entries.size() << " entries to warm-start file '" << filename << "'");
+}
+
+
+bool SolverWarmStartCache::lookup(Key key, Entry& entry)
+{
+    boost::mutex::scoped_lock lock(mutex);
+
+    std::map<Key, StoredEntry>::iterator it = entries.find(key);
+    if( it == entries.end() ) return false;
+    it->second.lastUse = ++clock;
+    entry = it->second.entry;
+    return true;
+}
+
+
+void SolverWarmStartCache::store(Key key, const Entry& entry)
+{
+    assert(entry.atoms.size() == entry.phases.size());
+    boost::mutex::scoped_lock lock(mutex);
+
+    StoredEntry& stored = entries[key];
+    stored.entry = entry;
+    stored.lastUse = ++clock;
+    if( stored.entry.nogoods.size() > maxNogoods )
+        stored.entry.nogoods.resize(maxNogoods);
+    evict(key);
+}
+
+
+void SolverWarmStartCache::evict(Key keep)
+{
+    std::size_t total = 0;
+    std::vector<std::pair<uint32_t, Key> > order;
+    for(std::map<Key, StoredEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        total += cost(it->second.entry);
+        if( it->first != keep ) order.push_back(std::make_pair(it->second.lastUse, it->first));
+    }
+    std::sort(order.begin(), order.end());
+
+    for(std::size_t i = 0; i < order.size() && total > maxNogoods; ++i) {
+        std::map<Key, StoredEntry>::iterator it = entries.find(order[i].second);
+        DBGLOG(DBG,"evicting warm-start entry " << it->first);
+        total -= cost(it->second.entry);
+        entries.erase(it);
+    }
+}
+
+
+SolverWarmStartCache::Key SolverWarmStartCache::computeKey(RegistryPtr reg, const OrdinaryASPProgram& program)
+{
+    // hash rules individually and combine them in sorted order such that the key does not depend on the order of the rules
+    boost::hash<std::string> hashString;
+    std::vector<std::size_t> ruleHashes;
+    ruleHashes.reserve(program.idb.size());
+    BOOST_FOREACH (ID ruleID, program.idb) {
+        ruleHashes.push_back(hashString(printToString<RawPrinter>(ruleID, reg)));
+    }
+    std::sort(ruleHashes.begin(), ruleHashes.end());
+
+    std::size_t seed = ruleHashes.size();
+    BOOST_FOREACH (std::size_t h, ruleHashes) boost::hash_combine(seed, h);
+    return seed;
+}
+
+
+std::string SolverWarmStartCache::atomText(RegistryPtr reg, IDAddress atom)
+{
+    const OrdinaryAtom& oatom = reg->ogatoms.getByAddress(atom);
+    if( !oatom.text.empty() ) return oatom.text;
+    // text is not stored with --lazyatomtext
+    return printToString<RawPrinter>(reg->ogatoms.getIDByAddress(atom), reg);
+}
+
+DLVHEX_NAMESPACE_END
+
+// vim:expandtab:ts=4:sw=4:
+// mode: C++
+// End:
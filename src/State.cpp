@@ -64,8 +64,10 @@
 #include "dlvhex2/SafetyChecker.h"
 #include "dlvhex2/MLPSyntaxChecker.h"
 #include "dlvhex2/MLPSolver.h"
+#include "dlvhex2/PersistentAnswerCache.h"
 
 #include <boost/foreach.hpp>
+#include <boost/optional.hpp>
 
 #include <iostream>
 #include <sstream>
@@ -699,6 +701,10 @@ namespace
         // processing a model this way gives it as a result, so we snapshot the first model here
         snapShotBenchmarking(*ctx);
 
+        // the model graph may only be inspected by this thread
+        if( !!ctx->memorySampler )
+            ctx->memorySampler->modelGraphCheckpoint(*ctx);
+
         bool abort = false;
         BOOST_FOREACH(ModelCallbackPtr mcb, ctx->modelCallbacks) {
             bool aborthere = !(*mcb)(answerset);
@@ -953,6 +959,11 @@ namespace
 void
 EvaluateState::evaluate(ProgramCtx* ctx)
 {
+    const unsigned memorySampleInterval = ctx->config.getOption("MemorySampleInterval");
+    if( ctx->config.getOption("DumpStats") && memorySampleInterval > 0 && !ctx->memorySampler ) {
+        ctx->memorySampler.reset(new memory::Sampler(*ctx, memorySampleInterval, std::cerr));
+    }
+
     do {
         if( ctx->config.getOption("Optimization") ) {
             if( ctx->config.getOption("OptimizationTwoStep") > 0 ) {
@@ -1006,6 +1017,19 @@ void PostProcessState::postProcess(ProgramCtx* ctx)
     DLVHEX_BENCHMARK_REGISTER_AND_SCOPE(sid,"postProcess");
 
     // cleanup some stuff that is better not automatically destructed
+    // the model graph is released below, so measure memory usage now
+    memory::Report memoryReport;
+    if( ctx->config.getOption("DumpStats") ) {
+        memory::collect(*ctx, memoryReport);
+        memoryReport.add("modelgraph", memory::modelGraphSize(*ctx));
+    }
+    boost::optional<memory::Report> memoryPeak;
+    if( !!ctx->memorySampler ) {
+        memoryPeak = ctx->memorySampler->getPeak();
+        memoryPeak->updatePeak(memoryReport);
+        ctx->memorySampler.reset();
+    }
+
     DBGLOG(DBG,"usage count of model builder before reset is " <<
         ctx->modelBuilder.use_count());
     ctx->modelBuilder.reset();
@@ -1044,6 +1068,23 @@ void PostProcessState::postProcess(ProgramCtx* ctx)
         std::cerr << ";solver;" << bmc.duration("Solver time", 3);
         std::cerr << ";overall;" << bmc.duration(overallName, 3);
         std::cerr << std::endl;
+        std::cerr << "MEMORY;" << memoryReport << std::endl;
+        if( !!memoryPeak )
+            std::cerr << "MEMORYPEAK;" << *memoryPeak << std::endl;
+        // dump hit rates of the external atom query caches
+        BOOST_FOREACH(const PluginAtomMap::value_type& entry, ctx->pluginAtomMap()) {
+            const PluginAtom::CacheStatistics stats = entry.second->getCacheStatistics();
+            if( stats.hits + stats.misses == 0 )
+                continue;
+            std::cerr << "EXTCACHE;&" << entry.first << ";hits;" << stats.hits <<
+                ";subsumptionhits;" << stats.subsumptionHits << ";misses;" << stats.misses <<
+                ";hitrate;" << static_cast<double>(stats.hits) / (stats.hits + stats.misses) <<
+                ";evictions;" << stats.evictions << ";bytes;" << stats.bytes << std::endl;
+        }
+        if( !!ctx->persistentAnswerCache ) {
+            std::cerr << "EXTCACHEFILE;hits;" << ctx->persistentAnswerCache->getHits() <<
+                ";misses;" << ctx->persistentAnswerCache->getMisses() << std::endl;
+        }
     }
 }
 
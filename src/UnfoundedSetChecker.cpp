@@ -1779,8 +1779,8 @@ void AssumptionBasedUnfoundedSetChecker::propagate(InterpretationConstPtr partia
             InterpretationPtr eaResult = InterpretationPtr(new Interpretation(reg));
             BaseModelGenerator::IntegrateExternalAnswerIntoInterpretationCB cb(eaResult);
 
-            InterpretationPtr eaInputIntrAssigned = InterpretationPtr(new Interpretation(inputCompatibleSet->getRegistry()));
-            eaInputIntrAssigned->getStorage() = assigned->getStorage();
+            InterpretationPtr eaInputIntrAssigned = InterpretationPtr(new Interpretation(*assigned));
+            eaInputIntrAssigned->setRegistry(inputCompatibleSet->getRegistry());
 
             InterpretationConstPtr partialInputSetWithoutAux = partialInterpretation->getInterpretationWithoutExternalAtomAuxiliaries();
             InterpretationPtr eaInputIntr = InterpretationPtr(new Interpretation(inputCompatibleSet->getRegistry()));
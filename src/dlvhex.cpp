@@ -138,6 +138,9 @@
 #include "dlvhex2/ASPSolver.h"
 #include "dlvhex2/AnswerSetPrinterCallback.h"
 #include "dlvhex2/State.h"
+#include "dlvhex2/Snapshot.h"
+#include "dlvhex2/SolverWarmStartCache.h"
+#include "dlvhex2/PersistentAnswerCache.h"
 #include "dlvhex2/EvalGraphBuilder.h"
 #include "dlvhex2/EvalHeuristicBase.h"
 #include "dlvhex2/EvalHeuristicASP.h"
@@ -364,8 +367,35 @@ printUsage(std::ostream &out, const char* whoAmI, bool full)
         << "     --solver=S       Use S as ASP engine, where S is one of dlv, dlvdb, libdlv, libclingo, genuineii, genuinegi, genuineic, genuinegc" << std::endl
         << "                        (genuineii=(i)nternal grounder and (i)nternal solver; genuinegi=(g)ringo grounder and (i)nternal solver" << std::endl
         << "                         genuineic=(i)nternal grounder and (c)lasp solver; genuinegc=(g)ringo grounder and (c)lasp solver)." << std::endl
+        << "     --cdnlpropagation=[classic,watches]" << std::endl
+        << "                      Unit propagation engine of the internal solver (genuineii, genuinegi):" << std::endl
+        << "                         classic (default): Watching sets per literal, maintained on every (un)assignment" << std::endl
+        << "                         watches          : Two watched literals in flat arrays with a propagation trail" << std::endl
+        << "     --cdnlheuristics=[classic,vsids]" << std::endl
+        << "                      Decision heuristics of the internal solver:" << std::endl
+        << "                         classic (default): Most active atom of the most recent conflicts" << std::endl
+        << "                         vsids            : Most active atom from an activity heap with decay" << std::endl
+        << "     --cdnlrestarts=[none,luby,geometric]" << std::endl
+        << "                      Restart strategy of the internal solver (default: none)." << std::endl
+        << "     --cdnlrestartbase=N" << std::endl
+        << "                      Number of conflicts in the first restart interval (default: 100)." << std::endl
+        << "     --cdnlphasesaving" << std::endl
+        << "                      Let the internal solver reuse the last truth value of an atom for decisions." << std::endl
+        << "     --cdnlreduce=N   Let the internal solver delete the less useful half of its learned nogoods" << std::endl
+        << "                      every N conflicts (default: 0, never)." << std::endl
+        << "     --warmstart=FILE Let the internal solver start with the learned nogoods and phases of earlier runs" << std::endl
+        << "                      on units with the same ground program, and store its own ones in FILE at the end;" << std::endl
+        << "                      nogoods are verified against the current program before they are used." << std::endl
+        << "     --warmstart-limit=N" << std::endl
+        << "                      Maximum number of nogoods kept in the warm-start file (default: 10000)." << std::endl
         << "     --claspconfig=C  If clasp is used, configure it with C where C is parsed by clasp config parser, or " << std::endl
         << "                      C is one of the predefined strings frumpy, jumpy, handy, crafty, or trendy." << std::endl
+        << "     --claspthreads=N Let clasp search with N threads (default: 1); requires clasp with multi-threading support" << std::endl
+        << "                      and is not used for optimization problems." << std::endl
+        << "     --claspparallelmode=[compete,split]" << std::endl
+        << "                      Cooperation of the clasp threads:" << std::endl
+        << "                         compete (default): Portfolio of differently configured solvers on the whole search space" << std::endl
+        << "                         split            : Distribute the search space among the solvers" << std::endl
         << " -e, --heuristics=H   Use H as evaluation heuristics, where H is one of" << std::endl
         << "                         old              : Old dlvhex behavior" << std::endl
         << "                         trivial          : Use component graph as eval graph (much overhead)" << std::endl
@@ -376,8 +406,38 @@ printUsage(std::ostream &out, const char* whoAmI, bool full)
         << "                                            where component indices <idx> are from '--graphviz=comp'" << std::endl
         << "                         asp:<script>     : Use asp program <script> as eval heuristic" << std::endl
         << "     --forcegc        Always use the guess and check model generator." << std::endl
+        << "     --persistentunits" << std::endl
+        << "                      Let guess and check model generators of a unit share one ground program and reuse" << std::endl
+        << "                      the solver and learned external atom nogoods, passing the input as assumptions" << std::endl
+        << "                      (not with --transunitlearning or --extinlining)." << std::endl
+        << "     --enumthreads=N  Let guess and check model generators split their search space into cubes and enumerate" << std::endl
+        << "                      them with N threads (default: 1); implies --persistentunits and is not used for" << std::endl
+        << "                      optimization problems." << std::endl
         << " -m, --modelbuilder=M Use M as model builder, where M is one of (online,offline)." << std::endl
         << "     --nocache        Do not cache queries to and answers from external atoms." << std::endl
+        << "     --extcachelimit=N" << std::endl
+        << "                      Limit the caches of all external atoms to about N megabytes in total" << std::endl
+        << "                      (default: 0, unlimited); answers which are cheap to recompute and" << std::endl
+        << "                      which were not used recently are dropped first." << std::endl
+        << "     --extcacheatomlimit=N" << std::endl
+        << "                      Limit the cache of each external atom to about N megabytes (default: 0, unlimited)." << std::endl
+        << "     --extcachefile=FILE" << std::endl
+        << "                      Answer queries to external atoms with property 'persistentcache' from the answers" << std::endl
+        << "                      of earlier runs stored in FILE, and store new answers there at the end." << std::endl
+        << "     --extcachefile-limit=N" << std::endl
+        << "                      Maximum number of answers kept in the external answer cache file (default: 100000)." << std::endl
+        << "     --concurrentregistry" << std::endl
+        << "                      Use sharded, mostly lock-free indices for terms, predicates and ordinary atoms" << std::endl
+        << "                      (speeds up registry lookups from multiple threads at the cost of additional memory)." << std::endl
+        << "     --lazyatomtext   Do not store the textual representation of ordinary atoms, render it only for output" << std::endl
+        << "                      (saves memory and time if few of many atoms are printed; not with --mlp)." << std::endl
+        << "     --parserthreads=N" << std::endl
+        << "                      Scan large inputs consisting of facts with N threads (default: 1)." << std::endl
+        << "     --save-snapshot=FILE" << std::endl
+        << "                      Save registry and program to FILE after parsing and rewriting (not with --mlp)." << std::endl
+        << "     --load-snapshot=FILE" << std::endl
+        << "                      Load registry and program from FILE instead of parsing the input" << std::endl
+        << "                      (requires the same dlvhex version, plugins and plugin options as when saving)." << std::endl
         << "     --iauxinaux      Keep auxiliary input predicates in auxiliary external atom predicates (can increase or decrease efficiency)." << std::endl
         << "     --constspace     Free partial models immediately after using them. This may cause some models." << std::endl
         << "                      to be computed multiple times. (Not with monolithic.)" << std::endl
@@ -403,8 +463,13 @@ printUsage(std::ostream &out, const char* whoAmI, bool full)
         << "                         8                : Timing information" << std::endl
         << "                                           (only if configured with --enable-benchmark)" << std::endl
         << "                      add values for multiple categories." << std::endl
-        << "     --dumpstats      Dump certain benchmarking results and statistics in CSV format." << std::endl
+        << "     --dumpstats      Dump certain benchmarking results and statistics (including hit rates of" << std::endl
+        << "                      external atom caches) in CSV format." << std::endl
         << "                      (Only if configured with --enable-benchmark.)" << std::endl
+        << "     --memsampleinterval=MS" << std::endl
+        << "                      With --dumpstats, sample the approximate memory usage of registry," << std::endl
+        << "                      nogoods, external atom caches and model graph every MS milliseconds" << std::endl
+        << "                      during evaluation (default: 1000, 0 disables sampling)." << std::endl
         << "     --graphviz=G     Specify comma separated list of graph types to export as .dot files." << std::endl
         << "                      Default is none, graph types are:" << std::endl
         << "                         dep              : Dependency Graph (once per program)" << std::endl
@@ -653,6 +718,14 @@ int main(int argc, char *argv[])
             }
             throw UsageError(bad.str());
         }
+        // preload answers of external atoms of earlier runs
+        // (before the plugin atoms are created such that they are registered with the cache)
+        const std::string extCacheFile = pctx.config.getStringOption("ExtAtomCacheFile");
+        if( !extCacheFile.empty() ) {
+            pctx.persistentAnswerCache.reset(new PersistentAnswerCache(extCacheFile, pctx.config.getOption("ExtAtomCacheFileLimit")));
+            pctx.persistentAnswerCache->load();
+        }
+
         // use configured plugins to obtain plugin atoms
         pctx.addPluginAtomsFromPluginContainer();
 
@@ -678,17 +751,32 @@ int main(int argc, char *argv[])
         }
         #endif
 
-        // now we check if we got input
-        if( !pctx.inputProvider || !pctx.inputProvider->hasContent() )
-            throw UsageError("no input specified!");
+        const std::string loadSnapshot = pctx.config.getStringOption("LoadSnapshot");
+        if( !loadSnapshot.empty() ) {
+            if( pctx.config.getOption("MLP") )
+                throw UsageError("--load-snapshot cannot be used with --mlp");
+            if( !!pctx.inputProvider && pctx.inputProvider->hasContent() )
+                LOG(INFO,"ignoring input files because a snapshot is loaded");
 
-        // convert input (only done if at least one plugin provides a converter)
-        pctx.convert();
-        if( pctx.terminationRequest ) return 1;
+            // restore the program as it was after parsing and rewriting
+            Snapshot::load(pctx, loadSnapshot);
+            pctx.changeState(StatePtr(new SafetyCheckState));
+            pctx.associateExtAtomsWithPluginAtoms(pctx.idb, true);
+            if( pctx.terminationRequest ) return 1;
+        }
+        else {
+            // now we check if we got input
+            if( !pctx.inputProvider || !pctx.inputProvider->hasContent() )
+                throw UsageError("no input specified!");
 
-        // parse input (coming directly from inputprovider or from inputprovider provided by the convert() step)
-        pctx.parse();
-        if( pctx.terminationRequest ) return 1;
+            // convert input (only done if at least one plugin provides a converter)
+            pctx.convert();
+            if( pctx.terminationRequest ) return 1;
+
+            // parse input (coming directly from inputprovider or from inputprovider provided by the convert() step)
+            pctx.parse();
+            if( pctx.terminationRequest ) return 1;
+        }
 
         // check if in mlp mode
         if( pctx.config.getOption("MLP") ) {
@@ -703,19 +791,26 @@ int main(int argc, char *argv[])
 
         else {
 
-            // associate PluginAtom instances with
-            // ExternalAtom instances (in the IDB)
-            pctx.associateExtAtomsWithPluginAtoms(pctx.idb, true);
-            if( pctx.terminationRequest ) return 1;
+            if( loadSnapshot.empty() ) {
+                // associate PluginAtom instances with
+                // ExternalAtom instances (in the IDB)
+                pctx.associateExtAtomsWithPluginAtoms(pctx.idb, true);
+                if( pctx.terminationRequest ) return 1;
 
-            // rewrite program (plugins might want to do this, e.g., for partial grounding)
-            pctx.rewriteEDBIDB();
-            if( pctx.terminationRequest ) return 1;
+                // rewrite program (plugins might want to do this, e.g., for partial grounding)
+                pctx.rewriteEDBIDB();
+                if( pctx.terminationRequest ) return 1;
 
-            // associate PluginAtom instances with
-            // ExternalAtom instances (in the IDB)
-            // (again, rewrite might add external atoms)
-            pctx.associateExtAtomsWithPluginAtoms(pctx.idb, true);
+                // associate PluginAtom instances with
+                // ExternalAtom instances (in the IDB)
+                // (again, rewrite might add external atoms)
+                pctx.associateExtAtomsWithPluginAtoms(pctx.idb, true);
+            }
+
+            // save the rewritten program for later runs
+            const std::string saveSnapshot = pctx.config.getStringOption("SaveSnapshot");
+            if( !saveSnapshot.empty() )
+                Snapshot::save(pctx, saveSnapshot);
 
             // check weak safety
             pctx.safetyCheck();
@@ -753,6 +848,13 @@ int main(int argc, char *argv[])
             if( config.optionNoEval )
                 return 0;
 
+            // preload learned nogoods and phases of earlier runs
+            const std::string warmStartFile = pctx.config.getStringOption("WarmStartFile");
+            if( !warmStartFile.empty() ) {
+                pctx.warmStartCache.reset(new SolverWarmStartCache(warmStartFile, pctx.config.getOption("WarmStartLimit")));
+                pctx.warmStartCache->load();
+            }
+
             // setup model builder and configure plugin/dlvhex model processing hooks
             pctx.setupProgramCtx();
             if( pctx.terminationRequest ) return 1;
@@ -768,6 +870,15 @@ int main(int argc, char *argv[])
         // (accumulated model output/query answering should happen here)
         pctx.postProcess();
 
+        // store learned nogoods and phases for later runs
+        // (after post processing because solvers store them when the model builder is destroyed)
+        if( !!pctx.warmStartCache )
+            pctx.warmStartCache->save();
+
+        // store answers of external atoms for later runs
+        if( !!pctx.persistentAnswerCache )
+            pctx.persistentAnswerCache->save();
+
         // no error
         returnCode = 0;
     }
@@ -907,6 +1018,28 @@ Config& config, ProgramCtx& pctx)
         { "useatomcompliance", no_argument, 0, 75 },
         { "eaevaldebounce", required_argument, 0, 76 },
         { "claspsatdefernprop", required_argument, 0, 77 },
+        { "concurrentregistry", no_argument, 0, 79 },
+        { "lazyatomtext", no_argument, 0, 80 },
+        { "save-snapshot", required_argument, 0, 81 },
+        { "load-snapshot", required_argument, 0, 82 },
+        { "parserthreads", required_argument, 0, 83 },
+        { "memsampleinterval", required_argument, 0, 84 },
+        { "cdnlpropagation", required_argument, 0, 85 },
+        { "cdnlheuristics", required_argument, 0, 86 },
+        { "cdnlrestarts", required_argument, 0, 87 },
+        { "cdnlrestartbase", required_argument, 0, 88 },
+        { "cdnlphasesaving", no_argument, 0, 89 },
+        { "cdnlreduce", required_argument, 0, 90 },
+        { "claspthreads", required_argument, 0, 91 },
+        { "claspparallelmode", required_argument, 0, 92 },
+        { "persistentunits", no_argument, 0, 93 },
+        { "enumthreads", required_argument, 0, 94 },
+        { "warmstart", required_argument, 0, 95 },
+        { "warmstart-limit", required_argument, 0, 96 },
+        { "extcachelimit", required_argument, 0, 97 },
+        { "extcacheatomlimit", required_argument, 0, 98 },
+        { "extcachefile", required_argument, 0, 99 },
+        { "extcachefile-limit", required_argument, 0, 100 },
         { NULL, 0, NULL, 0 }
     };
 
@@ -1824,6 +1957,241 @@ Config& config, ProgramCtx& pctx)
                     pctx.config.setOption("ClaspSATDeferNPropagations", deferval);
                 }
                 break;
+            case 79:
+                pctx.config.setOption("ConcurrentRegistry", 1);
+                break;
+            case 80:
+                pctx.config.setOption("LazyAtomText", 1);
+                break;
+            case 81:
+                pctx.config.setStringOption("SaveSnapshot", std::string(optarg));
+                break;
+            case 82:
+                pctx.config.setStringOption("LoadSnapshot", std::string(optarg));
+                break;
+            case 83:
+            {
+                int parserthreads = 1;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        parserthreads = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        parserthreads = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse number of parser threads '" << optarg << "' - using default=" << parserthreads << "!");
+                }
+                if (parserthreads < 1) {
+                    throw GeneralError(std::string("Number of parser threads must be > 0"));
+                }
+                pctx.config.setOption("ParserThreads", parserthreads);
+            }
+            break;
+            case 84:
+            {
+                unsigned interval = 1000;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        interval = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        interval = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse memory sample interval '" << optarg << "' - using default=" << interval << "!");
+                }
+                pctx.config.setOption("MemorySampleInterval", interval);
+            }
+            break;
+            case 85:
+            {
+                std::string engine(optarg);
+                if (engine == "classic") {
+                    pctx.config.setOption("CDNLPropagation", 0);
+                }
+                else if (engine == "watches") {
+                    pctx.config.setOption("CDNLPropagation", 1);
+                }
+                else {
+                    throw GeneralError(std::string("Unknown propagation engine: \"") + engine + std::string("\""));
+                }
+            }
+            break;
+            case 86:
+            {
+                std::string heur(optarg);
+                if (heur == "classic") {
+                    pctx.config.setOption("CDNLHeuristics", 0);
+                }
+                else if (heur == "vsids") {
+                    pctx.config.setOption("CDNLHeuristics", 1);
+                }
+                else {
+                    throw GeneralError(std::string("Unknown decision heuristics: \"") + heur + std::string("\""));
+                }
+            }
+            break;
+            case 87:
+            {
+                std::string strategy(optarg);
+                if (strategy == "none") {
+                    pctx.config.setOption("CDNLRestarts", 0);
+                }
+                else if (strategy == "luby") {
+                    pctx.config.setOption("CDNLRestarts", 1);
+                }
+                else if (strategy == "geometric") {
+                    pctx.config.setOption("CDNLRestarts", 2);
+                }
+                else {
+                    throw GeneralError(std::string("Unknown restart strategy: \"") + strategy + std::string("\""));
+                }
+            }
+            break;
+            case 88:
+            {
+                int base = 100;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        base = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        base = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse restart base '" << optarg << "' - using default=" << base << "!");
+                }
+                if (base < 1) {
+                    throw GeneralError(std::string("Restart base must be > 0"));
+                }
+                pctx.config.setOption("CDNLRestartBase", base);
+            }
+            break;
+            case 89:
+                pctx.config.setOption("CDNLPhaseSaving", 1);
+                break;
+            case 90:
+            {
+                int interval = 0;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        interval = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        interval = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse nogood reduction interval '" << optarg << "' - using default=" << interval << "!");
+                }
+                pctx.config.setOption("CDNLNogoodReduction", interval);
+            }
+            break;
+            case 91:
+            {
+                int threads = 1;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        threads = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        threads = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse number of clasp threads '" << optarg << "' - using default=" << threads << "!");
+                }
+                if (threads < 1) {
+                    throw GeneralError(std::string("Number of clasp threads must be > 0"));
+                }
+                pctx.config.setOption("ClaspThreads", threads);
+            }
+            break;
+            case 92:
+            {
+                std::string mode(optarg);
+                if (mode != "compete" && mode != "split") {
+                    throw GeneralError(std::string("Unknown clasp parallel mode: \"") + mode + std::string("\""));
+                }
+                pctx.config.setStringOption("ClaspParallelMode", mode);
+            }
+            break;
+            case 93:
+                pctx.config.setOption("PersistentUnits", 1);
+                break;
+            case 94:
+            {
+                int threads = 1;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        threads = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        threads = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse number of enumeration threads '" << optarg << "' - using default=" << threads << "!");
+                }
+                if (threads < 1) {
+                    throw GeneralError(std::string("Number of enumeration threads must be > 0"));
+                }
+                pctx.config.setOption("EnumerationThreads", threads);
+            }
+            break;
+            case 95:
+                pctx.config.setStringOption("WarmStartFile", std::string(optarg));
+                break;
+            case 96:
+            {
+                int limit = 10000;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        limit = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        limit = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse warm-start limit '" << optarg << "' - using default=" << limit << "!");
+                }
+                pctx.config.setOption("WarmStartLimit", limit);
+            }
+            break;
+            case 97:
+            case 98:
+            {
+                int limit = 0;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        limit = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        limit = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse external atom cache limit '" << optarg << "' - using default=" << limit << "!");
+                }
+                pctx.config.setOption(ch == 97 ? "ExtAtomCacheLimit" : "ExtAtomCacheAtomLimit", limit);
+            }
+            break;
+            case 99:
+                pctx.config.setStringOption("ExtAtomCacheFile", std::string(optarg));
+                break;
+            case 100:
+            {
+                int limit = 100000;
+                try
+                {
+                    if( optarg[0] == '=' )
+                        limit = boost::lexical_cast<unsigned>(&optarg[1]);
+                    else
+                        limit = boost::lexical_cast<unsigned>(optarg);
+                }
+                catch(const boost::bad_lexical_cast&) {
+                    LOG(ERROR,"could not parse external answer cache file limit '" << optarg << "' - using default=" << limit << "!");
+                }
+                pctx.config.setOption("ExtAtomCacheFileLimit", limit);
+            }
+            break;
         }
     }
 
@@ -1889,6 +2257,36 @@ Config& config, ProgramCtx& pctx)
         throw GeneralError("Option --noouterexternalatoms can only be used with --liberalsafety");
     }
 
+    if (pctx.config.getOption("ConcurrentRegistry")) {
+        pctx.registry()->setConcurrentStorage(true);
+    }
+
+    if (pctx.config.getOption("LazyAtomText")) {
+        // the MLP solver looks up atoms by their text
+        if (pctx.config.getOption("MLP")) {
+            LOG(WARNING,"--lazyatomtext cannot be used with --mlp, ignoring it");
+        }
+        else {
+            pctx.registry()->setLazyAtomText(true);
+        }
+    }
+
+    if (pctx.config.getOption("MLP") && !pctx.config.getStringOption("SaveSnapshot").empty()) {
+        LOG(WARNING,"--save-snapshot cannot be used with --mlp, ignoring it");
+    }
+
+    if (!pctx.config.getStringOption("WarmStartFile").empty()) {
+        const int solver = pctx.config.getOption("GenuineSolver");
+        if (solver != 1 && solver != 2) {
+            LOG(WARNING,"--warmstart is only supported by the internal solver (--solver=genuineii or --solver=genuinegi), ignoring it");
+            pctx.config.setStringOption("WarmStartFile", "");
+        }
+        else if (pctx.config.getOption("MLP")) {
+            LOG(WARNING,"--warmstart cannot be used with --mlp, ignoring it");
+            pctx.config.setStringOption("WarmStartFile", "");
+        }
+    }
+
     // configure plugin path
     configurePluginPath(config.optionPlugindir);
 
@@ -1896,7 +2294,7 @@ Config& config, ProgramCtx& pctx)
 
     // stdin requested, append it first
     if( std::string(argv[optind - 1]) == "--" )
-        pctx.inputProvider->addStreamInput(std::cin, "<stdin>");
+        pctx.inputProvider->addStreamingInput(std::cin, "<stdin>");
 
     // collect further filenames/URIs
     // if we use dlvdb, manage .typ files
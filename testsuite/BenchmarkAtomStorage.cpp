@@ -0,0 +1,166 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   BenchmarkAtomStorage.cpp
+ *
+ * @brief  Microbenchmark for the memory footprint of ground atom storage.
+ *
+ * Stores the same ground atoms once in an OrdinaryAtomTable (one OrdinaryAtom
+ * object with tuple and text per atom) and once in a CompactOrdinaryAtomTable
+ * (columnar storage without text) and reports the heap bytes per atom as well
+ * as the time for storing and for looking up all atoms by tuple.
+ *
+ * Usage: BenchmarkAtomStorage [atoms [arity]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Term.h"
+#include "dlvhex2/Atoms.h"
+#include "dlvhex2/TermTable.h"
+#include "dlvhex2/OrdinaryAtomTable.h"
+#include "dlvhex2/CompactOrdinaryAtomTable.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+LOG_INIT(Logger::ERROR | Logger::WARNING)
+
+DLVHEX_NAMESPACE_USE
+
+namespace
+{
+  // number of heap bytes currently in use (0 if unknown on this platform)
+  std::size_t heapInUse()
+  {
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+    #elif defined(__GLIBC__)
+    return static_cast<unsigned>(mallinfo().uordblks);
+    #else
+    return 0;
+    #endif
+  }
+
+  double seconds(const boost::posix_time::ptime& start)
+  {
+    return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1000000.0;
+  }
+
+  template<typename TableT>
+  void report(const char* name, const std::vector<Tuple>& tuples, std::size_t bytes, double storeTime,
+      const TableT& table)
+  {
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    unsigned found = 0;
+    for(unsigned i = 0; i < tuples.size(); ++i)
+      if( table.getIDByTuple(tuples[i]).address == i )
+        found++;
+    double lookupTime = seconds(start);
+    if( found != tuples.size() )
+      std::cerr << name << " found only " << found << " of " << tuples.size() << " atoms" << std::endl;
+    std::cout << name << ";" << tuples.size() << ";" << bytes << ";" <<
+      (static_cast<double>(bytes) / tuples.size()) << ";" << storeTime << ";" << lookupTime << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned atoms = 1000000;
+  unsigned arity = 2;
+  if( argc > 1 ) atoms = boost::lexical_cast<unsigned>(argv[1]);
+  if( argc > 2 ) arity = boost::lexical_cast<unsigned>(argv[2]);
+  if( atoms == 0 ) atoms = 1;
+
+  // edge(c<i>,c<i+1>,...) over a pool of constants
+  TermTable ttab;
+  ID idp = ttab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "edge"));
+  const unsigned constants = 1000;
+  std::vector<ID> consts;
+  std::vector<std::string> symbols;
+  for(unsigned i = 0; i < constants; ++i)
+  {
+    std::ostringstream sym; sym << "c" << i;
+    symbols.push_back(sym.str());
+    consts.push_back(ttab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, sym.str())));
+  }
+  std::vector<Tuple> tuples(atoms);
+  for(unsigned i = 0; i < atoms; ++i)
+  {
+    tuples[i].push_back(idp);
+    unsigned rest = i;
+    for(unsigned a = 0; a < arity; ++a)
+    {
+      tuples[i].push_back(consts[rest % constants]);
+      rest /= constants;
+    }
+  }
+
+  const IDKind kind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG;
+  std::cout << "table;atoms;heap_bytes;bytes_per_atom;store_seconds;lookup_seconds" << std::endl;
+  {
+    std::size_t before = heapInUse();
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    OrdinaryAtomTable oatab;
+    for(unsigned i = 0; i < atoms; ++i)
+    {
+      // the same text as built by Registry::storeOrdinaryAtom
+      std::string text = "edge(" + symbols[tuples[i][1].address - 1];
+      for(unsigned a = 2; a <= arity; ++a)
+        text += "," + symbols[tuples[i][a].address - 1];
+      text += ")";
+      oatab.storeAndGetID(OrdinaryAtom(kind, text, tuples[i]));
+    }
+    double storeTime = seconds(start);
+    report("OrdinaryAtomTable", tuples, heapInUse() - before, storeTime, oatab);
+  }
+  {
+    std::size_t before = heapInUse();
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    CompactOrdinaryAtomTable catab;
+    for(unsigned i = 0; i < atoms; ++i)
+      catab.getIDByTupleOrStore(kind, tuples[i]);
+    double storeTime = seconds(start);
+    report("CompactOrdinaryAtomTable", tuples, heapInUse() - before, storeTime, catab);
+  }
+  return 0;
+}
+
+// Local Variables:
+// mode: C++
+// End:
@@ -0,0 +1,157 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   BenchmarkTableLookup.cpp
+ *
+ * @brief  Microbenchmark for registry table lookups from multiple threads.
+ *
+ * Stores a number of ground atoms and measures the throughput of
+ * OrdinaryAtomTable::getIDByTuple/getByID and TermTable::getByID lookups
+ * for an increasing number of threads, once with the default storage mode
+ * and once with the concurrent storage mode (see ConcurrentTable.h).
+ *
+ * Usage: BenchmarkTableLookup [atoms [lookups-per-thread [max-threads]]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Term.h"
+#include "dlvhex2/Atoms.h"
+#include "dlvhex2/TermTable.h"
+#include "dlvhex2/OrdinaryAtomTable.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+LOG_INIT(Logger::ERROR | Logger::WARNING)
+
+DLVHEX_NAMESPACE_USE
+
+namespace
+{
+  struct Lookups
+  {
+    const TermTable& ttab;
+    const OrdinaryAtomTable& oatab;
+    const std::vector<Tuple>& tuples;
+    unsigned lookups;
+    unsigned offset;
+    unsigned long& found;
+
+    Lookups(const TermTable& ttab, const OrdinaryAtomTable& oatab, const std::vector<Tuple>& tuples,
+        unsigned lookups, unsigned offset, unsigned long& found):
+      ttab(ttab), oatab(oatab), tuples(tuples), lookups(lookups), offset(offset), found(found) {}
+
+    void operator()()
+    {
+      unsigned long f = 0;
+      // stride through the tuples such that threads do not access the same atoms in lockstep
+      unsigned pos = offset;
+      for(unsigned i = 0; i < lookups; ++i)
+      {
+        const Tuple& tup = tuples[pos];
+        ID id = oatab.getIDByTuple(tup);
+        if( id != ID_FAIL && oatab.getByID(id).tuple.size() == tup.size() &&
+            !ttab.getByID(tup[1]).symbol.empty() )
+          f++;
+        pos += 7919;
+        if( pos >= tuples.size() ) pos -= tuples.size();
+      }
+      found = f;
+    }
+  };
+
+  double run(const TermTable& ttab, const OrdinaryAtomTable& oatab, const std::vector<Tuple>& tuples,
+      unsigned threads, unsigned lookups)
+  {
+    std::vector<unsigned long> found(threads, 0);
+    boost::thread_group group;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for(unsigned t = 0; t < threads; ++t)
+      group.create_thread(Lookups(ttab, oatab, tuples, lookups, (t * 104729) % tuples.size(), found[t]));
+    group.join_all();
+    boost::posix_time::time_duration d = boost::posix_time::microsec_clock::universal_time() - start;
+    for(unsigned t = 0; t < threads; ++t)
+      if( found[t] != lookups )
+        std::cerr << "thread " << t << " found only " << found[t] << " of " << lookups << " atoms" << std::endl;
+    return static_cast<double>(threads) * lookups / (d.total_microseconds() / 1000000.0);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned atoms = 100000;
+  unsigned lookups = 1000000;
+  unsigned maxThreads = boost::thread::hardware_concurrency();
+  if( argc > 1 ) atoms = boost::lexical_cast<unsigned>(argv[1]);
+  if( argc > 2 ) lookups = boost::lexical_cast<unsigned>(argv[2]);
+  if( argc > 3 ) maxThreads = boost::lexical_cast<unsigned>(argv[3]);
+  if( maxThreads == 0 ) maxThreads = 1;
+
+  // p(c0), ..., p(c<atoms-1>)
+  TermTable ttab;
+  OrdinaryAtomTable oatab;
+  ID idp = ttab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "p"));
+  std::vector<Tuple> tuples;
+  tuples.reserve(atoms);
+  for(unsigned i = 0; i < atoms; ++i)
+  {
+    std::ostringstream sym; sym << "c" << i;
+    ID idc = ttab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, sym.str()));
+    Tuple tup; tup.push_back(idp); tup.push_back(idc);
+    oatab.storeAndGetID(OrdinaryAtom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, "p(" + sym.str() + ")", tup));
+    tuples.push_back(tup);
+  }
+
+  std::cout << "mode;threads;lookups_per_second;speedup" << std::endl;
+  for(unsigned mode = 0; mode <= 1; ++mode)
+  {
+    ttab.setConcurrentStorage(mode == 1);
+    oatab.setConcurrentStorage(mode == 1);
+    const char* modeName = (mode == 1) ? "concurrent" : "default";
+    double base = 0;
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+      double throughput = run(ttab, oatab, tuples, threads, lookups);
+      if( threads == 1 ) base = throughput;
+      std::cout << modeName << ";" << threads << ";" << static_cast<unsigned long>(throughput) << ";" << (throughput / base) << std::endl;
+    }
+  }
+  return 0;
+}
+
+// Local Variables:
+// mode: C++
+// End:
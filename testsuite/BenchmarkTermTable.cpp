@@ -0,0 +1,199 @@
+/* dlvhex -- Answer-Set Programming with external interfaces.
+ * Copyright (C) 2005-2007 Roman Schindlauer
+ * Copyright (C) 2006-2015 Thomas Krennwallner
+ * Copyright (C) 2009-2016 Peter Schüller
+ * Copyright (C) 2011-2016 Christoph Redl
+ * Copyright (C) 2015-2016 Tobias Kaminski
+ * Copyright (C) 2015-2016 Antonius Weinzierl
+ *
+ * This file is part of dlvhex.
+ *
+ * dlvhex is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * dlvhex is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with dlvhex; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA.
+ */
+
+/**
+ * @file   BenchmarkTermTable.cpp
+ *
+ * @brief  Microbenchmark for interning constants in the TermTable.
+ *
+ * Stores node constants as they occur in term-heavy instances (e.g., the
+ * reachability benchmark with symbolic node names) once in a table with a
+ * hashed multi_index over std::string symbols (the former TermTable layout)
+ * and once in the TermTable, and reports the heap bytes per term as well as
+ * the time for storing all terms and for looking them up by std::string and
+ * by boost::string_ref into an input buffer.
+ *
+ * Usage: BenchmarkTermTable [terms [lookups]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include "dlvhex2/ID.h"
+#include "dlvhex2/Term.h"
+#include "dlvhex2/TermTable.h"
+
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+LOG_INIT(Logger::ERROR | Logger::WARNING)
+
+DLVHEX_NAMESPACE_USE
+
+namespace
+{
+  // the TermTable layout before symbols were interned using impl::SymbolIndex
+  class StringIndexedTermTable:
+  public Table<Term, boost::multi_index::indexed_by<
+    boost::multi_index::random_access<boost::multi_index::tag<impl::AddressTag> >,
+    boost::multi_index::hashed_unique<boost::multi_index::tag<impl::TermTag>,
+      BOOST_MULTI_INDEX_MEMBER(Term,std::string,symbol)> > >
+  {
+  public:
+    typedef Container::index<impl::AddressTag>::type AddressIndex;
+    typedef Container::index<impl::TermTag>::type TermIndex;
+
+    ID getIDByString(const std::string& str) const
+    {
+      ReadLock lock(mutex);
+      const TermIndex& sidx = container.get<impl::TermTag>();
+      TermIndex::const_iterator it = sidx.find(str);
+      if( it == sidx.end() )
+        return ID_FAIL;
+      const AddressIndex& aidx = container.get<impl::AddressTag>();
+      return ID(it->kind, container.project<impl::AddressTag>(it) - aidx.begin());
+    }
+
+    ID storeAndGetID(const Term& symb)
+    {
+      WriteLock lock(mutex);
+      AddressIndex& idx = container.get<impl::AddressTag>();
+      AddressIndex::const_iterator it = idx.push_back(symb).first;
+      return ID(symb.kind, it - idx.begin());
+    }
+  };
+
+  // number of heap bytes currently in use (0 if unknown on this platform)
+  std::size_t heapInUse()
+  {
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+    #elif defined(__GLIBC__)
+    return static_cast<unsigned>(mallinfo().uordblks);
+    #else
+    return 0;
+    #endif
+  }
+
+  double seconds(const boost::posix_time::ptime& start)
+  {
+    return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1000000.0;
+  }
+
+  // lookup by copying the symbol from the input buffer into a std::string (as required by the former API)
+  template<typename TableT>
+  double lookupCopies(const TableT& table, const std::string& buffer,
+      const std::vector<std::pair<std::size_t, std::size_t> >& positions, unsigned lookups, unsigned& found)
+  {
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    found = 0;
+    for(unsigned i = 0; i < lookups; ++i)
+    {
+      const std::pair<std::size_t, std::size_t>& pos = positions[(i * 7919u) % positions.size()];
+      if( table.getIDByString(buffer.substr(pos.first, pos.second)) != ID_FAIL )
+        found++;
+    }
+    return seconds(start);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned terms = 1000000;
+  unsigned lookups = 5000000;
+  if( argc > 1 ) terms = boost::lexical_cast<unsigned>(argv[1]);
+  if( argc > 2 ) lookups = boost::lexical_cast<unsigned>(argv[2]);
+  if( terms == 0 ) terms = 1;
+
+  // input buffer with all symbols, as a parser would see it
+  std::string buffer;
+  std::vector<std::pair<std::size_t, std::size_t> > positions;
+  for(unsigned i = 0; i < terms; ++i)
+  {
+    std::ostringstream sym; sym << "node" << i;
+    positions.push_back(std::make_pair(buffer.size(), sym.str().size()));
+    buffer += sym.str();
+    buffer += ' ';
+  }
+
+  const IDKind kind = ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT;
+  std::cout << "table;terms;heap_bytes;bytes_per_term;store_seconds;lookup_string_seconds;lookup_string_ref_seconds" << std::endl;
+  {
+    std::size_t before = heapInUse();
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    StringIndexedTermTable ttab;
+    for(unsigned i = 0; i < terms; ++i)
+      ttab.storeAndGetID(Term(kind, buffer.substr(positions[i].first, positions[i].second)));
+    double storeTime = seconds(start);
+    std::size_t bytes = heapInUse() - before;
+    unsigned found;
+    double lookupTime = lookupCopies(ttab, buffer, positions, lookups, found);
+    if( found != lookups )
+      std::cerr << "StringIndexedTermTable found only " << found << " of " << lookups << " terms" << std::endl;
+    std::cout << "StringIndexedTermTable;" << terms << ";" << bytes << ";" <<
+      (static_cast<double>(bytes) / terms) << ";" << storeTime << ";" << lookupTime << ";-" << std::endl;
+  }
+  {
+    std::size_t before = heapInUse();
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    TermTable ttab;
+    for(unsigned i = 0; i < terms; ++i)
+      ttab.storeAndGetID(Term(kind, buffer.substr(positions[i].first, positions[i].second)));
+    double storeTime = seconds(start);
+    std::size_t bytes = heapInUse() - before;
+    unsigned found;
+    double lookupTime = lookupCopies(ttab, buffer, positions, lookups, found);
+    start = boost::posix_time::microsec_clock::universal_time();
+    unsigned foundRef = 0;
+    for(unsigned i = 0; i < lookups; ++i)
+    {
+      const std::pair<std::size_t, std::size_t>& pos = positions[(i * 7919u) % positions.size()];
+      if( ttab.getIDByString(boost::string_ref(buffer.data() + pos.first, pos.second)) != ID_FAIL )
+        foundRef++;
+    }
+    double lookupRefTime = seconds(start);
+    if( found != lookups || foundRef != lookups )
+      std::cerr << "TermTable found only " << found << "/" << foundRef << " of " << lookups << " terms" << std::endl;
+    std::cout << "TermTable;" << terms << ";" << bytes << ";" <<
+      (static_cast<double>(bytes) / terms) << ";" << storeTime << ";" << lookupTime << ";" << lookupRefTime << std::endl;
+  }
+  return 0;
+}
+
+// Local Variables:
+// mode: C++
+// End:
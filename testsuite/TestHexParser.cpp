@@ -39,12 +39,15 @@
 #include "dlvhex2/Printer.h"
 #include "dlvhex2/Registry.h"
 #include "dlvhex2/Interpretation.h"
+#include "dlvhex2/Snapshot.h"
+#include "dlvhex2/BulkFactLoader.h"
 
 #define BOOST_TEST_MODULE "TestHexParser"
 #include <boost/test/unit_test.hpp>
 
 #include <iostream>
 #include <fstream>
+#include <cstdio>
 
 #define LOG_REGISTRY_PROGRAM(ctx) \
   LOG(INFO,*ctx.registry()); \
@@ -111,6 +114,286 @@ BOOST_AUTO_TEST_CASE(testHexParserSimple)
 }
 
 
+BOOST_AUTO_TEST_CASE(testHexParserLazyAtomText) 
+{
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+  ctx.registry()->setLazyAtomText(true);
+
+  std::stringstream ss;
+  ss <<
+    "a. c(d,e)." << std::endl <<
+    "f(X) :- c(X,e)." << std::endl;
+
+  InputProviderPtr ip(new InputProvider);
+  ip->addStreamInput(ss, "testinput");
+  ModuleHexParser parser;
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip, ctx));
+
+  // atoms are stored without text and found by tuple
+  BOOST_CHECK(ctx.registry()->ogatoms.getIDByString("c(d,e)") == ID_FAIL);
+  Tuple tcde;
+  tcde.push_back(ctx.registry()->terms.getIDByString("c"));
+  tcde.push_back(ctx.registry()->terms.getIDByString("d"));
+  tcde.push_back(ctx.registry()->terms.getIDByString("e"));
+  ID idcde = ctx.registry()->ogatoms.getIDByTuple(tcde);
+  BOOST_REQUIRE(idcde != ID_FAIL);
+  BOOST_CHECK(ctx.registry()->ogatoms.getByID(idcde).text.empty());
+  BOOST_REQUIRE(ctx.edb != 0);
+  BOOST_CHECK(ctx.edb->getFact(idcde.address));
+
+  // text is rendered on output
+  BOOST_CHECK_EQUAL(printToString<RawPrinter>(idcde, ctx.registry()), "c(d,e)");
+  BOOST_REQUIRE(ctx.idb.size() == 1);
+  const Rule& r = ctx.registry()->rules.getByID(ctx.idb[0]);
+  BOOST_REQUIRE(r.head.size() == 1 && r.body.size() == 1);
+  BOOST_CHECK_EQUAL(printToString<RawPrinter>(r.head[0], ctx.registry()), "f(X)");
+  BOOST_CHECK_EQUAL(printToString<RawPrinter>(r.body[0], ctx.registry()), "c(X,e)");
+
+  // storing the same tuple again yields the same atom
+  OrdinaryAtom oa(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+  oa.tuple = tcde;
+  BOOST_CHECK_EQUAL(ctx.registry()->storeOrdinaryGAtom(oa), idcde);
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserSnapshot) 
+{
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+
+  std::stringstream ss;
+  ss <<
+    "a. c(d,e)." << std::endl <<
+    "f(X) v b :- c(X,Y), not a, X != Y." << std::endl;
+
+  InputProviderPtr ip(new InputProvider);
+  ip->addStreamInput(ss, "testinput");
+  ModuleHexParser parser;
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip, ctx));
+
+  const std::string filename("TestHexParserSnapshot.snapshot");
+  BOOST_REQUIRE_NO_THROW(Snapshot::save(ctx, filename));
+
+  // loading restores the same IDs, facts and rules
+  ProgramCtx ctx2;
+  ctx2.setupRegistry(RegistryPtr(new Registry));
+  BOOST_REQUIRE_NO_THROW(Snapshot::load(ctx2, filename));
+  BOOST_CHECK_EQUAL(ctx2.registry()->terms.getSize(), ctx.registry()->terms.getSize());
+  BOOST_CHECK_EQUAL(ctx2.registry()->ogatoms.getSize(), ctx.registry()->ogatoms.getSize());
+  BOOST_CHECK_EQUAL(ctx2.registry()->ogatoms.getIDByString("c(d,e)"), ctx.registry()->ogatoms.getIDByString("c(d,e)"));
+  BOOST_REQUIRE(ctx2.edb != 0);
+  BOOST_CHECK(ctx2.edb->getStorage() == ctx.edb->getStorage());
+  BOOST_REQUIRE(ctx2.idb == ctx.idb);
+  BOOST_CHECK_EQUAL(
+    printToString<RawPrinter>(ctx2.idb[0], ctx2.registry()),
+    printToString<RawPrinter>(ctx.idb[0], ctx.registry()));
+
+  // a snapshot cannot be loaded twice or into a registry with conflicting entries
+  BOOST_CHECK_THROW(Snapshot::load(ctx2, filename), GeneralError);
+  ProgramCtx ctx3;
+  ctx3.setupRegistry(RegistryPtr(new Registry));
+  ctx3.registry()->storeConstantTerm("x");
+  BOOST_CHECK_THROW(Snapshot::load(ctx3, filename), GeneralError);
+
+  std::remove(filename.c_str());
+}
+
+namespace
+{
+  // collects the EDB of a context as a set of atom texts
+  std::set<std::string> edbTexts(ProgramCtx& ctx)
+  {
+    std::set<std::string> texts;
+    bm::bvector<>::enumerator it = ctx.edb->getStorage().first();
+    for(; it != ctx.edb->getStorage().end(); ++it)
+      texts.insert(printToString<RawPrinter>(ctx.registry()->ogatoms.getIDByAddress(*it), ctx.registry()));
+    return texts;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserBulkFacts) 
+{
+  std::string facts =
+    "a. b() . c(d,\"e f\",7). % comment\n"
+    "c(d, \"g\\\"h\" ,0012).\n";
+
+  // facts first: loaded directly, the rest goes through the parser
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ip(new InputProvider);
+  ip->addStringInput(facts + "f(X) :- c(X,Y,Z). g(1..3).", "testinput");
+  ModuleHexParser parser;
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip, ctx));
+
+  // rule first: everything goes through the parser
+  ProgramCtx ctx2;
+  ctx2.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ip2(new InputProvider);
+  ip2->addStringInput("f(X) :- c(X,Y,Z). g(1..3).\n" + facts, "testinput");
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip2, ctx2));
+
+  std::set<std::string> texts = edbTexts(ctx);
+  BOOST_CHECK_EQUAL(texts.size(), 4);
+  BOOST_CHECK(texts.count("c(d,\"g\\\"h\",12)") == 1);
+  BOOST_CHECK(texts == edbTexts(ctx2));
+  BOOST_CHECK_EQUAL(ctx.maxint, ctx2.maxint);
+  BOOST_CHECK_EQUAL(ctx.idb.size(), 2);
+  BOOST_CHECK_EQUAL(ctx2.idb.size(), 2);
+
+  // invalid input is still reported by the parser
+  ProgramCtx ctx3;
+  ctx3.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ip3(new InputProvider);
+  ip3->addStringInput(facts + "c(d", "testinput");
+  BOOST_CHECK_THROW(parser.parse(ip3, ctx3), SyntaxError);
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserBulkFactsPieces) 
+{
+  const std::string text =
+    "a. c(d,\"e. f\",17).% comment\n"
+    "c(d,\"g\",1234). b.\n";
+
+  ProgramCtx ref;
+  ref.setupRegistry(RegistryPtr(new Registry));
+  ref.edb.reset(new Interpretation(ref.registry()));
+  BulkFactLoader refLoader(ref);
+  BOOST_REQUIRE(refLoader.loadFacts(text.data(), text.data() + text.size()) == text.data() + text.size());
+  BOOST_REQUIRE_EQUAL(refLoader.getFactCount(), 4);
+
+  // split the text at every position, incomplete statements are continued with the next piece
+  for(std::size_t split = 0; split <= text.size(); ++split) {
+    ProgramCtx ctx;
+    ctx.setupRegistry(RegistryPtr(new Registry));
+    ctx.edb.reset(new Interpretation(ctx.registry()));
+    BulkFactLoader loader(ctx);
+    bool nonFact;
+    const char* rest = loader.loadFactsPartial(text.data(), text.data() + split, nonFact);
+    BOOST_CHECK(!nonFact);
+    std::string pending(rest, text.data() + split);
+    pending.append(text, split, std::string::npos);
+    BOOST_CHECK(loader.loadFacts(pending.data(), pending.data() + pending.size()) == pending.data() + pending.size());
+    BOOST_CHECK_EQUAL(loader.getFactCount(), 4);
+    BOOST_CHECK(edbTexts(ctx) == edbTexts(ref));
+    BOOST_CHECK_EQUAL(ctx.maxint, ref.maxint);
+  }
+
+  // rules stop loading
+  const std::string rule = "a. b :- a.";
+  bool nonFact;
+  const char* rest = refLoader.loadFactsPartial(rule.data(), rule.data() + rule.size(), nonFact);
+  BOOST_CHECK(nonFact);
+  BOOST_CHECK_EQUAL(std::string(rest), "b :- a.");
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserBulkFactsParallel) 
+{
+  // large enough for several chunks, with a fact spanning lines and a rule at the end
+  std::stringstream facts;
+  for(unsigned i = 0; i < 40000; ++i) {
+    facts << "edge(n" << (i % 997) << ",\"n " << (i % 1009) << "\"," << i << ").";
+    if( i == 30000 )
+      facts << " multi(a,\n b).";
+    facts << " % node " << i << "\n";
+  }
+  facts << "path(X,Y) :- edge(X,Y,Z).\n";
+  const std::string text = facts.str();
+  const char* rule = text.data() + text.find("path");
+
+  ProgramCtx ref;
+  ref.setupRegistry(RegistryPtr(new Registry));
+  ref.edb.reset(new Interpretation(ref.registry()));
+  BulkFactLoader refLoader(ref);
+  bool nonFact;
+  BOOST_REQUIRE(refLoader.loadFactsPartial(text.data(), text.data() + text.size(), nonFact) == rule);
+  BOOST_CHECK(nonFact);
+
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+  ctx.edb.reset(new Interpretation(ctx.registry()));
+  BulkFactLoader loader(ctx);
+  loader.setThreads(4);
+  BOOST_REQUIRE(text.size() >= 4 * BulkFactLoader::MinimumChunkSize);
+  BOOST_REQUIRE(loader.loadFactsPartial(text.data(), text.data() + text.size(), nonFact) == rule);
+  BOOST_CHECK(nonFact);
+
+  // same IDs as sequential loading
+  BOOST_CHECK_EQUAL(loader.getFactCount(), refLoader.getFactCount());
+  BOOST_CHECK_EQUAL(ctx.maxint, ref.maxint);
+  BOOST_REQUIRE_EQUAL(ctx.registry()->terms.getSize(), ref.registry()->terms.getSize());
+  for(unsigned i = 0; i < ref.registry()->terms.getSize(); ++i)
+    BOOST_CHECK_EQUAL(ctx.registry()->terms.getByID(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, i)).symbol,
+                      ref.registry()->terms.getByID(ID(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, i)).symbol);
+  BOOST_REQUIRE_EQUAL(ctx.registry()->ogatoms.getSize(), ref.registry()->ogatoms.getSize());
+  for(unsigned i = 0; i < ref.registry()->ogatoms.getSize(); ++i)
+    BOOST_CHECK_EQUAL(ctx.registry()->ogatoms.getByAddress(i).text, ref.registry()->ogatoms.getByAddress(i).text);
+  BOOST_CHECK(edbTexts(ctx) == edbTexts(ref));
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserStreamingInput) 
+{
+  const std::string filename("TestHexParserStreamingInput.hex");
+  {
+    std::ofstream file(filename.c_str());
+    file << "f(X) :- c(X,Y)." << std::endl << "c(x,y).";
+  }
+  std::stringstream facts;
+  for(unsigned i = 0; i < 1000; ++i)
+    facts << "c(a" << i << ",b). ";
+  facts << "g(X) :- f(X).";
+
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ip(new InputProvider);
+  ip->addStreamingInput(facts, "<stream>");
+  ip->addFileInput(filename);
+  ModuleHexParser parser;
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip, ctx));
+
+  BOOST_CHECK_EQUAL(edbTexts(ctx).size(), 1001);
+  BOOST_CHECK_EQUAL(ctx.idb.size(), 2);
+
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testHexParserBulkCSV) 
+{
+  const std::string filename("TestHexParserBulkCSV.csv");
+  {
+    std::ofstream csv(filename.c_str());
+    csv << "a;12;b\\;c" << std::endl << std::endl << "x y;;3" << std::endl;
+  }
+
+  // CSV loaded directly
+  ProgramCtx ctx;
+  ctx.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ip(new InputProvider);
+  ip->addCSVFileInput("p", filename);
+  ModuleHexParser parser;
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip, ctx));
+
+  // CSV converted into HEX facts
+  ProgramCtx ctx2;
+  ctx2.setupRegistry(RegistryPtr(new Registry));
+  InputProviderPtr ipcsv(new InputProvider);
+  ipcsv->addCSVFileInput("p", filename);
+  std::ostringstream converted;
+  converted << ipcsv->getAsStream().rdbuf();
+  InputProviderPtr ip2(new InputProvider);
+  ip2->addStringInput("x :- y.\n" + converted.str(), "testinput");
+  BOOST_REQUIRE_NO_THROW(parser.parse(ip2, ctx2));
+
+  std::set<std::string> texts = edbTexts(ctx);
+  BOOST_CHECK_EQUAL(texts.size(), 3);
+  BOOST_CHECK(texts.count("p(0,\"a\",12,\"b\\;c\")") == 1);
+  BOOST_CHECK(texts.count("p(1,\"\")") == 1);
+  BOOST_CHECK(texts.count("p(2,\"x y\",\"\",3)") == 1);
+  BOOST_CHECK(texts == edbTexts(ctx2));
+  BOOST_CHECK_EQUAL(ctx.maxint, ctx2.maxint);
+
+  std::remove(filename.c_str());
+}
+
 BOOST_AUTO_TEST_CASE(testHexParserConstraint) 
 {
   ProgramCtx ctx;
@@ -37,15 +37,28 @@
 #include "dlvhex2/Term.h"
 #include "dlvhex2/Atoms.h"
 #include "dlvhex2/TermTable.h"
+#include "dlvhex2/PredicateTable.h"
 #include "dlvhex2/OrdinaryAtomTable.h"
+#include "dlvhex2/CompactOrdinaryAtomTable.h"
 #include "dlvhex2/BuiltinAtomTable.h"
 #include "dlvhex2/AggregateAtomTable.h"
 #include "dlvhex2/RuleTable.h"
+#include "dlvhex2/MemoryUsage.h"
+#include "dlvhex2/Nogood.h"
+#include "dlvhex2/Interpretation.h"
+#include "dlvhex2/SolverWarmStartCache.h"
+#include "dlvhex2/PersistentAnswerCache.h"
+#include "dlvhex2/Registry.h"
 
 #define BOOST_TEST_MODULE "TestTables"
 #include <boost/test/unit_test.hpp>
 
+#include <boost/thread/thread.hpp>
+
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 LOG_INIT(Logger::ERROR | Logger::WARNING)
 
@@ -134,6 +147,48 @@ BOOST_AUTO_TEST_CASE(testTermTable)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(testTermTableInterning) 
+{
+  // enough terms to grow the symbol index several times
+  std::string buffer;
+  std::vector<std::pair<std::size_t, std::size_t> > positions;
+  for(unsigned i = 0; i < 5000; ++i)
+  {
+    std::ostringstream sym; sym << "c" << i;
+    positions.push_back(std::make_pair(buffer.size(), sym.str().size()));
+    buffer += sym.str() + ",";
+  }
+
+  TermTable stab;
+  for(unsigned i = 0; i < positions.size(); ++i)
+  {
+    boost::string_ref ref(buffer.data() + positions[i].first, positions[i].second);
+    BOOST_CHECK_EQUAL(ID_FAIL, stab.getIDByString(ref));
+    ID id = stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, ref.to_string()));
+    BOOST_CHECK_EQUAL(id.address, i);
+  }
+
+  TermTable copy(stab);
+  for(unsigned i = 0; i < positions.size(); ++i)
+  {
+    boost::string_ref ref(buffer.data() + positions[i].first, positions[i].second);
+    ID id = stab.getIDByString(ref);
+    BOOST_CHECK_EQUAL(id.address, i);
+    BOOST_CHECK(stab.getStringByID(id) == ref);
+    BOOST_CHECK_EQUAL(stab.getIDByString(ref.to_string()), id);
+    BOOST_CHECK_EQUAL(copy.getIDByString(ref), id);
+  }
+  BOOST_CHECK_EQUAL(ID_FAIL, stab.getIDByString(boost::string_ref(buffer.data(), 1)));
+
+  // the index is maintained in concurrent storage mode as well
+  stab.setConcurrentStorage(true);
+  ID id = stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "d"));
+  BOOST_CHECK_EQUAL(stab.getIDByString("d"), id);
+  BOOST_CHECK_EQUAL(stab.getIDByString("c42").address, 42);
+  stab.setConcurrentStorage(false);
+  BOOST_CHECK_EQUAL(stab.getIDByString("d"), id);
+}
+
 BOOST_AUTO_TEST_CASE(testOrdinaryAtomTable) 
 {
 	Term term_a(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "a");
@@ -183,6 +238,199 @@ BOOST_AUTO_TEST_CASE(testOrdinaryAtomTable)
 	}
 }
 
+namespace
+{
+  // stores atoms p(0),...,p(count-1) with pre-stored constant terms
+  struct ConcurrentStorer
+  {
+    OrdinaryAtomTable& oatab;
+    const std::vector<ID>& consts;
+    ConcurrentStorer(OrdinaryAtomTable& oatab, const std::vector<ID>& consts):
+      oatab(oatab), consts(consts) {}
+    void operator()()
+    {
+      for(unsigned i = 0; i < consts.size(); ++i)
+      {
+        Tuple tup; tup.push_back(consts[0]); tup.push_back(consts[i]);
+        std::ostringstream text; text << "p(" << i << ")";
+        OrdinaryAtom at(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, text.str(), tup);
+        oatab.storeAndGetID(at);
+      }
+    }
+  };
+
+  // looks up atoms while they are stored and counts those found with a consistent content
+  struct ConcurrentReader
+  {
+    const OrdinaryAtomTable& oatab;
+    const std::vector<ID>& consts;
+    unsigned& consistent;
+    ConcurrentReader(const OrdinaryAtomTable& oatab, const std::vector<ID>& consts, unsigned& consistent):
+      oatab(oatab), consts(consts), consistent(consistent) {}
+    void operator()()
+    {
+      consistent = 0;
+      for(unsigned i = 0; i < consts.size(); ++i)
+      {
+        Tuple tup; tup.push_back(consts[0]); tup.push_back(consts[i]);
+        ID id;
+        do { id = oatab.getIDByTuple(tup); } while( id == ID_FAIL );
+        if( oatab.getByID(id).tuple == tup )
+          consistent++;
+      }
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(testConcurrentStorage) 
+{
+	Term term_a(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "a");
+	Term term_b(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "b");
+	Predicate pred_p(ID::MAINKIND_TERM | ID::SUBKIND_TERM_PREDICATE, "p", 1);
+
+	{
+		// switching the mode keeps existing entries and addresses
+		TermTable stab;
+		ID ida = stab.storeAndGetID(term_a);
+		stab.setConcurrentStorage(true);
+		BOOST_CHECK(stab.isConcurrentStorage());
+		ID idb = stab.storeAndGetID(term_b);
+		BOOST_CHECK_EQUAL(ida, stab.getIDByString("a"));
+		BOOST_CHECK_EQUAL(idb, stab.getIDByString("b"));
+		BOOST_CHECK_EQUAL(idb.address, 1);
+		BOOST_CHECK_EQUAL(ID_FAIL, stab.getIDByString("c"));
+		BOOST_CHECK_EQUAL(stab.getByID(idb).symbol, "b");
+		BOOST_CHECK_EQUAL(stab.getSize(), 2);
+
+		TermTable copy(stab);
+		BOOST_CHECK(copy.isConcurrentStorage());
+		BOOST_CHECK_EQUAL(idb, copy.getIDByString("b"));
+
+		stab.setConcurrentStorage(false);
+		BOOST_CHECK_EQUAL(idb, stab.getIDByString("b"));
+
+		PredicateTable ptab;
+		ptab.setConcurrentStorage(true);
+		ID idp = ptab.storeAndGetID(pred_p);
+		BOOST_CHECK_EQUAL(idp, ptab.getIDByString("p"));
+		BOOST_CHECK_EQUAL(ptab.getByString("p").arity, 1);
+		BOOST_CHECK_EQUAL(ptab.getByString("q").arity, -1);
+	}
+
+	{
+		// readers look up atoms while a writer stores them
+		const unsigned count = 5000;
+		TermTable stab;
+		stab.setConcurrentStorage(true);
+		std::vector<ID> consts;
+		for(unsigned i = 0; i < count; ++i)
+		{
+			std::ostringstream sym; sym << "c" << i;
+			consts.push_back(stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, sym.str())));
+		}
+
+		OrdinaryAtomTable oatab;
+		oatab.setConcurrentStorage(true);
+		unsigned consistent1, consistent2;
+		boost::thread reader1((ConcurrentReader(oatab, consts, consistent1)));
+		boost::thread reader2((ConcurrentReader(oatab, consts, consistent2)));
+		boost::thread writer((ConcurrentStorer(oatab, consts)));
+		writer.join();
+		reader1.join();
+		reader2.join();
+		BOOST_CHECK_EQUAL(consistent1, count);
+		BOOST_CHECK_EQUAL(consistent2, count);
+		BOOST_CHECK_EQUAL(oatab.getSize(), count);
+		BOOST_CHECK_EQUAL(oatab.getIDByString("p(42)").address, 42);
+	}
+}
+
+namespace
+{
+  // builds "pred(arg1,...)" from symbols stored in a TermTable
+  struct TermTextBuilder
+  {
+    const TermTable& ttab;
+    TermTextBuilder(const TermTable& ttab): ttab(ttab) {}
+    std::string operator()(const Tuple& tuple) const
+    {
+      std::ostringstream s;
+      s << ttab.getByID(tuple.front()).symbol;
+      for(unsigned i = 1; i < tuple.size(); ++i)
+        s << (i == 1 ? "(" : ",") << ttab.getByID(tuple[i]).symbol;
+      if( tuple.size() > 1 )
+        s << ")";
+      return s.str();
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(testCompactOrdinaryAtomTable) 
+{
+	const unsigned count = 1000;
+	TermTable stab;
+	ID idp = stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "p"));
+	ID idq = stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, "q"));
+	std::vector<ID> consts;
+	for(unsigned i = 0; i < count; ++i)
+	{
+		std::ostringstream sym; sym << "c" << i;
+		consts.push_back(stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, sym.str())));
+	}
+
+	CompactOrdinaryAtomTable catab;
+	OrdinaryAtomTable oatab;
+	const IDKind kind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG;
+
+	// atoms of different arity with the same prefix must be distinguished
+	Tuple tupq; tupq.push_back(idq);
+	BOOST_CHECK_EQUAL(ID_FAIL, catab.getIDByTuple(tupq));
+	ID idatq = catab.storeAndGetID(OrdinaryAtom(kind, "q", tupq));
+	BOOST_CHECK_EQUAL(idatq, ID(kind, 0));
+	for(unsigned i = 0; i < count; ++i)
+	{
+		Tuple tup; tup.push_back(idp); tup.push_back(consts[i]);
+		if( i % 2 == 0 )
+			tup.push_back(consts[(i * 7) % count]);
+		std::string text = TermTextBuilder(stab)(tup);
+		ID idc = catab.storeAndGetID(OrdinaryAtom(kind, text, tup));
+		ID ido = oatab.storeAndGetID(OrdinaryAtom(kind, text, tup));
+		BOOST_CHECK_EQUAL(idc.address, i + 1);
+		BOOST_CHECK_EQUAL(ido.address, i);
+	}
+	BOOST_CHECK_EQUAL(catab.getSize(), count + 1);
+
+	// without text builder, atoms have no text
+	BOOST_CHECK_EQUAL(catab.getByAddress(0).text, "");
+	catab.setTextBuilder(TermTextBuilder(stab));
+
+	unsigned consistent = 0;
+	for(unsigned i = 0; i < count; ++i)
+	{
+		const OrdinaryAtom& oa = oatab.getByAddress(i);
+		ID idc = catab.getIDByTuple(oa.tuple);
+		OrdinaryAtom ca = catab.getByID(idc);
+		if( idc.address == i + 1 && ca.tuple == oa.tuple && ca.text == oa.text && ca.kind == oa.kind &&
+			catab.getPredicateByAddress(idc.address) == idp )
+			consistent++;
+	}
+	BOOST_CHECK_EQUAL(consistent, count);
+	BOOST_CHECK_EQUAL(catab.getTextByAddress(0), "q");
+
+	// lookup of unknown tuples and store-if-missing
+	Tuple tupqa; tupqa.push_back(idq); tupqa.push_back(consts[0]);
+	BOOST_CHECK_EQUAL(ID_FAIL, catab.getIDByTuple(tupqa));
+	ID idatqa = catab.getIDByTupleOrStore(kind, tupqa);
+	BOOST_CHECK_EQUAL(idatqa.address, count + 1);
+	BOOST_CHECK_EQUAL(idatqa, catab.getIDByTupleOrStore(kind, tupqa));
+	BOOST_CHECK_EQUAL(catab.getTextByAddress(idatqa.address), "q(c0)");
+	BOOST_CHECK(catab.getMemoryUsage() > 0);
+
+	catab.clear();
+	BOOST_CHECK_EQUAL(catab.getSize(), 0);
+	BOOST_CHECK_EQUAL(ID_FAIL, catab.getIDByTuple(tupq));
+}
+
 BOOST_AUTO_TEST_CASE(testBuiltinAtomTable) 
 {
   ID idint(ID::MAINKIND_TERM | ID::SUBKIND_TERM_BUILTIN, ID::TERM_BUILTIN_INT);
@@ -357,6 +605,294 @@ BOOST_AUTO_TEST_CASE(testRuleTable)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(testMemoryUsage) 
+{
+  const memory::DynamicSize dynamicSize;
+
+  TermTable stab;
+  const std::size_t emptyBytes = stab.getMemoryUsage(dynamicSize);
+  for(unsigned i = 0; i < 100; ++i)
+  {
+    std::ostringstream s;
+    s << "a_rather_long_constant_name_" << i;
+    stab.storeAndGetID(Term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, s.str()));
+  }
+  // each term stores at least its value and its (heap allocated) symbol
+  BOOST_CHECK_GE(stab.getMemoryUsage(dynamicSize), emptyBytes + 100 * (sizeof(Term) + 28));
+
+  memory::Report report;
+  report.add("terms", 100);
+  report.add("rules", 20);
+  report.add("terms", 5);
+  BOOST_REQUIRE_EQUAL(report.getEntries().size(), 2);
+  BOOST_CHECK_EQUAL(report.getEntries()[0].second, 105);
+  BOOST_CHECK_EQUAL(report.getTotal(), 125);
+  std::ostringstream out;
+  out << report;
+  BOOST_CHECK_EQUAL(out.str(), "terms;105;rules;20;total;125");
+
+  memory::Report peak;
+  peak.updatePeak(report);
+  memory::Report smaller;
+  smaller.add("terms", 50);
+  smaller.add("nogoods", 7);
+  peak.updatePeak(smaller);
+  BOOST_CHECK_EQUAL(peak.getTotal(), 132);
+
+  // nogood sets account for their nogoods globally
+  const std::size_t nogoodBytes = NogoodSet::getTotalMemoryUsage();
+  {
+    NogoodSet ngs;
+    Nogood ng;
+    ng.insert(NogoodContainer::createLiteral(1, true));
+    ng.insert(NogoodContainer::createLiteral(2, false));
+    ngs.addNogood(ng);
+    // the total only counts the nogoods, not the indices of the set
+    const std::size_t added = NogoodSet::getTotalMemoryUsage() - nogoodBytes;
+    BOOST_CHECK_GT(added, 0);
+    BOOST_CHECK_LE(added, ngs.getMemoryUsage());
+    NogoodSet copy(ngs);
+    BOOST_CHECK_EQUAL(NogoodSet::getTotalMemoryUsage(), nogoodBytes + 2 * added);
+  }
+  BOOST_CHECK_EQUAL(NogoodSet::getTotalMemoryUsage(), nogoodBytes);
+}
+
+BOOST_AUTO_TEST_CASE(testNogoodSetClear) 
+{
+  NogoodSet ngs;
+  Nogood ng1, ng2;
+  ng1.insert(NogoodContainer::createLiteral(1, true));
+  ng1.insert(NogoodContainer::createLiteral(2, false));
+  ng2.insert(NogoodContainer::createLiteral(3, true));
+  ng2.recomputeHash();
+  BOOST_REQUIRE_EQUAL(ngs.addNogood(ng1), 0);
+  BOOST_REQUIRE_EQUAL(ngs.addNogood(ng2), 1);
+  const std::size_t bytes = ngs.getMemoryUsage();
+
+  // cleared nogoods keep their index but release their literals
+  ngs.clearNogood(0);
+  BOOST_CHECK_EQUAL(ngs.getNogoodCount(), 2);
+  BOOST_CHECK(ngs.getNogood(0).empty());
+  BOOST_CHECK(ngs.getNogood(1) == ng2);
+  BOOST_CHECK_LT(ngs.getMemoryUsage(), bytes);
+
+  // the slot is not reused and the nogood can be added again
+  BOOST_CHECK_EQUAL(ngs.addNogood(ng1), 2);
+  BOOST_CHECK_EQUAL(ngs.addNogood(ng2), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testNogoodSetCompactLiterals) 
+{
+  // ground and nonground literals survive the compact encoding
+  Nogood ng;
+  ng.insert(NogoodContainer::createLiteral(7, true));
+  ng.insert(NogoodContainer::createLiteral(8, false));
+  ng.insert(NogoodContainer::createLiteral(3, false, false));
+  ng.insert(NogoodContainer::createLiteral(4, true, false));
+  BOOST_CHECK_EQUAL(NogoodSet::compactLiteral(NogoodContainer::createLiteral(8, false)), 17);
+  BOOST_FOREACH (ID lit, ng) {
+    BOOST_CHECK(NogoodSet::expandLiteral(NogoodSet::compactLiteral(lit)) == lit);
+  }
+
+  NogoodSet ngs;
+  int index = ngs.addNogood(ng);
+  ng.recomputeHash();
+  BOOST_CHECK(ngs.getNogood(index) == ng);
+  BOOST_CHECK(!ngs.getNogood(index).isGround());
+  BOOST_REQUIRE_EQUAL(ngs.getNogoodSize(index), 4);
+  BOOST_CHECK(std::equal(ngs.getLiterals(index).begin(), ngs.getLiterals(index).end(), ng.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(testInterpretationSharing) 
+{
+  Interpretation intr;
+  intr.setFact(1); intr.setFact(5); intr.setFact(70000);
+
+  // copies share the bitset until one of them is modified
+  Interpretation copy(intr);
+  BOOST_CHECK(copy.sharesStorageWith(intr));
+  BOOST_CHECK(copy == intr);
+  copy.setFact(7);
+  BOOST_CHECK(!copy.sharesStorageWith(intr));
+  BOOST_CHECK(copy.getFact(7));
+  BOOST_CHECK(!intr.getFact(7));
+
+  Interpretation assigned;
+  assigned = intr;
+  BOOST_CHECK(assigned.sharesStorageWith(intr));
+  assigned.getStorage() &= copy.getStorage();
+  BOOST_CHECK(!assigned.sharesStorageWith(intr));
+  BOOST_CHECK(intr.getFact(70000));
+
+  // masked views iterate the intersection without materializing it
+  Interpretation mask;
+  mask.setFact(5); mask.setFact(6); mask.setFact(70000); mask.setFact(80000);
+  InterpretationMaskView view = copy.getMaskedView(mask);
+  std::vector<IDAddress> bits;
+  InterpretationMaskView::TrueBitIterator it, it_end;
+  for(boost::tie(it, it_end) = view.trueBits(); it != it_end; ++it)
+    bits.push_back(*it);
+  BOOST_REQUIRE_EQUAL(bits.size(), 2);
+  BOOST_CHECK_EQUAL(bits[0], 5);
+  BOOST_CHECK_EQUAL(bits[1], 70000);
+  BOOST_CHECK_EQUAL(view.count(), 2);
+  BOOST_CHECK(!view.isClear());
+  BOOST_CHECK(view.getFact(5));
+  BOOST_CHECK(!view.getFact(6));
+  BOOST_CHECK(view.isSubsetOf(intr.getStorage()));
+  Interpretation other;
+  other.setFact(5);
+  BOOST_CHECK(!view.isSubsetOf(other.getStorage()));
+
+  Interpretation projected;
+  view.materialize(projected);
+  BOOST_CHECK_EQUAL(projected.getStorage().count(), 2);
+  BOOST_CHECK(projected.getFact(70000));
+
+  Interpretation empty;
+  BOOST_CHECK(empty.getMaskedView(mask).isClear());
+  boost::tie(it, it_end) = empty.getMaskedView(mask).trueBits();
+  BOOST_CHECK(it == it_end);
+}
+
+BOOST_AUTO_TEST_CASE(testSolverWarmStartCache) 
+{
+  const std::string filename = "TestTables_warmstart.tmp";
+  std::remove(filename.c_str());
+
+  SolverWarmStartCache::Entry e1;
+  e1.atoms.push_back("a"); e1.atoms.push_back("p(\"x y\")");
+  e1.phases.push_back(1); e1.phases.push_back(0);
+  e1.nogoods.push_back(std::vector<int>(1, 2));
+  e1.nogoods.push_back(std::vector<int>(2, -1));
+  SolverWarmStartCache::Entry e2;
+  e2.atoms.push_back("b");
+  e2.phases.push_back(2);
+
+  // a missing file yields an empty cache
+  SolverWarmStartCache cache(filename, 3);
+  cache.load();
+  SolverWarmStartCache::Entry found;
+  BOOST_CHECK(!cache.lookup(1, found));
+  cache.store(1, e1);
+  cache.store(2, e2);
+  cache.save();
+
+  // entries survive saving and loading
+  SolverWarmStartCache loaded(filename, 3);
+  loaded.load();
+  BOOST_REQUIRE(loaded.lookup(1, found));
+  BOOST_CHECK(found.atoms == e1.atoms);
+  BOOST_CHECK(found.phases == e1.phases);
+  BOOST_CHECK(found.nogoods == e1.nogoods);
+  BOOST_REQUIRE(loaded.lookup(2, found));
+  BOOST_CHECK(found.nogoods.empty());
+
+  // entry 2 was used more recently than entry 1 and is kept when the bound is exceeded
+  loaded.store(3, e2);
+  BOOST_CHECK(!loaded.lookup(1, found));
+  BOOST_CHECK(loaded.lookup(2, found));
+  BOOST_CHECK(loaded.lookup(3, found));
+
+  // corrupt files are ignored
+  {
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    out << "garbage";
+  }
+  loaded.load();
+  BOOST_CHECK(!loaded.lookup(2, found));
+  std::remove(filename.c_str());
+}
+
+namespace
+{
+  class TestCachePlugin: public PluginInterface
+  {
+  public:
+    TestCachePlugin() { setNameVersion("testcacheplugin", 1, 2, 3); }
+  };
+
+  // builds the query &ext[a](<pattern>) with input interpretation {p(a)} in a registry
+  PluginAtom::Query makeCacheQuery(RegistryPtr reg, const char* patternVariable, bool withInterpretation)
+  {
+    const ID a = reg->storeConstantTerm("a");
+    InterpretationPtr intr(new Interpretation(reg));
+    if( withInterpretation ) {
+      OrdinaryAtom pa(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+      pa.tuple.push_back(reg->storeConstantTerm("p"));
+      pa.tuple.push_back(a);
+      pa.text = "p(a)";
+      intr->setFact(reg->ogatoms.storeAndGetID(pa).address);
+    }
+    return PluginAtom::Query(0, intr, Tuple(1, a), Tuple(1, reg->storeVariableTerm(patternVariable)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testPersistentAnswerCache) 
+{
+  const std::string filename = "TestTables_extcache.tmp";
+  std::remove(filename.c_str());
+  TestCachePlugin plugin;
+
+  RegistryPtr reg(new Registry);
+  PersistentAnswerCache cache(filename, 2);
+  cache.load();
+  cache.registerPluginAtom("ext", plugin);
+
+  // only registered predicates and complete interpretations are cached
+  std::string key, key2;
+  PluginAtom::Query query = makeCacheQuery(reg, "X", true);
+  BOOST_CHECK(!cache.computeKey(reg, "other", query, key));
+  PluginAtom::Query partialQuery = query;
+  partialQuery.assigned = query.interpretation;
+  BOOST_CHECK(!cache.computeKey(reg, "ext", partialQuery, key));
+
+  // keys do not depend on variable names but on the input interpretation
+  BOOST_REQUIRE(cache.computeKey(reg, "ext", query, key));
+  BOOST_REQUIRE(cache.computeKey(reg, "ext", makeCacheQuery(reg, "Y", true), key2));
+  BOOST_CHECK(key == key2);
+  BOOST_REQUIRE(cache.computeKey(reg, "ext", makeCacheQuery(reg, "X", false), key2));
+  BOOST_CHECK(key != key2);
+
+  // answer with nested, integer and quoted terms
+  std::vector<ID> fa;
+  fa.push_back(reg->storeConstantTerm("f"));
+  fa.push_back(reg->storeConstantTerm("a"));
+  Term nested(ID::MAINKIND_TERM | ID::SUBKIND_TERM_NESTED, fa, reg);
+  PluginAtom::Answer answer;
+  answer.get().push_back(Tuple(1, reg->terms.storeAndGetID(nested)));
+  answer.get().push_back(Tuple(1, ID::termFromInteger(3)));
+  answer.get().push_back(Tuple(1, reg->storeConstantTerm("\"x y\"")));
+  PluginAtom::Answer found;
+  BOOST_CHECK(!cache.lookup(reg, key, found));
+  cache.store(reg, key, answer);
+  cache.store(reg, key2, PluginAtom::Answer());
+  cache.save();
+
+  // answers survive saving and loading into a fresh registry
+  RegistryPtr reg2(new Registry);
+  PersistentAnswerCache loaded(filename, 1);
+  loaded.load();
+  loaded.registerPluginAtom("ext", plugin);
+  BOOST_REQUIRE(loaded.computeKey(reg2, "ext", makeCacheQuery(reg2, "Z", true), key2));
+  BOOST_CHECK(key == key2);
+  BOOST_REQUIRE(loaded.lookup(reg2, key2, found));
+  BOOST_REQUIRE_EQUAL(found.get().size(), 3);
+  BOOST_CHECK(found.get()[0][0].isNestedTerm());
+  BOOST_CHECK_EQUAL(reg2->terms.getByID(found.get()[0][0]).symbol, "f(a)");
+  BOOST_CHECK(found.get()[1][0] == ID::termFromInteger(3));
+  BOOST_CHECK_EQUAL(reg2->terms.getByID(found.get()[2][0]).symbol, "\"x y\"");
+  BOOST_CHECK_EQUAL(loaded.getHits(), 1);
+
+  // the entry which was used most recently is kept when the bound is exceeded
+  loaded.save();
+  loaded.load();
+  BOOST_CHECK(loaded.lookup(reg2, key2, found));
+  BOOST_REQUIRE(loaded.computeKey(reg2, "ext", makeCacheQuery(reg2, "X", false), key2));
+  BOOST_CHECK(!loaded.lookup(reg2, key2, found));
+  std::remove(filename.c_str());
+}
+
 // Local Variables:
 // mode: C++
 // End: